@@ -87,11 +87,13 @@ void restoreConnections(TextureProject& project, const NodeSnapshot& snapshot) {
 }
 
 void restoreNode(TextureProject& project, const NodeSnapshot& snapshot) {
+   TextureProject::InvalidationBatch batch(project);
    restoreNodeState(project, snapshot);
    restoreConnections(project, snapshot);
 }
 
 void restoreNodes(TextureProject& project, const QList<NodeSnapshot>& snapshots) {
+   TextureProject::InvalidationBatch batch(project);
    for (const NodeSnapshot& snapshot : snapshots) {
       restoreNodeState(project, snapshot);
    }
@@ -239,6 +241,7 @@ private:
       if (receiver.isNull()) {
          return;
       }
+      TextureProject::InvalidationBatch batch(project);
       for (const QString& slot : receiver->getSourceSlots()) {
          receiver->setSourceSlot(slot, 0);
       }
@@ -302,6 +305,7 @@ public:
                                           : QStringLiteral("Paste nodes"));
    }
    void undo() override {
+      TextureProject::InvalidationBatch batch(project);
       for (auto snapshot = snapshots.crbegin(); snapshot != snapshots.crend(); ++snapshot) {
          project.removeNode(snapshot->id);
       }
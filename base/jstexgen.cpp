@@ -16,12 +16,14 @@
 #include <limits>
 #include <map>
 #include <mutex>
-#include <set>
 #include <stdexcept>
+#include <thread>
 #include <utility>
+#include <vector>
 
 std::atomic<quint64> JsTexGen::nextStableId{1};
 std::atomic<quint64> JsTexGen::evaluationCount{0};
+std::atomic<quint64> JsTexGen::bridgeCopies{0};
 
 namespace {
 
@@ -495,8 +497,8 @@ struct WorkerRuntime {
 thread_local std::unique_ptr<WorkerRuntime> workerRuntime;
 /// @brief Protects activeEngines during cross-thread interruption requests.
 std::mutex activeEnginesMutex;
-/// @brief Engines currently executing user JavaScript.
-std::set<QJSEngine*> activeEngines;
+/// @brief Engines currently executing user JavaScript and the threads running them.
+std::map<QJSEngine*, std::thread::id> activeEngines;
 
 /// @brief Registers a QJSEngine as interruptible for the duration of one operation.
 class ActiveEngine final {
@@ -506,7 +508,7 @@ public:
    explicit ActiveEngine(QJSEngine& engine) : engine(engine) {
       engine.setInterrupted(false);
       std::lock_guard lock(activeEnginesMutex);
-      activeEngines.insert(&engine);
+      activeEngines.emplace(&engine, std::this_thread::get_id());
    }
 
    /// @brief Unregisters the engine and clears its interruption state.
@@ -558,7 +560,7 @@ QJSValue settingValue(QJSEngine& engine, const QJSValue& freeze, const QVariant&
 
 /// @brief Creates an immutable JavaScript image view backed by a QByteArray buffer.
 /// @param runtime Worker runtime that owns the returned JavaScript values.
-/// @param bytes Tightly packed RGBA image bytes.
+/// @param bytes Tightly packed RGBA image bytes, which the view shares instead of copying.
 /// @param size Image dimensions.
 /// @param buffer Destination retaining the ArrayBuffer-compatible Qt bridge value.
 /// @return An image object containing data, dimensions, stride, and format.
@@ -664,9 +666,48 @@ void JsTexGen::generate(const QSize size, TexturePixel* destimage,
    if (destimage == nullptr) {
       throw std::invalid_argument("JavaScript destination image is null");
    }
+   if (!nativeImplementation.isNull()) {
+      nativeImplementation->generate(size, destimage, sourceimages, settings);
+      return;
+   }
    generateDescriptor(size, destimage, sourceimages, settings);
 }
 
+QList<QRect> JsTexGen::getTilingRegions(const QSize size, const int pass,
+                                        const int maximumRegionCount) const {
+   if (nativeImplementation.isNull()) {
+      return TextureGenerator::getTilingRegions(size, pass, maximumRegionCount);
+   }
+   return nativeImplementation->getTilingRegions(size, pass, maximumRegionCount);
+}
+
+void JsTexGen::generateRegion(const QSize size, const int pass, const QRect region,
+                              TexturePixel* destimage,
+                              const QMap<QString, TextureImagePtr>& sourceimages,
+                              const TextureNodeSettings& settings) const {
+   if (nativeImplementation.isNull()) {
+      TextureGenerator::generateRegion(size, pass, region, destimage, sourceimages, settings);
+      return;
+   }
+   nativeImplementation->generateRegion(size, pass, region, destimage, sourceimages, settings);
+}
+
+void JsTexGen::setNativeImplementation(TextureGeneratorPtr implementation) {
+   nativeImplementation = std::move(implementation);
+}
+
+QByteArray JsTexGen::getCacheIdentity() const {
+   if (!valid) {
+      return QByteArray();
+   }
+   // Native output may differ from the script's in the last bit of a sine, so the two are cached
+   // separately.
+   if (!nativeImplementation.isNull()) {
+      return nativeImplementation->getCacheIdentity();
+   }
+   return QByteArrayLiteral("js/") + revision;
+}
+
 void JsTexGen::generateDescriptor(const QSize size, TexturePixel* destimage,
                                   const QMap<QString, TextureImagePtr>& sourceimages,
                                   const TextureNodeSettings& settings) const {
@@ -694,12 +735,28 @@ void JsTexGen::generateDescriptor(const QSize size, TexturePixel* destimage,
 
    QJSValue settingsObject = runtime.engine.newObject();
    for (auto iterator = settings.cbegin(); iterator != settings.cend(); ++iterator) {
+      // Scripts only see the settings they declare.
+      if (iterator.key() == QLatin1String(TextureReferenceSizeSetting)) {
+         continue;
+      }
       settingsObject.setProperty(iterator.key(),
                                  settingValue(runtime.engine, runtime.freeze, iterator.value()));
    }
    settingsObject = frozen(runtime.freeze, settingsObject);
 
-   QByteArray outputBytes(static_cast<qsizetype>(byteCount), '\0');
+   // Bundled scripts keep no image view once generate() returns, and the generator tests check
+   // that they leave the cached images of their inputs untouched, so their views alias the images.
+   // User scripts get private buffers, because JavaScript has no read-only typed arrays and a
+   // retained view would outlive its image.
+   const bool sharedBuffers = origin == Origin::BuiltIn;
+   QByteArray outputBytes;
+   if (sharedBuffers) {
+      std::memset(static_cast<void*>(destimage), 0, byteCount);
+      outputBytes = QByteArray::fromRawData(reinterpret_cast<const char*>(destimage),
+                                            static_cast<qsizetype>(byteCount));
+   } else {
+      outputBytes = QByteArray(static_cast<qsizetype>(byteCount), '\0');
+   }
    QJSValue outputBuffer;
    const QJSValue output = imageView(runtime, outputBytes, size, outputBuffer);
 
@@ -717,8 +774,14 @@ void JsTexGen::generateDescriptor(const QSize size, TexturePixel* destimage,
                  .arg(sourceIdentity, slot)
                  .toStdString());
       }
-      const QByteArray sourceBytes(reinterpret_cast<const char*>(source->data()),
-                                   static_cast<qsizetype>(byteCount));
+      const auto* sourceData = reinterpret_cast<const char*>(source->data());
+      QByteArray sourceBytes;
+      if (sharedBuffers) {
+         sourceBytes = QByteArray::fromRawData(sourceData, static_cast<qsizetype>(byteCount));
+      } else {
+         sourceBytes = QByteArray(sourceData, static_cast<qsizetype>(byteCount));
+         bridgeCopies.fetch_add(1, std::memory_order_relaxed);
+      }
       QJSValue sourceBuffer;
       inputs.setProperty(slot, imageView(runtime, sourceBytes, size, sourceBuffer));
       inputBuffers.append(sourceBuffer);
@@ -747,16 +810,33 @@ void JsTexGen::generateDescriptor(const QSize size, TexturePixel* destimage,
                                    .arg(sourceIdentity)
                                    .toStdString());
    }
-   std::memcpy(destimage, rendered.constData(), byteCount);
+   // Scripts that write in place leave nothing to copy, unless Qt detached the shared buffer.
+   if (rendered.constData() != reinterpret_cast<const char*>(destimage)) {
+      std::memcpy(destimage, rendered.constData(), byteCount);
+      bridgeCopies.fetch_add(1, std::memory_order_relaxed);
+   }
 }
 
 void JsTexGen::interruptActiveEngines() {
    std::lock_guard lock(activeEnginesMutex);
-   for (QJSEngine* engine : activeEngines) {
-      engine->setInterrupted(true);
+   for (const auto& engine : activeEngines) {
+      engine.first->setInterrupted(true);
+   }
+}
+
+void JsTexGen::interruptActiveEngines(const std::vector<std::thread::id>& threads) {
+   std::lock_guard lock(activeEnginesMutex);
+   for (const auto& engine : activeEngines) {
+      if (std::find(threads.cbegin(), threads.cend(), engine.second) != threads.cend()) {
+         engine.first->setInterrupted(true);
+      }
    }
 }
 
 quint64 JsTexGen::runtimeEvaluationCount() noexcept {
    return evaluationCount.load(std::memory_order_relaxed);
 }
+
+quint64 JsTexGen::bridgeCopyCount() noexcept {
+   return bridgeCopies.load(std::memory_order_relaxed);
+}
@@ -11,6 +11,8 @@
 #include <QString>
 #include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 
 /// @brief Adapts a validated JavaScript texture-generator definition to TextureGenerator.
 class JsTexGen final : public TextureGenerator {
@@ -25,7 +27,7 @@ public:
    /// @brief Releases the validated definition and its runtime-cache lifetime token.
    ~JsTexGen() override;
 
-   /// @brief Executes the JavaScript generator for one destination image.
+   /// @brief Executes the JavaScript generator, or its native implementation, for one image.
    /// @param size Width and height of the destination and source images.
    /// @param destimage Writable destination pixel buffer.
    /// @param sourceimages Source images keyed by the script's declared input slots.
@@ -34,6 +36,51 @@ public:
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
 
+   /// @brief Reports that the destination is cleared before the script runs.
+   /// @return Always @c true.
+   bool writesEveryPixel() const override { return true; }
+
+   /// @brief Reports whether a native implementation renders regions on separate threads.
+   /// @return @c true when the attached native implementation supports tiling.
+   bool supportsTiling() const override {
+      return !nativeImplementation.isNull() && nativeImplementation->supportsTiling();
+   }
+
+   /// @brief Returns the number of tiling passes of the native implementation.
+   /// @return The pass count of the native implementation, or one without it.
+   int getTilingPassCount() const override {
+      return nativeImplementation.isNull() ? 1 : nativeImplementation->getTilingPassCount();
+   }
+
+   /// @brief Returns the tiling regions of the native implementation.
+   /// @param size Width and height of the destination image.
+   /// @param pass Zero-based tiling pass.
+   /// @param maximumRegionCount Upper bound on the number of returned regions.
+   /// @return Disjoint regions covering the image.
+   QList<QRect> getTilingRegions(QSize size, int pass, int maximumRegionCount) const override;
+
+   /// @brief Renders one region with the native implementation.
+   /// @param size Width and height of the destination and source images.
+   /// @param pass Zero-based tiling pass.
+   /// @param region Pixels to write, in image coordinates.
+   /// @param destimage Writable destination pixel buffer for the whole image.
+   /// @param sourceimages Source images keyed by input-slot name.
+   /// @param settings Current generator settings.
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+
+   /// @brief Renders this generator with C++ code instead of the script.
+   /// @details The implementation must read the script's setting IDs and input slots and write
+   /// the pixels the script writes; it is only attached to bundled scripts, whose source is known.
+   /// Attach it before the generator is rendered.
+   /// @param implementation Native implementation, or null to render the script again.
+   void setNativeImplementation(TextureGeneratorPtr implementation);
+
+   /// @brief Returns the implementation attached by setNativeImplementation().
+   /// @return The native implementation, or null when the script renders.
+   TextureGeneratorPtr getNativeImplementation() const { return nativeImplementation; }
+
    /// @brief Gets the ordered input slots declared by the script.
    /// @return Stable input slot names.
    QStringList getSourceSlots() const override { return inputSlots; }
@@ -78,6 +125,11 @@ public:
    /// @return The digest of the original JavaScript source.
    QByteArray contentRevision() const { return revision; }
 
+   /// @brief Identifies rendered images by the script content, so edits invalidate cached images.
+   /// @return The identity of the native implementation, the content revision of a valid script,
+   /// or an empty array for an invalid one.
+   QByteArray getCacheIdentity() const override;
+
    /// @brief Returns the original source so bundled definitions can be viewed or copied.
    /// @return The complete JavaScript source supplied to the constructor.
    QString source() const { return scriptContent; }
@@ -85,10 +137,22 @@ public:
    /// @brief Interrupts JavaScript currently executing on any render worker.
    static void interruptActiveEngines();
 
+   /// @brief Interrupts JavaScript currently executing on some threads only.
+   /// @details Lets one render engine stop its own scripts without failing the renders of
+   /// another engine that runs at the same time.
+   /// @param threads IDs of the threads whose scripts are interrupted.
+   static void interruptActiveEngines(const std::vector<std::thread::id>& threads);
+
    /// @brief Returns the number of descriptor runtime evaluations, for diagnostics and tests.
    /// @return The process-wide count of descriptor programs evaluated by render workers.
    static quint64 runtimeEvaluationCount() noexcept;
 
+   /// @brief Returns the number of full-image copies made between C++ and JavaScript buffers.
+   /// @details Bundled generators read and write image memory in place; generators loaded from a
+   /// user directory copy each input once and their output once.
+   /// @return The process-wide count of copied images, for benchmarks and tests.
+   static quint64 bridgeCopyCount() noexcept;
+
 private:
    /// @brief Evaluates the definition in an isolated engine and records validated metadata.
    void validate();
@@ -118,6 +182,8 @@ private:
    QStringList inputSlots;
    /// @brief SHA-256 digest of scriptContent.
    QByteArray revision;
+   /// @brief C++ implementation rendering in place of the script, or null.
+   TextureGeneratorPtr nativeImplementation;
    /// @brief Token whose expiration invalidates per-worker runtime cache entries.
    std::shared_ptr<void> lifetimeToken;
    /// @brief Process-unique identifier used as part of the runtime cache key.
@@ -133,6 +199,8 @@ private:
    static std::atomic<quint64> nextStableId;
    /// @brief Counts descriptor evaluations performed by render-worker runtimes.
    static std::atomic<quint64> evaluationCount;
+   /// @brief Counts full-image copies between C++ and JavaScript buffers.
+   static std::atomic<quint64> bridgeCopies;
 };
 
 #endif  // JSTEXGEN_H
@@ -34,6 +34,18 @@ int validBrushOrDefault(const int value, const int fallback) {
    return BackgroundBrushStyles::isSupported(value) ? value : fallback;
 }
 
+bool isValidImageMemoryBudget(const int megabytes) {
+   return megabytes >= 64 && megabytes <= 65536;
+}
+
+bool isValidPreviewLatency(const int milliseconds) {
+   return milliseconds >= 0 && milliseconds <= 1000;
+}
+
+bool isValidProgressivePreviewScale(const int percent) { return percent >= 0 && percent <= 90; }
+
+bool isValidRenderThreads(const int threads) { return threads >= 0 && threads <= 256; }
+
 SettingsManager::TextureFiltering validTextureFilteringOrDefault(const int value) {
    switch (static_cast<SettingsManager::TextureFiltering>(value)) {
       case SettingsManager::TextureFiltering::Smooth:
@@ -53,7 +65,12 @@ SettingsManager::SettingsManager(QObject* parent)
       connectionLabelSize(12),
       displaySourceNames(false),
       displayReceiverNames(false),
-      textureFiltering(TextureFiltering::Smooth) {
+      textureFiltering(TextureFiltering::Smooth),
+      imageMemoryBudget(1024),
+      previewLatency(50),
+      progressivePreviewScale(25),
+      fullSizePreview(false),
+      renderThreads(0) {
    readSettings();
 }
 
@@ -228,6 +245,63 @@ void SettingsManager::setTextureFiltering(const TextureFiltering filtering) {
    }
 }
 
+int SettingsManager::getImageMemoryBudget() const { return imageMemoryBudget; }
+
+void SettingsManager::setImageMemoryBudget(const int megabytes) {
+   if (!isValidImageMemoryBudget(megabytes)) {
+      return;
+   }
+   if (megabytes != imageMemoryBudget) {
+      imageMemoryBudget = megabytes;
+      emit settingsUpdated();
+   }
+}
+
+int SettingsManager::getPreviewLatency() const { return previewLatency; }
+
+void SettingsManager::setPreviewLatency(const int milliseconds) {
+   if (!isValidPreviewLatency(milliseconds)) {
+      return;
+   }
+   if (milliseconds != previewLatency) {
+      previewLatency = milliseconds;
+      emit settingsUpdated();
+   }
+}
+
+int SettingsManager::getProgressivePreviewScale() const { return progressivePreviewScale; }
+
+void SettingsManager::setProgressivePreviewScale(const int percent) {
+   if (!isValidProgressivePreviewScale(percent)) {
+      return;
+   }
+   if (percent != progressivePreviewScale) {
+      progressivePreviewScale = percent;
+      emit settingsUpdated();
+   }
+}
+
+bool SettingsManager::getFullSizePreview() const { return fullSizePreview; }
+
+void SettingsManager::setFullSizePreview(const bool enabled) {
+   if (enabled != fullSizePreview) {
+      fullSizePreview = enabled;
+      emit settingsUpdated();
+   }
+}
+
+int SettingsManager::getRenderThreads() const { return renderThreads; }
+
+void SettingsManager::setRenderThreads(const int threads) {
+   if (!isValidRenderThreads(threads)) {
+      return;
+   }
+   if (threads != renderThreads) {
+      renderThreads = threads;
+      emit settingsUpdated();
+   }
+}
+
 void SettingsManager::loadSettings() {
    if (readSettings()) {
       emit settingsUpdated();
@@ -251,6 +325,11 @@ bool SettingsManager::saveSettings() const {
    settings.setValue("displaysourcenames", displaySourceNames);
    settings.setValue("displayreceivernames", displayReceiverNames);
    settings.setValue("texturefiltering", static_cast<int>(textureFiltering));
+   settings.setValue("imagememorybudget", imageMemoryBudget);
+   settings.setValue("previewlatency", previewLatency);
+   settings.setValue("progressivepreviewscale", progressivePreviewScale);
+   settings.setValue("fullsizepreview", fullSizePreview);
+   settings.setValue("renderthreads", renderThreads);
    settings.sync();
    return settings.status() == QSettings::NoError;
 }
@@ -299,6 +378,23 @@ bool SettingsManager::readSettings() {
    bool newDisplayReceiverNames = settings.value("displayreceivernames", false).toBool();
    const TextureFiltering newTextureFiltering = validTextureFilteringOrDefault(
        settings.value("texturefiltering", static_cast<int>(TextureFiltering::Smooth)).toInt());
+   int newImageMemoryBudget = settings.value("imagememorybudget", 1024).toInt();
+   if (!isValidImageMemoryBudget(newImageMemoryBudget)) {
+      newImageMemoryBudget = 1024;
+   }
+   int newPreviewLatency = settings.value("previewlatency", 50).toInt();
+   if (!isValidPreviewLatency(newPreviewLatency)) {
+      newPreviewLatency = 50;
+   }
+   int newProgressivePreviewScale = settings.value("progressivepreviewscale", 25).toInt();
+   if (!isValidProgressivePreviewScale(newProgressivePreviewScale)) {
+      newProgressivePreviewScale = 25;
+   }
+   bool newFullSizePreview = settings.value("fullsizepreview", false).toBool();
+   int newRenderThreads = settings.value("renderthreads", 0).toInt();
+   if (!isValidRenderThreads(newRenderThreads)) {
+      newRenderThreads = 0;
+   }
 
    bool changed =
        previewSize != newPreviewSize || thumbnailSize != newThumbnailSize ||
@@ -311,7 +407,10 @@ bool SettingsManager::readSettings() {
        nodeBackgroundBrush != newNodeBackgroundBrush ||
        connectionLabelSize != newConnectionLabelSize ||
        displaySourceNames != newDisplaySourceNames ||
-       displayReceiverNames != newDisplayReceiverNames || textureFiltering != newTextureFiltering;
+       displayReceiverNames != newDisplayReceiverNames || textureFiltering != newTextureFiltering ||
+       imageMemoryBudget != newImageMemoryBudget || previewLatency != newPreviewLatency ||
+       progressivePreviewScale != newProgressivePreviewScale ||
+       fullSizePreview != newFullSizePreview || renderThreads != newRenderThreads;
 
    previewSize = newPreviewSize;
    thumbnailSize = newThumbnailSize;
@@ -328,5 +427,10 @@ bool SettingsManager::readSettings() {
    displaySourceNames = newDisplaySourceNames;
    displayReceiverNames = newDisplayReceiverNames;
    textureFiltering = newTextureFiltering;
+   imageMemoryBudget = newImageMemoryBudget;
+   previewLatency = newPreviewLatency;
+   progressivePreviewScale = newProgressivePreviewScale;
+   fullSizePreview = newFullSizePreview;
+   renderThreads = newRenderThreads;
    return changed;
 }
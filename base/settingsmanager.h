@@ -86,6 +86,25 @@ public:
    /// @brief Gets the filtering used for scaled texture previews.
    TextureFiltering getTextureFiltering() const;
 
+   /// @brief Gets the memory budget shared by all cached node images.
+   /// @return The budget in mebibytes.
+   int getImageMemoryBudget() const;
+
+   /// @brief Gets how long an edit may wait for a running thumbnail render before replacing it.
+   /// @return The latency budget in milliseconds.
+   int getPreviewLatency() const;
+
+   /// @brief Gets the size of the quick first pass of thumbnail renders.
+   /// @return The size in percent of the thumbnail size, or zero when the pass is disabled.
+   int getProgressivePreviewScale() const;
+
+   /// @brief Checks whether previewed nodes are also rendered at the preview size.
+   bool getFullSizePreview() const;
+
+   /// @brief Gets the number of worker threads used to render images.
+   /// @return The thread count, or zero to use every hardware thread.
+   int getRenderThreads() const;
+
    /// @brief Reloads persisted settings and emits `settingsUpdated()` if any value changes.
    void loadSettings();
 
@@ -150,6 +169,25 @@ public slots:
    /// @brief Sets the filtering used for scaled texture previews.
    void setTextureFiltering(TextureFiltering filtering);
 
+   /// @brief Sets the memory budget shared by all cached node images.
+   /// @param megabytes The budget in mebibytes, between 64 and 65536.
+   void setImageMemoryBudget(int megabytes);
+
+   /// @brief Sets how long an edit may wait for a running thumbnail render before replacing it.
+   /// @param milliseconds The latency budget in milliseconds, between 0 and 1000.
+   void setPreviewLatency(int milliseconds);
+
+   /// @brief Sets the size of the quick first pass of thumbnail renders.
+   /// @param percent The size in percent of the thumbnail size, between 0 and 90.
+   void setProgressivePreviewScale(int percent);
+
+   /// @brief Sets whether previewed nodes are also rendered at the preview size.
+   void setFullSizePreview(bool enabled);
+
+   /// @brief Sets the number of worker threads used to render images.
+   /// @param threads The thread count between 1 and 256, or zero to use every hardware thread.
+   void setRenderThreads(int threads);
+
 private:
    /// @brief Reads and applies values from `QSettings`.
    /// @return @c true if at least one value changes.
@@ -185,6 +223,16 @@ private:
    bool displayReceiverNames;
    /// @brief Filtering used by node, 2D, and 3D texture previews.
    TextureFiltering textureFiltering;
+   /// @brief Memory budget of cached node images in mebibytes.
+   int imageMemoryBudget;
+   /// @brief Latency budget of thumbnail renders during continuous edits in milliseconds.
+   int previewLatency;
+   /// @brief Size of the first pass of thumbnail renders in percent of the thumbnail size.
+   int progressivePreviewScale;
+   /// @brief Whether previewed nodes are rendered at the preview size after the thumbnails.
+   bool fullSizePreview;
+   /// @brief Number of render worker threads, or zero for every hardware thread.
+   int renderThreads;
 };
 
 #endif  // SETTINGSMANAGER_H
@@ -5,16 +5,47 @@
 
 #include "textureexporter.h"
 #include "textureimage.h"
+#include "textureimageencoder.h"
 #include "texturenode.h"
 #include "textureproject.h"
+#include "texturerendermanager.h"
 #include <QFileInfo>
-#include <QImageWriter>
 #include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <exception>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 namespace {
 
+/// @brief Longest wait for the render workers before the cancellation hook is polled again.
+constexpr std::chrono::milliseconds hookPollInterval(50);
+
+/// @brief Render results and progress shared between the render workers and the exporting thread.
+struct ExportRenderState {
+   /// @brief Protects every other member.
+   std::mutex mutex;
+   /// @brief Signals that a result, a failure, or progress was recorded.
+   std::condition_variable changed;
+   /// @brief IDs of the exported nodes whose images have not rendered yet.
+   QSet<int> pendingNodes;
+   /// @brief Images of the exported nodes that have rendered.
+   QMap<int, TextureImagePtr> images;
+   /// @brief Rendered images of the exported nodes, added to the node caches after the render.
+   std::vector<TextureRenderResult> results;
+   /// @brief Whether the render stopped because a node failed.
+   bool failed = false;
+   /// @brief Message of the render failure.
+   QString failure;
+   /// @brief Number of nodes that have finished rendering.
+   std::size_t finishedNodes = 0;
+};
+
 /// @brief Creates a failed texture-export operation result.
 /// @param error Failure category.
 /// @param message Human-readable failure description.
@@ -62,36 +93,115 @@ QImage TextureExporter::toQImage(const TextureImage& image, QString* error) {
    return result;
 }
 
-TextureExportResult TextureExporter::exportPng(TextureProject& project, const int nodeId,
-                                               const QSize size, const QString& path,
-                                               const bool overwrite) {
-   const TextureNodePtr node = project.getNode(nodeId);
-   if (node.isNull()) {
-      return failure(TextureExportError::InvalidNode,
-                     QStringLiteral("The project has no node with id %1").arg(nodeId));
+TextureExportResult TextureExporter::renderGraph(TextureGraphSnapshot graph, const int nodeId,
+                                                 TextureRenderCache* const renderCache,
+                                                 TextureImagePtr& image,
+                                                 std::vector<TextureRenderResult>& rendered,
+                                                 const TextureExportHooks& hooks,
+                                                 const std::size_t workerCount) {
+   QMap<int, TextureImagePtr> images;
+   const TextureExportResult result = renderGraph(std::move(graph), QList<int>{nodeId}, renderCache,
+                                                  images, rendered, hooks, workerCount);
+   if (result) {
+      image = images.value(nodeId);
    }
-   if (!validExportSize(size)) {
+   return result;
+}
+
+TextureExportResult TextureExporter::renderGraph(TextureGraphSnapshot graph,
+                                                 const QList<int>& nodeIds,
+                                                 TextureRenderCache* const renderCache,
+                                                 QMap<int, TextureImagePtr>& images,
+                                                 std::vector<TextureRenderResult>& rendered,
+                                                 const TextureExportHooks& hooks,
+                                                 const std::size_t workerCount) {
+   if (!validExportSize(graph.size)) {
       return failure(
           TextureExportError::InvalidSize,
           QStringLiteral("The export size must be positive and contain at most %1 pixels")
               .arg(MaximumPixelCount));
    }
-   if (QFileInfo::exists(path) && !overwrite) {
-      return failure(TextureExportError::OutputExists,
-                     QStringLiteral("The destination '%1' already exists").arg(path));
+   ExportRenderState state;
+   for (const int nodeId : nodeIds) {
+      const auto target =
+          std::find_if(graph.nodes.cbegin(), graph.nodes.cend(),
+                       [nodeId](const TextureNodeSnapshot& node) { return node.nodeId == nodeId; });
+      if (target == graph.nodes.cend()) {
+         return failure(TextureExportError::InvalidNode,
+                        QStringLiteral("The project has no node with id %1").arg(nodeId));
+      }
+      // A node that already has a cached image at the export size needs no render at all.
+      if (target->cachedImage.isNull()) {
+         state.pendingNodes.insert(nodeId);
+      } else {
+         state.images.insert(nodeId, target->cachedImage);
+      }
+   }
+   // Only the requested images leave the render, so the others may be rendered over in place.
+   for (TextureNodeSnapshot& node : graph.nodes) {
+      node.keepImage = nodeIds.contains(node.nodeId);
+   }
+   const int nodeCount = static_cast<int>(graph.nodes.size());
+   if (hooks.progress) {
+      hooks.progress(0, nodeCount);
+   }
+   if (state.pendingNodes.isEmpty()) {
+      images = state.images;
+      if (hooks.progress) {
+         hooks.progress(nodeCount, nodeCount);
+      }
+      return {};
    }
 
-   QImage outputImage;
+   bool cancelled = false;
+   std::size_t reportedNodes = 0;
    try {
-      const TextureImagePtr rendered = node->renderImage(size);
-      if (rendered.isNull()) {
-         return failure(TextureExportError::Render,
-                        QStringLiteral("The texture generator returned no image"));
+      TextureRenderManager engine(
+          [&state](TextureRenderResult result) {
+             std::lock_guard lock(state.mutex);
+             state.pendingNodes.remove(result.nodeId);
+             state.images.insert(result.nodeId, result.image);
+             state.results.push_back(std::move(result));
+             state.changed.notify_all();
+          },
+          [&state](TextureRenderFailure renderFailure) {
+             std::lock_guard lock(state.mutex);
+             state.failed = true;
+             state.failure = std::move(renderFailure.message);
+             state.changed.notify_all();
+          },
+          workerCount);
+      engine.setRenderCache(renderCache);
+      engine.setProgressObserver([&state](const std::size_t finishedNodes, std::size_t) {
+         std::lock_guard lock(state.mutex);
+         state.finishedNodes = std::max(state.finishedNodes, finishedNodes);
+         state.changed.notify_all();
+      });
+      engine.render(std::move(graph));
+
+      std::unique_lock lock(state.mutex);
+      while (!state.pendingNodes.isEmpty() && !state.failed) {
+         // The hooks run without the lock, so workers keep recording results meanwhile.
+         if (hooks.progress && state.finishedNodes != reportedNodes) {
+            reportedNodes = state.finishedNodes;
+            lock.unlock();
+            hooks.progress(static_cast<int>(reportedNodes), nodeCount);
+            lock.lock();
+            continue;
+         }
+         if (hooks.cancelRequested) {
+            lock.unlock();
+            cancelled = hooks.cancelRequested();
+            lock.lock();
+            if (cancelled) {
+               break;
+            }
+         }
+         state.changed.wait_for(lock, hookPollInterval);
       }
-      QString conversionError;
-      outputImage = toQImage(*rendered, &conversionError);
-      if (outputImage.isNull()) {
-         return failure(TextureExportError::Render, conversionError);
+      lock.unlock();
+      if (cancelled) {
+         engine.cancel();
       }
    } catch (const std::exception& error) {
       return failure(TextureExportError::Render, QString::fromUtf8(error.what()));
@@ -99,18 +209,79 @@ TextureExportResult TextureExporter::exportPng(TextureProject& project, const in
       return failure(TextureExportError::Render, QStringLiteral("Unknown texture rendering error"));
    }
 
+   // Finished images stay useful after a failure or cancellation, so they are returned too.
+   rendered = std::move(state.results);
+   if (cancelled) {
+      return failure(TextureExportError::Cancelled, QStringLiteral("The export was cancelled"));
+   }
+   if (state.failed) {
+      return failure(TextureExportError::Render, state.failure);
+   }
+   if (hooks.progress && static_cast<int>(reportedNodes) != nodeCount) {
+      hooks.progress(nodeCount, nodeCount);
+   }
+   images = state.images;
+   return {};
+}
+
+TextureExportResult TextureExporter::renderNode(TextureProject& project, const int nodeId,
+                                                const QSize size, TextureImagePtr& image,
+                                                const TextureExportHooks& hooks) {
+   QMap<int, TextureImagePtr> images;
+   const TextureExportResult result =
+       renderNodes(project, QList<int>{nodeId}, size, images, hooks);
+   if (result) {
+      image = images.value(nodeId);
+   }
+   return result;
+}
+
+TextureExportResult TextureExporter::renderNodes(TextureProject& project,
+                                                 const QList<int>& nodeIds, const QSize size,
+                                                 QMap<int, TextureImagePtr>& images,
+                                                 const TextureExportHooks& hooks) {
+   for (const int nodeId : nodeIds) {
+      if (project.getNode(nodeId).isNull()) {
+         return failure(TextureExportError::InvalidNode,
+                        QStringLiteral("The project has no node with id %1").arg(nodeId));
+      }
+   }
+   std::vector<TextureRenderResult> rendered;
+   const TextureExportResult result =
+       renderGraph(project.createUpstreamGraphSnapshot(nodeIds, size), nodeIds,
+                   project.getRenderCache(), images, rendered, hooks,
+                   project.getRenderWorkerCount());
+   for (const TextureRenderResult& renderResult : rendered) {
+      project.addRenderedImage(renderResult);
+   }
+   return result;
+}
+
+TextureExportResult TextureExporter::writeImage(const TextureImage& image, const QString& path,
+                                                const bool overwrite,
+                                                const TextureEncodeOptions& options) {
+   if (QFileInfo::exists(path) && !overwrite) {
+      return failure(TextureExportError::OutputExists,
+                     QStringLiteral("The destination '%1' already exists").arg(path));
+   }
+   if (!validExportSize(image.getSize())) {
+      return failure(
+          TextureExportError::Render,
+          QStringLiteral("The texture dimensions are invalid or exceed the export limit"));
+   }
+
    QSaveFile output(path);
    if (!output.open(QIODevice::WriteOnly)) {
       return failure(TextureExportError::OutputOpen,
                      QStringLiteral("Could not open '%1': %2").arg(path, output.errorString()));
    }
-   QImageWriter writer(&output, "png");
-   writer.setQuality(100);
-   if (!writer.write(outputImage)) {
+   QString encodeError;
+   if (!TextureImageEncoder::encode(image, output, options, &encodeError)) {
       output.cancelWriting();
-      return failure(
-          TextureExportError::Encode,
-          QStringLiteral("Could not encode PNG '%1': %2").arg(path, writer.errorString()));
+      return failure(TextureExportError::Encode,
+                     QStringLiteral("Could not encode %1 '%2': %3")
+                         .arg(TextureImageEncoder::formatName(options.format).toUpper(), path,
+                              encodeError));
    }
    if (!output.commit()) {
       return failure(TextureExportError::OutputCommit,
@@ -118,3 +289,48 @@ TextureExportResult TextureExporter::exportPng(TextureProject& project, const in
    }
    return {};
 }
+
+TextureExportResult TextureExporter::writePng(const TextureImage& image, const QString& path,
+                                              const bool overwrite) {
+   return writeImage(image, path, overwrite, TextureEncodeOptions());
+}
+
+TextureExportResult TextureExporter::exportPng(TextureProject& project, const int nodeId,
+                                               const QSize size, const QString& path,
+                                               const bool overwrite,
+                                               const TextureExportHooks& hooks) {
+   return exportImage(project, nodeId, size, path, overwrite, TextureEncodeOptions(), hooks);
+}
+
+TextureExportResult TextureExporter::exportImage(TextureProject& project, const int nodeId,
+                                                 const QSize size, const QString& path,
+                                                 const bool overwrite,
+                                                 const TextureEncodeOptions& options,
+                                                 const TextureExportHooks& hooks) {
+   const TextureNodePtr node = project.getNode(nodeId);
+   if (node.isNull()) {
+      return failure(TextureExportError::InvalidNode,
+                     QStringLiteral("The project has no node with id %1").arg(nodeId));
+   }
+   if (!validExportSize(size)) {
+      return failure(
+          TextureExportError::InvalidSize,
+          QStringLiteral("The export size must be positive and contain at most %1 pixels")
+              .arg(MaximumPixelCount));
+   }
+   if (QFileInfo::exists(path) && !overwrite) {
+      return failure(TextureExportError::OutputExists,
+                     QStringLiteral("The destination '%1' already exists").arg(path));
+   }
+
+   TextureImagePtr rendered;
+   const TextureExportResult renderResult = renderNode(project, nodeId, size, rendered, hooks);
+   if (!renderResult) {
+      return renderResult;
+   }
+   if (rendered.isNull()) {
+      return failure(TextureExportError::Render,
+                     QStringLiteral("The texture generator returned no image"));
+   }
+   return writeImage(*rendered, path, overwrite, options);
+}
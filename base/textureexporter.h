@@ -6,12 +6,19 @@
 #ifndef TEXTUREEXPORTER_H
 #define TEXTUREEXPORTER_H
 
+#include "textureimage.h"
+#include "textureimageencoder.h"
+#include "texturerendermanager.h"
 #include <QImage>
+#include <QList>
+#include <QMap>
 #include <QSize>
 #include <QString>
+#include <functional>
+#include <vector>
 
-class TextureImage;
 class TextureProject;
+class TextureRenderCache;
 
 /// @brief Identifies the stage at which an image export operation failed.
 enum class TextureExportError {
@@ -27,7 +34,9 @@ enum class TextureExportError {
    OutputOpen,
    /// @brief Rendering or conversion to a Qt image failed.
    Render,
-   /// @brief The rendered image could not be encoded as PNG.
+   /// @brief The caller's cancellation hook stopped the render.
+   Cancelled,
+   /// @brief The rendered image could not be encoded or written.
    Encode,
    /// @brief The temporary output could not be committed atomically.
    OutputCommit
@@ -47,6 +56,16 @@ struct TextureExportResult {
    explicit operator bool() const noexcept { return succeeded(); }
 };
 
+/// @brief Optional callbacks that observe and stop an export while its image renders.
+/// @details Both callbacks run on the thread that called the export function, between waits for
+/// the render workers, so they may update and poll a user interface.
+struct TextureExportHooks {
+   /// @brief Receives the number of finished nodes and the number of nodes the export renders.
+   std::function<void(int finishedNodes, int nodeCount)> progress;
+   /// @brief Polled while rendering; returning @c true stops the export.
+   std::function<bool()> cancelRequested;
+};
+
 /// @brief Provides shared texture conversion and headless image-export operations.
 class TextureExporter final {
 public:
@@ -59,16 +78,126 @@ public:
    /// @return Converted image, or a null image when conversion fails.
    [[nodiscard]] static QImage toQImage(const TextureImage& image, QString* error = nullptr);
 
+   /// @brief Renders a graph snapshot on a dedicated worker pool, blocking until one node is done.
+   /// @details Independent branches render at the same time and large images are split into
+   /// regions. Snapshot nodes that carry a cached image are not rendered again. The function does
+   /// not access the project the snapshot was copied from, so it may run on any thread.
+   /// @param graph Snapshot containing the node and every node it depends on.
+   /// @param nodeId Identifier of the node whose image is returned.
+   /// @param renderCache Content-addressed cache read and filled by the render, or null.
+   /// @param image Receives the rendered image on success.
+   /// @param rendered Receives the rendered images of the requested nodes, also after a failure or
+   /// cancellation, for TextureProject::addRenderedImage(). Intermediate images are released
+   /// during the render.
+   /// @param hooks Optional progress and cancellation callbacks.
+   /// @param workerCount Number of render threads, or zero to use every hardware thread.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult renderGraph(TextureGraphSnapshot graph, int nodeId,
+                                                        TextureRenderCache* renderCache,
+                                                        TextureImagePtr& image,
+                                                        std::vector<TextureRenderResult>& rendered,
+                                                        const TextureExportHooks& hooks = {},
+                                                        std::size_t workerCount = 0);
+
+   /// @brief Renders a graph snapshot until several of its nodes are done.
+   /// @details The nodes render together, so nodes they share are rendered once. Every other
+   /// node is marked as not keeping its image, so its only receiver may render over it in place
+   /// and it is not added to the render cache.
+   /// @param graph Snapshot containing the nodes and every node they depend on.
+   /// @param nodeIds Identifiers of the nodes whose images are returned.
+   /// @param renderCache Content-addressed cache read and filled by the render, or null.
+   /// @param images Receives the rendered image of every requested node on success.
+   /// @param rendered Receives the rendered images of the requested nodes, also after a failure or
+   /// cancellation, for TextureProject::addRenderedImage(). Intermediate images are released
+   /// during the render.
+   /// @param hooks Optional progress and cancellation callbacks.
+   /// @param workerCount Number of render threads, or zero to use every hardware thread.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult renderGraph(TextureGraphSnapshot graph,
+                                                        const QList<int>& nodeIds,
+                                                        TextureRenderCache* renderCache,
+                                                        QMap<int, TextureImagePtr>& images,
+                                                        std::vector<TextureRenderResult>& rendered,
+                                                        const TextureExportHooks& hooks = {},
+                                                        std::size_t workerCount = 0);
+
+   /// @brief Renders a project node and the nodes it depends on, blocking until it is done.
+   /// @details The node's upstream graph is copied and rendered on a dedicated worker pool with
+   /// the project's render worker count, so independent branches render at the same time and
+   /// large images are split into regions. Images already cached by the nodes or the project's
+   /// render cache are reused, and the node's rendered image is added to its cache afterwards.
+   /// @param project Project containing the node to render.
+   /// @param nodeId Identifier of the node to render.
+   /// @param size Image dimensions in pixels.
+   /// @param image Receives the rendered image on success.
+   /// @param hooks Optional progress and cancellation callbacks.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult renderNode(TextureProject& project, int nodeId,
+                                                       QSize size, TextureImagePtr& image,
+                                                       const TextureExportHooks& hooks = {});
+
+   /// @brief Renders several project nodes at one size in a single render.
+   /// @details The upstream graphs of the nodes are merged, so nodes they share are rendered
+   /// once, and every node that does not depend on another renders at the same time. Cached
+   /// images are reused, and the images of the requested nodes are added to their caches
+   /// afterwards.
+   /// @param project Project containing the nodes to render.
+   /// @param nodeIds Identifiers of the nodes to render.
+   /// @param size Image dimensions in pixels.
+   /// @param images Receives the image of every requested node on success.
+   /// @param hooks Optional progress and cancellation callbacks.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult renderNodes(TextureProject& project,
+                                                        const QList<int>& nodeIds, QSize size,
+                                                        QMap<int, TextureImagePtr>& images,
+                                                        const TextureExportHooks& hooks = {});
+
+   /// @brief Writes a texture image atomically as an image file.
+   /// @details The image is encoded straight from its pixel storage while the file is written.
+   /// @param image Image to encode.
+   /// @param path Destination path for the image file.
+   /// @param overwrite Whether an existing destination may be replaced.
+   /// @param options Format and compression of the file.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult writeImage(const TextureImage& image,
+                                                       const QString& path, bool overwrite,
+                                                       const TextureEncodeOptions& options);
+
+   /// @brief Writes a texture image atomically as a PNG file with the default compression.
+   /// @param image Image to encode.
+   /// @param path Destination path for the PNG file.
+   /// @param overwrite Whether an existing destination may be replaced.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult writePng(const TextureImage& image,
+                                                     const QString& path, bool overwrite);
+
    /// @brief Renders a project node and writes it atomically as a PNG file.
    /// @param project Project containing the node to render.
    /// @param nodeId Identifier of the node to render.
    /// @param size Output image dimensions in pixels.
    /// @param path Destination path for the PNG file.
    /// @param overwrite Whether an existing destination may be replaced.
+   /// @param hooks Optional progress and cancellation callbacks used while rendering.
    /// @return The operation result, including an error message on failure.
    [[nodiscard]] static TextureExportResult exportPng(TextureProject& project, int nodeId,
                                                       QSize size, const QString& path,
-                                                      bool overwrite);
+                                                      bool overwrite,
+                                                      const TextureExportHooks& hooks = {});
+
+   /// @brief Renders a project node and writes it atomically as an image file.
+   /// @param project Project containing the node to render.
+   /// @param nodeId Identifier of the node to render.
+   /// @param size Output image dimensions in pixels.
+   /// @param path Destination path for the image file.
+   /// @param overwrite Whether an existing destination may be replaced.
+   /// @param options Format and compression of the file.
+   /// @param hooks Optional progress and cancellation callbacks used while rendering.
+   /// @return The operation result, including an error message on failure.
+   [[nodiscard]] static TextureExportResult exportImage(TextureProject& project, int nodeId,
+                                                        QSize size, const QString& path,
+                                                        bool overwrite,
+                                                        const TextureEncodeOptions& options,
+                                                        const TextureExportHooks& hooks = {});
 };
 
 #endif  // TEXTUREEXPORTER_H
@@ -0,0 +1,101 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "textureexportjob.h"
+#include "textureimageencoder.h"
+#include "textureproject.h"
+#include "texturerendermanager.h"
+#include <QFileInfo>
+#include <QMetaObject>
+#include <cstddef>
+#include <utility>
+
+TextureExportJob::TextureExportJob(TextureProject& project, const int nodeId, const QSize size,
+                                   QString path, const bool overwrite, QObject* parent)
+    : QObject(parent),
+      project(project),
+      nodeId(nodeId),
+      size(size),
+      path(std::move(path)),
+      overwrite(overwrite) {}
+
+TextureExportJob::~TextureExportJob() {
+   cancel();
+   if (worker.joinable()) {
+      worker.join();
+   }
+}
+
+void TextureExportJob::start() {
+   if (started) {
+      return;
+   }
+   started = true;
+   running = true;
+   if (QFileInfo::exists(path) && !overwrite) {
+      QMetaObject::invokeMethod(
+          this,
+          [this]() {
+             complete({TextureExportError::OutputExists,
+                       QStringLiteral("The destination '%1' already exists").arg(path)},
+                      {});
+          },
+          Qt::QueuedConnection);
+      return;
+   }
+
+   // The snapshot is taken here, on the project's thread, so the worker never touches the project.
+   TextureGraphSnapshot graph = project.createUpstreamGraphSnapshot(nodeId, size);
+   TextureRenderCache* const renderCache = project.getRenderCache();
+   const std::size_t workerCount = project.getRenderWorkerCount();
+   worker = std::thread([this, graph = std::move(graph), renderCache, workerCount]() mutable {
+      TextureExportHooks hooks;
+      hooks.progress = [this](const int finishedNodes, const int nodeCount) {
+         QMetaObject::invokeMethod(
+             this,
+             [this, finishedNodes, nodeCount]() { emit progressChanged(finishedNodes, nodeCount); },
+             Qt::QueuedConnection);
+      };
+      hooks.cancelRequested = [this]() { return cancelRequested.load(); };
+
+      TextureImagePtr image;
+      std::vector<TextureRenderResult> rendered;
+      TextureExportResult exportResult = TextureExporter::renderGraph(
+          std::move(graph), nodeId, renderCache, image, rendered, hooks, workerCount);
+      if (exportResult && image.isNull()) {
+         exportResult = {TextureExportError::Render,
+                         QStringLiteral("The texture generator returned no image")};
+      }
+      if (exportResult && cancelRequested) {
+         exportResult = {TextureExportError::Cancelled,
+                         QStringLiteral("The export was cancelled")};
+      }
+      if (exportResult) {
+         TextureEncodeOptions options;
+         options.format =
+             TextureImageEncoder::formatForPath(path).value_or(TextureFileFormat::Png);
+         exportResult = TextureExporter::writeImage(*image, path, overwrite, options);
+      }
+      QMetaObject::invokeMethod(
+          this,
+          [this, exportResult = std::move(exportResult), rendered = std::move(rendered)]() mutable {
+             complete(std::move(exportResult), std::move(rendered));
+          },
+          Qt::QueuedConnection);
+   });
+}
+
+void TextureExportJob::complete(TextureExportResult exportResult,
+                                std::vector<TextureRenderResult> rendered) {
+   if (worker.joinable()) {
+      worker.join();
+   }
+   for (const TextureRenderResult& renderResult : rendered) {
+      project.addRenderedImage(renderResult);
+   }
+   result = std::move(exportResult);
+   running = false;
+   emit finished();
+}
@@ -0,0 +1,100 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREEXPORTJOB_H
+#define TEXTUREEXPORTJOB_H
+
+#include "textureexporter.h"
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class TextureProject;
+
+/// @brief Renders a project node and writes it as an image file without blocking the event loop.
+/// @details start() copies the node's upstream graph on the calling thread, so nodes that
+/// already have a cached image at the export size are reused instead of rendered. The copy is
+/// then rendered and encoded on a background thread with its own worker pool, which lets several
+/// jobs and the project's thumbnail renders run at the same time. Signals are emitted on the
+/// thread that owns the job, and the exported node's image is added to its node cache there
+/// before finished() is emitted. The file format follows the path's suffix, and paths with an
+/// unknown suffix are written as PNG. The project must outlive the job.
+class TextureExportJob final : public QObject {
+   Q_OBJECT
+
+public:
+   /// @brief Creates an export job that has not started yet.
+   /// @param project Project containing the node to export.
+   /// @param nodeId Identifier of the node to export.
+   /// @param size Output image dimensions in pixels.
+   /// @param path Destination path for the image file.
+   /// @param overwrite Whether an existing destination may be replaced.
+   /// @param parent Optional QObject parent.
+   TextureExportJob(TextureProject& project, int nodeId, QSize size, QString path,
+                    bool overwrite, QObject* parent = nullptr);
+
+   /// @brief Cancels a running export and waits for its background thread to stop.
+   ~TextureExportJob() override;
+
+   /// @brief Starts the export on a background thread.
+   /// @details Invalid nodes, sizes and existing destinations finish the job with an error
+   /// without starting a thread. A job can only be started once.
+   void start();
+
+   /// @brief Asks a running export to stop; finished() then reports TextureExportError::Cancelled.
+   void cancel() { cancelRequested = true; }
+
+   /// @brief Returns whether the job has started and not finished yet.
+   [[nodiscard]] bool isRunning() const { return running; }
+
+   /// @brief Returns the identifier of the exported node.
+   [[nodiscard]] int getNodeId() const { return nodeId; }
+
+   /// @brief Returns the output image dimensions.
+   [[nodiscard]] QSize getSize() const { return size; }
+
+   /// @brief Returns the destination path of the image file.
+   [[nodiscard]] const QString& getPath() const { return path; }
+
+   /// @brief Returns the outcome of a finished job, or success while it is still running.
+   [[nodiscard]] const TextureExportResult& getResult() const { return result; }
+
+signals:
+   /// @brief Reports the number of finished nodes and the number of nodes the export renders.
+   void progressChanged(int finishedNodes, int nodeCount);
+
+   /// @brief Emitted once when the export has succeeded, failed or been cancelled.
+   void finished();
+
+private:
+   /// @brief Joins the background thread, caches its images and emits finished().
+   void complete(TextureExportResult exportResult, std::vector<TextureRenderResult> rendered);
+
+   /// @brief Project whose node is exported.
+   TextureProject& project;
+   /// @brief Identifier of the exported node.
+   const int nodeId;
+   /// @brief Output image dimensions.
+   const QSize size;
+   /// @brief Destination path of the image file.
+   const QString path;
+   /// @brief Whether an existing destination may be replaced.
+   const bool overwrite;
+   /// @brief Outcome reported by getResult().
+   TextureExportResult result;
+   /// @brief Whether start() was called.
+   bool started = false;
+   /// @brief Whether the export has started and not finished.
+   bool running = false;
+   /// @brief Set by cancel() and polled by the background thread.
+   std::atomic<bool> cancelRequested{false};
+   /// @brief Thread rendering and encoding the image.
+   std::thread worker;
+};
+
+#endif  // TEXTUREEXPORTJOB_H
@@ -8,6 +8,10 @@
 #include <QMutexLocker>
 #include <QRegularExpression>
 #include <QSet>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 const TextureGeneratorSetting* findTextureGeneratorSetting(const TextureGeneratorSettings& settings,
                                                            const QString& id) {
@@ -33,6 +37,36 @@ QString validateTextureGeneratorSettings(const TextureGeneratorSettings& setting
    return QString();
 }
 
+void fillTextureRegion(const QSize size, const QRect region, TexturePixel* pixels,
+                       const TexturePixel value) {
+   for (int y = region.top(); y <= region.bottom(); ++y) {
+      TexturePixel* row = pixels + static_cast<qsizetype>(y) * size.width() + region.left();
+      std::fill_n(row, region.width(), value);
+   }
+}
+
+void copyTextureRegion(const QSize size, const QRect region, const TexturePixel* source,
+                       TexturePixel* destination) {
+   for (int y = region.top(); y <= region.bottom(); ++y) {
+      const qsizetype offset = static_cast<qsizetype>(y) * size.width() + region.left();
+      std::copy_n(source + offset, region.width(), destination + offset);
+   }
+}
+
+QSize textureReferenceSize(const QSize size, const TextureNodeSettings& settings) {
+   const QSize reference = settings.value(TextureReferenceSizeSetting).toSize();
+   return reference.isValid() && !reference.isEmpty() ? reference : size;
+}
+
+int scaleTextureLength(const double length, const int extent, const int referenceExtent) {
+   if (!(length > 0.0) || extent <= 0 || referenceExtent <= 0) {
+      return 0;
+   }
+   const double scaled = std::round(length * extent / referenceExtent);
+   const double largest = static_cast<double>(std::numeric_limits<int>::max());
+   return static_cast<int>(std::clamp(scaled, 1.0, largest));
+}
+
 void TextureGenerator::generateWithTiming(const QSize size, TexturePixel* destimage,
                                           const QMap<QString, TextureImagePtr>& sourceimages,
                                           const TextureNodeSettings& settings) const {
@@ -47,6 +81,32 @@ void TextureGenerator::generateWithTiming(const QSize size, TexturePixel* destim
    recordGenerationTime(timer.nsecsElapsed());
 }
 
+QList<QRect> TextureGenerator::getTilingRegions(const QSize size, const int pass,
+                                               const int maximumRegionCount) const {
+   Q_UNUSED(pass);
+   QList<QRect> regions;
+   const int regionCount = std::clamp(maximumRegionCount, 1, std::max(size.height(), 1));
+   for (int index = 0; index < regionCount; ++index) {
+      const int top = static_cast<int>(static_cast<qint64>(size.height()) * index / regionCount);
+      const int bottom =
+          static_cast<int>(static_cast<qint64>(size.height()) * (index + 1) / regionCount);
+      if (bottom > top) {
+         regions.append(QRect(0, top, size.width(), bottom - top));
+      }
+   }
+   return regions;
+}
+
+void TextureGenerator::generateRegion(const QSize size, const int pass, const QRect region,
+                                      TexturePixel* destimage,
+                                      const QMap<QString, TextureImagePtr>& sourceimages,
+                                      const TextureNodeSettings& settings) const {
+   if (pass != 0 || region != QRect(QPoint(0, 0), size)) {
+      throw std::logic_error("The texture generator does not support tiled rendering");
+   }
+   generate(size, destimage, sourceimages, settings);
+}
+
 TextureGenerator::GenerationTiming TextureGenerator::getGenerationTiming() const {
    QMutexLocker lock(&generationTimesMutex);
    GenerationTiming timing;
@@ -8,9 +8,11 @@
 
 #include "base/textureimage.h"
 #include "global.h"
+#include <QByteArray>
 #include <QList>
 #include <QMap>
 #include <QMutex>
+#include <QRect>
 #include <QSharedPointer>
 #include <QStringList>
 
@@ -65,6 +67,60 @@ public:
                            const QMap<QString, TextureImagePtr>& sourceimages,
                            const TextureNodeSettings& settings) const;
 
+   /// @brief Reports whether generate() and generateRegion() write every destination pixel.
+   /// @details Destination buffers of generators that do are allocated without being cleared.
+   /// @return @c true when no output pixel keeps the value it had before the call.
+   virtual bool writesEveryPixel() const { return false; }
+
+   /// @brief Names the input whose image the generator would reproduce unchanged.
+   /// @details The render manager gives the node the image of that input instead of allocating
+   /// a buffer and calling generate().
+   /// @param size Width and height of the image being rendered.
+   /// @param settings Current generator settings, including defaults.
+   /// @return The slot name, or an empty string when the output differs from every input.
+   virtual QString getPassThroughSlot(QSize size, const TextureNodeSettings& settings) const {
+      Q_UNUSED(size);
+      Q_UNUSED(settings);
+      return QString();
+   }
+
+   /// @brief Names the input whose pixel buffer generate() accepts as its destination.
+   /// @details When the render owns the only reference to that input's image, the render manager
+   /// passes the image's own pixels as @p destimage and the result must equal an out-of-place
+   /// render. The buffer then holds the input instead of zeros, whatever writesEveryPixel()
+   /// returns. generateRegion() must handle the same aliasing for every tiling pass.
+   /// @return The slot name, or an empty string when the destination must be a separate buffer.
+   virtual QString getInPlaceSlot() const { return QString(); }
+
+   /// @brief Reports whether generateRegion() can render parts of one image on separate threads.
+   /// @return @c true when the generator implements generateRegion() for every tiling pass.
+   virtual bool supportsTiling() const { return false; }
+
+   /// @brief Returns the number of dependent passes needed by a tiled render.
+   /// @return One for generators whose regions only read source images.
+   virtual int getTilingPassCount() const { return 1; }
+
+   /// @brief Splits one tiled-render pass into regions that can be rendered concurrently.
+   /// @param size Width and height of the destination image.
+   /// @param pass Zero-based tiling pass.
+   /// @param maximumRegionCount Upper bound on the number of returned regions.
+   /// @return Disjoint regions covering the image; horizontal row bands by default.
+   virtual QList<QRect> getTilingRegions(QSize size, int pass, int maximumRegionCount) const;
+
+   /// @brief Renders the destination pixels inside one region of one tiled-render pass.
+   /// @details Regions of the same pass may run at the same time on different threads, and every
+   /// region of a pass finishes before the next pass starts. The default implementation only
+   /// accepts a single pass covering the whole image and forwards it to generate().
+   /// @param size Width and height of the destination and source images.
+   /// @param pass Zero-based tiling pass.
+   /// @param region Pixels to write, in image coordinates.
+   /// @param destimage Writable destination pixel buffer for the whole image.
+   /// @param sourceimages Source images keyed by input-slot name.
+   /// @param settings Current generator settings.
+   virtual void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                               const QMap<QString, TextureImagePtr>& sourceimages,
+                               const TextureNodeSettings& settings) const;
+
    /// @brief Returns timing data for up to the last ten completed generation calls.
    /// @return A thread-safe snapshot; runCount is zero before the first completed call.
    GenerationTiming getGenerationTiming() const;
@@ -85,6 +141,13 @@ public:
    /// @return A source path, resource URL, diagnostic label, or an empty string for C++ generators.
    virtual QString getSourceIdentity() const { return QString(); }
 
+   /// @brief Returns a stable identity used to share rendered images through TextureRenderCache.
+   /// @details The identity must change whenever the generator's output for the same settings and
+   /// source images changes, because cached images outlive the process.
+   /// @return An identity for deterministic generators, or an empty array if outputs must not be
+   /// cached.
+   virtual QByteArray getCacheIdentity() const { return QByteArray(); }
+
    /// @brief Returns the ordered, stable names of the generator's input slots.
    /// @return Input slot names in serialization and presentation order.
    virtual QStringList getSourceSlots() const = 0;
@@ -103,6 +166,9 @@ public:
    QString resolveSourceSlot(const QString& serializedSlot) const;
 
 private:
+   /// @brief Lets the render manager record the duration of tiled renders spanning several threads.
+   friend class TextureRenderManager;
+
    /// @brief Adds a completed call duration to the rolling timing window.
    /// @param elapsedNanoseconds Duration reported by the monotonic timer.
    void recordGenerationTime(qint64 elapsedNanoseconds) const;
@@ -125,6 +191,41 @@ const TextureGeneratorSetting* findTextureGeneratorSetting(const TextureGenerato
 /// @return An empty string when valid, otherwise a diagnostic describing the first invalid ID.
 QString validateTextureGeneratorSettings(const TextureGeneratorSettings& settings);
 
+/// @brief Fills the pixels of one region of an image with a single value.
+/// @param size Width and height of the image.
+/// @param region Pixels to fill, in image coordinates.
+/// @param pixels Pixel buffer for the whole image.
+/// @param value Value written to every pixel in @p region.
+void fillTextureRegion(QSize size, QRect region, TexturePixel* pixels, TexturePixel value);
+
+/// @brief Copies the pixels of one region between two images of the same size.
+/// @param size Width and height of both images.
+/// @param region Pixels to copy, in image coordinates.
+/// @param source Pixel buffer read for the whole image.
+/// @param destination Pixel buffer written for the whole image.
+void copyTextureRegion(QSize size, QRect region, const TexturePixel* source,
+                       TexturePixel* destination);
+
+/// @brief Reserved setting ID holding the size a reduced-size render stands in for.
+/// @details Progressive passes add it to the node settings they render with. Its value is a QSize.
+inline constexpr char TextureReferenceSizeSetting[] = "__referencesize";
+
+/// @brief Returns the size whose image a render approximates.
+/// @param size Width and height of the image being rendered.
+/// @param settings Generator settings, possibly holding TextureReferenceSizeSetting.
+/// @return The reference size of a reduced-size render, otherwise @p size.
+QSize textureReferenceSize(QSize size, const TextureNodeSettings& settings);
+
+/// @brief Scales a length defined for a reference image extent to the extent being rendered.
+/// @details Generators whose settings are lengths in pixels of a reference image use this, so an
+/// image rendered at another size, such as a low-resolution preview, looks like a resampled copy
+/// of the reference image.
+/// @param length Length in pixels of the reference image.
+/// @param extent Width or height of the rendered image.
+/// @param referenceExtent Width or height the length is defined for.
+/// @return The rounded length, at least one pixel when @p length is positive, or zero otherwise.
+int scaleTextureLength(double length, int extent, int referenceExtent);
+
 /// @brief Shared ownership pointer used for registered texture generators.
 using TextureGeneratorPtr = QSharedPointer<TextureGenerator>;
 
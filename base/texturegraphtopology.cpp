@@ -0,0 +1,231 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturegraphtopology.h"
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <algorithm>
+#include <utility>
+
+void TextureGraphTopology::addNode(const int id) {
+   if (!vertices.contains(id)) {
+      Vertex vertex;
+      vertex.order = nextOrder++;
+      vertices.insert(id, vertex);
+      ++changes;
+   }
+}
+
+void TextureGraphTopology::removeNode(const int id) {
+   const auto vertex = vertices.constFind(id);
+   if (vertex == vertices.cend()) {
+      return;
+   }
+   const QList<int> sourceIds = vertex->sources;
+   const QList<int> receiverIds = vertex->receivers;
+   for (const int sourceId : sourceIds) {
+      removeEdge(sourceId, id);
+   }
+   for (const int receiverId : receiverIds) {
+      removeEdge(id, receiverId);
+   }
+   vertices.remove(id);
+   ++changes;
+}
+
+bool TextureGraphTopology::addEdge(const int sourceId, const int receiverId) {
+   const auto source = vertices.find(sourceId);
+   const auto receiver = vertices.find(receiverId);
+   if (sourceId == receiverId || source == vertices.end() || receiver == vertices.end()) {
+      return false;
+   }
+   if (source->receivers.contains(receiverId)) {
+      return true;
+   }
+   if (source->order > receiver->order) {
+      // Only nodes ordered between the receiver and the source can lie on a path between them.
+      QList<int> forward;
+      if (searchForward(receiverId, sourceId, forward)) {
+         return false;
+      }
+      QList<int> backward;
+      searchBackward(sourceId, receiver->order, backward);
+      // Reuse the order values of both sets, giving the nodes that reach the source the lower ones.
+      const auto byOrder = [this](const int lhs, const int rhs) {
+         return vertexAt(lhs).order < vertexAt(rhs).order;
+      };
+      std::sort(forward.begin(), forward.end(), byOrder);
+      std::sort(backward.begin(), backward.end(), byOrder);
+      QList<qint64> orders;
+      orders.reserve(forward.size() + backward.size());
+      for (const int id : std::as_const(backward)) {
+         orders.append(vertexAt(id).order);
+      }
+      for (const int id : std::as_const(forward)) {
+         orders.append(vertexAt(id).order);
+      }
+      std::sort(orders.begin(), orders.end());
+      qsizetype next = 0;
+      for (const int id : std::as_const(backward)) {
+         vertices[id].order = orders.at(next++);
+      }
+      for (const int id : std::as_const(forward)) {
+         vertices[id].order = orders.at(next++);
+      }
+   }
+   vertices[sourceId].receivers.append(receiverId);
+   vertices[receiverId].sources.append(sourceId);
+   ++edges;
+   ++changes;
+   return true;
+}
+
+void TextureGraphTopology::removeEdge(const int sourceId, const int receiverId) {
+   const auto source = vertices.find(sourceId);
+   if (source == vertices.end() || !source->receivers.removeOne(receiverId)) {
+      return;
+   }
+   vertices[receiverId].sources.removeOne(sourceId);
+   --edges;
+   ++changes;
+}
+
+bool TextureGraphTopology::hasEdge(const int sourceId, const int receiverId) const {
+   const auto source = vertices.constFind(sourceId);
+   return source != vertices.cend() && source->receivers.contains(receiverId);
+}
+
+bool TextureGraphTopology::reaches(const int fromId, const int toId) const {
+   if (!vertices.contains(fromId) || !vertices.contains(toId)) {
+      return false;
+   }
+   if (fromId == toId) {
+      return true;
+   }
+   QList<int> visited;
+   return searchForward(fromId, toId, visited);
+}
+
+qint64 TextureGraphTopology::orderOf(const int id) const {
+   const auto vertex = vertices.constFind(id);
+   return vertex != vertices.cend() ? vertex->order : -1;
+}
+
+QList<int> TextureGraphTopology::topologicalOrder() const {
+   QList<std::pair<qint64, int>> ordered;
+   ordered.reserve(vertices.size());
+   for (auto vertex = vertices.cbegin(); vertex != vertices.cend(); ++vertex) {
+      ordered.append({vertex->order, vertex.key()});
+   }
+   std::sort(ordered.begin(), ordered.end());
+   QList<int> ids;
+   ids.reserve(ordered.size());
+   for (const auto& [order, id] : std::as_const(ordered)) {
+      ids.append(id);
+   }
+   return ids;
+}
+
+QList<int> TextureGraphTopology::downstreamOrder(const QSet<int>& roots,
+                                                 QSet<int>* downstream) const {
+   QSet<int> closure;
+   QList<int> pending;
+   for (const int id : roots) {
+      if (vertices.contains(id) && !closure.contains(id)) {
+         closure.insert(id);
+         pending.append(id);
+      }
+   }
+   while (!pending.isEmpty()) {
+      const int id = pending.takeLast();
+      for (const int receiverId : vertexAt(id).receivers) {
+         if (downstream != nullptr) {
+            downstream->insert(receiverId);
+         }
+         if (!closure.contains(receiverId)) {
+            closure.insert(receiverId);
+            pending.append(receiverId);
+         }
+      }
+   }
+   QList<std::pair<qint64, int>> ordered;
+   ordered.reserve(closure.size());
+   for (const int id : std::as_const(closure)) {
+      ordered.append({vertexAt(id).order, id});
+   }
+   std::sort(ordered.begin(), ordered.end());
+   QList<int> ids;
+   ids.reserve(ordered.size());
+   for (const auto& [order, id] : std::as_const(ordered)) {
+      ids.append(id);
+   }
+   return ids;
+}
+
+bool TextureGraphTopology::hasCycle() const {
+   QHash<int, int> sourceCounts;
+   QList<int> ready;
+   for (auto vertex = vertices.cbegin(); vertex != vertices.cend(); ++vertex) {
+      sourceCounts.insert(vertex.key(), static_cast<int>(vertex->sources.size()));
+      if (vertex->sources.isEmpty()) {
+         ready.append(vertex.key());
+      }
+   }
+   qsizetype sorted = 0;
+   while (!ready.isEmpty()) {
+      const int id = ready.takeLast();
+      ++sorted;
+      for (const int receiverId : vertexAt(id).receivers) {
+         if (--sourceCounts[receiverId] == 0) {
+            ready.append(receiverId);
+         }
+      }
+   }
+   return sorted != vertices.size();
+}
+
+const TextureGraphTopology::Vertex& TextureGraphTopology::vertexAt(const int id) const {
+   static const Vertex missing;
+   const auto vertex = vertices.constFind(id);
+   return vertex != vertices.cend() ? vertex.value() : missing;
+}
+
+bool TextureGraphTopology::searchForward(const int startId, const int targetId,
+                                         QList<int>& visited) const {
+   const qint64 upperOrder = vertexAt(targetId).order;
+   QSet<int> seen{startId};
+   QList<int> pending{startId};
+   while (!pending.isEmpty()) {
+      const int id = pending.takeLast();
+      visited.append(id);
+      for (const int receiverId : vertexAt(id).receivers) {
+         if (receiverId == targetId) {
+            return true;
+         }
+         if (vertexAt(receiverId).order < upperOrder && !seen.contains(receiverId)) {
+            seen.insert(receiverId);
+            pending.append(receiverId);
+         }
+      }
+   }
+   return false;
+}
+
+void TextureGraphTopology::searchBackward(const int startId, const qint64 lowerOrder,
+                                          QList<int>& visited) const {
+   QSet<int> seen{startId};
+   QList<int> pending{startId};
+   while (!pending.isEmpty()) {
+      const int id = pending.takeLast();
+      visited.append(id);
+      for (const int sourceId : vertexAt(id).sources) {
+         if (vertexAt(sourceId).order > lowerOrder && !seen.contains(sourceId)) {
+            seen.insert(sourceId);
+            pending.append(sourceId);
+         }
+      }
+   }
+}
@@ -0,0 +1,126 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREGRAPHTOPOLOGY_H
+#define TEXTUREGRAPHTOPOLOGY_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QtGlobal>
+#include <cstdint>
+
+/// @brief Adjacency and topological order of a texture graph, kept acyclic as edges are added.
+/// @details Every node has an order value, and every edge leads from a lower to a higher value. An
+/// edge that agrees with the order is added at once. Otherwise one search forward from the
+/// receiver, bounded by the order of the source, tells whether the edge would close a cycle, and
+/// only the nodes between the two ends are given new order values (the Pearce-Kelly algorithm).
+/// The class is not synchronized; its owner serializes access.
+class TextureGraphTopology final {
+public:
+   /// @brief Adds a node without edges after every existing node in the order.
+   /// @param id The node ID; an existing ID is left unchanged.
+   void addNode(int id);
+
+   /// @brief Removes a node and its edges.
+   /// @param id The node ID.
+   void removeNode(int id);
+
+   /// @brief Checks whether a node is present.
+   [[nodiscard]] bool contains(int id) const { return vertices.contains(id); }
+
+   /// @brief Adds an edge from a source to a receiver unless it would close a cycle.
+   /// @param sourceId The source node ID.
+   /// @param receiverId The receiver node ID.
+   /// @return @c true if the edge exists afterwards; @c false if a node is missing, the nodes are
+   /// the same, or the receiver reaches the source.
+   bool addEdge(int sourceId, int receiverId);
+
+   /// @brief Removes an edge if it exists.
+   /// @param sourceId The source node ID.
+   /// @param receiverId The receiver node ID.
+   void removeEdge(int sourceId, int receiverId);
+
+   /// @brief Checks whether an edge exists.
+   [[nodiscard]] bool hasEdge(int sourceId, int receiverId) const;
+
+   /// @brief Checks whether a node can be reached from another one by following edges.
+   /// @details Only nodes ordered between the two are visited.
+   /// @param fromId The node where the search starts.
+   /// @param toId The node searched for.
+   /// @return @c true if the nodes are the same or a path leads from one to the other.
+   [[nodiscard]] bool reaches(int fromId, int toId) const;
+
+   /// @brief Returns the receivers of a node.
+   [[nodiscard]] QList<int> receivers(int id) const { return vertexAt(id).receivers; }
+
+   /// @brief Returns the sources of a node.
+   [[nodiscard]] QList<int> sources(int id) const { return vertexAt(id).sources; }
+
+   /// @brief Returns the order value of a node, which is larger than that of all of its sources.
+   /// @return The order value, or -1 when the node is missing.
+   [[nodiscard]] qint64 orderOf(int id) const;
+
+   /// @brief Returns every node in topological order.
+   [[nodiscard]] QList<int> topologicalOrder() const;
+
+   /// @brief Returns nodes and every node downstream of them in topological order.
+   /// @param roots IDs of the nodes where the traversal starts; missing nodes are skipped.
+   /// @param downstream Optional destination for the returned nodes that have a source among them.
+   /// @return The IDs, each listed once after all of its sources.
+   [[nodiscard]] QList<int> downstreamOrder(const QSet<int>& roots,
+                                            QSet<int>* downstream = nullptr) const;
+
+   /// @brief Checks the edges for a cycle, which the class never lets form.
+   /// @return @c true if a cycle is found.
+   [[nodiscard]] bool hasCycle() const;
+
+   /// @brief Gets the number of nodes.
+   [[nodiscard]] int nodeCount() const { return static_cast<int>(vertices.size()); }
+
+   /// @brief Gets the number of edges.
+   [[nodiscard]] int edgeCount() const { return edges; }
+
+   /// @brief Gets a number that changes whenever a node or an edge is added or removed.
+   [[nodiscard]] std::uint64_t revision() const { return changes; }
+
+private:
+   /// @brief Adjacency and order value of one node.
+   struct Vertex {
+      /// @brief Position in the topological order; larger than the values of all sources.
+      qint64 order = -1;
+      /// @brief IDs of the nodes this node feeds.
+      QList<int> receivers;
+      /// @brief IDs of the nodes this node reads.
+      QList<int> sources;
+   };
+
+   /// @brief Returns a node, or an empty node without an order value when the ID is missing.
+   const Vertex& vertexAt(int id) const;
+
+   /// @brief Collects the nodes reachable from a node that are ordered before a bound.
+   /// @param startId The node where the search starts.
+   /// @param targetId The node whose order value bounds the search.
+   /// @param visited Destination for the visited nodes, including the start.
+   /// @return @c true if the target is reached.
+   bool searchForward(int startId, int targetId, QList<int>& visited) const;
+
+   /// @brief Collects the nodes that reach a node and are ordered after a bound.
+   /// @param startId The node where the search starts.
+   /// @param lowerOrder Order value the visited nodes must exceed.
+   /// @param visited Destination for the visited nodes, including the start.
+   void searchBackward(int startId, qint64 lowerOrder, QList<int>& visited) const;
+
+   /// @brief Nodes stored by ID.
+   QHash<int, Vertex> vertices;
+   /// @brief Order value given to the next added node.
+   qint64 nextOrder = 0;
+   /// @brief Number of edges.
+   int edges = 0;
+   /// @brief Number of changes to the nodes and edges.
+   std::uint64_t changes = 0;
+};
+
+#endif  // TEXTUREGRAPHTOPOLOGY_H
@@ -6,12 +6,15 @@
 
 #include "textureimage.h"
 #include "global.h"
+#include "textureimagepool.h"
 #include <QSize>
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <limits>
 #include <new>
 #include <stdexcept>
+#include <utility>
 
 namespace {
 
@@ -77,6 +80,89 @@ QImage copyTextureImage(const QSize size, const TexturePixel* pixels) {
    return copy;
 }
 
-TextureImage::TextureImage(QSize size) : size(size), pixels(checkedPixelCount(size)) {}
+TextureImage::TextureImage(QSize size, const Initialization initialization)
+    : size(size), count(checkedPixelCount(size)) {
+   pixels = TextureImagePool::instance().acquire(count);
+   if (initialization == Initialization::Zeroed) {
+      std::memset(static_cast<void*>(pixels), 0, count * sizeof(TexturePixel));
+   }
+}
+
+TextureImage::~TextureImage() { TextureImagePool::instance().release(pixels, count); }
+
+TextureImage::TextureImage(TextureImage&& other) noexcept
+    : size(std::exchange(other.size, QSize())),
+      count(std::exchange(other.count, 0)),
+      pixels(std::exchange(other.pixels, nullptr)) {}
+
+TextureImage& TextureImage::operator=(TextureImage&& other) noexcept {
+   if (this != &other) {
+      TextureImagePool::instance().release(pixels, count);
+      size = std::exchange(other.size, QSize());
+      count = std::exchange(other.count, 0);
+      pixels = std::exchange(other.pixels, nullptr);
+   }
+   return *this;
+}
+
+TextureImagePtr TextureImage::create(QSize size, const Initialization initialization) {
+   return TextureImagePtr::create(size, initialization);
+}
 
-TextureImagePtr TextureImage::create(QSize size) { return TextureImagePtr::create(size); }
+TextureImagePtr TextureImage::scaled(const QSize newSize) const {
+   TextureImagePtr result = create(newSize, Initialization::Uninitialized);
+   if (newSize == size) {
+      std::memcpy(static_cast<void*>(result->data()), data(), byteSize());
+      return result;
+   }
+   const QImage resized =
+       toQImageView()
+           .scaled(newSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+           .convertToFormat(QImage::Format_RGBA8888);
+   if (resized.isNull()) {
+      throw std::bad_alloc();
+   }
+   const std::size_t rowBytes = static_cast<std::size_t>(newSize.width()) * sizeof(TexturePixel);
+   for (int y = 0; y < newSize.height(); ++y) {
+      TexturePixel* row = result->data() + static_cast<std::size_t>(y) * newSize.width();
+      std::memcpy(static_cast<void*>(row), resized.constScanLine(y), rowBytes);
+   }
+   return result;
+}
+
+TextureImagePtr TextureImage::halved() const {
+   const QSize newSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+   TextureImagePtr result = create(newSize, Initialization::Uninitialized);
+   const TexturePixel* source = data();
+   TexturePixel* destination = result->data();
+   for (int y = 0; y < newSize.height(); ++y) {
+      const TexturePixel* top = source + static_cast<std::size_t>(2 * y) * size.width();
+      const TexturePixel* bottom =
+          source + static_cast<std::size_t>(std::min(2 * y + 1, size.height() - 1)) * size.width();
+      for (int x = 0; x < newSize.width(); ++x) {
+         const int left = 2 * x;
+         const int right = std::min(2 * x + 1, size.width() - 1);
+         const TexturePixel* block[4] = {top + left, top + right, bottom + left, bottom + right};
+         unsigned int alpha = 0;
+         unsigned int color[3] = {0, 0, 0};
+         unsigned int weighted[3] = {0, 0, 0};
+         for (const TexturePixel* pixel : block) {
+            alpha += pixel->a;
+            color[0] += pixel->r;
+            color[1] += pixel->g;
+            color[2] += pixel->b;
+            weighted[0] += static_cast<unsigned int>(pixel->r) * pixel->a;
+            weighted[1] += static_cast<unsigned int>(pixel->g) * pixel->a;
+            weighted[2] += static_cast<unsigned int>(pixel->b) * pixel->a;
+         }
+         quint8 channels[3];
+         for (int channel = 0; channel < 3; ++channel) {
+            channels[channel] = static_cast<quint8>(
+                alpha == 0 ? (color[channel] + 2) / 4 : (weighted[channel] + alpha / 2) / alpha);
+         }
+         *destination++ = TexturePixel(channels[0], channels[1], channels[2],
+                                       static_cast<quint8>((alpha + 2) / 4));
+      }
+   }
+   return result;
+}
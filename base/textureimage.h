@@ -12,7 +12,6 @@
 #include <QSharedPointer>
 #include <QSize>
 #include <cstddef>
-#include <vector>
 
 class TextureImage;
 using TextureImagePtr = QSharedPointer<TextureImage>;
@@ -44,16 +43,27 @@ QImage makeTextureImageView(QSize size, const TexturePixel* pixels);
 QImage copyTextureImage(QSize size, const TexturePixel* pixels);
 
 /// @brief Owns a contiguous buffer of texture pixels.
+/// @details Pixel buffers come from TextureImagePool and go back to it when the image is destroyed,
+/// so renders of the same size reuse buffers instead of allocating them.
 class TextureImage {
 public:
+   /// @brief Selects the initial contents of a new image.
+   enum class Initialization {
+      /// @brief Every pixel starts as transparent black.
+      Zeroed,
+      /// @brief Pixels start with unspecified values and must all be written before being read.
+      Uninitialized
+   };
+
    /// @brief Constructs an image with an owned, contiguous pixel buffer.
    /// @param size The image width and height in pixels; both dimensions must be positive.
+   /// @param initialization Initial contents of the pixels.
    /// @throws std::invalid_argument if either dimension is not positive.
    /// @throws std::length_error if the required pixel storage cannot be represented.
-   explicit TextureImage(QSize size);
+   explicit TextureImage(QSize size, Initialization initialization = Initialization::Zeroed);
 
-   /// @brief Destroys the image and releases its pixel buffer.
-   ~TextureImage() = default;
+   /// @brief Destroys the image and returns its pixel buffer to the pool.
+   ~TextureImage();
 
    /// @brief Disables copy construction to prevent accidental duplication of the pixel buffer.
    TextureImage(const TextureImage&) = delete;
@@ -62,32 +72,35 @@ public:
    TextureImage& operator=(const TextureImage&) = delete;
 
    /// @brief Moves an image without copying its pixel buffer.
-   TextureImage(TextureImage&&) noexcept = default;
+   TextureImage(TextureImage&& other) noexcept;
 
    /// @brief Move-assigns an image without copying its pixel buffer.
-   TextureImage& operator=(TextureImage&&) noexcept = default;
+   TextureImage& operator=(TextureImage&& other) noexcept;
 
    /// @brief Creates a shared texture image with an owned pixel buffer.
    /// @param size The image width and height in pixels; both dimensions must be positive.
+   /// @param initialization Initial contents of the pixels. Use Initialization::Uninitialized only
+   /// when every pixel is written before the image is shared.
    /// @return A shared pointer to the newly allocated image.
    /// @throws std::invalid_argument if either dimension is not positive.
    /// @throws std::length_error if the required pixel storage cannot be represented.
-   static TextureImagePtr create(QSize size);
+   static TextureImagePtr create(QSize size,
+                                 Initialization initialization = Initialization::Zeroed);
 
    /// @brief Returns the image dimensions in pixels.
    QSize getSize() const noexcept { return size; }
 
    /// @brief Returns the number of pixels in the image buffer.
-   std::size_t pixelCount() const noexcept { return pixels.size(); }
+   std::size_t pixelCount() const noexcept { return count; }
 
    /// @brief Returns the size of the image buffer in bytes.
-   std::size_t byteSize() const noexcept { return pixels.size() * sizeof(TexturePixel); }
+   std::size_t byteSize() const noexcept { return count * sizeof(TexturePixel); }
 
    /// @brief Returns a mutable pointer to the contiguous pixel buffer.
-   TexturePixel* data() noexcept { return pixels.data(); }
+   TexturePixel* data() noexcept { return pixels; }
 
    /// @brief Returns a read-only pointer to the contiguous pixel buffer.
-   const TexturePixel* data() const noexcept { return pixels.data(); }
+   const TexturePixel* data() const noexcept { return pixels; }
 
    /// @brief Returns a mutable pointer through the established accessor alias.
    TexturePixel* getData() noexcept { return data(); }
@@ -109,11 +122,27 @@ public:
    /// @return A QImage independent of this TextureImage's lifetime.
    QImage toQImageCopy() const { return copyTextureImage(size, data()); }
 
+   /// @brief Resamples this image to other dimensions with smooth filtering.
+   /// @param newSize The width and height of the copy; both dimensions must be positive.
+   /// @return A new image independent of this one.
+   /// @throws std::invalid_argument if either dimension is not positive.
+   /// @throws std::length_error if the required pixel storage cannot be represented.
+   TextureImagePtr scaled(QSize newSize) const;
+
+   /// @brief Creates the next level of a mip chain by averaging blocks of two by two pixels.
+   /// @details Colors are weighted by alpha, so transparent pixels do not darken their neighbors.
+   /// The blocks of the last row or column of an odd dimension repeat the image's last row or
+   /// column, so no edge pixel is left out.
+   /// @return A new image of half the width and height, rounded up.
+   TextureImagePtr halved() const;
+
 private:
    /// @brief Image width and height in pixels.
    QSize size;
-   /// @brief Contiguous storage for the image pixels.
-   std::vector<TexturePixel> pixels;
+   /// @brief Number of pixels in the buffer.
+   std::size_t count = 0;
+   /// @brief Contiguous pixel storage taken from TextureImagePool, or null after a move.
+   TexturePixel* pixels = nullptr;
 };
 
 #endif  // TEXTUREIMAGE_H
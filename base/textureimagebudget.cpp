@@ -0,0 +1,165 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "textureimagebudget.h"
+#include "textureimage.h"
+#include <QSize>
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief Bytes per megabyte used to express costs per size.
+constexpr double bytesPerMegabyte = 1024.0 * 1024.0;
+
+}  // namespace
+
+TextureImageBudget::TextureImageBudget(EvictionHandler evictionHandler, const std::size_t budget)
+    : evictionHandler(std::move(evictionHandler)), budget(budget) {}
+
+void TextureImageBudget::add(const int nodeId, const QSize size, const TextureImagePtr& image,
+                             const double costMilliseconds) {
+   if (image.isNull()) {
+      return;
+   }
+   std::vector<Victim> victims;
+   {
+      std::lock_guard lock(mutex);
+      Entry entry{image.data(), image->byteSize(), std::max(costMilliseconds, 0.0), 0.0, 0};
+      markUsed(entry);
+      const Key key = makeKey(nodeId, size);
+      const auto existing = entries.find(key);
+      if (existing != entries.end()) {
+         usedBytes -= existing->second.bytes;
+      }
+      usedBytes += entry.bytes;
+      entries.insert_or_assign(key, entry);
+      victims = collectVictims();
+   }
+   notifyEvicted(victims);
+}
+
+void TextureImageBudget::touch(const int nodeId, const QSize size) {
+   std::lock_guard lock(mutex);
+   const auto entry = entries.find(makeKey(nodeId, size));
+   if (entry != entries.end()) {
+      markUsed(entry->second);
+   }
+}
+
+void TextureImageBudget::remove(const int nodeId, const QSize size, const TextureImage* image) {
+   std::lock_guard lock(mutex);
+   const auto entry = entries.find(makeKey(nodeId, size));
+   if (entry != entries.end() && entry->second.image == image) {
+      usedBytes -= entry->second.bytes;
+      entries.erase(entry);
+   }
+}
+
+void TextureImageBudget::pin(const int nodeId, const QSize size) {
+   std::lock_guard lock(mutex);
+   ++pins[makeKey(nodeId, size)];
+}
+
+void TextureImageBudget::unpin(const int nodeId, const QSize size) {
+   std::vector<Victim> victims;
+   {
+      std::lock_guard lock(mutex);
+      const auto pin = pins.find(makeKey(nodeId, size));
+      if (pin == pins.end()) {
+         return;
+      }
+      if (--pin->second > 0) {
+         return;
+      }
+      pins.erase(pin);
+      victims = collectVictims();
+   }
+   notifyEvicted(victims);
+}
+
+bool TextureImageBudget::isPinned(const int nodeId, const QSize size) const {
+   std::lock_guard lock(mutex);
+   return pins.find(makeKey(nodeId, size)) != pins.end();
+}
+
+void TextureImageBudget::setBudget(const std::size_t bytes) {
+   std::vector<Victim> victims;
+   {
+      std::lock_guard lock(mutex);
+      budget = bytes;
+      victims = collectVictims();
+   }
+   notifyEvicted(victims);
+}
+
+std::size_t TextureImageBudget::getBudget() const {
+   std::lock_guard lock(mutex);
+   return budget;
+}
+
+TextureImageBudget::Statistics TextureImageBudget::getStatistics() const {
+   std::lock_guard lock(mutex);
+   Statistics statistics;
+   statistics.budgetBytes = budget;
+   statistics.usedBytes = usedBytes;
+   statistics.imageCount = entries.size();
+   statistics.evictions = evictions;
+   statistics.evictedBytes = evictedBytes;
+   for (const auto& [key, entry] : entries) {
+      if (pins.find(key) != pins.end()) {
+         statistics.pinnedBytes += entry.bytes;
+      }
+   }
+   return statistics;
+}
+
+void TextureImageBudget::markUsed(Entry& entry) {
+   const double megabytes = std::max(static_cast<double>(entry.bytes) / bytesPerMegabyte, 1e-6);
+   entry.priority = inflation + entry.costMilliseconds / megabytes;
+   entry.lastUse = ++useCounter;
+}
+
+std::vector<TextureImageBudget::Victim> TextureImageBudget::collectVictims() {
+   std::vector<Victim> victims;
+   while (usedBytes > budget) {
+      // Node caches hold a few images per node, so a scan is cheaper than maintaining a heap
+      // that every touch() would have to reorder.
+      auto victim = entries.end();
+      for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+         if (pins.find(entry->first) != pins.end()) {
+            continue;
+         }
+         if (victim == entries.end() || entry->second.priority < victim->second.priority ||
+             (entry->second.priority == victim->second.priority &&
+              entry->second.lastUse < victim->second.lastUse)) {
+            victim = entry;
+         }
+      }
+      if (victim == entries.end()) {
+         break;
+      }
+      inflation = std::max(inflation, victim->second.priority);
+      usedBytes -= victim->second.bytes;
+      ++evictions;
+      evictedBytes += victim->second.bytes;
+      victims.push_back(Victim{victim->first, victim->second.image});
+      entries.erase(victim);
+   }
+   return victims;
+}
+
+void TextureImageBudget::notifyEvicted(const std::vector<Victim>& victims) const {
+   if (!evictionHandler) {
+      return;
+   }
+   for (const Victim& victim : victims) {
+      evictionHandler(victim.key.nodeId, QSize(victim.key.width, victim.key.height),
+                      victim.image);
+   }
+}
@@ -0,0 +1,182 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREIMAGEBUDGET_H
+#define TEXTUREIMAGEBUDGET_H
+
+#include "textureimage.h"
+#include <QSize>
+#include <QtGlobal>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/// @brief Keeps the images cached by a project's nodes within one memory budget.
+/// @details Nodes report every image they cache, and the budget evicts images once their total
+/// size exceeds the limit. Eviction uses the GreedyDual-Size policy: each image is ranked by its
+/// recompute cost per megabyte on top of an aging value that rises with every eviction, so images
+/// that were not used recently go first, and cheap or large images go before expensive small
+/// ones. Pinned images, such as the ones currently on screen, are never evicted.
+class TextureImageBudget {
+public:
+   /// @brief Counters describing the tracked images.
+   struct Statistics {
+      /// @brief Maximum number of pixel bytes kept before images are evicted.
+      std::size_t budgetBytes = 0;
+      /// @brief Pixel bytes of all tracked images.
+      std::size_t usedBytes = 0;
+      /// @brief Pixel bytes of tracked images that are pinned.
+      std::size_t pinnedBytes = 0;
+      /// @brief Number of tracked images.
+      std::size_t imageCount = 0;
+      /// @brief Number of images evicted since construction.
+      quint64 evictions = 0;
+      /// @brief Pixel bytes evicted since construction.
+      quint64 evictedBytes = 0;
+   };
+
+   /// @brief Receives an evicted image so its owner can drop it.
+   /// @details Called without internal locks held. The image pointer identifies the evicted image
+   /// and must only be compared, because the owner may already have replaced it.
+   using EvictionHandler = std::function<void(int nodeId, QSize size, const TextureImage* image)>;
+
+   /// @brief Default budget in bytes.
+   static constexpr std::size_t DefaultBudget = std::size_t(1024) * 1024 * 1024;
+
+   /// @brief Constructs an empty budget.
+   /// @param evictionHandler Callback that drops evicted images from their nodes.
+   /// @param budget Maximum number of pixel bytes kept before images are evicted.
+   explicit TextureImageBudget(EvictionHandler evictionHandler,
+                               std::size_t budget = DefaultBudget);
+
+   /// @brief Disables copying because the budget owns its index and statistics.
+   TextureImageBudget(const TextureImageBudget&) = delete;
+
+   /// @brief Disables copy assignment because the budget owns its index and statistics.
+   TextureImageBudget& operator=(const TextureImageBudget&) = delete;
+
+   /// @brief Tracks an image cached by a node and evicts images that no longer fit.
+   /// @details Replaces any image tracked for the same node and size.
+   /// @param nodeId ID of the node that caches the image.
+   /// @param size Dimensions under which the node caches the image.
+   /// @param image Cached image.
+   /// @param costMilliseconds Estimated time needed to render the image again.
+   void add(int nodeId, QSize size, const TextureImagePtr& image, double costMilliseconds);
+
+   /// @brief Marks an image as recently used.
+   /// @param nodeId ID of the node that caches the image.
+   /// @param size Dimensions of the image.
+   void touch(int nodeId, QSize size);
+
+   /// @brief Stops tracking an image that its node dropped.
+   /// @param nodeId ID of the node that cached the image.
+   /// @param size Dimensions of the image.
+   /// @param image Dropped image; a different image tracked under the same key is kept.
+   void remove(int nodeId, QSize size, const TextureImage* image);
+
+   /// @brief Protects a node's image at one size from eviction.
+   /// @details Pins are counted, so every call must be matched by unpin(). A pin may be placed
+   /// before the image exists and applies to every later image cached under the same key.
+   /// @param nodeId ID of the node.
+   /// @param size Dimensions of the image.
+   void pin(int nodeId, QSize size);
+
+   /// @brief Releases a pin placed by pin() and evicts images that no longer fit.
+   /// @param nodeId ID of the node.
+   /// @param size Dimensions of the image.
+   void unpin(int nodeId, QSize size);
+
+   /// @brief Checks whether a node's image at one size is pinned.
+   bool isPinned(int nodeId, QSize size) const;
+
+   /// @brief Sets the budget and evicts images that no longer fit.
+   /// @param bytes Maximum number of pixel bytes kept before images are evicted.
+   void setBudget(std::size_t bytes);
+
+   /// @brief Returns the budget in bytes.
+   std::size_t getBudget() const;
+
+   /// @brief Returns a snapshot of the tracked usage and eviction counters.
+   Statistics getStatistics() const;
+
+private:
+   /// @brief Identifies a node image by node ID and dimensions.
+   struct Key {
+      /// @brief Node ID.
+      int nodeId;
+      /// @brief Image width.
+      int width;
+      /// @brief Image height.
+      int height;
+
+      /// @brief Orders keys by node ID and then dimensions.
+      bool operator<(const Key& other) const {
+         if (nodeId != other.nodeId) {
+            return nodeId < other.nodeId;
+         }
+         return width != other.width ? width < other.width : height < other.height;
+      }
+   };
+
+   /// @brief One tracked image.
+   struct Entry {
+      /// @brief Identity of the tracked image.
+      const TextureImage* image;
+      /// @brief Pixel bytes of the image.
+      std::size_t bytes;
+      /// @brief Estimated time needed to render the image again.
+      double costMilliseconds;
+      /// @brief Eviction priority; the lowest unpinned value is evicted first.
+      double priority;
+      /// @brief Value of useCounter at the last use, which breaks priority ties.
+      quint64 lastUse;
+   };
+
+   /// @brief An image chosen for eviction.
+   struct Victim {
+      /// @brief Key of the evicted image.
+      Key key;
+      /// @brief Identity of the evicted image.
+      const TextureImage* image;
+   };
+
+   /// @brief Creates the key of a node image.
+   static Key makeKey(int nodeId, QSize size) { return Key{nodeId, size.width(), size.height()}; }
+
+   /// @brief Updates the priority and use order of an image used now, while mutex is held.
+   void markUsed(Entry& entry);
+
+   /// @brief Removes images from the index until the budget is met, while mutex is held.
+   /// @return The removed images, which the caller passes to the eviction handler.
+   std::vector<Victim> collectVictims();
+
+   /// @brief Passes evicted images to the eviction handler without holding mutex.
+   void notifyEvicted(const std::vector<Victim>& victims) const;
+
+   /// @brief Callback that drops evicted images from their nodes.
+   EvictionHandler evictionHandler;
+   /// @brief Protects every member below.
+   mutable std::mutex mutex;
+   /// @brief Tracked images by key.
+   std::map<Key, Entry> entries;
+   /// @brief Pin counts by key.
+   std::map<Key, int> pins;
+   /// @brief Maximum number of pixel bytes kept before images are evicted.
+   std::size_t budget;
+   /// @brief Pixel bytes of all tracked images.
+   std::size_t usedBytes = 0;
+   /// @brief Aging value, raised to the priority of every evicted image.
+   double inflation = 0.0;
+   /// @brief Number of image uses, which orders images of equal priority.
+   quint64 useCounter = 0;
+   /// @brief Number of images evicted since construction.
+   quint64 evictions = 0;
+   /// @brief Pixel bytes evicted since construction.
+   quint64 evictedBytes = 0;
+};
+
+#endif  // TEXTUREIMAGEBUDGET_H
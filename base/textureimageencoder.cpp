@@ -0,0 +1,627 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "textureimageencoder.h"
+#include "global.h"
+#include "textureimage.h"
+#include <QByteArrayView>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QImage>
+#include <QImageWriter>
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <future>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+#ifdef PTM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+/// @brief Number of bytes collected before they are written to the device.
+constexpr std::size_t outputBufferBytes = 1024 * 1024;
+
+/// @brief Collects small writes and passes them to a device in large pieces.
+/// @details Writes at least as large as the buffer go to the device directly, so pixel storage
+/// that is already in the file layout is written without a copy.
+class BufferedOutput final {
+public:
+   /// @brief Creates an empty buffer in front of an open device.
+   explicit BufferedOutput(QIODevice& device) : device(device) {
+      buffer.reserve(outputBufferBytes);
+   }
+
+   /// @brief Appends bytes to the output.
+   void write(const void* data, const std::size_t length) {
+      if (buffer.size() + length > outputBufferBytes) {
+         flush();
+         if (length >= outputBufferBytes) {
+            writeDevice(static_cast<const char*>(data), length);
+            return;
+         }
+      }
+      const auto* bytes = static_cast<const char*>(data);
+      buffer.insert(buffer.end(), bytes, bytes + length);
+   }
+
+   /// @brief Appends one byte to the output.
+   void writeByte(const quint8 value) {
+      if (buffer.size() >= outputBufferBytes) {
+         flush();
+      }
+      buffer.push_back(static_cast<char>(value));
+   }
+
+   /// @brief Appends a 16-bit value with the least significant byte first.
+   void writeLittleEndian16(const quint16 value) {
+      writeByte(static_cast<quint8>(value));
+      writeByte(static_cast<quint8>(value >> 8U));
+   }
+
+   /// @brief Appends a 32-bit value with the least significant byte first.
+   void writeLittleEndian32(const quint32 value) {
+      writeLittleEndian16(static_cast<quint16>(value));
+      writeLittleEndian16(static_cast<quint16>(value >> 16U));
+   }
+
+   /// @brief Appends a 32-bit value with the most significant byte first.
+   void writeBigEndian32(const quint32 value) {
+      for (int shift = 24; shift >= 0; shift -= 8) {
+         writeByte(static_cast<quint8>(value >> static_cast<unsigned>(shift)));
+      }
+   }
+
+   /// @brief Writes the buffered bytes to the device.
+   /// @return True when every byte written so far reached the device.
+   bool flush() {
+      if (!buffer.empty()) {
+         writeDevice(buffer.data(), buffer.size());
+         buffer.clear();
+      }
+      return ok;
+   }
+
+private:
+   /// @brief Writes bytes to the device until they are all written or the device fails.
+   void writeDevice(const char* data, std::size_t length) {
+      while (ok && length > 0) {
+         const qint64 written = device.write(data, static_cast<qint64>(length));
+         if (written <= 0) {
+            ok = false;
+            return;
+         }
+         data += written;
+         length -= static_cast<std::size_t>(written);
+      }
+   }
+
+   /// @brief Destination of the output.
+   QIODevice& device;
+   /// @brief Bytes not written to the device yet.
+   std::vector<char> buffer;
+   /// @brief Whether every device write succeeded.
+   bool ok = true;
+};
+
+/// @brief Reads the RGBA bytes of one image row.
+const quint8* rowBytes(const TextureImage& image, const int row) {
+   const auto width = static_cast<std::size_t>(image.getSize().width());
+   return reinterpret_cast<const quint8*>(image.data() + static_cast<std::size_t>(row) * width);
+}
+
+#ifdef PTM_HAVE_ZLIB
+
+/// @brief Size of the deflate window, which is also the longest useful preset dictionary.
+constexpr std::size_t deflateWindowBytes = 32 * 1024;
+/// @brief Smallest amount of filtered PNG data deflated as one band.
+constexpr std::size_t minimumBandBytes = 64 * 1024;
+/// @brief Largest amount of filtered PNG data deflated as one band.
+constexpr std::size_t maximumBandBytes = 1024 * 1024;
+
+/// @brief Filter types of PNG scanlines.
+enum PngFilter : quint8 { FilterNone = 0, FilterSub, FilterUp, FilterAverage, FilterPaeth };
+
+/// @brief Predicts a byte from its left, upper, and upper-left neighbours as PNG defines it.
+quint8 paethPredictor(const int left, const int up, const int upLeft) {
+   const int estimate = left + up - upLeft;
+   const int leftDistance = std::abs(estimate - left);
+   const int upDistance = std::abs(estimate - up);
+   const int upLeftDistance = std::abs(estimate - upLeft);
+   if (leftDistance <= upDistance && leftDistance <= upLeftDistance) {
+      return static_cast<quint8>(left);
+   }
+   return static_cast<quint8>(upDistance <= upLeftDistance ? up : upLeft);
+}
+
+/// @brief Filters one RGBA scanline.
+/// @param filter Filter to apply.
+/// @param row Bytes of the scanline.
+/// @param previous Bytes of the scanline above, or null for the first one.
+/// @param destination Receives the filtered bytes, without the filter type.
+/// @param length Number of bytes in the scanline.
+/// @return Sum of the filtered bytes read as signed values, the cost the filter choice minimises.
+std::size_t filterRow(const PngFilter filter, const quint8* row, const quint8* previous,
+                      quint8* destination, const std::size_t length) {
+   constexpr std::size_t bytesPerPixel = sizeof(TexturePixel);
+   std::size_t cost = 0;
+   for (std::size_t i = 0; i < length; ++i) {
+      const int left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+      const int up = previous ? previous[i] : 0;
+      const int upLeft = previous && i >= bytesPerPixel ? previous[i - bytesPerPixel] : 0;
+      int predicted = 0;
+      switch (filter) {
+         case FilterNone:
+            break;
+         case FilterSub:
+            predicted = left;
+            break;
+         case FilterUp:
+            predicted = up;
+            break;
+         case FilterAverage:
+            predicted = (left + up) / 2;
+            break;
+         case FilterPaeth:
+            predicted = paethPredictor(left, up, upLeft);
+            break;
+      }
+      const auto value = static_cast<quint8>(row[i] - predicted);
+      destination[i] = value;
+      cost += static_cast<std::size_t>(std::abs(static_cast<int>(static_cast<qint8>(value))));
+   }
+   return cost;
+}
+
+/// @brief Filters consecutive image rows into PNG scanlines, each led by its filter type.
+/// @details Stored data is not filtered. Otherwise every row uses the filter with the lowest cost,
+/// which depends only on the row and the one above, so a range filters the same way on its own
+/// as inside a larger range.
+std::vector<quint8> filterRows(const TextureImage& image, const int firstRow, const int rowCount,
+                               const int compressionLevel) {
+   const std::size_t length = static_cast<std::size_t>(image.getSize().width()) *
+                              sizeof(TexturePixel);
+   std::vector<quint8> filtered(static_cast<std::size_t>(rowCount) * (length + 1));
+   std::vector<quint8> candidate(compressionLevel > 0 ? length : 0);
+   for (int index = 0; index < rowCount; ++index) {
+      const int row = firstRow + index;
+      const quint8* bytes = rowBytes(image, row);
+      const quint8* previous = row > 0 ? rowBytes(image, row - 1) : nullptr;
+      quint8* destination = filtered.data() + static_cast<std::size_t>(index) * (length + 1);
+      if (compressionLevel == 0) {
+         destination[0] = FilterNone;
+         std::copy(bytes, bytes + length, destination + 1);
+         continue;
+      }
+      destination[0] = FilterNone;
+      std::size_t bestCost = filterRow(FilterNone, bytes, previous, destination + 1, length);
+      for (const PngFilter filter : {FilterSub, FilterUp, FilterAverage, FilterPaeth}) {
+         const std::size_t cost = filterRow(filter, bytes, previous, candidate.data(), length);
+         if (cost < bestCost) {
+            bestCost = cost;
+            destination[0] = filter;
+            std::copy(candidate.cbegin(), candidate.cend(), destination + 1);
+         }
+      }
+   }
+   return filtered;
+}
+
+/// @brief Deflated data of a horizontal band of a PNG image.
+struct PngBand {
+   /// @brief Raw deflate data; it ends on a byte boundary unless the band is the last one.
+   std::vector<quint8> compressed;
+   /// @brief Adler-32 checksum of the filtered data.
+   uLong adler = 0;
+   /// @brief Number of filtered bytes.
+   std::size_t filteredBytes = 0;
+   /// @brief Failure description, or an empty string on success.
+   QString error;
+};
+
+/// @brief Filters and deflates a horizontal band of an image.
+/// @details The band is primed with the filtered bytes before it, so matches may reach back into
+/// the previous band just like in a single stream. A band that is not the last ends with a sync
+/// flush, so the raw streams of consecutive bands concatenate into one valid deflate stream.
+PngBand deflateBand(const TextureImage& image, const int firstRow, const int rowCount,
+                    const int compressionLevel, const bool last) {
+   PngBand band;
+   const std::vector<quint8> filtered = filterRows(image, firstRow, rowCount, compressionLevel);
+   band.filteredBytes = filtered.size();
+   band.adler =
+       adler32(adler32(0L, Z_NULL, 0), filtered.data(), static_cast<uInt>(filtered.size()));
+
+   z_stream stream{};
+   if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+       Z_OK) {
+      band.error = QStringLiteral("Could not initialise the PNG compressor");
+      return band;
+   }
+   if (firstRow > 0 && compressionLevel > 0) {
+      const std::size_t scanlineBytes = filtered.size() / static_cast<std::size_t>(rowCount);
+      const int dictionaryRows = static_cast<int>(std::min<std::size_t>(
+          static_cast<std::size_t>(firstRow),
+          (deflateWindowBytes + scanlineBytes - 1) / scanlineBytes));
+      const std::vector<quint8> before =
+          filterRows(image, firstRow - dictionaryRows, dictionaryRows, compressionLevel);
+      const std::size_t dictionaryBytes = std::min(before.size(), deflateWindowBytes);
+      deflateSetDictionary(&stream, before.data() + before.size() - dictionaryBytes,
+                           static_cast<uInt>(dictionaryBytes));
+   }
+
+   band.compressed.resize(deflateBound(&stream, static_cast<uLong>(filtered.size())) + 64);
+   stream.next_in = const_cast<Bytef*>(filtered.data());
+   stream.avail_in = static_cast<uInt>(filtered.size());
+   stream.next_out = band.compressed.data();
+   stream.avail_out = static_cast<uInt>(band.compressed.size());
+   const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+   int status = Z_OK;
+   for (;;) {
+      status = deflate(&stream, flush);
+      if (status == Z_STREAM_ERROR || status == Z_STREAM_END ||
+          (!last && stream.avail_in == 0 && stream.avail_out > 0)) {
+         break;
+      }
+      // The output buffer ran full before the flush completed.
+      const std::size_t used = band.compressed.size() - stream.avail_out;
+      band.compressed.resize(band.compressed.size() * 2);
+      stream.next_out = band.compressed.data() + used;
+      stream.avail_out = static_cast<uInt>(band.compressed.size() - used);
+   }
+   band.compressed.resize(band.compressed.size() - stream.avail_out);
+   deflateEnd(&stream);
+   if (status == Z_STREAM_ERROR) {
+      band.error = QStringLiteral("Could not compress the PNG data");
+   }
+   return band;
+}
+
+/// @brief Writes a PNG chunk whose data is the concatenation of several pieces.
+void writePngChunk(BufferedOutput& output, const char* type,
+                   const std::initializer_list<QByteArrayView> pieces) {
+   qsizetype length = 0;
+   for (const QByteArrayView piece : pieces) {
+      length += piece.size();
+   }
+   output.writeBigEndian32(static_cast<quint32>(length));
+   output.write(type, 4);
+   uLong crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(type), 4);
+   for (const QByteArrayView piece : pieces) {
+      // A null buffer would reset the checksum instead of extending it.
+      if (piece.size() == 0) {
+         continue;
+      }
+      output.write(piece.data(), static_cast<std::size_t>(piece.size()));
+      crc = crc32(crc, reinterpret_cast<const Bytef*>(piece.data()),
+                  static_cast<uInt>(piece.size()));
+   }
+   output.writeBigEndian32(static_cast<quint32>(crc));
+}
+
+/// @brief Encodes an image as an RGBA PNG, deflating bands of rows on several threads.
+bool encodePng(const TextureImage& image, BufferedOutput& output,
+               const TextureEncodeOptions& options, QString* error) {
+   constexpr std::array<quint8, 8> signature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+   const QSize size = image.getSize();
+   output.write(signature.data(), signature.size());
+   const std::array<quint8, 13> header{
+       static_cast<quint8>(size.width() >> 24), static_cast<quint8>(size.width() >> 16),
+       static_cast<quint8>(size.width() >> 8),  static_cast<quint8>(size.width()),
+       static_cast<quint8>(size.height() >> 24), static_cast<quint8>(size.height() >> 16),
+       static_cast<quint8>(size.height() >> 8), static_cast<quint8>(size.height()),
+       8, 6, 0, 0, 0};
+   writePngChunk(output, "IHDR", {QByteArrayView(header.data(), header.size())});
+
+   const int level = options.compressionLevel;
+   const std::size_t threadCount =
+       options.threadCount > 0
+           ? static_cast<std::size_t>(options.threadCount)
+           : static_cast<std::size_t>(std::max(1U, std::thread::hardware_concurrency()));
+   // Bands are small enough to keep every thread busy and large enough to compress well.
+   const std::size_t scanlineBytes =
+       static_cast<std::size_t>(size.width()) * sizeof(TexturePixel) + 1;
+   const int minimumRows =
+       static_cast<int>(std::max<std::size_t>(1, (minimumBandBytes + scanlineBytes - 1) /
+                                                     scanlineBytes));
+   const int maximumRows = std::max(
+       minimumRows, static_cast<int>(std::max<std::size_t>(1, maximumBandBytes / scanlineBytes)));
+   const int bandRows = std::clamp(size.height() / static_cast<int>(threadCount * 4), minimumRows,
+                                   maximumRows);
+
+   // The zlib header announces a 32 KiB window and the compression level in use.
+   const int levelFlag = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+   const unsigned streamHeader = 0x7800U | (static_cast<unsigned>(levelFlag) << 6U);
+   const std::array<quint8, 2> zlibHeader{
+       0x78, static_cast<quint8>((streamHeader + 31U - streamHeader % 31U) & 0xFFU)};
+
+   std::deque<std::future<PngBand>> bands;
+   int nextRow = 0;
+   const auto launchBand = [&]() {
+      const int rowCount = std::min(bandRows, size.height() - nextRow);
+      const bool last = nextRow + rowCount == size.height();
+      bands.push_back(std::async(threadCount > 1 ? std::launch::async : std::launch::deferred,
+                                 deflateBand, std::cref(image), nextRow, rowCount, level, last));
+      nextRow += rowCount;
+   };
+   while (nextRow < size.height() && bands.size() < threadCount) {
+      launchBand();
+   }
+   uLong adler = adler32(0L, Z_NULL, 0);
+   bool first = true;
+   while (!bands.empty()) {
+      const PngBand band = bands.front().get();
+      bands.pop_front();
+      if (!band.error.isEmpty()) {
+         if (error) {
+            *error = band.error;
+         }
+         return false;
+      }
+      if (nextRow < size.height()) {
+         launchBand();
+      }
+      adler = adler32_combine(adler, band.adler, static_cast<z_off_t>(band.filteredBytes));
+      const std::array<quint8, 4> trailer{
+          static_cast<quint8>(adler >> 24U), static_cast<quint8>(adler >> 16U),
+          static_cast<quint8>(adler >> 8U), static_cast<quint8>(adler)};
+      const bool last = bands.empty();
+      writePngChunk(
+          output, "IDAT",
+          {first ? QByteArrayView(zlibHeader.data(), zlibHeader.size()) : QByteArrayView(),
+           QByteArrayView(band.compressed.data(), static_cast<qsizetype>(band.compressed.size())),
+           last ? QByteArrayView(trailer.data(), trailer.size()) : QByteArrayView()});
+      first = false;
+   }
+   writePngChunk(output, "IEND", {});
+   return true;
+}
+
+#else
+
+/// @brief Encodes an image as a PNG through Qt, reading the texture storage through a view.
+bool encodePng(const TextureImage& image, QIODevice& output, const TextureEncodeOptions& options,
+               QString* error) {
+   QImageWriter writer(&output, "png");
+   // Qt derives the deflate level from the quality as (100 - quality) * 9 / 91.
+   writer.setQuality(100 - (options.compressionLevel * 91 + 8) / 9);
+   if (!writer.write(image.toQImageView())) {
+      if (error) {
+         *error = writer.errorString();
+      }
+      return false;
+   }
+   return true;
+}
+
+#endif
+
+/// @brief Encodes an image as an uncompressed 32-bit TGA with a top-left origin.
+bool encodeTga(const TextureImage& image, BufferedOutput& output, QString* error) {
+   const QSize size = image.getSize();
+   if (size.width() > 0xFFFF || size.height() > 0xFFFF) {
+      if (error) {
+         *error = QStringLiteral("TGA images are limited to 65535 pixels per side");
+      }
+      return false;
+   }
+   constexpr std::array<quint8, 12> header{0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+   output.write(header.data(), header.size());
+   output.writeLittleEndian16(static_cast<quint16>(size.width()));
+   output.writeLittleEndian16(static_cast<quint16>(size.height()));
+   output.writeByte(32);
+   // Eight alpha bits, rows stored from the top.
+   output.writeByte(0x28);
+
+   std::vector<quint8> row(static_cast<std::size_t>(size.width()) * sizeof(TexturePixel));
+   for (int y = 0; y < size.height(); ++y) {
+      const quint8* source = rowBytes(image, y);
+      for (std::size_t i = 0; i < row.size(); i += sizeof(TexturePixel)) {
+         row[i] = source[i + 2];
+         row[i + 1] = source[i + 1];
+         row[i + 2] = source[i];
+         row[i + 3] = source[i + 3];
+      }
+      output.write(row.data(), row.size());
+   }
+   // The TGA 2.0 footer, without extension or developer areas.
+   constexpr char footer[] = "\0\0\0\0\0\0\0\0TRUEVISION-XFILE.";
+   output.write(footer, sizeof(footer));
+   return true;
+}
+
+/// @brief Encodes an image as an uncompressed DDS surface in the texture's own byte order.
+void encodeDds(const TextureImage& image, BufferedOutput& output) {
+   const QSize size = image.getSize();
+   const auto width = static_cast<quint32>(size.width());
+   output.write("DDS ", 4);
+   output.writeLittleEndian32(124);
+   // Caps, height, width, pitch, and pixel format are set.
+   output.writeLittleEndian32(0x100F);
+   output.writeLittleEndian32(static_cast<quint32>(size.height()));
+   output.writeLittleEndian32(width);
+   output.writeLittleEndian32(width * static_cast<quint32>(sizeof(TexturePixel)));
+   for (int i = 0; i < 13; ++i) {
+      output.writeLittleEndian32(0);
+   }
+   // The pixel format is 32-bit RGB with alpha, with red in the lowest byte.
+   for (const quint32 value :
+        {32U, 0x41U, 0U, 32U, 0x000000FFU, 0x0000FF00U, 0x00FF0000U, 0xFF000000U}) {
+      output.writeLittleEndian32(value);
+   }
+   output.writeLittleEndian32(0x1000);
+   for (int i = 0; i < 4; ++i) {
+      output.writeLittleEndian32(0);
+   }
+   output.write(image.data(), image.byteSize());
+}
+
+/// @brief Returns whether two pixels have the same channels.
+bool samePixel(const TexturePixel& first, const TexturePixel& second) {
+   return first.r == second.r && first.g == second.g && first.b == second.b && first.a == second.a;
+}
+
+/// @brief Returns the wrapped difference of two channel values as a signed number.
+int channelDifference(const quint8 value, const quint8 previous) {
+   return static_cast<qint8>(static_cast<quint8>(value - previous));
+}
+
+/// @brief Encodes an image in the Quite OK Image format.
+void encodeQoi(const TextureImage& image, BufferedOutput& output) {
+   const QSize size = image.getSize();
+   output.write("qoif", 4);
+   output.writeBigEndian32(static_cast<quint32>(size.width()));
+   output.writeBigEndian32(static_cast<quint32>(size.height()));
+   output.writeByte(4);
+   output.writeByte(0);
+
+   std::array<TexturePixel, 64> seen{};
+   TexturePixel previous(0, 0, 0, 255);
+   int run = 0;
+   const TexturePixel* pixels = image.data();
+   const std::size_t count = image.pixelCount();
+   for (std::size_t i = 0; i < count; ++i) {
+      const TexturePixel pixel = pixels[i];
+      if (samePixel(pixel, previous)) {
+         ++run;
+         if (run == 62 || i + 1 == count) {
+            output.writeByte(static_cast<quint8>(0xC0 | (run - 1)));
+            run = 0;
+         }
+         continue;
+      }
+      if (run > 0) {
+         output.writeByte(static_cast<quint8>(0xC0 | (run - 1)));
+         run = 0;
+      }
+      const int hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+      if (samePixel(seen[hash], pixel)) {
+         output.writeByte(static_cast<quint8>(hash));
+      } else if (pixel.a != previous.a) {
+         seen[hash] = pixel;
+         output.writeByte(0xFF);
+         output.write(&pixel, sizeof(pixel));
+      } else {
+         seen[hash] = pixel;
+         const int red = channelDifference(pixel.r, previous.r);
+         const int green = channelDifference(pixel.g, previous.g);
+         const int blue = channelDifference(pixel.b, previous.b);
+         const int redGreen = red - green;
+         const int blueGreen = blue - green;
+         if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1) {
+            output.writeByte(
+                static_cast<quint8>(0x40 | (red + 2) << 4 | (green + 2) << 2 | (blue + 2)));
+         } else if (green >= -32 && green <= 31 && redGreen >= -8 && redGreen <= 7 &&
+                    blueGreen >= -8 && blueGreen <= 7) {
+            output.writeByte(static_cast<quint8>(0x80 | (green + 32)));
+            output.writeByte(static_cast<quint8>((redGreen + 8) << 4 | (blueGreen + 8)));
+         } else {
+            output.writeByte(0xFE);
+            output.write(&pixel, 3);
+         }
+      }
+      previous = pixel;
+   }
+   constexpr std::array<quint8, 8> end{0, 0, 0, 0, 0, 0, 0, 1};
+   output.write(end.data(), end.size());
+}
+
+}  // namespace
+
+std::optional<TextureFileFormat> TextureImageEncoder::formatForPath(const QString& path) {
+   const QString suffix = QFileInfo(path).suffix().toLower();
+   if (suffix == QLatin1String("png")) {
+      return TextureFileFormat::Png;
+   }
+   if (suffix == QLatin1String("tga")) {
+      return TextureFileFormat::Tga;
+   }
+   if (suffix == QLatin1String("dds")) {
+      return TextureFileFormat::Dds;
+   }
+   if (suffix == QLatin1String("raw") || suffix == QLatin1String("rgba")) {
+      return TextureFileFormat::Raw;
+   }
+   if (suffix == QLatin1String("qoi")) {
+      return TextureFileFormat::Qoi;
+   }
+   return std::nullopt;
+}
+
+QStringList TextureImageEncoder::fileSuffixes() {
+   return {QStringLiteral("png"), QStringLiteral("tga"), QStringLiteral("dds"),
+           QStringLiteral("raw"), QStringLiteral("rgba"), QStringLiteral("qoi")};
+}
+
+QString TextureImageEncoder::formatName(const TextureFileFormat format) {
+   switch (format) {
+      case TextureFileFormat::Png:
+         return QStringLiteral("png");
+      case TextureFileFormat::Tga:
+         return QStringLiteral("tga");
+      case TextureFileFormat::Dds:
+         return QStringLiteral("dds");
+      case TextureFileFormat::Raw:
+         return QStringLiteral("raw");
+      case TextureFileFormat::Qoi:
+         return QStringLiteral("qoi");
+   }
+   return {};
+}
+
+bool TextureImageEncoder::encode(const TextureImage& image, QIODevice& output,
+                                 const TextureEncodeOptions& options, QString* error) {
+   TextureEncodeOptions clamped = options;
+   clamped.compressionLevel = std::clamp(options.compressionLevel, 0, 9);
+   try {
+#ifndef PTM_HAVE_ZLIB
+      if (clamped.format == TextureFileFormat::Png) {
+         return encodePng(image, output, clamped, error);
+      }
+#endif
+      BufferedOutput buffered(output);
+      switch (clamped.format) {
+         case TextureFileFormat::Png:
+#ifdef PTM_HAVE_ZLIB
+            if (!encodePng(image, buffered, clamped, error)) {
+               return false;
+            }
+#endif
+            break;
+         case TextureFileFormat::Tga:
+            if (!encodeTga(image, buffered, error)) {
+               return false;
+            }
+            break;
+         case TextureFileFormat::Dds:
+            encodeDds(image, buffered);
+            break;
+         case TextureFileFormat::Raw:
+            buffered.write(image.data(), image.byteSize());
+            break;
+         case TextureFileFormat::Qoi:
+            encodeQoi(image, buffered);
+            break;
+      }
+      if (!buffered.flush()) {
+         if (error) {
+            *error = output.errorString();
+         }
+         return false;
+      }
+   } catch (const std::exception& exception) {
+      if (error) {
+         *error = QString::fromUtf8(exception.what());
+      }
+      return false;
+   }
+   return true;
+}
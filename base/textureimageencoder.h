@@ -0,0 +1,73 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREIMAGEENCODER_H
+#define TEXTUREIMAGEENCODER_H
+
+#include <QString>
+#include <QStringList>
+#include <optional>
+
+class QIODevice;
+class TextureImage;
+
+/// @brief File formats a texture image can be encoded as.
+enum class TextureFileFormat {
+   /// @brief Deflate-compressed PNG with straight alpha.
+   Png,
+   /// @brief Uncompressed 32-bit Truevision TGA with a top-left origin.
+   Tga,
+   /// @brief Uncompressed 32-bit DirectDraw Surface without mipmaps.
+   Dds,
+   /// @brief Headerless RGBA bytes, row by row from the top.
+   Raw,
+   /// @brief The Quite OK Image format, a fast lossless compression.
+   Qoi
+};
+
+/// @brief Settings of an image encode.
+struct TextureEncodeOptions {
+   /// @brief Compression level used unless another one is chosen.
+   static constexpr int defaultCompressionLevel = 6;
+
+   /// @brief Format written to the output.
+   TextureFileFormat format = TextureFileFormat::Png;
+   /// @brief Deflate level from 0, which stores the data, to 9, which compresses the most.
+   /// @details Only PNG output is compressed with deflate; the other formats ignore the level.
+   int compressionLevel = defaultCompressionLevel;
+   /// @brief Number of threads deflating PNG data, or zero for one per processor core.
+   int threadCount = 0;
+};
+
+/// @brief Encodes texture images straight from their pixel storage into image files.
+/// @details The encoders read the RGBA rows of the image directly and write them to the output in
+/// bounded pieces, so no converted copy of the whole image is made. PNG data is filtered and
+/// deflated in horizontal bands on several threads when zlib is available; each band is primed
+/// with the end of the previous one, so the file stays close to a single-threaded encode.
+class TextureImageEncoder final {
+public:
+   /// @brief Returns the format matching the suffix of a file path.
+   /// @param path File path whose suffix is checked, ignoring case.
+   /// @return The matching format, or nothing for an unsupported suffix.
+   [[nodiscard]] static std::optional<TextureFileFormat> formatForPath(const QString& path);
+
+   /// @brief Returns the lower-case file suffixes of every supported format.
+   [[nodiscard]] static QStringList fileSuffixes();
+
+   /// @brief Returns the short name of a format, such as "png".
+   [[nodiscard]] static QString formatName(TextureFileFormat format);
+
+   /// @brief Encodes an image and writes it to an open device.
+   /// @param image Image to encode.
+   /// @param output Device opened for writing.
+   /// @param options Format, compression level, and thread count of the encode.
+   /// @param error Optional destination for a failure description.
+   /// @return True when the whole image was written.
+   [[nodiscard]] static bool encode(const TextureImage& image, QIODevice& output,
+                                    const TextureEncodeOptions& options = {},
+                                    QString* error = nullptr);
+};
+
+#endif  // TEXTUREIMAGEENCODER_H
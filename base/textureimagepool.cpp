@@ -0,0 +1,147 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "textureimagepool.h"
+#include "global.h"
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+TextureImagePool::TextureImagePool(const std::size_t retainedBudget)
+    : retainedBudget(retainedBudget) {}
+
+TextureImagePool::~TextureImagePool() { trim(); }
+
+TextureImagePool& TextureImagePool::instance() {
+   // Never destroyed, because images held by other static objects may be released after the
+   // function-local statics constructed later than them.
+   static auto* pool = new TextureImagePool;
+   return *pool;
+}
+
+TexturePixel* TextureImagePool::acquire(const std::size_t pixelCount) {
+   {
+      std::lock_guard lock(mutex);
+      ++statistics.liveBuffers;
+      const auto bucket = buckets.find(pixelCount);
+      if (bucket != buckets.end() && !bucket->second.buffers.empty()) {
+         TexturePixel* const pixels = bucket->second.buffers.back();
+         bucket->second.buffers.pop_back();
+         bucket->second.lastUse = ++useCounter;
+         --statistics.retainedBuffers;
+         statistics.retainedBytes -= pixelCount * sizeof(TexturePixel);
+         ++statistics.reuses;
+         return pixels;
+      }
+      ++statistics.heapAllocations;
+   }
+   try {
+      return allocate(pixelCount);
+   } catch (...) {
+      std::lock_guard lock(mutex);
+      --statistics.liveBuffers;
+      --statistics.heapAllocations;
+      throw;
+   }
+}
+
+void TextureImagePool::release(TexturePixel* const pixels, const std::size_t pixelCount) noexcept {
+   if (pixels == nullptr) {
+      return;
+   }
+   std::lock_guard lock(mutex);
+   --statistics.liveBuffers;
+   try {
+      Bucket& bucket = buckets[pixelCount];
+      bucket.buffers.push_back(pixels);
+      bucket.lastUse = ++useCounter;
+   } catch (const std::bad_alloc&) {
+      // The bucket index could not grow, so the buffer goes straight back to the heap.
+      ++statistics.heapFrees;
+      deallocate(pixels);
+      return;
+   }
+   ++statistics.releases;
+   ++statistics.retainedBuffers;
+   statistics.retainedBytes += pixelCount * sizeof(TexturePixel);
+   freeExcess();
+}
+
+void TextureImagePool::setRetainedBudget(const std::size_t bytes) {
+   std::lock_guard lock(mutex);
+   retainedBudget = bytes;
+   freeExcess();
+}
+
+std::size_t TextureImagePool::getRetainedBudget() const {
+   std::lock_guard lock(mutex);
+   return retainedBudget;
+}
+
+void TextureImagePool::trim() {
+   std::map<std::size_t, Bucket> released;
+   {
+      std::lock_guard lock(mutex);
+      released.swap(buckets);
+      for (const auto& [pixelCount, bucket] : released) {
+         statistics.heapFrees += bucket.buffers.size();
+      }
+      statistics.retainedBuffers = 0;
+      statistics.retainedBytes = 0;
+   }
+   for (const auto& [pixelCount, bucket] : released) {
+      for (TexturePixel* const pixels : bucket.buffers) {
+         deallocate(pixels);
+      }
+   }
+}
+
+TextureImagePool::Statistics TextureImagePool::getStatistics() const {
+   std::lock_guard lock(mutex);
+   return statistics;
+}
+
+void TextureImagePool::resetStatistics() {
+   std::lock_guard lock(mutex);
+   statistics.heapAllocations = 0;
+   statistics.reuses = 0;
+   statistics.releases = 0;
+   statistics.heapFrees = 0;
+}
+
+void TextureImagePool::freeExcess() noexcept {
+   while (statistics.retainedBytes > retainedBudget) {
+      // Only a few image sizes are in use at a time, so a scan finds the oldest bucket cheaply.
+      auto oldest = buckets.end();
+      for (auto bucket = buckets.begin(); bucket != buckets.end(); ++bucket) {
+         if (!bucket->second.buffers.empty() &&
+             (oldest == buckets.end() || bucket->second.lastUse < oldest->second.lastUse)) {
+            oldest = bucket;
+         }
+      }
+      if (oldest == buckets.end()) {
+         break;
+      }
+      deallocate(oldest->second.buffers.front());
+      oldest->second.buffers.erase(oldest->second.buffers.begin());
+      --statistics.retainedBuffers;
+      statistics.retainedBytes -= oldest->first * sizeof(TexturePixel);
+      ++statistics.heapFrees;
+      if (oldest->second.buffers.empty()) {
+         buckets.erase(oldest);
+      }
+   }
+}
+
+TexturePixel* TextureImagePool::allocate(const std::size_t pixelCount) {
+   return static_cast<TexturePixel*>(
+       ::operator new(pixelCount * sizeof(TexturePixel), std::align_val_t(BufferAlignment)));
+}
+
+void TextureImagePool::deallocate(TexturePixel* const pixels) noexcept {
+   ::operator delete(pixels, std::align_val_t(BufferAlignment));
+}
@@ -0,0 +1,122 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREIMAGEPOOL_H
+#define TEXTUREIMAGEPOOL_H
+
+#include "global.h"
+#include <QtGlobal>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/// @brief Recycles the pixel buffers of released texture images.
+/// @details Buffers are kept in buckets by pixel count, so a render of the same graph at the same
+/// size, such as the renders triggered by a slider drag, reuses the buffers of the previous render
+/// instead of returning to the heap. Released buffers are kept until their total size exceeds the
+/// retained budget; the buffers of the least recently used bucket are freed first.
+class TextureImagePool {
+public:
+   /// @brief Counters describing pool use since construction or the last resetStatistics().
+   struct Statistics {
+      /// @brief Buffers taken from the heap because no released buffer matched.
+      quint64 heapAllocations = 0;
+      /// @brief Buffers handed out again after being released.
+      quint64 reuses = 0;
+      /// @brief Buffers returned to the pool.
+      quint64 releases = 0;
+      /// @brief Buffers freed to respect the retained budget.
+      quint64 heapFrees = 0;
+      /// @brief Number of buffers handed out and not yet released.
+      std::size_t liveBuffers = 0;
+      /// @brief Number of released buffers kept for reuse.
+      std::size_t retainedBuffers = 0;
+      /// @brief Bytes of released buffers kept for reuse.
+      std::size_t retainedBytes = 0;
+   };
+
+   /// @brief Default retained budget in bytes.
+   static constexpr std::size_t DefaultRetainedBudget = std::size_t(256) * 1024 * 1024;
+
+   /// @brief Alignment in bytes of every buffer, which suits vector loads and cache lines.
+   static constexpr std::size_t BufferAlignment = 64;
+
+   /// @brief Constructs an empty pool.
+   /// @param retainedBudget Maximum number of bytes kept in released buffers.
+   explicit TextureImagePool(std::size_t retainedBudget = DefaultRetainedBudget);
+
+   /// @brief Frees every retained buffer.
+   ~TextureImagePool();
+
+   /// @brief Disables copying because the pool owns its buffers.
+   TextureImagePool(const TextureImagePool&) = delete;
+
+   /// @brief Disables copy assignment because the pool owns its buffers.
+   TextureImagePool& operator=(const TextureImagePool&) = delete;
+
+   /// @brief Returns the pool used by every TextureImage in the process.
+   static TextureImagePool& instance();
+
+   /// @brief Hands out a buffer for a number of pixels.
+   /// @details The contents of the buffer are unspecified.
+   /// @param pixelCount Number of pixels; must be positive.
+   /// @return A buffer aligned to BufferAlignment that must be passed back to release().
+   /// @throws std::bad_alloc if the buffer cannot be allocated.
+   TexturePixel* acquire(std::size_t pixelCount);
+
+   /// @brief Returns a buffer handed out by acquire() for reuse.
+   /// @param pixels Buffer to return; null is ignored.
+   /// @param pixelCount Number of pixels passed to acquire().
+   void release(TexturePixel* pixels, std::size_t pixelCount) noexcept;
+
+   /// @brief Sets the retained budget and frees buffers that no longer fit.
+   /// @param bytes Maximum number of bytes kept in released buffers; zero disables pooling.
+   void setRetainedBudget(std::size_t bytes);
+
+   /// @brief Returns the retained budget in bytes.
+   std::size_t getRetainedBudget() const;
+
+   /// @brief Frees every retained buffer.
+   void trim();
+
+   /// @brief Returns a snapshot of the pool counters.
+   Statistics getStatistics() const;
+
+   /// @brief Resets the event counters while keeping the buffer counts.
+   void resetStatistics();
+
+private:
+   /// @brief Released buffers of one pixel count.
+   struct Bucket {
+      /// @brief Buffers ready for reuse, the most recently released last.
+      std::vector<TexturePixel*> buffers;
+      /// @brief Value of useCounter at the last acquire or release of this pixel count.
+      quint64 lastUse = 0;
+   };
+
+   /// @brief Frees the oldest retained buffers until the retained budget is met, while mutex is
+   /// held.
+   void freeExcess() noexcept;
+
+   /// @brief Allocates an aligned buffer from the heap.
+   static TexturePixel* allocate(std::size_t pixelCount);
+
+   /// @brief Frees a buffer allocated by allocate().
+   static void deallocate(TexturePixel* pixels) noexcept;
+
+   /// @brief Protects every member below.
+   mutable std::mutex mutex;
+   /// @brief Released buffers by pixel count.
+   std::map<std::size_t, Bucket> buckets;
+   /// @brief Maximum number of bytes kept in released buffers.
+   std::size_t retainedBudget;
+   /// @brief Number of acquire and release calls, which orders buckets by recent use.
+   quint64 useCounter = 0;
+   /// @brief Pool counters.
+   Statistics statistics;
+};
+
+#endif  // TEXTUREIMAGEPOOL_H
@@ -9,7 +9,10 @@
 #include "global.h"
 #include "texturerendermanager.h"
 #include "textureimage.h"
+#include "textureimagebudget.h"
+#include "texturerendercache.h"
 #include "textureproject.h"
+#include <QByteArray>
 #include <QColor>
 #include <QDomDocument>
 #include <QDomElement>
@@ -42,6 +45,24 @@ bool operator<(const QSize& lhs, const QSize& rhs) {
    return lhs.height() < rhs.height();
 }
 
+namespace {
+
+/// @brief Cost assumed for a generator that has no timing samples yet.
+constexpr double unmeasuredRenderMilliseconds = 1.0;
+
+/// @brief Estimates how long a generator needs to render an image again.
+/// @param generator The generator that produced the image.
+/// @return The generator's recent average duration in milliseconds.
+double recomputeMilliseconds(const TextureGeneratorPtr& generator) {
+   if (generator.isNull()) {
+      return 0.0;
+   }
+   const TextureGenerator::GenerationTiming timing = generator->getGenerationTiming();
+   return timing.runCount > 0 ? timing.averageMilliseconds : unmeasuredRenderMilliseconds;
+}
+
+}  // namespace
+
 TextureNode::TextureNode(TextureProject* project, const TextureGeneratorPtr& gen, int id) {
    qRegisterMetaType<TextureNodePtr>("TextureNodePtr");
    name = QString("Node %1").arg(id);
@@ -76,10 +97,12 @@ void TextureNode::release() {
          receiverNode->removeSource(id);
       }
    }
+   invalidateImageCache();
    deleted = true;
 }
 
 void TextureNode::loadFromXML(const QDomNode& xmlnode, QMap<int, int> idMappings) {
+   TextureProject::InvalidationBatch batch(*project);
    name = xmlnode.toElement().attribute("name");
    QDomElement pos = xmlnode.namedItem("pos").toElement();
    if (!pos.isNull()) {
@@ -237,6 +260,7 @@ void TextureNode::replaceGeneratorDefinition(const TextureGeneratorPtr& generato
       }
       const TextureNodePtr sourceNode = project->getNode(oldSourceId);
       if (!sourceNode.isNull()) {
+         project->disconnectNodes(oldSourceId, id);
          std::unique_lock receiverLock(sourceNode->receiverMutex);
          sourceNode->receivers.remove(id);
       }
@@ -297,40 +321,26 @@ bool TextureNode::setSourceSlot(const QString& slot, int sourceId) {
    if (oldSourceId != 0 && sources.keys(oldSourceId).length() <= 1) {
       oldNode = project->getNode(oldSourceId);
       if (!oldNode.isNull()) {
+         project->disconnectNodes(oldSourceId, id);
          std::unique_lock receiverLock(oldNode->receiverMutex);
          oldNode->receivers.remove(id);
          removedOldReceiver = true;
       }
    }
    // Can we add a new source node?
-   bool addedReceiver = false;
    if (sourceId != 0) {
-      // Does the node exist?
+      // The project rejects a missing source and an edge that would close a cycle.
       TextureNodePtr sourceNode = project->getNode(sourceId);
-      if (sourceNode.isNull()) {
-         if (removedOldReceiver) {
-            std::unique_lock receiverLock(oldNode->receiverMutex);
-            oldNode->receivers.insert(id);
-         }
-         return false;
-      }
-      // Does adding it cause loops?
-      {
-         std::unique_lock receiverLock(sourceNode->receiverMutex);
-         addedReceiver = !sourceNode->receivers.contains(id);
-         sourceNode->receivers.insert(id);
-      }
-      if (project->findLoops()) {
-         if (addedReceiver) {
-            std::unique_lock receiverLock(sourceNode->receiverMutex);
-            sourceNode->receivers.remove(id);
-         }
+      if (sourceNode.isNull() || !project->connectNodes(sourceId, id)) {
          if (removedOldReceiver) {
+            project->connectNodes(oldSourceId, id);
             std::unique_lock receiverLock(oldNode->receiverMutex);
             oldNode->receivers.insert(id);
          }
          return false;
       }
+      std::unique_lock receiverLock(sourceNode->receiverMutex);
+      sourceNode->receivers.insert(id);
    }
 
    sources[slot] = sourceId;
@@ -368,69 +378,75 @@ void TextureNode::setUpdated() {
 }
 
 void TextureNode::invalidateImageCache() {
+   QMap<QSize, TextureImagePtr> droppedImages;
    {
       std::unique_lock lock(imageMutex);
       ++imageRevision;
-      texturecache.clear();
+      droppedImages.swap(texturecache);
+      cacheKeys.clear();
    }
-}
-
-void TextureNode::propagateImageUpdate() {
-   QSet<int> receiversCopy;
-   {
-      std::shared_lock lock(receiverMutex);
-      receiversCopy = receivers;
-   }
-   QSetIterator<int> receiveriter(receiversCopy);
-   while (receiveriter.hasNext()) {
-      TextureNodePtr receiverNode = project->getNode(receiveriter.next());
-      if (!receiverNode.isNull()) {
-         receiverNode->setUpdated();
-      }
+   TextureImageBudget& budget = project->getImageBudget();
+   for (auto image = droppedImages.cbegin(); image != droppedImages.cend(); ++image) {
+      budget.remove(id, image.key(), image.value().data());
    }
-   emit imageUpdated(id);
 }
 
+void TextureNode::propagateImageUpdate() { project->nodeInvalidated(id); }
+
 TextureImagePtr TextureNode::renderImage(QSize size) {
    for (;;) {
       std::uint64_t renderRevision = 0;
+      TextureImagePtr cachedImage;
       {
          std::shared_lock lock(imageMutex);
-         TextureImagePtr cachedImage = texturecache.value(size);
-         if (!cachedImage.isNull()) {
-            return cachedImage;
-         }
+         cachedImage = texturecache.value(size);
          renderRevision = imageRevision;
       }
+      if (!cachedImage.isNull()) {
+         project->getImageBudget().touch(id, size);
+         return cachedImage;
+      }
 
-      const QMap<QString, int> sourcesCopy = getSources();
+      TextureRenderCache* const renderCache = project->getRenderCache();
+      const QByteArray key = renderCache != nullptr ? cacheKey(size) : QByteArray();
+      TextureImagePtr renderedImage =
+          renderCache != nullptr ? renderCache->find(key) : TextureImagePtr();
+      const bool renderedHere = renderedImage.isNull();
       TextureGeneratorPtr generator;
       TextureNodeSettings settingsCopy;
       {
          std::shared_lock lock(settingsMutex);
          generator = gen;
-         settingsCopy = settings;
+         if (renderedHere) {
+            settingsCopy = settings;
+         }
       }
-
-      QMap<QString, TextureImagePtr> sourceImages;
-      for (const QString& slot : generator->getSourceSlots()) {
-         const int slotSource = sourcesCopy.value(slot);
-         if (slotSource != 0) {
-            TextureNodePtr sourceNode = project->getNode(slotSource);
-            if (!sourceNode.isNull()) {
-               sourceImages.insert(slot, sourceNode->renderImage(size));
+      if (renderedHere) {
+         const QMap<QString, int> sourcesCopy = getSources();
+
+         QMap<QString, TextureImagePtr> sourceImages;
+         for (const QString& slot : generator->getSourceSlots()) {
+            const int slotSource = sourcesCopy.value(slot);
+            if (slotSource != 0) {
+               TextureNodePtr sourceNode = project->getNode(slotSource);
+               if (!sourceNode.isNull()) {
+                  sourceImages.insert(slot, sourceNode->renderImage(size));
+               }
             }
          }
-      }
 
-      for (const TextureGeneratorSetting& setting : generator->getSettings()) {
-         if (!settingsCopy.contains(setting.id)) {
-            settingsCopy.insert(setting.id, setting.defaultvalue);
+         for (const TextureGeneratorSetting& setting : generator->getSettings()) {
+            if (!settingsCopy.contains(setting.id)) {
+               settingsCopy.insert(setting.id, setting.defaultvalue);
+            }
          }
-      }
 
-      TextureImagePtr renderedImage = TextureImage::create(size);
-      generator->generateWithTiming(size, renderedImage->data(), sourceImages, settingsCopy);
+         renderedImage = TextureImage::create(size,
+                                              generator->writesEveryPixel()
+                                                  ? TextureImage::Initialization::Uninitialized
+                                                  : TextureImage::Initialization::Zeroed);
+         generator->generateWithTiming(size, renderedImage->data(), sourceImages, settingsCopy);
+      }
 
       bool imagePublished = false;
       {
@@ -438,16 +454,21 @@ TextureImagePtr TextureNode::renderImage(QSize size) {
          if (renderRevision != imageRevision) {
             continue;
          }
-         TextureImagePtr cachedImage = texturecache.value(size);
-         if (!cachedImage.isNull()) {
-            return cachedImage;
+         cachedImage = texturecache.value(size);
+         if (cachedImage.isNull()) {
+            texturecache.insert(size, renderedImage);
+            imagePublished = true;
          }
-         texturecache.insert(size, renderedImage);
-         imagePublished = true;
       }
-      if (imagePublished) {
-         emit imageAvailable(id, size);
+      if (!imagePublished) {
+         return cachedImage;
       }
+      project->getImageBudget().add(id, size, renderedImage, recomputeMilliseconds(generator));
+      // The unchanged revision shows that the key describes the settings used for the render.
+      if (renderedHere && renderCache != nullptr) {
+         renderCache->insert(key, renderedImage);
+      }
+      emit imageAvailable(id, size);
       return renderedImage;
    }
 }
@@ -460,6 +481,8 @@ bool TextureNode::setGenerator(TextureGeneratorPtr newgenerator) {
    if (oldGenerator == newgenerator) {
       return true;
    }
+   // Disconnecting and reconnecting the slots invalidates downstream nodes once at the end.
+   TextureProject::InvalidationBatch batch(*project);
 
    const QStringList oldSlots =
        oldGenerator.isNull() ? QStringList() : oldGenerator->getSourceSlots();
@@ -531,58 +554,122 @@ QStringList TextureNode::getSourceSlots() const {
 }
 
 TextureImagePtr TextureNode::cachedImage(QSize size) const {
-   std::shared_lock lock(imageMutex);
-   return texturecache.value(size);
+   TextureImagePtr image;
+   {
+      std::shared_lock lock(imageMutex);
+      image = texturecache.value(size);
+   }
+   if (!image.isNull()) {
+      project->getImageBudget().touch(id, size);
+   }
+   return image;
+}
+
+TextureNodeSnapshot TextureNode::createTextureNodeSnapshot(QSize size, bool cacheable) const {
+   const QByteArray key =
+       cacheable && project->getRenderCache() != nullptr ? cacheKey(size) : QByteArray();
+   TextureNodeSnapshot snapshot;
+   {
+      std::shared_lock settingsLock(settingsMutex);
+      std::shared_lock sourceLock(sourceMutex);
+      std::shared_lock imageLock(imageMutex);
+      snapshot = TextureNodeSnapshot{id, imageRevision, gen, settings, sources,
+                                     texturecache.value(size)};
+      // A key computed before a concurrent change no longer describes the captured settings.
+      if (cacheKeys.value(size) == key) {
+         snapshot.cacheKey = key;
+      }
+   }
+   // Renders read cached images as sources, so a snapshot counts as a use.
+   if (!snapshot.cachedImage.isNull()) {
+      project->getImageBudget().touch(id, size);
+   }
+   return snapshot;
 }
 
-TextureNodeSnapshot TextureNode::createTextureNodeSnapshot(QSize size) const {
-   std::shared_lock settingsLock(settingsMutex);
-   std::shared_lock sourceLock(sourceMutex);
-   std::shared_lock imageLock(imageMutex);
-   return TextureNodeSnapshot{id, imageRevision, gen, settings, sources, texturecache.value(size)};
+QByteArray TextureNode::cacheKey(QSize size) const {
+   std::uint64_t keyRevision = 0;
+   {
+      std::shared_lock lock(imageMutex);
+      const auto key = cacheKeys.constFind(size);
+      if (key != cacheKeys.cend()) {
+         return key.value();
+      }
+      keyRevision = imageRevision;
+   }
+
+   TextureGeneratorPtr generator;
+   TextureNodeSettings settingsCopy;
+   {
+      std::shared_lock lock(settingsMutex);
+      generator = gen;
+      settingsCopy = settings;
+   }
+   const QMap<QString, int> sourcesCopy = getSources();
+   QMap<QString, QByteArray> sourceKeys;
+   for (const QString& slot : generator->getSourceSlots()) {
+      const int slotSource = sourcesCopy.value(slot);
+      if (slotSource != 0) {
+         const TextureNodePtr sourceNode = project->getNode(slotSource);
+         if (!sourceNode.isNull()) {
+            sourceKeys.insert(slot, sourceNode->cacheKey(size));
+         }
+      }
+   }
+   const QByteArray key = TextureRenderCache::makeKey(*generator, settingsCopy, size, sourceKeys);
+
+   std::unique_lock lock(imageMutex);
+   if (keyRevision == imageRevision) {
+      cacheKeys.insert(size, key);
+   }
+   return key;
 }
 
 bool TextureNode::publishRenderedImage(QSize size, std::uint64_t revision,
                                        const TextureImagePtr& image) {
    {
       std::unique_lock lock(imageMutex);
-      if (image.isNull() || revision != imageRevision || texturecache.contains(size)) {
+      if (image.isNull() || texturecache.contains(size)) {
+         return false;
+      }
+      if (revision != imageRevision) {
+         lock.unlock();
+         emit frameAvailable(id, size, image);
          return false;
       }
       texturecache.insert(size, image);
    }
+   project->getImageBudget().add(id, size, image, recomputeMilliseconds(getGenerator()));
    emit imageAvailable(id, size);
    return true;
 }
 
-void TextureNode::discardCachedImage(QSize size) {
-   std::unique_lock lock(imageMutex);
-   texturecache.remove(size);
-}
-
-bool TextureNode::findLoop() const {
-   QList<int> empty;
-   return findLoop(empty);
+void TextureNode::publishFrame(QSize size, const TextureImagePtr& image) {
+   if (!image.isNull()) {
+      emit frameAvailable(id, size, image);
+   }
 }
 
-bool TextureNode::findLoop(QList<int> visited) const {
-   if (visited.contains(id)) {
-      return true;
-   }
-   visited.push_back(id);
-   QSet<int> receiversCopy;
+void TextureNode::discardCachedImage(QSize size, const TextureImage* image) {
+   TextureImagePtr droppedImage;
    {
-      std::shared_lock lock(receiverMutex);
-      receiversCopy = receivers;
+      std::unique_lock lock(imageMutex);
+      const auto cached = texturecache.find(size);
+      if (cached == texturecache.end() || (image != nullptr && cached.value().data() != image)) {
+         return;
+      }
+      droppedImage = cached.value();
+      texturecache.erase(cached);
    }
-   QSetIterator<int> receiveriter(receiversCopy);
-   bool hasLoop = false;
+   project->getImageBudget().remove(id, size, droppedImage.data());
+}
+
+bool TextureNode::findLoop() const {
+   QSetIterator<int> receiveriter = getReceivers();
    while (receiveriter.hasNext()) {
-      const TextureNodePtr receiverNode = project->getNode(receiveriter.next());
-      if (!receiverNode.isNull() && receiverNode->findLoop(visited)) {
-         hasLoop = true;
-         break;
+      if (project->reaches(receiveriter.next(), id)) {
+         return true;
       }
    }
-   return hasLoop;
+   return false;
 }
@@ -10,6 +10,7 @@
 #include "base/texturegenerator.h"
 #include "global.h"
 #include "textureimage.h"
+#include <QByteArray>
 #include <QDomDocument>
 #include <QDomElement>
 #include <QDomNode>
@@ -104,7 +105,8 @@ public:
    /// @param sourceId The source node ID, or `0` to disconnect the slot.
    /// @return @c true if the connection change was accepted.
    /// @details The change is rejected if the slot is invalid, the source does not exist, or the
-   /// proposed edge would introduce a cycle in the graph.
+   /// proposed edge would introduce a cycle in the graph. The cycle check is one search of the
+   /// project's topology index from this node towards the source.
    bool setSourceSlot(const QString& slot, int sourceId);
 
    /// @brief Checks whether this node participates in a direct or indirect graph cycle.
@@ -130,6 +132,7 @@ public:
    [[nodiscard]] TextureImagePtr renderImage(QSize size);
 
    /// @brief Returns the cached image for the given size without rendering.
+   /// @details Counts as a use of the image for the project's image memory budget.
    /// @param size The width and height of the cached image.
    /// @return The cached image, or a null pointer if no image is available.
    [[nodiscard]] TextureImagePtr cachedImage(QSize size) const;
@@ -156,15 +159,17 @@ signals:
    /// @brief Emitted when the node position changes.
    void positionUpdated(int id);
 
-   /// @brief Emitted when the node image cache becomes outdated.
-   void imageUpdated(int id);
-
    /// @brief Emitted when the available source slots change.
    void slotsUpdated(int id);
 
    /// @brief Emitted when a rendered image is added to the cache.
    void imageAvailable(int id, QSize size);
 
+   /// @brief Emitted when an image that is not cached is rendered.
+   /// @details The image is of an outdated revision or from the low-resolution pass of a
+   /// progressive render; views may show it until the current image is available.
+   void frameAvailable(int id, QSize size, TextureImagePtr image);
+
    /// @brief Emitted when the generator settings change.
    void settingsUpdated(int id);
 
@@ -194,18 +199,15 @@ private:
    /// @return The serialized node element.
    QDomElement saveAsXML(QDomDocument targetdoc);
 
-   /// @brief Searches downstream receiver nodes for a cycle.
-   /// @param visited The node IDs on the current traversal path.
-   /// @return @c true if the traversal reaches a previously visited node.
-   bool findLoop(QList<int> visited) const;
-
    /// @brief Invalidates cached images and advances the render revision.
    /// @details Call this function while the lock protecting a related state mutation remains held,
    /// so renderers cannot observe new state with an old revision.
    void invalidateImageCache();
 
-   /// @brief Invalidates downstream nodes and notifies observers after local state is consistent.
-   /// @details Call this function without holding this node's state or cache locks.
+   /// @brief Has the project invalidate downstream nodes and notify observers after local state is
+   /// consistent.
+   /// @details Call this function without holding this node's state or cache locks. Inside a
+   /// TextureProject::InvalidationBatch, the downstream nodes are invalidated when it closes.
    void propagateImageUpdate();
 
    /// @brief Disconnects every source slot that references a node ID.
@@ -220,19 +222,38 @@ private:
 
    /// @brief Copies the node state needed for background rendering.
    /// @param size The width and height of the image to render.
+   /// @param cacheable Whether the render may read from and add to the shared render cache.
    /// @return A synchronized copy of the node's render state and any matching cached image.
-   TextureNodeSnapshot createTextureNodeSnapshot(QSize size) const;
+   TextureNodeSnapshot createTextureNodeSnapshot(QSize size, bool cacheable = true) const;
 
    /// @brief Publishes a rendered image if its captured revision is still current.
+   /// @details An image of an outdated revision is not cached but offered to views through
+   /// frameAvailable(), so continuous edits still show intermediate results.
    /// @param size The rendered image dimensions.
    /// @param revision The node revision captured before rendering.
    /// @param image The completed image.
    /// @return @c true if the image was added to the cache.
    bool publishRenderedImage(QSize size, std::uint64_t revision, const TextureImagePtr& image);
 
+   /// @brief Offers an image that is not cached to the views through frameAvailable().
+   /// @details Used for the low-resolution pass of progressive renders, whose images are shown
+   /// scaled up until the image at the requested size is available.
+   /// @param size The rendered image dimensions.
+   /// @param image The completed image.
+   void publishFrame(QSize size, const TextureImagePtr& image);
+
+   /// @brief Returns the content key of this node's image, computing it from its sources if needed.
+   /// @details Keys are remembered per size until the next invalidation of this node.
+   /// @param size The width and height of the image.
+   /// @return The key used with TextureRenderCache, or an empty array if the image is not
+   /// cacheable.
+   QByteArray cacheKey(QSize size) const;
+
    /// @brief Removes the cached image for the specified dimensions.
    /// @param size The dimensions to remove from the cache.
-   void discardCachedImage(QSize size);
+   /// @param image The image to remove, or null to remove whichever image is cached. A different
+   /// cached image is kept.
+   void discardCachedImage(QSize size, const TextureImage* image = nullptr);
 
    /// @brief Stable ID assigned by the project.
    int id;
@@ -250,8 +271,10 @@ private:
    TextureGeneratorPtr gen;
    /// @brief Project that owns this node.
    TextureProject* project;
-   /// @brief Generated images stored by image dimensions.
+   /// @brief Generated images stored by image dimensions and tracked by the project's budget.
    QMap<QSize, TextureImagePtr> texturecache;
+   /// @brief Content keys of the current revision stored by image dimensions.
+   mutable QMap<QSize, QByteArray> cacheKeys;
    /// @brief Version increased whenever the rendered output becomes outdated.
    std::uint64_t imageRevision = 0;
    /// @brief Whether all graph connections have been released before deletion.
@@ -260,7 +283,7 @@ private:
    mutable std::shared_mutex sourceMutex;
    /// @brief Protects the receiver set.
    mutable std::shared_mutex receiverMutex;
-   /// @brief Protects cached images and the image revision.
+   /// @brief Protects cached images, content keys, and the image revision.
    mutable std::shared_mutex imageMutex;
    /// @brief Protects the generator and its setting values.
    mutable std::shared_mutex settingsMutex;
@@ -0,0 +1,340 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturepixelkernels.h"
+#include "base/texturepixelkernels_simd.h"
+#include "global.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using TexturePixelKernels::ChannelSource;
+using TexturePixelKernels::InstructionSet;
+using TexturePixelKernelsSimd::Table;
+
+static_assert(TexturePixelKernels::ConvolutionShift == TexturePixelKernelsSimd::ConvolutionShift,
+              "The scalar and vector convolutions must use the same fixed-point weights");
+
+/// @brief Reports whether the processor and operating system support AVX2 instructions.
+bool processorSupportsAvx2() {
+#if defined(_MSC_VER) && defined(_M_X64)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7) {
+      return false;
+   }
+   __cpuid(info, 1);
+   const bool osSavesVectorState = (info[2] & (1 << 27)) != 0;
+   const bool avx = (info[2] & (1 << 28)) != 0;
+   if (!osSavesVectorState || !avx || (_xgetbv(0) & 6) != 6) {
+      return false;
+   }
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2") != 0;
+#else
+   return false;
+#endif
+}
+
+/// @brief Returns the vector kernels of an instruction set, or null for the scalar kernels.
+const Table* tableFor(const InstructionSet instructionSet) {
+   switch (instructionSet) {
+      case InstructionSet::AVX2:
+         return processorSupportsAvx2() ? TexturePixelKernelsSimd::avx2Table() : nullptr;
+      case InstructionSet::SSE2:
+         return TexturePixelKernelsSimd::sse2Table();
+      case InstructionSet::Scalar:
+         break;
+   }
+   return nullptr;
+}
+
+/// @brief Holds the selected instruction set and its kernels.
+struct Dispatch {
+   std::atomic<InstructionSet> instructionSet{TexturePixelKernels::bestInstructionSet()};
+   std::atomic<const Table*> table{tableFor(instructionSet.load())};
+};
+
+Dispatch& dispatch() {
+   static Dispatch instance;
+   return instance;
+}
+
+/// @brief Returns the kernels used by the next call, or null for the scalar kernels.
+const Table* vectorTable() { return dispatch().table.load(std::memory_order_relaxed); }
+
+/// @brief Packs a pixel in memory order, as vector lanes read it.
+std::uint32_t packed(const TexturePixel pixel) {
+   std::uint32_t value = 0;
+   std::memcpy(&value, &pixel, sizeof(value));
+   return value;
+}
+
+/// @brief Divides a value of at most 255 * 255 by 255, rounding to the nearest value.
+constexpr quint8 divideBy255(const unsigned value) {
+   const unsigned rounded = value + 128;
+   return static_cast<quint8>((rounded + (rounded >> 8)) >> 8);
+}
+
+/// @brief Returns one channel of a pixel by its index in memory order.
+quint8 channelOf(const TexturePixel& pixel, const int channel) {
+   switch (channel) {
+      case 0:
+         return pixel.r;
+      case 1:
+         return pixel.g;
+      case 2:
+         return pixel.b;
+      default:
+         return pixel.a;
+   }
+}
+
+}  // namespace
+
+bool TexturePixelKernels::isSupported(const InstructionSet instructionSet) {
+   return instructionSet == InstructionSet::Scalar || tableFor(instructionSet) != nullptr;
+}
+
+TexturePixelKernels::InstructionSet TexturePixelKernels::bestInstructionSet() {
+   if (isSupported(InstructionSet::AVX2)) {
+      return InstructionSet::AVX2;
+   }
+   if (isSupported(InstructionSet::SSE2)) {
+      return InstructionSet::SSE2;
+   }
+   return InstructionSet::Scalar;
+}
+
+TexturePixelKernels::InstructionSet TexturePixelKernels::activeInstructionSet() {
+   return dispatch().instructionSet.load();
+}
+
+void TexturePixelKernels::setActiveInstructionSet(InstructionSet instructionSet) {
+   if (instructionSet == InstructionSet::AVX2 && !isSupported(instructionSet)) {
+      instructionSet = InstructionSet::SSE2;
+   }
+   if (instructionSet == InstructionSet::SSE2 && !isSupported(instructionSet)) {
+      instructionSet = InstructionSet::Scalar;
+   }
+   dispatch().instructionSet.store(instructionSet);
+   dispatch().table.store(tableFor(instructionSet));
+}
+
+const char* TexturePixelKernels::instructionSetName(const InstructionSet instructionSet) {
+   switch (instructionSet) {
+      case InstructionSet::AVX2:
+         return "avx2";
+      case InstructionSet::SSE2:
+         return "sse2";
+      case InstructionSet::Scalar:
+         break;
+   }
+   return "scalar";
+}
+
+void TexturePixelKernels::addSaturated(TexturePixel* const destination,
+                                       const TexturePixel* const source, const std::size_t count) {
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->addSaturated(destination, source, count) : 0; i < count;
+        ++i) {
+      destination[i] += source[i];
+   }
+}
+
+void TexturePixelKernels::offsetSaturated(TexturePixel* const destination,
+                                          const TexturePixel* const source,
+                                          const std::size_t count, const TexturePixel increase,
+                                          const TexturePixel decrease) {
+   const Table* vector = vectorTable();
+   std::size_t i = vector ? vector->offsetSaturated(destination, source, count, packed(increase),
+                                                    packed(decrease))
+                          : 0;
+   const auto offset = [](const quint8 value, const quint8 up, const quint8 down) {
+      const int raised = qMin(value + up, 255);
+      return static_cast<quint8>(qMax(raised - down, 0));
+   };
+   for (; i < count; ++i) {
+      const TexturePixel pixel = source[i];
+      destination[i] = TexturePixel(offset(pixel.r, increase.r, decrease.r),
+                                    offset(pixel.g, increase.g, decrease.g),
+                                    offset(pixel.b, increase.b, decrease.b),
+                                    offset(pixel.a, increase.a, decrease.a));
+   }
+}
+
+void TexturePixelKernels::multiply(TexturePixel* const destination,
+                                   const TexturePixel* const source, const std::size_t count) {
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->multiply(destination, source, count) : 0; i < count;
+        ++i) {
+      TexturePixel& pixel = destination[i];
+      const TexturePixel& factor = source[i];
+      pixel = TexturePixel(divideBy255(pixel.r * factor.r), divideBy255(pixel.g * factor.g),
+                           divideBy255(pixel.b * factor.b), divideBy255(pixel.a * factor.a));
+   }
+}
+
+void TexturePixelKernels::lerp(TexturePixel* const destination, const TexturePixel* const first,
+                               const TexturePixel* const second, const std::size_t count,
+                               const quint8 weight) {
+   const Table* vector = vectorTable();
+   std::size_t i = vector ? vector->lerp(destination, first, second, count, weight) : 0;
+   const unsigned firstWeight = 255U - weight;
+   for (; i < count; ++i) {
+      const TexturePixel from = first[i];
+      const TexturePixel to = second[i];
+      destination[i] = TexturePixel(divideBy255(from.r * firstWeight + to.r * weight),
+                                    divideBy255(from.g * firstWeight + to.g * weight),
+                                    divideBy255(from.b * firstWeight + to.b * weight),
+                                    divideBy255(from.a * firstWeight + to.a * weight));
+   }
+}
+
+void TexturePixelKernels::blendOver(TexturePixel* const destination,
+                                    const TexturePixel* const source, const std::size_t count) {
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->blendOver(destination, source, count) : 0; i < count;
+        ++i) {
+      TexturePixel& lower = destination[i];
+      const TexturePixel upper = source[i];
+      const unsigned lowerWeight = 255U - upper.a;
+      lower = TexturePixel(divideBy255(lower.r * lowerWeight + upper.r * upper.a),
+                           divideBy255(lower.g * lowerWeight + upper.g * upper.a),
+                           divideBy255(lower.b * lowerWeight + upper.b * upper.a),
+                           divideBy255(lower.a * lowerWeight + 255U * upper.a));
+   }
+}
+
+void TexturePixelKernels::invert(TexturePixel* const destination, const TexturePixel* const source,
+                                 const std::size_t count, const TexturePixel mask) {
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->invert(destination, source, count, packed(mask)) : 0;
+        i < count; ++i) {
+      const TexturePixel pixel = source[i];
+      destination[i] = TexturePixel(
+          static_cast<quint8>(pixel.r ^ mask.r), static_cast<quint8>(pixel.g ^ mask.g),
+          static_cast<quint8>(pixel.b ^ mask.b), static_cast<quint8>(pixel.a ^ mask.a));
+   }
+}
+
+void TexturePixelKernels::swizzle(TexturePixel* const destination, const TexturePixel* const first,
+                                  const TexturePixel* const second, const std::size_t count,
+                                  const ChannelSelection& selection) {
+   // Channels of a missing source read as zero.
+   TexturePixelKernelsSimd::Selection prepared{};
+   quint8 constantChannels[4] = {0, 0, 0, 0};
+   int sourceChannels[4] = {0, 0, 0, 0};
+   for (int channel = 0; channel < 4; ++channel) {
+      const ChannelSource channelSource = selection[static_cast<std::size_t>(channel)];
+      const auto index = static_cast<int>(channelSource);
+      const TexturePixel* source = nullptr;
+      if (channelSource >= ChannelSource::SecondRed) {
+         source = second;
+         sourceChannels[channel] = index - static_cast<int>(ChannelSource::SecondRed);
+      } else if (channelSource >= ChannelSource::FirstRed) {
+         source = first;
+         sourceChannels[channel] = index - static_cast<int>(ChannelSource::FirstRed);
+      } else if (channelSource == ChannelSource::Full) {
+         constantChannels[channel] = 255;
+      }
+      prepared.sources[channel] = source;
+      prepared.shifts[channel] = (sourceChannels[channel] - channel) * 8;
+   }
+   const TexturePixel constant(constantChannels[0], constantChannels[1], constantChannels[2],
+                               constantChannels[3]);
+   prepared.constant = packed(constant);
+
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->swizzle(destination, count, prepared) : 0; i < count;
+        ++i) {
+      quint8 channels[4];
+      for (int channel = 0; channel < 4; ++channel) {
+         const auto* source = static_cast<const TexturePixel*>(prepared.sources[channel]);
+         channels[channel] =
+             source ? channelOf(source[i], sourceChannels[channel]) : constantChannels[channel];
+      }
+      destination[i] = TexturePixel(channels[0], channels[1], channels[2], channels[3]);
+   }
+}
+
+void TexturePixelKernels::applyLookup(TexturePixel* const destination,
+                                      const TexturePixel* const source, const std::size_t count,
+                                      const ChannelLookupTables& tables) {
+   // Neither SSE2 nor AVX2 has a byte gather, and AVX2's 32-bit gather is slower than four
+   // scalar loads from tables that stay in the L1 cache, so every instruction set runs this loop.
+   for (std::size_t i = 0; i < count; ++i) {
+      const TexturePixel pixel = source[i];
+      destination[i] = TexturePixel(tables.red[pixel.r], tables.green[pixel.g],
+                                    tables.blue[pixel.b], tables.alpha[pixel.a]);
+   }
+}
+
+void TexturePixelKernels::luminance(TexturePixel* const destination,
+                                    const TexturePixel* const source, const std::size_t count) {
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->luminance(destination, source, count) : 0; i < count;
+        ++i) {
+      const TexturePixel pixel = source[i];
+      // Equal to truncating intensity() * 255 for every channel combination.
+      const auto grey = static_cast<quint8>((pixel.r + pixel.g + pixel.b) / 3);
+      destination[i] = TexturePixel(grey, grey, grey, pixel.a);
+   }
+}
+
+void TexturePixelKernels::cutAlpha(TexturePixel* const destination,
+                                   const TexturePixel* const mask, const std::size_t count,
+                                   int factor) {
+   // Alpha never exceeds 255, so every factor above 256 leaves the same pixels as 256.
+   factor = qMin(factor, 256);
+   const Table* vector = vectorTable();
+   for (std::size_t i = vector ? vector->cutAlpha(destination, mask, count, factor) : 0;
+        i < count; ++i) {
+      TexturePixel& pixel = destination[i];
+      if (pixel.a > factor * mask[i].a) {
+         pixel.a = static_cast<quint8>(pixel.a - mask[i].a);
+      } else {
+         pixel.a = 0;
+      }
+   }
+}
+
+void TexturePixelKernels::convolve(TexturePixel* const destination,
+                                   const TexturePixel* const source, const std::size_t count,
+                                   const qint16* const weights, const int tapCount) {
+   const Table* vector = vectorTable();
+   constexpr unsigned rounding = 1U << (ConvolutionShift - 1);
+   for (std::size_t i = vector ? vector->convolve(destination, source, count, weights, tapCount)
+                               : 0;
+        i < count; ++i) {
+      const TexturePixel* window = source + i;
+      unsigned red = rounding;
+      unsigned green = rounding;
+      unsigned blue = rounding;
+      unsigned alpha = rounding;
+      for (int tap = 0; tap < tapCount; ++tap) {
+         const auto weight = static_cast<unsigned>(weights[tap]);
+         red += weight * window[tap].r;
+         green += weight * window[tap].g;
+         blue += weight * window[tap].b;
+         alpha += weight * window[tap].a;
+      }
+      destination[i] = TexturePixel(static_cast<quint8>(red >> ConvolutionShift),
+                                    static_cast<quint8>(green >> ConvolutionShift),
+                                    static_cast<quint8>(blue >> ConvolutionShift),
+                                    static_cast<quint8>(alpha >> ConvolutionShift));
+   }
+}
@@ -0,0 +1,186 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREPIXELKERNELS_H
+#define TEXTUREPIXELKERNELS_H
+
+#include "global.h"
+#include <QtGlobal>
+#include <array>
+#include <cstddef>
+
+/// @brief Channel operations over contiguous spans of texture pixels.
+/// @details Every kernel has a scalar implementation and, on x86-64, SSE2 and AVX2
+/// implementations that produce identical bytes. The widest instruction set supported by the
+/// processor is selected on first use. Unless stated otherwise, a destination span may be the
+/// same as a source span but must not partially overlap it.
+namespace TexturePixelKernels {
+
+/// @brief Instruction sets the kernels can run on.
+enum class InstructionSet {
+   /// @brief Portable C++ processing one pixel at a time.
+   Scalar,
+   /// @brief 128-bit vectors processing four pixels at a time.
+   SSE2,
+   /// @brief 256-bit vectors processing eight pixels at a time.
+   AVX2
+};
+
+/// @brief Selects the value written to one output channel by swizzle().
+enum class ChannelSource : quint8 {
+   /// @brief Writes 0.
+   Zero,
+   /// @brief Writes 255.
+   Full,
+   /// @brief Copies the first source's red channel.
+   FirstRed,
+   /// @brief Copies the first source's green channel.
+   FirstGreen,
+   /// @brief Copies the first source's blue channel.
+   FirstBlue,
+   /// @brief Copies the first source's alpha channel.
+   FirstAlpha,
+   /// @brief Copies the second source's red channel.
+   SecondRed,
+   /// @brief Copies the second source's green channel.
+   SecondGreen,
+   /// @brief Copies the second source's blue channel.
+   SecondBlue,
+   /// @brief Copies the second source's alpha channel.
+   SecondAlpha
+};
+
+/// @brief Number of fraction bits in the fixed-point weights passed to convolve().
+constexpr int ConvolutionShift = 14;
+
+/// @brief Output channel sources for red, green, blue and alpha, in that order.
+using ChannelSelection = std::array<ChannelSource, 4>;
+
+/// @brief One 256-entry lookup table per channel, indexed by the input channel value.
+struct ChannelLookupTables {
+   /// @brief Replacement values for the red channel.
+   std::array<quint8, 256> red{};
+   /// @brief Replacement values for the green channel.
+   std::array<quint8, 256> green{};
+   /// @brief Replacement values for the blue channel.
+   std::array<quint8, 256> blue{};
+   /// @brief Replacement values for the alpha channel.
+   std::array<quint8, 256> alpha{};
+};
+
+/// @brief Reports whether the processor and build support an instruction set.
+/// @param instructionSet Instruction set to test.
+/// @return @c true when kernels can run on the instruction set.
+bool isSupported(InstructionSet instructionSet);
+
+/// @brief Returns the widest instruction set supported by the processor and build.
+InstructionSet bestInstructionSet();
+
+/// @brief Returns the instruction set used by the kernels.
+InstructionSet activeInstructionSet();
+
+/// @brief Selects the instruction set used by the kernels, for tests and benchmarks.
+/// @param instructionSet Instruction set to use; unsupported sets fall back to the best supported
+/// narrower one.
+void setActiveInstructionSet(InstructionSet instructionSet);
+
+/// @brief Returns a short name such as "avx2" for logs and benchmark output.
+/// @param instructionSet Instruction set to name.
+const char* instructionSetName(InstructionSet instructionSet);
+
+/// @brief Adds source channels to destination channels with saturation at 255.
+/// @param destination Pixels to add to.
+/// @param source Pixels to add.
+/// @param count Number of pixels.
+void addSaturated(TexturePixel* destination, const TexturePixel* source, std::size_t count);
+
+/// @brief Raises and then lowers every channel by constant amounts, saturating at 0 and 255.
+/// @param destination Pixels receiving the result; may be @p source.
+/// @param source Pixels to adjust.
+/// @param count Number of pixels.
+/// @param increase Amount added to each channel.
+/// @param decrease Amount subtracted from each channel after the addition.
+void offsetSaturated(TexturePixel* destination, const TexturePixel* source, std::size_t count,
+                     TexturePixel increase, TexturePixel decrease);
+
+/// @brief Multiplies channels as fractions of 255, rounding to the nearest value.
+/// @param destination Pixels to multiply.
+/// @param source Pixels to multiply by.
+/// @param count Number of pixels.
+void multiply(TexturePixel* destination, const TexturePixel* source, std::size_t count);
+
+/// @brief Interpolates every channel between two spans, rounding to the nearest value.
+/// @param destination Pixels receiving the result.
+/// @param first Pixels returned for weight 0.
+/// @param second Pixels returned for weight 255.
+/// @param count Number of pixels.
+/// @param weight Share of the second span from 0 to 255.
+void lerp(TexturePixel* destination, const TexturePixel* first, const TexturePixel* second,
+          std::size_t count, quint8 weight);
+
+/// @brief Composites source pixels over destination pixels using the source alpha.
+/// @details Colours are interpolated by source alpha and alpha becomes
+/// `sourceAlpha + destinationAlpha * (255 - sourceAlpha) / 255`, rounded to the nearest value.
+/// @param destination Pixels composited onto.
+/// @param source Pixels placed on top.
+/// @param count Number of pixels.
+void blendOver(TexturePixel* destination, const TexturePixel* source, std::size_t count);
+
+/// @brief Inverts the channels selected by a mask.
+/// @param destination Pixels receiving the result.
+/// @param source Pixels to invert.
+/// @param count Number of pixels.
+/// @param mask 255 in each channel to invert and 0 in each channel to keep.
+void invert(TexturePixel* destination, const TexturePixel* source, std::size_t count,
+            TexturePixel mask);
+
+/// @brief Builds pixels from the channels of up to two sources and constant values.
+/// @param destination Pixels receiving the result.
+/// @param first First source; channels of a null source read as 0.
+/// @param second Second source; channels of a null source read as 0.
+/// @param count Number of pixels.
+/// @param selection Source of each output channel.
+void swizzle(TexturePixel* destination, const TexturePixel* first, const TexturePixel* second,
+             std::size_t count, const ChannelSelection& selection);
+
+/// @brief Replaces every channel with the entry of its lookup table.
+/// @param destination Pixels receiving the result; may be @p source.
+/// @param source Pixels to look up.
+/// @param count Number of pixels.
+/// @param tables Lookup table of each channel.
+void applyLookup(TexturePixel* destination, const TexturePixel* source, std::size_t count,
+                 const ChannelLookupTables& tables);
+
+/// @brief Replaces colour channels with the truncated mean of red, green and blue.
+/// @details Matches `static_cast<quint8>(TexturePixel::intensity() * 255)` and keeps alpha.
+/// @param destination Pixels receiving the result.
+/// @param source Pixels to convert.
+/// @param count Number of pixels.
+void luminance(TexturePixel* destination, const TexturePixel* source, std::size_t count);
+
+/// @brief Cuts a mask's alpha out of destination alpha, as the Cutout generator does.
+/// @details Alpha becomes `alpha - maskAlpha` where `alpha > factor * maskAlpha`, and 0 elsewhere.
+/// @param destination Pixels whose alpha is reduced.
+/// @param mask Pixels whose alpha is removed.
+/// @param count Number of pixels.
+/// @param factor Multiplier of the mask alpha in the threshold test.
+void cutAlpha(TexturePixel* destination, const TexturePixel* mask, std::size_t count, int factor);
+
+/// @brief Convolves a span with a one-dimensional kernel of fixed-point weights.
+/// @details Every channel of `destination[i]` becomes the sum of `weights[k] * source[i + k]`
+/// over all taps, divided by `1 << ConvolutionShift` and rounded to the nearest value. The
+/// weights must not be negative and must sum to at most `1 << ConvolutionShift`. The destination
+/// must not overlap the source.
+/// @param destination Pixels receiving the result.
+/// @param source Pixels to convolve; `count + tapCount - 1` pixels are read.
+/// @param count Number of pixels written.
+/// @param weights Weight of each tap.
+/// @param tapCount Number of weights.
+void convolve(TexturePixel* destination, const TexturePixel* source, std::size_t count,
+              const qint16* weights, int tapCount);
+
+}  // namespace TexturePixelKernels
+
+#endif  // TEXTUREPIXELKERNELS_H
@@ -0,0 +1,93 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturepixelkernels_simd.h"
+#include <cstddef>
+#include <cstdint>
+
+// CMake compiles this file with AVX2 code generation on x86-64. The kernels are only called
+// after the processor has reported AVX2 support.
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+namespace {
+
+/// @brief AVX2 operations used by the shared kernel templates.
+struct Avx2 {
+   using Vector = __m256i;
+   static constexpr std::size_t Pixels = 8;
+
+   static Vector load(const void* pixels) {
+      return _mm256_loadu_si256(static_cast<const __m256i*>(pixels));
+   }
+   static void store(void* pixels, const Vector value) {
+      _mm256_storeu_si256(static_cast<__m256i*>(pixels), value);
+   }
+   static Vector zero() { return _mm256_setzero_si256(); }
+   static Vector set16(const int value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+   static Vector set32(const std::uint32_t value) {
+      return _mm256_set1_epi32(static_cast<int>(value));
+   }
+   static Vector alphaLanes16() { return _mm256_set1_epi64x(0x00FF000000000000LL); }
+   static Vector bitAnd(const Vector a, const Vector b) { return _mm256_and_si256(a, b); }
+   static Vector bitOr(const Vector a, const Vector b) { return _mm256_or_si256(a, b); }
+   static Vector bitXor(const Vector a, const Vector b) { return _mm256_xor_si256(a, b); }
+   static Vector addSaturated8(const Vector a, const Vector b) { return _mm256_adds_epu8(a, b); }
+   static Vector subtractSaturated8(const Vector a, const Vector b) {
+      return _mm256_subs_epu8(a, b);
+   }
+   static Vector add16(const Vector a, const Vector b) { return _mm256_add_epi16(a, b); }
+   static Vector subtract16(const Vector a, const Vector b) { return _mm256_sub_epi16(a, b); }
+   static Vector multiplyLow16(const Vector a, const Vector b) { return _mm256_mullo_epi16(a, b); }
+   static Vector multiplyHighUnsigned16(const Vector a, const Vector b) {
+      return _mm256_mulhi_epu16(a, b);
+   }
+   template <int Bits>
+   static Vector shiftRight16(const Vector value) {
+      return _mm256_srli_epi16(value, Bits);
+   }
+   static Vector multiplyAddPairs16(const Vector a, const Vector b) {
+      return _mm256_madd_epi16(a, b);
+   }
+   static Vector add32(const Vector a, const Vector b) { return _mm256_add_epi32(a, b); }
+   static Vector subtract32(const Vector a, const Vector b) { return _mm256_sub_epi32(a, b); }
+   static Vector greaterThan32(const Vector a, const Vector b) { return _mm256_cmpgt_epi32(a, b); }
+   template <int Bits>
+   static Vector shiftRight32(const Vector value) {
+      return _mm256_srli_epi32(value, Bits);
+   }
+   template <int Bits>
+   static Vector shiftLeft32(const Vector value) {
+      return _mm256_slli_epi32(value, Bits);
+   }
+   static Vector shiftRight32(const Vector value, const int bits) {
+      return _mm256_srl_epi32(value, _mm_cvtsi32_si128(bits));
+   }
+   static Vector shiftLeft32(const Vector value, const int bits) {
+      return _mm256_sll_epi32(value, _mm_cvtsi32_si128(bits));
+   }
+   static Vector unpackLow8(const Vector a, const Vector b) { return _mm256_unpacklo_epi8(a, b); }
+   static Vector unpackHigh8(const Vector a, const Vector b) { return _mm256_unpackhi_epi8(a, b); }
+   static Vector packSigned32(const Vector a, const Vector b) { return _mm256_packs_epi32(a, b); }
+   static Vector packUnsigned16(const Vector a, const Vector b) {
+      return _mm256_packus_epi16(a, b);
+   }
+   static Vector broadcastAlpha16(const Vector value) {
+      return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(value, 0xFF), 0xFF);
+   }
+};
+
+const TexturePixelKernelsSimd::Table table = TexturePixelKernelsSimd::makeTable<Avx2>();
+
+}  // namespace
+
+const TexturePixelKernelsSimd::Table* TexturePixelKernelsSimd::avx2Table() { return &table; }
+
+#else
+
+const TexturePixelKernelsSimd::Table* TexturePixelKernelsSimd::avx2Table() { return nullptr; }
+
+#endif
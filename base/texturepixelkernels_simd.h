@@ -0,0 +1,305 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTUREPIXELKERNELS_SIMD_H
+#define TEXTUREPIXELKERNELS_SIMD_H
+
+// Shared by the translation units compiled for each vector instruction set. Only fundamental
+// types and intrinsics may be used here: an inline library function instantiated in a unit
+// compiled with -mavx2 could be merged by the linker into code that runs on older processors.
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Vector implementations of the TexturePixelKernels operations.
+/// @details Every function processes the longest prefix of whole vectors and returns its length
+/// in pixels; the caller finishes the remaining pixels with the scalar implementation.
+namespace TexturePixelKernelsSimd {
+
+/// @brief Number of fraction bits in convolution weights, as TexturePixelKernels::ConvolutionShift.
+constexpr int ConvolutionShift = 14;
+
+/// @brief Output channel sources prepared for shifting whole pixels.
+struct Selection {
+   /// @brief Source of each output channel, or null for the constant value.
+   const void* sources[4];
+   /// @brief Right shift in bits moving the source channel into place; negative shifts left.
+   int shifts[4];
+   /// @brief Packed pixel holding the constant channels and zero elsewhere.
+   std::uint32_t constant;
+};
+
+/// @brief Kernels compiled for one instruction set.
+struct Table {
+   /// @brief Implements TexturePixelKernels::addSaturated().
+   std::size_t (*addSaturated)(void* destination, const void* source, std::size_t count);
+   /// @brief Implements TexturePixelKernels::offsetSaturated() with packed offsets.
+   std::size_t (*offsetSaturated)(void* destination, const void* source, std::size_t count,
+                                  std::uint32_t increase, std::uint32_t decrease);
+   /// @brief Implements TexturePixelKernels::multiply().
+   std::size_t (*multiply)(void* destination, const void* source, std::size_t count);
+   /// @brief Implements TexturePixelKernels::lerp().
+   std::size_t (*lerp)(void* destination, const void* first, const void* second,
+                       std::size_t count, int weight);
+   /// @brief Implements TexturePixelKernels::blendOver().
+   std::size_t (*blendOver)(void* destination, const void* source, std::size_t count);
+   /// @brief Implements TexturePixelKernels::invert() with a packed mask.
+   std::size_t (*invert)(void* destination, const void* source, std::size_t count,
+                         std::uint32_t mask);
+   /// @brief Implements TexturePixelKernels::swizzle() with a prepared selection.
+   std::size_t (*swizzle)(void* destination, std::size_t count, const Selection& selection);
+   /// @brief Implements TexturePixelKernels::luminance().
+   std::size_t (*luminance)(void* destination, const void* source, std::size_t count);
+   /// @brief Implements TexturePixelKernels::cutAlpha() for factors from 0 to 256.
+   std::size_t (*cutAlpha)(void* destination, const void* mask, std::size_t count, int factor);
+   /// @brief Implements TexturePixelKernels::convolve().
+   std::size_t (*convolve)(void* destination, const void* source, std::size_t count,
+                           const std::int16_t* weights, int tapCount);
+};
+
+/// @brief Returns the SSE2 kernels, or null when the build does not target SSE2.
+const Table* sse2Table();
+
+/// @brief Returns the AVX2 kernels, or null when the build cannot compile AVX2.
+const Table* avx2Table();
+
+/// @brief Returns the address of a pixel in a span of packed pixels.
+static inline unsigned char* pixelAt(void* pixels, const std::size_t index) {
+   return static_cast<unsigned char*>(pixels) + index * 4;
+}
+
+/// @brief Returns the address of a pixel in a read-only span of packed pixels.
+static inline const unsigned char* pixelAt(const void* pixels, const std::size_t index) {
+   return static_cast<const unsigned char*>(pixels) + index * 4;
+}
+
+/// @brief Divides 16-bit lanes holding at most 255 * 255 by 255, rounding to the nearest value.
+template <class Isa>
+typename Isa::Vector divideBy255(typename Isa::Vector value) {
+   value = Isa::add16(value, Isa::set16(128));
+   return Isa::template shiftRight16<8>(Isa::add16(value, Isa::template shiftRight16<8>(value)));
+}
+
+template <class Isa>
+std::size_t addSaturated(void* destination, const void* source, const std::size_t count) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      Isa::store(pixelAt(destination, i),
+                 Isa::addSaturated8(Isa::load(pixelAt(destination, i)),
+                                    Isa::load(pixelAt(source, i))));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t offsetSaturated(void* destination, const void* source, const std::size_t count,
+                            const std::uint32_t increase, const std::uint32_t decrease) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector increases = Isa::set32(increase);
+   const typename Isa::Vector decreases = Isa::set32(decrease);
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      const typename Isa::Vector raised =
+          Isa::addSaturated8(Isa::load(pixelAt(source, i)), increases);
+      Isa::store(pixelAt(destination, i), Isa::subtractSaturated8(raised, decreases));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t multiply(void* destination, const void* source, const std::size_t count) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector zero = Isa::zero();
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      const typename Isa::Vector lower = Isa::load(pixelAt(destination, i));
+      const typename Isa::Vector upper = Isa::load(pixelAt(source, i));
+      const typename Isa::Vector low = divideBy255<Isa>(
+          Isa::multiplyLow16(Isa::unpackLow8(lower, zero), Isa::unpackLow8(upper, zero)));
+      const typename Isa::Vector high = divideBy255<Isa>(
+          Isa::multiplyLow16(Isa::unpackHigh8(lower, zero), Isa::unpackHigh8(upper, zero)));
+      Isa::store(pixelAt(destination, i), Isa::packUnsigned16(low, high));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t lerp(void* destination, const void* first, const void* second,
+                 const std::size_t count, const int weight) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector zero = Isa::zero();
+   const typename Isa::Vector secondWeight = Isa::set16(weight);
+   const typename Isa::Vector firstWeight = Isa::set16(255 - weight);
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      const typename Isa::Vector from = Isa::load(pixelAt(first, i));
+      const typename Isa::Vector to = Isa::load(pixelAt(second, i));
+      const typename Isa::Vector low = divideBy255<Isa>(
+          Isa::add16(Isa::multiplyLow16(Isa::unpackLow8(from, zero), firstWeight),
+                     Isa::multiplyLow16(Isa::unpackLow8(to, zero), secondWeight)));
+      const typename Isa::Vector high = divideBy255<Isa>(
+          Isa::add16(Isa::multiplyLow16(Isa::unpackHigh8(from, zero), firstWeight),
+                     Isa::multiplyLow16(Isa::unpackHigh8(to, zero), secondWeight)));
+      Isa::store(pixelAt(destination, i), Isa::packUnsigned16(low, high));
+   }
+   return vectorCount;
+}
+
+/// @brief Composites 16-bit source lanes over destination lanes by the source alpha lanes.
+template <class Isa>
+typename Isa::Vector blendOver16(const typename Isa::Vector lower,
+                                 const typename Isa::Vector upper) {
+   // With the source alpha lane replaced by 255, the colour formula also yields the alpha formula:
+   // (lowerAlpha * (255 - upperAlpha) + 255 * upperAlpha) / 255 rounds to the same value.
+   const typename Isa::Vector upperAlpha = Isa::broadcastAlpha16(upper);
+   const typename Isa::Vector opaqueUpper = Isa::bitOr(upper, Isa::alphaLanes16());
+   return divideBy255<Isa>(
+       Isa::add16(Isa::multiplyLow16(lower, Isa::subtract16(Isa::set16(255), upperAlpha)),
+                  Isa::multiplyLow16(opaqueUpper, upperAlpha)));
+}
+
+template <class Isa>
+std::size_t blendOver(void* destination, const void* source, const std::size_t count) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector zero = Isa::zero();
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      const typename Isa::Vector lower = Isa::load(pixelAt(destination, i));
+      const typename Isa::Vector upper = Isa::load(pixelAt(source, i));
+      const typename Isa::Vector low =
+          blendOver16<Isa>(Isa::unpackLow8(lower, zero), Isa::unpackLow8(upper, zero));
+      const typename Isa::Vector high =
+          blendOver16<Isa>(Isa::unpackHigh8(lower, zero), Isa::unpackHigh8(upper, zero));
+      Isa::store(pixelAt(destination, i), Isa::packUnsigned16(low, high));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t invert(void* destination, const void* source, const std::size_t count,
+                   const std::uint32_t mask) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector masks = Isa::set32(mask);
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      Isa::store(pixelAt(destination, i), Isa::bitXor(Isa::load(pixelAt(source, i)), masks));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t swizzle(void* destination, const std::size_t count, const Selection& selection) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector constant = Isa::set32(selection.constant);
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      typename Isa::Vector result = constant;
+      for (int channel = 0; channel < 4; ++channel) {
+         if (selection.sources[channel] == nullptr) {
+            continue;
+         }
+         typename Isa::Vector moved = Isa::load(pixelAt(selection.sources[channel], i));
+         const int shift = selection.shifts[channel];
+         moved = shift >= 0 ? Isa::shiftRight32(moved, shift) : Isa::shiftLeft32(moved, -shift);
+         result = Isa::bitOr(result, Isa::bitAnd(moved, Isa::set32(0xFFU << (channel * 8))));
+      }
+      Isa::store(pixelAt(destination, i), result);
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t luminance(void* destination, const void* source, const std::size_t count) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector channelMask = Isa::set32(0xFFU);
+   const typename Isa::Vector alphaMask = Isa::set32(0xFF000000U);
+   // (sum * 21846) >> 16 equals sum / 3 for every sum of three channels.
+   const typename Isa::Vector oneThird = Isa::set32(21846);
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      const typename Isa::Vector pixels = Isa::load(pixelAt(source, i));
+      const typename Isa::Vector sum = Isa::add32(
+          Isa::add32(Isa::bitAnd(pixels, channelMask),
+                     Isa::bitAnd(Isa::template shiftRight32<8>(pixels), channelMask)),
+          Isa::bitAnd(Isa::template shiftRight32<16>(pixels), channelMask));
+      const typename Isa::Vector grey = Isa::multiplyHighUnsigned16(sum, oneThird);
+      const typename Isa::Vector colour =
+          Isa::bitOr(Isa::bitOr(grey, Isa::template shiftLeft32<8>(grey)),
+                     Isa::template shiftLeft32<16>(grey));
+      Isa::store(pixelAt(destination, i), Isa::bitOr(colour, Isa::bitAnd(pixels, alphaMask)));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t cutAlpha(void* destination, const void* mask, const std::size_t count,
+                     const int factor) {
+   // Products are formed in the low 16 bits of each pixel, so larger factors are left to the
+   // scalar implementation.
+   if (factor < 0 || factor > 256) {
+      return 0;
+   }
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector factors = Isa::set32(static_cast<std::uint32_t>(factor));
+   const typename Isa::Vector colourMask = Isa::set32(0x00FFFFFFU);
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      const typename Isa::Vector pixels = Isa::load(pixelAt(destination, i));
+      const typename Isa::Vector alpha = Isa::template shiftRight32<24>(pixels);
+      const typename Isa::Vector maskAlpha =
+          Isa::template shiftRight32<24>(Isa::load(pixelAt(mask, i)));
+      const typename Isa::Vector threshold = Isa::multiplyLow16(maskAlpha, factors);
+      const typename Isa::Vector remaining =
+          Isa::bitAnd(Isa::subtract32(alpha, maskAlpha), Isa::greaterThan32(alpha, threshold));
+      Isa::store(pixelAt(destination, i),
+                 Isa::bitOr(Isa::bitAnd(pixels, colourMask),
+                            Isa::template shiftLeft32<24>(remaining)));
+   }
+   return vectorCount;
+}
+
+template <class Isa>
+std::size_t convolve(void* destination, const void* source, const std::size_t count,
+                     const std::int16_t* weights, const int tapCount) {
+   const std::size_t vectorCount = count - count % Isa::Pixels;
+   const typename Isa::Vector zero = Isa::zero();
+   const typename Isa::Vector rounding = Isa::set32(1U << (ConvolutionShift - 1));
+   for (std::size_t i = 0; i < vectorCount; i += Isa::Pixels) {
+      // Two taps are interleaved per 16-bit lane pair, so one multiply-add applies both weights.
+      // Each sum holds the four 32-bit channels of one pixel in every 128-bit lane.
+      typename Isa::Vector sums[4] = {rounding, rounding, rounding, rounding};
+      for (int tap = 0; tap < tapCount; tap += 2) {
+         const bool paired = tap + 1 < tapCount;
+         const typename Isa::Vector first = Isa::load(pixelAt(source, i + tap));
+         const typename Isa::Vector second =
+             paired ? Isa::load(pixelAt(source, i + tap + 1)) : zero;
+         const std::uint32_t firstWeight = static_cast<std::uint16_t>(weights[tap]);
+         const std::uint32_t secondWeight =
+             paired ? static_cast<std::uint16_t>(weights[tap + 1]) : 0U;
+         const typename Isa::Vector factors = Isa::set32(firstWeight | (secondWeight << 16));
+         const typename Isa::Vector low = Isa::unpackLow8(first, second);
+         const typename Isa::Vector high = Isa::unpackHigh8(first, second);
+         const typename Isa::Vector lanes[4] = {
+             Isa::unpackLow8(low, zero), Isa::unpackHigh8(low, zero),
+             Isa::unpackLow8(high, zero), Isa::unpackHigh8(high, zero)};
+         for (int pixel = 0; pixel < 4; ++pixel) {
+            sums[pixel] = Isa::add32(sums[pixel], Isa::multiplyAddPairs16(lanes[pixel], factors));
+         }
+      }
+      const typename Isa::Vector lower =
+          Isa::packSigned32(Isa::template shiftRight32<ConvolutionShift>(sums[0]),
+                            Isa::template shiftRight32<ConvolutionShift>(sums[1]));
+      const typename Isa::Vector upper =
+          Isa::packSigned32(Isa::template shiftRight32<ConvolutionShift>(sums[2]),
+                            Isa::template shiftRight32<ConvolutionShift>(sums[3]));
+      Isa::store(pixelAt(destination, i), Isa::packUnsigned16(lower, upper));
+   }
+   return vectorCount;
+}
+
+/// @brief Collects the kernels instantiated for one instruction set.
+template <class Isa>
+Table makeTable() {
+   return Table{&addSaturated<Isa>, &offsetSaturated<Isa>, &multiply<Isa>,
+                &lerp<Isa>,         &blendOver<Isa>,       &invert<Isa>,
+                &swizzle<Isa>,      &luminance<Isa>,       &cutAlpha<Isa>,
+                &convolve<Isa>};
+}
+
+}  // namespace TexturePixelKernelsSimd
+
+#endif  // TEXTUREPIXELKERNELS_SIMD_H
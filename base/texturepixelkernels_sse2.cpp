@@ -0,0 +1,90 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturepixelkernels_simd.h"
+#include <cstddef>
+#include <cstdint>
+
+// SSE2 is part of every x86-64 processor, so no extra code generation flags are needed.
+#if defined(__SSE2__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+namespace {
+
+/// @brief SSE2 operations used by the shared kernel templates.
+struct Sse2 {
+   using Vector = __m128i;
+   static constexpr std::size_t Pixels = 4;
+
+   static Vector load(const void* pixels) {
+      return _mm_loadu_si128(static_cast<const __m128i*>(pixels));
+   }
+   static void store(void* pixels, const Vector value) {
+      _mm_storeu_si128(static_cast<__m128i*>(pixels), value);
+   }
+   static Vector zero() { return _mm_setzero_si128(); }
+   static Vector set16(const int value) { return _mm_set1_epi16(static_cast<short>(value)); }
+   static Vector set32(const std::uint32_t value) {
+      return _mm_set1_epi32(static_cast<int>(value));
+   }
+   static Vector alphaLanes16() { return _mm_set1_epi64x(0x00FF000000000000LL); }
+   static Vector bitAnd(const Vector a, const Vector b) { return _mm_and_si128(a, b); }
+   static Vector bitOr(const Vector a, const Vector b) { return _mm_or_si128(a, b); }
+   static Vector bitXor(const Vector a, const Vector b) { return _mm_xor_si128(a, b); }
+   static Vector addSaturated8(const Vector a, const Vector b) { return _mm_adds_epu8(a, b); }
+   static Vector subtractSaturated8(const Vector a, const Vector b) {
+      return _mm_subs_epu8(a, b);
+   }
+   static Vector add16(const Vector a, const Vector b) { return _mm_add_epi16(a, b); }
+   static Vector subtract16(const Vector a, const Vector b) { return _mm_sub_epi16(a, b); }
+   static Vector multiplyLow16(const Vector a, const Vector b) { return _mm_mullo_epi16(a, b); }
+   static Vector multiplyHighUnsigned16(const Vector a, const Vector b) {
+      return _mm_mulhi_epu16(a, b);
+   }
+   template <int Bits>
+   static Vector shiftRight16(const Vector value) {
+      return _mm_srli_epi16(value, Bits);
+   }
+   static Vector multiplyAddPairs16(const Vector a, const Vector b) {
+      return _mm_madd_epi16(a, b);
+   }
+   static Vector add32(const Vector a, const Vector b) { return _mm_add_epi32(a, b); }
+   static Vector subtract32(const Vector a, const Vector b) { return _mm_sub_epi32(a, b); }
+   static Vector greaterThan32(const Vector a, const Vector b) { return _mm_cmpgt_epi32(a, b); }
+   template <int Bits>
+   static Vector shiftRight32(const Vector value) {
+      return _mm_srli_epi32(value, Bits);
+   }
+   template <int Bits>
+   static Vector shiftLeft32(const Vector value) {
+      return _mm_slli_epi32(value, Bits);
+   }
+   static Vector shiftRight32(const Vector value, const int bits) {
+      return _mm_srl_epi32(value, _mm_cvtsi32_si128(bits));
+   }
+   static Vector shiftLeft32(const Vector value, const int bits) {
+      return _mm_sll_epi32(value, _mm_cvtsi32_si128(bits));
+   }
+   static Vector unpackLow8(const Vector a, const Vector b) { return _mm_unpacklo_epi8(a, b); }
+   static Vector unpackHigh8(const Vector a, const Vector b) { return _mm_unpackhi_epi8(a, b); }
+   static Vector packSigned32(const Vector a, const Vector b) { return _mm_packs_epi32(a, b); }
+   static Vector packUnsigned16(const Vector a, const Vector b) { return _mm_packus_epi16(a, b); }
+   static Vector broadcastAlpha16(const Vector value) {
+      return _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xFF), 0xFF);
+   }
+};
+
+const TexturePixelKernelsSimd::Table table = TexturePixelKernelsSimd::makeTable<Sse2>();
+
+}  // namespace
+
+const TexturePixelKernelsSimd::Table* TexturePixelKernelsSimd::sse2Table() { return &table; }
+
+#else
+
+const TexturePixelKernelsSimd::Table* TexturePixelKernelsSimd::sse2Table() { return nullptr; }
+
+#endif
@@ -9,13 +9,18 @@
 #include "base/texturegenerator.h"
 #include "global.h"
 #include "texturenode.h"
+#include "textureimagebudget.h"
+#include "texturerendercache.h"
+#include "texturerendercoalescer.h"
 #include "texturerendermanager.h"
+#include "texturerenderplan.h"
 #include "settingsmanager.h"
 #include <QDebug>
 #include <QDomDocument>
 #include <QDomElement>
 #include <QDomNode>
 #include <QDomNodeList>
+#include <QList>
 #include <QMap>
 #include <QMapIterator>
 #include <QMetaObject>
@@ -28,19 +33,52 @@
 #include <Qt>
 #include <QtLogging>
 #include <QtCore/qtmetamacros.h>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <utility>
+#include <vector>
+
+TextureProject::InvalidationBatch::InvalidationBatch(TextureProject& project) : project(project) {
+   ++project.invalidationDepth;
+}
+
+TextureProject::InvalidationBatch::~InvalidationBatch() {
+   if (--project.invalidationDepth == 0) {
+      project.commitInvalidation();
+   }
+}
 
 TextureProject::TextureProject(const bool automaticThumbnailRendering)
     : newIdCounter(0),
       emptygenerator(new EmptyGenerator()),
+      imageBudget(std::make_unique<TextureImageBudget>(
+          [this](const int id, const QSize size, const TextureImage* image) {
+             const TextureNodePtr node = getNode(id);
+             if (!node.isNull()) {
+                node->discardCachedImage(size, image);
+                if (size == thumbnailSize) {
+                   markThumbnailDirty(id);
+                }
+             }
+          })),
       thumbnailSize(250, 250),
+      previewSize(800, 800),
       settingsManager(nullptr),
+      renderCache(&TextureRenderCache::instance()),
       modified(false),
       automaticThumbnailRendering(automaticThumbnailRendering) {
+   renderCoalescer = std::make_unique<TextureRenderCoalescer>(
+       [this]() { return startThumbnailRender(); },
+       [this]() { return renderManager ? renderManager->estimatedRemainingMilliseconds() : 0.0; });
+   createRenderManager();
+   scheduleThumbnailRender();
+}
+
+void TextureProject::createRenderManager() {
    renderManager = std::make_unique<TextureRenderManager>(
        [this](TextureRenderResult result) {
           QMetaObject::invokeMethod(
@@ -57,8 +95,21 @@ TextureProject::TextureProject(const bool automaticThumbnailRendering)
                  publishRenderFailure(std::move(failure));
               },
               Qt::QueuedConnection);
-       });
-   scheduleThumbnailRender();
+       },
+       renderWorkerCount);
+   renderManager->setRenderCache(renderCache);
+   const std::uint64_t generation = ++renderManagerGeneration;
+   renderManager->setCompletionObserver([this, generation](const std::uint64_t sequence) {
+      QMetaObject::invokeMethod(
+          this,
+          [this, generation, sequence]() {
+             // A replaced manager numbers its renders separately from the current one.
+             if (generation == renderManagerGeneration) {
+                renderCoalescer->renderFinished(sequence);
+             }
+          },
+          Qt::QueuedConnection);
+   });
 }
 
 TextureProject::~TextureProject() {
@@ -80,23 +131,65 @@ void TextureProject::setSettingsManager(SettingsManager* manager) {
                     &TextureProject::settingsUpdated);
 }
 
+void TextureProject::setRenderCache(TextureRenderCache* cache) {
+   renderCache = cache;
+   renderManager->setRenderCache(cache);
+   scheduleThumbnailRender();
+}
+
+void TextureProject::setRenderWorkerCount(const std::size_t count) {
+   if (count == renderWorkerCount) {
+      return;
+   }
+   renderWorkerCount = count;
+   // Destroying the manager cancels its render; nodes it did not publish stay dirty.
+   renderManager.reset();
+   createRenderManager();
+   renderCoalescer->cancel();
+   scheduleThumbnailRender();
+}
+
 void TextureProject::settingsUpdated() {
    if (!settingsManager) {
       return;
    }
    previewSize = settingsManager->getPreviewSize();
+   imageBudget->setBudget(static_cast<std::size_t>(settingsManager->getImageMemoryBudget()) *
+                          1024 * 1024);
+   renderCoalescer->setLatencyBudget(settingsManager->getPreviewLatency());
+   progressiveScale = settingsManager->getProgressivePreviewScale();
+   previewPassEnabled = settingsManager->getFullSizePreview();
+   setRenderWorkerCount(static_cast<std::size_t>(settingsManager->getRenderThreads()));
    const QSize previousThumbnailSize = thumbnailSize;
    thumbnailSize = settingsManager->getThumbnailSize();
    if (previousThumbnailSize != thumbnailSize) {
       renderManager->cancel();
+      renderCoalescer->cancel();
       const QMap<int, TextureNodePtr> nodesCopy = nodesSnapshot();
       for (const TextureNodePtr& node : nodesCopy) {
          node->discardCachedImage(previousThumbnailSize);
+         markThumbnailDirty(node->getId());
       }
    }
    scheduleThumbnailRender();
 }
 
+void TextureProject::setProgressiveScale(const int percent) {
+   progressiveScale = qBound(0, percent, 100);
+}
+
+void TextureProject::setPreviewPassEnabled(const bool enabled) {
+   previewPassEnabled = enabled;
+   scheduleThumbnailRender();
+}
+
+void TextureProject::setPreviewNodes(const QList<int>& ids) {
+   previewNodes = ids;
+   if (previewPassEnabled) {
+      scheduleThumbnailRender();
+   }
+}
+
 void TextureProject::setName(const QString& newname) {
    name = newname;
    emit nameUpdated(name);
@@ -122,14 +215,17 @@ void TextureProject::loadFromXML(const QDomDocument& xmlfile) {
          idMappings[nodeId] = getNewId();
       }
    }
-   QMapIterator<int, int> nodeiterator(idMappings);
-   while (nodeiterator.hasNext()) {
-      newNode(nodeiterator.next().value());
-   }
-   for (int i = 0; i < nodes.count(); i++) {
-      QDomNode currNode = nodes.at(i);
-      int nodeId = currNode.toElement().attribute("id").toInt();
-      getNode(idMappings[nodeId])->loadFromXML(currNode, idMappings);
+   {
+      InvalidationBatch batch(*this);
+      QMapIterator<int, int> nodeiterator(idMappings);
+      while (nodeiterator.hasNext()) {
+         newNode(nodeiterator.next().value());
+      }
+      for (int i = 0; i < nodes.count(); i++) {
+         QDomNode currNode = nodes.at(i);
+         int nodeId = currNode.toElement().attribute("id").toInt();
+         getNode(idMappings[nodeId])->loadFromXML(currNode, idMappings);
+      }
    }
    modified = false;
 }
@@ -172,6 +268,7 @@ QDomDocument TextureProject::saveAsXML(bool includegenerators) {
 bool TextureProject::isModified() const { return modified; }
 
 void TextureProject::clear() {
+   InvalidationBatch batch(*this);
    for (;;) {
       const QMap<int, TextureNodePtr> nodesCopy = nodesSnapshot();
       if (nodesCopy.isEmpty()) {
@@ -220,32 +317,286 @@ QMap<int, TextureNodePtr> TextureProject::nodesSnapshot() const {
    return nodes;
 }
 
-TextureGraphSnapshot TextureProject::createTextureGraphSnapshot(QSize renderSize) const {
+TextureGraphSnapshot TextureProject::createUpstreamGraphSnapshot(const int nodeId,
+                                                                 const QSize renderSize) const {
+   return createUpstreamGraphSnapshot(QList<int>{nodeId}, renderSize);
+}
+
+TextureGraphSnapshot TextureProject::createUpstreamGraphSnapshot(const QList<int>& nodeIds,
+                                                                 const QSize renderSize) const {
    const QMap<int, TextureNodePtr> nodesCopy = nodesSnapshot();
    TextureGraphSnapshot snapshot;
    snapshot.size = renderSize;
-   snapshot.nodes.reserve(static_cast<std::size_t>(nodesCopy.size()));
-   for (const TextureNodePtr& node : nodesCopy) {
+   snapshot.plan = getRenderPlan();
+   QSet<int> visited;
+   QList<int> pending = nodeIds;
+   while (!pending.isEmpty()) {
+      const int id = pending.takeLast();
+      const TextureNodePtr node = nodesCopy.value(id);
+      if (node.isNull() || visited.contains(id)) {
+         continue;
+      }
+      visited.insert(id);
       snapshot.nodes.push_back(node->createTextureNodeSnapshot(renderSize));
+      const TextureNodeSnapshot& nodeSnapshot = snapshot.nodes.back();
+      if (nodeSnapshot.cachedImage.isNull()) {
+         for (const int sourceId : nodeSnapshot.sources) {
+            pending.append(sourceId);
+         }
+      }
+   }
+   return snapshot;
+}
+
+TextureGraphSnapshot TextureProject::createDirtyGraphSnapshot(const QSize renderSize) const {
+   QSet<int> dirtyIds;
+   {
+      std::lock_guard lock(dirtyThumbnailMutex);
+      dirtyIds = dirtyThumbnailNodes;
+   }
+   const QMap<int, TextureNodePtr> nodesCopy = nodesSnapshot();
+   TextureGraphSnapshot snapshot;
+   snapshot.size = renderSize;
+   snapshot.plan = getRenderPlan();
+   snapshot.nodes.reserve(static_cast<std::size_t>(dirtyIds.size()));
+   QSet<int> visited;
+   QList<int> pending(dirtyIds.cbegin(), dirtyIds.cend());
+   while (!pending.isEmpty()) {
+      const int id = pending.takeLast();
+      const TextureNodePtr node = nodesCopy.value(id);
+      if (node.isNull() || visited.contains(id)) {
+         continue;
+      }
+      visited.insert(id);
+      if (!dirtyIds.contains(id)) {
+         // Up-to-date inputs only lend their image; cached snapshots are never published.
+         TextureImagePtr image = node->cachedImage(renderSize);
+         if (!image.isNull()) {
+            TextureNodeSnapshot inputSnapshot;
+            inputSnapshot.nodeId = id;
+            inputSnapshot.cachedImage = std::move(image);
+            snapshot.nodes.push_back(std::move(inputSnapshot));
+            continue;
+         }
+      }
+      snapshot.nodes.push_back(node->createTextureNodeSnapshot(renderSize));
+      const TextureNodeSnapshot& nodeSnapshot = snapshot.nodes.back();
+      if (nodeSnapshot.cachedImage.isNull()) {
+         for (const int sourceId : nodeSnapshot.sources) {
+            pending.append(sourceId);
+         }
+      }
+   }
+   return snapshot;
+}
+
+TextureGraphSnapshot TextureProject::createProgressiveGraphSnapshot(
+    const TextureGraphSnapshot& thumbnails, const QSize renderSize) const {
+   const QMap<int, TextureNodePtr> nodesCopy = nodesSnapshot();
+   TextureGraphSnapshot snapshot;
+   snapshot.size = renderSize;
+   snapshot.plan = thumbnails.plan;
+   snapshot.nodes.reserve(thumbnails.nodes.size());
+   bool rendersNodes = false;
+   for (const TextureNodeSnapshot& thumbnail : thumbnails.nodes) {
+      if (!thumbnail.cachedImage.isNull()) {
+         // Cached inputs are resampled instead of rendering their upstream nodes again.
+         TextureNodeSnapshot inputSnapshot;
+         inputSnapshot.nodeId = thumbnail.nodeId;
+         inputSnapshot.cachedImage = thumbnail.cachedImage->scaled(renderSize);
+         snapshot.nodes.push_back(std::move(inputSnapshot));
+         continue;
+      }
+      const TextureNodePtr node = nodesCopy.value(thumbnail.nodeId);
+      if (node.isNull()) {
+         continue;
+      }
+      // Progressive frames are only shown until the thumbnail arrives, so they are not cached.
+      TextureNodeSnapshot nodeSnapshot = node->createTextureNodeSnapshot(renderSize, false);
+      // Generators scale lengths from the thumbnail, so the frame resembles the thumbnail.
+      nodeSnapshot.settings.insert(TextureReferenceSizeSetting, thumbnails.size);
+      rendersNodes = rendersNodes || nodeSnapshot.cachedImage.isNull();
+      snapshot.nodes.push_back(std::move(nodeSnapshot));
+   }
+   if (!rendersNodes) {
+      snapshot.nodes.clear();
    }
    return snapshot;
 }
 
+TextureGraphSnapshot TextureProject::createPreviewGraphSnapshot() const {
+   QList<int> ids;
+   for (const int id : previewNodes) {
+      const TextureNodePtr node = getNode(id);
+      if (!node.isNull() && node->cachedImage(previewSize).isNull()) {
+         ids.append(id);
+      }
+   }
+   TextureGraphSnapshot snapshot;
+   snapshot.size = previewSize;
+   return ids.isEmpty() ? snapshot : createUpstreamGraphSnapshot(ids, previewSize);
+}
+
+QSize TextureProject::progressiveSize() const {
+   if (progressiveScale <= 0 || progressiveScale >= 100) {
+      return {};
+   }
+   return QSize(qMax(1, thumbnailSize.width() * progressiveScale / 100),
+                qMax(1, thumbnailSize.height() * progressiveScale / 100));
+}
+
+bool TextureProject::addRenderedImage(const TextureRenderResult& result) {
+   const TextureNodePtr node = getNode(result.nodeId);
+   return !node.isNull() && node->publishRenderedImage(result.size, result.revision, result.image);
+}
+
+void TextureProject::invalidateNodes(const QList<int>& ids) {
+   InvalidationBatch batch(*this);
+   for (const int id : ids) {
+      const TextureNodePtr node = getNode(id);
+      if (!node.isNull()) {
+         node->invalidateImageCache();
+         invalidatedNodes.insert(id);
+      }
+   }
+}
+
+void TextureProject::nodeInvalidated(const int id) {
+   invalidatedNodes.insert(id);
+   if (invalidationDepth == 0) {
+      commitInvalidation();
+   }
+}
+
+void TextureProject::commitInvalidation() {
+   QSet<int> roots;
+   roots.swap(invalidatedNodes);
+   QSet<int> downstream;
+   QList<int> order;
+   if (!roots.isEmpty()) {
+      std::shared_lock lock(topologyMutex);
+      order = topology.downstreamOrder(roots, &downstream);
+   }
+   // Edited nodes invalidated themselves. One below another edited node is invalidated again, as
+   // it may have been rendered from the old source between the two edits.
+   for (const int id : order) {
+      if (downstream.contains(id)) {
+         const TextureNodePtr node = getNode(id);
+         if (!node.isNull()) {
+            node->invalidateImageCache();
+         }
+      }
+   }
+   if (!order.isEmpty()) {
+      modified = true;
+      if (automaticThumbnailRendering) {
+         std::lock_guard lock(dirtyThumbnailMutex);
+         for (const int id : order) {
+            dirtyThumbnailNodes.insert(id);
+         }
+      }
+   }
+   if (!order.isEmpty() || thumbnailRenderDeferred) {
+      thumbnailRenderDeferred = false;
+      scheduleThumbnailRender();
+   }
+   if (!order.isEmpty()) {
+      emit imagesUpdated(order);
+   }
+}
+
+bool TextureProject::connectNodes(const int sourceId, const int receiverId) {
+   std::unique_lock lock(topologyMutex);
+   return topology.addEdge(sourceId, receiverId);
+}
+
+void TextureProject::disconnectNodes(const int sourceId, const int receiverId) {
+   std::unique_lock lock(topologyMutex);
+   topology.removeEdge(sourceId, receiverId);
+}
+
+bool TextureProject::reaches(const int fromId, const int toId) const {
+   std::shared_lock lock(topologyMutex);
+   return topology.reaches(fromId, toId);
+}
+
+QList<int> TextureProject::getTopologicalOrder() const {
+   std::shared_lock lock(topologyMutex);
+   return topology.topologicalOrder();
+}
+
+std::shared_ptr<const TextureRenderPlan> TextureProject::getRenderPlan() const {
+   std::shared_lock lock(topologyMutex);
+   std::lock_guard planLock(renderPlanMutex);
+   if (!renderPlan || renderPlan->getRevision() != topology.revision()) {
+      renderPlan = TextureRenderPlan::compile(topology);
+   }
+   return renderPlan;
+}
+
 void TextureProject::scheduleThumbnailRender() {
-   if (automaticThumbnailRendering && renderManager) {
-      renderManager->render(createTextureGraphSnapshot(thumbnailSize));
+   if (invalidationDepth > 0) {
+      thumbnailRenderDeferred = true;
+      return;
+   }
+   if (automaticThumbnailRendering && renderCoalescer) {
+      renderCoalescer->request();
+   }
+}
+
+std::uint64_t TextureProject::startThumbnailRender() {
+   if (!renderManager) {
+      return 0;
+   }
+   TextureGraphSnapshot snapshot = createDirtyGraphSnapshot(thumbnailSize);
+   {
+      // Dirty nodes that gained a thumbnail elsewhere, such as from an export, are up to date.
+      std::lock_guard lock(dirtyThumbnailMutex);
+      for (const TextureNodeSnapshot& nodeSnapshot : snapshot.nodes) {
+         if (!nodeSnapshot.cachedImage.isNull()) {
+            dirtyThumbnailNodes.remove(nodeSnapshot.nodeId);
+         }
+      }
+   }
+   std::vector<TextureGraphSnapshot> passes;
+   if (progressiveSize().isValid() && !snapshot.nodes.empty()) {
+      // A quick pass at a fraction of the size shows the edit before the thumbnails are ready.
+      passes.push_back(createProgressiveGraphSnapshot(snapshot, progressiveSize()));
+   }
+   passes.push_back(std::move(snapshot));
+   if (previewPassEnabled && previewSize.isValid() && previewSize != thumbnailSize) {
+      passes.push_back(createPreviewGraphSnapshot());
+   }
+   const bool empty =
+       std::all_of(passes.cbegin(), passes.cend(),
+                   [](const TextureGraphSnapshot& pass) { return pass.nodes.empty(); });
+   // Rendering replaces older work, which is safe because unpublished nodes stay dirty.
+   return empty ? 0 : renderManager->render(std::move(passes));
+}
+
+void TextureProject::markThumbnailDirty(const int id) {
+   if (automaticThumbnailRendering) {
+      std::lock_guard lock(dirtyThumbnailMutex);
+      dirtyThumbnailNodes.insert(id);
    }
 }
 
 void TextureProject::markSaved() { modified = false; }
 
 void TextureProject::publishRenderResult(TextureRenderResult result) {
-   if (result.size != thumbnailSize) {
+   const TextureNodePtr node = getNode(result.nodeId);
+   if (node.isNull()) {
       return;
    }
-   const TextureNodePtr node = getNode(result.nodeId);
-   if (!node.isNull()) {
+   if (result.size == thumbnailSize) {
+      if (node->publishRenderedImage(result.size, result.revision, result.image)) {
+         std::lock_guard lock(dirtyThumbnailMutex);
+         dirtyThumbnailNodes.remove(result.nodeId);
+      }
+   } else if (result.size == previewSize) {
       node->publishRenderedImage(result.size, result.revision, result.image);
+   } else if (result.size == progressiveSize()) {
+      node->publishFrame(result.size, result.image);
    }
 }
 
@@ -268,6 +619,9 @@ TextureNodePtr TextureProject::newNode(int id, TextureGeneratorPtr generator) {
       generator = emptygenerator;
    }
 
+   // The generator assigned by the node constructor invalidates the node, which the batch turns
+   // into one thumbnail render and notification after the node is announced.
+   InvalidationBatch batch(*this);
    TextureNodePtr newNode;
    {
       std::unique_lock lock(nodesMutex);
@@ -283,27 +637,26 @@ TextureNodePtr TextureProject::newNode(int id, TextureGeneratorPtr generator) {
       }
       newNode = TextureNodePtr(new TextureNode(this, generator, id));
       nodes.insert(id, newNode);
+      std::unique_lock topologyLock(topologyMutex);
+      topology.addNode(id);
    }
 
    QObject::connect(newNode.data(), &TextureNode::nodesConnected, this,
                     &TextureProject::notifyNodesConnected);
    QObject::connect(newNode.data(), &TextureNode::nodesDisconnected, this,
                     &TextureProject::notifyNodesDisconnected);
-   QObject::connect(newNode.data(), &TextureNode::imageUpdated, this,
-                    &TextureProject::notifyImageUpdated);
    QObject::connect(newNode.data(), &TextureNode::imageAvailable, this,
                     &TextureProject::notifyImageAvailable);
+   QObject::connect(newNode.data(), &TextureNode::frameAvailable, this,
+                    &TextureProject::frameAvailable);
    QObject::connect(newNode.data(), &TextureNode::positionUpdated, this,
                     [this](int) { modified = true; });
    QObject::connect(newNode.data(), &TextureNode::nameUpdated, this,
                     [this](int) { modified = true; });
 
-   // TextureNode initializes its generator before the signal connections above exist, so its
-   // initial imageUpdated signal cannot mark the project as changed. Node creation is itself a
-   // document change and must be recorded explicitly.
+   // Node creation is itself a document change and must be recorded explicitly.
    modified = true;
    emit nodeAdded(newNode);
-   scheduleThumbnailRender();
    return newNode;
 }
 
@@ -359,6 +712,7 @@ bool TextureProject::replaceGenerator(const TextureGeneratorPtr& oldGenerator,
       return false;
    }
 
+   InvalidationBatch batch(*this);
    const TextureGeneratorSettings oldDefinitions = oldGenerator->getSettings();
    const TextureGeneratorSettings newDefinitions = newGenerator->getSettings();
    const QList<int> nodeIds = getNodeIds();
@@ -448,6 +802,7 @@ int TextureProject::pasteNodes(const QString& xml) {
       return 0;
    }
    QDomNodeList nodes = nodeRoot.childNodes();
+   InvalidationBatch batch(*this);
    int pastedNodeCount = 0;
    for (int i = 0; i < nodes.count(); i++) {
       QDomNode currNode = nodes.at(i);
@@ -474,10 +829,17 @@ void TextureProject::removeNode(int id) {
    if (remNode.isNull()) {
       return;
    }
+   InvalidationBatch batch(*this);
    remNode->release();
    {
       std::unique_lock lock(nodesMutex);
       nodes.remove(id);
+      std::unique_lock topologyLock(topologyMutex);
+      topology.removeNode(id);
+   }
+   {
+      std::lock_guard lock(dirtyThumbnailMutex);
+      dirtyThumbnailNodes.remove(id);
    }
    // Removing an unconnected node emits no disconnection or image update signals.
    modified = true;
@@ -485,12 +847,6 @@ void TextureProject::removeNode(int id) {
    scheduleThumbnailRender();
 }
 
-void TextureProject::notifyImageUpdated(int id) {
-   modified = true;
-   scheduleThumbnailRender();
-   emit imageUpdated(id);
-}
-
 void TextureProject::notifyImageAvailable(int id, QSize size) { emit imageAvailable(id, size); }
 
 void TextureProject::notifyNodesConnected(int sourceId, int receiverId, QString slot) {
@@ -504,12 +860,6 @@ void TextureProject::notifyNodesDisconnected(int sourceId, int receiverId, QStri
 }
 
 bool TextureProject::findLoops() const {
-   const QMap<int, TextureNodePtr> nodesCopy = nodesSnapshot();
-   QMapIterator<int, TextureNodePtr> nodeiterator(nodesCopy);
-   while (nodeiterator.hasNext()) {
-      if (nodeiterator.next().value()->findLoop()) {
-         return true;
-      }
-   }
-   return false;
+   std::shared_lock lock(topologyMutex);
+   return topology.hasCycle();
 }
@@ -8,17 +8,26 @@
 #define TEXTUREPROJECT_H
 
 #include "base/texturegenerator.h"
+#include "texturegraphtopology.h"
 #include "texturenode.h"
 #include <QDomDocument>
 #include <QList>
 #include <QMap>
 #include <QObject>
+#include <QSet>
 #include <QSize>
 #include <QString>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 
+class TextureImageBudget;
+class TextureRenderCache;
+class TextureRenderCoalescer;
 class TextureRenderManager;
+class TextureRenderPlan;
 class ProjectFileService;
 class TextureGenerator;
 class SettingsManager;
@@ -35,6 +44,28 @@ class TextureProject : public QObject {
    friend class EditManager;
 
 public:
+   /// @brief Groups the image invalidations of several graph edits into one update.
+   /// @details While a batch is open, edited nodes and render requests are only recorded. When the
+   /// outermost batch closes, the project invalidates the nodes downstream of every edited node
+   /// once, in topological order, emits imagesUpdated() once, and schedules one thumbnail render.
+   /// Batches nest and are used on the thread that owns the project.
+   class InvalidationBatch final {
+   public:
+      /// @brief Opens a batch on a project.
+      /// @param project The project whose invalidations are grouped.
+      explicit InvalidationBatch(TextureProject& project);
+
+      /// @brief Closes the batch and applies the recorded invalidations if it is the outermost.
+      ~InvalidationBatch();
+
+      InvalidationBatch(const InvalidationBatch&) = delete;
+      InvalidationBatch& operator=(const InvalidationBatch&) = delete;
+
+   private:
+      /// @brief Project whose invalidations are grouped.
+      TextureProject& project;
+   };
+
    /// @brief Constructs an empty project and starts thumbnail rendering with default settings.
    explicit TextureProject(bool automaticThumbnailRendering = true);
 
@@ -64,9 +95,27 @@ public:
    TextureNodePtr getNode(int id) const;
 
    /// @brief Checks the graph for direct or indirect cycles.
+   /// @details Connections that would close a cycle are rejected, so this is a consistency check
+   /// that takes time linear in the size of the graph.
    /// @return @c true if at least one cycle is found.
    bool findLoops() const;
 
+   /// @brief Checks whether one node's image feeds another node, directly or through other nodes.
+   /// @param fromId The upstream node ID.
+   /// @param toId The downstream node ID.
+   /// @return @c true if both nodes exist and are the same or connected by a path of receivers.
+   bool reaches(int fromId, int toId) const;
+
+   /// @brief Returns all node IDs in topological order, every node after all of its sources.
+   /// @details The order is kept up to date as nodes are connected, so this only sorts the IDs.
+   QList<int> getTopologicalOrder() const;
+
+   /// @brief Returns the compiled render plan of the whole graph.
+   /// @details The plan is shared and compiled again only after nodes are added or removed or
+   /// connections change; setting changes reuse it. Graph snapshots carry it to the render
+   /// manager.
+   std::shared_ptr<const TextureRenderPlan> getRenderPlan() const;
+
    /// @brief Disconnects and removes a node from the graph.
    /// @param id The ID of the node to remove.
    void removeNode(int id);
@@ -94,6 +143,41 @@ public:
    /// @brief Returns nodes that are not used as a source by another node.
    QList<int> getSinkNodeIds() const;
 
+   /// @brief Copies the render state of one node and every node it depends on.
+   /// @details Sources of nodes that already have a cached image at the render size are left out,
+   /// because the cached image is used instead of rendering them.
+   /// @param nodeId ID of the node whose upstream graph is copied.
+   /// @param renderSize The width and height of the images to render.
+   /// @return A graph snapshot that is empty when the node does not exist.
+   TextureGraphSnapshot createUpstreamGraphSnapshot(int nodeId, QSize renderSize) const;
+
+   /// @brief Copies the render state of several nodes and every node they depend on.
+   /// @details Nodes shared by the upstream graphs are copied once.
+   /// @param nodeIds IDs of the nodes whose upstream graph is copied.
+   /// @param renderSize The width and height of the images to render.
+   /// @return A graph snapshot of the nodes that exist.
+   TextureGraphSnapshot createUpstreamGraphSnapshot(const QList<int>& nodeIds,
+                                                    QSize renderSize) const;
+
+   /// @brief Copies the render state of the nodes whose thumbnails are outdated.
+   /// @details Only nodes invalidated since their last published thumbnail are copied in full.
+   /// Their sources are added with nothing but the cached image handle when one exists, and are
+   /// otherwise copied together with their own upstream nodes, so the snapshot grows with the
+   /// size of an edit instead of the size of the project.
+   /// @param renderSize The width and height of the images to render.
+   /// @return A graph snapshot that is empty when every thumbnail is up to date.
+   TextureGraphSnapshot createDirtyGraphSnapshot(QSize renderSize) const;
+
+   /// @brief Invalidates the image caches of nodes and of every node downstream of them.
+   /// @details The nodes are invalidated together as one update; see InvalidationBatch.
+   /// @param ids IDs of the nodes whose images are outdated.
+   void invalidateNodes(const QList<int>& ids);
+
+   /// @brief Adds an image rendered from a graph snapshot to its node's image cache.
+   /// @param result The rendered image and the node revision captured in the snapshot.
+   /// @return @c true if the image was cached; outdated revisions and cached sizes are skipped.
+   bool addRenderedImage(const TextureRenderResult& result);
+
    /// @brief Gets a registered generator by its public name.
    /// @param name The generator name.
    /// @return A shared generator pointer, or null if no matching generator exists.
@@ -118,6 +202,69 @@ public:
    /// @return A non-owning settings manager pointer, or null if none is attached.
    SettingsManager* getSettingsManager() const { return settingsManager; }
 
+   /// @brief Sets the content-addressed cache shared with other projects.
+   /// @details Nodes look up their images in the cache before rendering and add rendered images
+   /// to it, so equal subgraphs and restored settings reuse earlier renders. New projects use
+   /// TextureRenderCache::instance().
+   /// @param cache Non-owning cache that outlives the project, or null to disable sharing.
+   void setRenderCache(TextureRenderCache* cache);
+
+   /// @brief Gets the content-addressed cache used by the project's nodes.
+   /// @return A non-owning cache pointer, or null if sharing is disabled.
+   TextureRenderCache* getRenderCache() const { return renderCache; }
+
+   /// @brief Sets the number of threads that render thumbnails, previews and exports.
+   /// @details A changed count cancels the running thumbnail render and replaces the render
+   /// manager, then renders the outdated thumbnails again. An attached settings manager sets the
+   /// count.
+   /// @param count Number of render threads, or zero to use every hardware thread.
+   void setRenderWorkerCount(std::size_t count);
+
+   /// @brief Gets the configured number of render threads.
+   /// @return The number of render threads, or zero when every hardware thread is used.
+   std::size_t getRenderWorkerCount() const { return renderWorkerCount; }
+
+   /// @brief Gets the memory budget shared by the image caches of all project nodes.
+   /// @details The budget evicts node images that were not used recently once their total size
+   /// exceeds the limit, preferring images that are cheap to render again. Views pin the images
+   /// they display, and the statistics report current usage and eviction counts. An attached
+   /// settings manager sets the limit.
+   /// @return The project's budget.
+   TextureImageBudget& getImageBudget() const { return *imageBudget; }
+
+   /// @brief Gets the coalescer that paces thumbnail renders during continuous edits.
+   /// @details Edits that arrive while a thumbnail render runs are merged into one follow-up
+   /// render instead of restarting it, and the statistics report the resulting frame times. An
+   /// attached settings manager sets the latency budget.
+   /// @return The project's coalescer.
+   TextureRenderCoalescer& getRenderCoalescer() const { return *renderCoalescer; }
+
+   /// @brief Sets the size of the quick first pass of thumbnail renders.
+   /// @details With a scale between 1 and 99 percent, each thumbnail render first renders the
+   /// outdated nodes at that fraction of the thumbnail size and offers the images through
+   /// frameAvailable(), then renders the thumbnails. An attached settings manager sets the scale.
+   /// @param percent Size of the first pass in percent of the thumbnail size, or zero to render
+   /// thumbnails in a single pass.
+   void setProgressiveScale(int percent);
+
+   /// @brief Gets the size of the quick first pass of thumbnail renders.
+   /// @return The size in percent of the thumbnail size, or zero when the pass is disabled.
+   int getProgressiveScale() const { return progressiveScale; }
+
+   /// @brief Sets whether thumbnail renders end with a pass at the preview size.
+   /// @details The pass renders the nodes set by setPreviewNodes() that have no image cached at
+   /// the preview size, after every thumbnail is up to date. An attached settings manager sets
+   /// the option.
+   /// @param enabled Whether to render the preview pass.
+   void setPreviewPassEnabled(bool enabled);
+
+   /// @brief Checks whether thumbnail renders end with a pass at the preview size.
+   bool isPreviewPassEnabled() const { return previewPassEnabled; }
+
+   /// @brief Sets the nodes that views show at the preview size.
+   /// @param ids IDs of the displayed nodes.
+   void setPreviewNodes(const QList<int>& ids);
+
 public slots:
    /// @brief Registers a texture generator unless its name is already in use.
    /// @param gen The generator to register.
@@ -145,10 +292,6 @@ public slots:
    /// @param slot The receiver slot name.
    void notifyNodesDisconnected(int sourceId, int receiverId, QString slot);
 
-   /// @brief Marks the project modified and forwards an image-invalidation notification.
-   /// @param id The updated node ID.
-   void notifyImageUpdated(int id);
-
    /// @brief Forwards a notification that a node image is available in the cache.
    /// @param id The ID of the rendered node.
    /// @param size The rendered image dimensions.
@@ -180,12 +323,18 @@ signals:
    /// @brief Emitted after two nodes are disconnected.
    void nodesDisconnected(int, int, QString);
 
-   /// @brief Emitted when a node image cache becomes outdated.
-   void imageUpdated(int);
+   /// @brief Emitted once per invalidation with every node whose image cache became outdated.
+   /// @details The IDs are in topological order, so sources come before their receivers.
+   void imagesUpdated(QList<int>);
 
    /// @brief Emitted when a rendered node image becomes available.
    void imageAvailable(int, QSize);
 
+   /// @brief Emitted when an image that is not cached is rendered.
+   /// @details The image is of an outdated node revision or from the low-resolution pass of a
+   /// progressive render; views may show it until the current image is available.
+   void frameAvailable(int, QSize, TextureImagePtr);
+
    /// @brief Reports a background render failure on the project owner thread.
    /// @param id The failed node ID, or `0` for a graph-level failure.
    /// @param size The image dimensions that failed to render.
@@ -217,14 +366,57 @@ private:
    /// @return A copy whose shared pointers keep the snapshot nodes alive.
    QMap<int, TextureNodePtr> nodesSnapshot() const;
 
-   /// @brief Copies the render state needed for all project nodes.
-   /// @param renderSize The width and height of the images to render.
-   /// @return A graph snapshot that does not retain live nodes or the project.
-   TextureGraphSnapshot createTextureGraphSnapshot(QSize renderSize) const;
+   /// @brief Creates the render manager with the configured number of threads.
+   void createRenderManager();
 
-   /// @brief Starts a thumbnail render using the latest graph state.
+   /// @brief Requests a thumbnail render of the nodes whose thumbnails are outdated.
+   /// @details A request made while an invalidation batch is open is made when the batch closes.
    void scheduleThumbnailRender();
 
+   /// @brief Starts a thumbnail render of the nodes whose thumbnails are outdated.
+   /// @return Number identifying the render, or zero if every thumbnail is up to date.
+   std::uint64_t startThumbnailRender();
+
+   /// @brief Copies a thumbnail snapshot for the quick first pass of a progressive render.
+   /// @details Nodes that carry a cached thumbnail lend a resampled copy of it, and the other
+   /// nodes are copied again at the smaller size, with the thumbnail size as their reference size.
+   /// @param thumbnails The snapshot of the thumbnail pass.
+   /// @param renderSize The width and height of the first pass.
+   /// @return A graph snapshot that is empty when no node needs to be rendered.
+   TextureGraphSnapshot createProgressiveGraphSnapshot(const TextureGraphSnapshot& thumbnails,
+                                                       QSize renderSize) const;
+
+   /// @brief Copies the render state of the preview nodes without an image at the preview size.
+   /// @return A graph snapshot that is empty when every preview node is up to date.
+   TextureGraphSnapshot createPreviewGraphSnapshot() const;
+
+   /// @brief Returns the size of the quick first pass of thumbnail renders.
+   /// @return The size, or an invalid size when the pass is disabled.
+   QSize progressiveSize() const;
+
+   /// @brief Records a node whose own image cache was invalidated by an edit.
+   /// @details Applies the invalidation at once unless an InvalidationBatch is open.
+   /// @param id The node ID.
+   void nodeInvalidated(int id);
+
+   /// @brief Invalidates everything downstream of the recorded nodes and notifies observers.
+   void commitInvalidation();
+
+   /// @brief Adds a connection to the topology index unless it would close a cycle.
+   /// @param sourceId The source node ID.
+   /// @param receiverId The receiver node ID.
+   /// @return @c true if the nodes are connected afterwards.
+   bool connectNodes(int sourceId, int receiverId);
+
+   /// @brief Removes a connection from the topology index.
+   /// @param sourceId The source node ID.
+   /// @param receiverId The receiver node ID.
+   void disconnectNodes(int sourceId, int receiverId);
+
+   /// @brief Records that a node's thumbnail must be rendered again.
+   /// @param id The node ID.
+   void markThumbnailDirty(int id);
+
    /// @brief Adds a completed image to the node cache on the project thread.
    /// @param result The completed image and its captured node revision.
    void publishRenderResult(TextureRenderResult result);
@@ -242,24 +434,58 @@ private:
    int newIdCounter;
    /// @brief Fallback generator used by nodes without another generator.
    TextureGeneratorPtr emptygenerator;
+   /// @brief Memory budget of the node image caches, destroyed after every node is released.
+   std::unique_ptr<TextureImageBudget> imageBudget;
    /// @brief Background render manager owned by the project.
    std::unique_ptr<TextureRenderManager> renderManager;
+   /// @brief Number of threads of the render manager, or zero to use every hardware thread.
+   std::size_t renderWorkerCount = 0;
+   /// @brief Number of render managers created, telling completions of replaced managers apart.
+   std::uint64_t renderManagerGeneration = 0;
+   /// @brief Paces the thumbnail renders started by graph edits.
+   std::unique_ptr<TextureRenderCoalescer> renderCoalescer;
    /// @brief Project nodes stored by ID.
    QMap<int, TextureNodePtr> nodes;
    /// @brief Registered texture generators stored by public name.
    QMap<QString, TextureGeneratorPtr> generators;
    /// @brief Protects the project node map.
    mutable std::shared_mutex nodesMutex;
+   /// @brief Connections between the project nodes and their topological order.
+   TextureGraphTopology topology;
+   /// @brief Protects the topology index.
+   mutable std::shared_mutex topologyMutex;
+   /// @brief Render plan compiled from the topology index, or null before the first render.
+   mutable std::shared_ptr<const TextureRenderPlan> renderPlan;
+   /// @brief Protects the render plan; taken after topologyMutex.
+   mutable std::mutex renderPlanMutex;
    /// @brief Width and height of node thumbnail images.
    QSize thumbnailSize;
    /// @brief Width and height of preview and export images.
    QSize previewSize;
    /// @brief Non-owning pointer to the application settings manager.
    SettingsManager* settingsManager;
+   /// @brief Non-owning pointer to the content-addressed render cache, or null.
+   TextureRenderCache* renderCache;
    /// @brief Whether the project has unsaved changes.
    bool modified;
    /// @brief Whether graph changes automatically schedule thumbnail rendering.
    bool automaticThumbnailRendering;
+   /// @brief Size of the first pass of thumbnail renders in percent, or zero when disabled.
+   int progressiveScale = 0;
+   /// @brief Whether thumbnail renders end with a pass at the preview size.
+   bool previewPassEnabled = false;
+   /// @brief IDs of the nodes that views show at the preview size.
+   QList<int> previewNodes;
+   /// @brief IDs of nodes without an up-to-date thumbnail, rendered by the next scheduled render.
+   QSet<int> dirtyThumbnailNodes;
+   /// @brief Protects the dirty thumbnail node set.
+   mutable std::mutex dirtyThumbnailMutex;
+   /// @brief Number of open invalidation batches.
+   int invalidationDepth = 0;
+   /// @brief IDs of nodes invalidated by edits since the last committed invalidation.
+   QSet<int> invalidatedNodes;
+   /// @brief Whether a thumbnail render was requested while an invalidation batch was open.
+   bool thumbnailRenderDeferred = false;
 };
 
 #endif  // TEXTUREPROJECT_H
@@ -0,0 +1,385 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturerendercache.h"
+#include "base/texturegenerator.h"
+#include "global.h"
+#include "textureimage.h"
+#include <QByteArray>
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaType>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/// @brief Magic number at the start of every disk cache file.
+constexpr quint32 diskFileMagic = 0x434d5450;  // "PTMC"
+/// @brief Version of the disk cache file layout.
+constexpr quint32 diskFileVersion = 1;
+/// @brief File name suffix of disk cache files.
+const QString diskFileSuffix = QStringLiteral(".ptmcache");
+
+/// @brief Header stored before the pixels of a disk cache file.
+struct DiskFileHeader {
+   /// @brief Always diskFileMagic.
+   quint32 magic;
+   /// @brief Always diskFileVersion.
+   quint32 version;
+   /// @brief Image width in pixels.
+   qint32 width;
+   /// @brief Image height in pixels.
+   qint32 height;
+};
+
+/// @brief Adds a length-prefixed field so that adjacent fields cannot run into each other.
+/// @param hash Hash being built.
+/// @param field Bytes to add.
+void addField(QCryptographicHash& hash, const QByteArray& field) {
+   const auto length = static_cast<quint32>(field.size());
+   hash.addData(QByteArrayView(reinterpret_cast<const char*>(&length), sizeof(length)));
+   hash.addData(field);
+}
+
+/// @brief Serializes a setting value without losing precision or alpha.
+/// @param value Setting value.
+/// @return The type name followed by an exact representation of the value.
+QByteArray serializeSetting(const QVariant& value) {
+   QByteArray serialized = QByteArray(value.typeName()) + ':';
+   switch (value.typeId()) {
+      case QMetaType::Double:
+      case QMetaType::Float:
+         serialized += QByteArray::number(value.toDouble(), 'g', 17);
+         break;
+      case QMetaType::QColor:
+         serialized += value.value<QColor>().name(QColor::HexArgb).toUtf8();
+         break;
+      case QMetaType::QStringList:
+         serialized += value.toStringList().join(QChar(0x1f)).toUtf8();
+         break;
+      default:
+         serialized += value.toString().toUtf8();
+         break;
+   }
+   return serialized;
+}
+
+}  // namespace
+
+TextureRenderCache::TextureRenderCache(const std::size_t memoryBudget)
+    : memoryBudget(memoryBudget) {}
+
+TextureRenderCache::~TextureRenderCache() {
+   {
+      std::lock_guard lock(writeMutex);
+      stopWriter = true;
+   }
+   writeQueueChanged.notify_all();
+   if (diskWriter.joinable()) {
+      diskWriter.join();
+   }
+}
+
+TextureRenderCache& TextureRenderCache::instance() {
+   static TextureRenderCache cache;
+   return cache;
+}
+
+QString TextureRenderCache::defaultDiskDirectory() {
+   const QString location = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+   return location.isEmpty() ? QString() : QDir(location).filePath(QStringLiteral("renders"));
+}
+
+QByteArray TextureRenderCache::makeKey(const TextureGenerator& generator,
+                                       const TextureNodeSettings& settings, const QSize size,
+                                       const QMap<QString, QByteArray>& sourceKeys) {
+   const QByteArray identity = generator.getCacheIdentity();
+   if (identity.isEmpty()) {
+      return QByteArray();
+   }
+   QCryptographicHash hash(QCryptographicHash::Sha256);
+   addField(hash, QByteArrayLiteral("ptm-render-cache-1"));
+   addField(hash, identity);
+   addField(hash, QByteArray::number(size.width()) + 'x' + QByteArray::number(size.height()));
+
+   // Renderers fill in missing settings with their defaults, so the key must do the same.
+   TextureNodeSettings values = settings;
+   for (const TextureGeneratorSetting& setting : generator.getSettings()) {
+      if (!values.contains(setting.id)) {
+         values.insert(setting.id, setting.defaultvalue);
+      }
+   }
+   for (auto value = values.cbegin(); value != values.cend(); ++value) {
+      addField(hash, value.key().toUtf8());
+      addField(hash, serializeSetting(value.value()));
+   }
+
+   for (const QString& slot : generator.getSourceSlots()) {
+      addField(hash, slot.toUtf8());
+      const auto sourceKey = sourceKeys.constFind(slot);
+      if (sourceKey == sourceKeys.cend()) {
+         addField(hash, QByteArray());
+         continue;
+      }
+      if (sourceKey->isEmpty()) {
+         return QByteArray();
+      }
+      addField(hash, *sourceKey);
+   }
+   return hash.result();
+}
+
+TextureImagePtr TextureRenderCache::find(const QByteArray& key) {
+   if (key.isEmpty()) {
+      return TextureImagePtr();
+   }
+   {
+      std::lock_guard lock(mutex);
+      const auto entry = entries.find(key);
+      if (entry != entries.end()) {
+         recency.splice(recency.begin(), recency, entry->recency);
+         ++statistics.memoryHits;
+         return entry->image;
+      }
+   }
+
+   TextureImagePtr image;
+   {
+      // An evicted image may still be waiting for the disk writer.
+      std::lock_guard lock(writeMutex);
+      image = pendingWrites.value(key);
+   }
+   const QString directory = getDiskDirectory();
+   if (image.isNull() && !directory.isEmpty()) {
+      image = readFromDisk(directory, key);
+   }
+   std::lock_guard lock(mutex);
+   if (image.isNull()) {
+      ++statistics.misses;
+      return image;
+   }
+   ++statistics.diskHits;
+   const auto entry = entries.find(key);
+   if (entry != entries.end()) {
+      return entry->image;
+   }
+   insertInMemory(key, image);
+   return image;
+}
+
+void TextureRenderCache::insert(const QByteArray& key, const TextureImagePtr& image) {
+   if (key.isEmpty() || image.isNull()) {
+      return;
+   }
+   {
+      std::lock_guard lock(mutex);
+      if (entries.contains(key)) {
+         return;
+      }
+      ++statistics.insertions;
+      insertInMemory(key, image);
+   }
+   if (!getDiskDirectory().isEmpty()) {
+      queueDiskWrite(key, image);
+   }
+}
+
+void TextureRenderCache::waitForDiskWrites() {
+   std::unique_lock lock(writeMutex);
+   writeQueueChanged.wait(lock, [this] { return writeQueue.empty(); });
+}
+
+void TextureRenderCache::setMemoryBudget(const std::size_t bytes) {
+   std::lock_guard lock(mutex);
+   memoryBudget = bytes;
+   evictToBudget();
+}
+
+std::size_t TextureRenderCache::getMemoryBudget() const {
+   std::lock_guard lock(mutex);
+   return memoryBudget;
+}
+
+bool TextureRenderCache::setDiskDirectory(const QString& path, const qint64 budget) {
+   std::lock_guard lock(diskMutex);
+   if (path.isEmpty()) {
+      diskDirectory.clear();
+      diskBytes = 0;
+      return true;
+   }
+   if (!QDir().mkpath(path)) {
+      diskDirectory.clear();
+      diskBytes = 0;
+      return false;
+   }
+   diskDirectory = QDir(path).absolutePath();
+   diskBudget = budget;
+   diskBytes = pruneDisk(diskDirectory, diskBudget);
+   return true;
+}
+
+QString TextureRenderCache::getDiskDirectory() const {
+   std::lock_guard lock(diskMutex);
+   return diskDirectory;
+}
+
+void TextureRenderCache::clear() {
+   std::lock_guard lock(mutex);
+   entries.clear();
+   recency.clear();
+   statistics = Statistics();
+}
+
+TextureRenderCache::Statistics TextureRenderCache::getStatistics() const {
+   std::lock_guard lock(mutex);
+   return statistics;
+}
+
+void TextureRenderCache::insertInMemory(const QByteArray& key, const TextureImagePtr& image) {
+   if (image->byteSize() > memoryBudget) {
+      return;
+   }
+   recency.push_front(key);
+   entries.insert(key, Entry{image, recency.begin()});
+   ++statistics.entryCount;
+   statistics.memoryBytes += image->byteSize();
+   evictToBudget();
+}
+
+void TextureRenderCache::evictToBudget() {
+   while (statistics.memoryBytes > memoryBudget && !recency.empty()) {
+      const auto entry = entries.find(recency.back());
+      statistics.memoryBytes -= entry->image->byteSize();
+      --statistics.entryCount;
+      ++statistics.evictions;
+      entries.erase(entry);
+      recency.pop_back();
+   }
+}
+
+QString TextureRenderCache::diskPath(const QString& directory, const QByteArray& key) {
+   return QDir(directory).filePath(QString::fromLatin1(key.toHex()) + diskFileSuffix);
+}
+
+TextureImagePtr TextureRenderCache::readFromDisk(const QString& directory, const QByteArray& key) {
+   QFile file(diskPath(directory, key));
+   if (!file.open(QIODevice::ReadOnly)) {
+      return TextureImagePtr();
+   }
+   DiskFileHeader header{};
+   if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+       header.magic != diskFileMagic || header.version != diskFileVersion || header.width <= 0 ||
+       header.height <= 0) {
+      return TextureImagePtr();
+   }
+   TextureImagePtr image;
+   try {
+      image = TextureImage::create(QSize(header.width, header.height),
+                                   TextureImage::Initialization::Uninitialized);
+   } catch (const std::exception&) {
+      return TextureImagePtr();
+   }
+   const auto byteSize = static_cast<qint64>(image->byteSize());
+   if (file.size() != static_cast<qint64>(sizeof(header)) + byteSize ||
+       file.read(reinterpret_cast<char*>(image->data()), byteSize) != byteSize) {
+      return TextureImagePtr();
+   }
+   // The modification time orders files for pruning, so a read marks the file as recently used.
+   file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+   return image;
+}
+
+void TextureRenderCache::queueDiskWrite(const QByteArray& key, const TextureImagePtr& image) {
+   std::lock_guard lock(writeMutex);
+   if (pendingWrites.contains(key)) {
+      return;
+   }
+   pendingWrites.insert(key, image);
+   writeQueue.push_back(key);
+   if (!diskWriter.joinable()) {
+      diskWriter = std::thread([this]() { runDiskWriter(); });
+   }
+   writeQueueChanged.notify_all();
+}
+
+void TextureRenderCache::runDiskWriter() {
+   std::unique_lock lock(writeMutex);
+   for (;;) {
+      writeQueueChanged.wait(lock, [this] { return stopWriter || !writeQueue.empty(); });
+      if (writeQueue.empty()) {
+         return;
+      }
+      const QByteArray key = writeQueue.front();
+      const TextureImagePtr image = pendingWrites.value(key);
+      lock.unlock();
+      writeToDisk(key, image);
+      lock.lock();
+      writeQueue.pop_front();
+      pendingWrites.remove(key);
+      writeQueueChanged.notify_all();
+   }
+}
+
+void TextureRenderCache::writeToDisk(const QByteArray& key, const TextureImagePtr& image) {
+   const QString directory = getDiskDirectory();
+   if (directory.isEmpty()) {
+      return;
+   }
+   const QString path = diskPath(directory, key);
+   if (QFileInfo::exists(path)) {
+      return;
+   }
+   const DiskFileHeader header{diskFileMagic, diskFileVersion, image->getSize().width(),
+                               image->getSize().height()};
+   QSaveFile file(path);
+   if (!file.open(QIODevice::WriteOnly) ||
+       file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header) ||
+       file.write(reinterpret_cast<const char*>(image->data()),
+                  static_cast<qint64>(image->byteSize())) !=
+           static_cast<qint64>(image->byteSize()) ||
+       !file.commit()) {
+      return;
+   }
+
+   std::lock_guard lock(diskMutex);
+   if (diskDirectory != directory) {
+      return;
+   }
+   diskBytes += static_cast<qint64>(sizeof(header) + image->byteSize());
+   if (diskBytes > diskBudget) {
+      // Pruning below the budget keeps the directory scan from running after every write.
+      diskBytes = pruneDisk(diskDirectory, diskBudget / 4 * 3);
+   }
+}
+
+qint64 TextureRenderCache::pruneDisk(const QString& directory, const qint64 target) {
+   const QFileInfoList files = QDir(directory).entryInfoList(
+       QStringList{QLatin1Char('*') + diskFileSuffix}, QDir::Files, QDir::Time | QDir::Reversed);
+   qint64 totalBytes = 0;
+   for (const QFileInfo& file : files) {
+      totalBytes += file.size();
+   }
+   for (const QFileInfo& file : files) {
+      if (totalBytes <= target) {
+         break;
+      }
+      if (QFile::remove(file.absoluteFilePath())) {
+         totalBytes -= file.size();
+      }
+   }
+   return totalBytes;
+}
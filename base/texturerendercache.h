@@ -0,0 +1,203 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTURERENDERCACHE_H
+#define TEXTURERENDERCACHE_H
+
+#include "base/texturegenerator.h"
+#include "global.h"
+#include "textureimage.h"
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QSize>
+#include <QString>
+#include <QtGlobal>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+
+/// @brief Process-wide cache of rendered images addressed by the content that produced them.
+/// @details A key hashes the generator's cache identity, its settings, the image size, and the
+/// keys of the images connected to its source slots, so equal subgraphs share one entry no matter
+/// which node or project they belong to. Entries are evicted least recently used first once the
+/// memory budget is exceeded. When a disk directory is set, inserted images are also written there
+/// by a background thread and memory misses are read back from it, so later sessions start warm.
+/// Cached images are shared and must not be modified.
+class TextureRenderCache {
+public:
+   /// @brief Counters describing cache use since construction or the last clear().
+   struct Statistics {
+      /// @brief Lookups answered from memory.
+      quint64 memoryHits = 0;
+      /// @brief Lookups answered from the disk directory.
+      quint64 diskHits = 0;
+      /// @brief Lookups that found no image.
+      quint64 misses = 0;
+      /// @brief Images added to the cache.
+      quint64 insertions = 0;
+      /// @brief Images dropped from memory to respect the memory budget.
+      quint64 evictions = 0;
+      /// @brief Number of images held in memory.
+      std::size_t entryCount = 0;
+      /// @brief Pixel bytes held in memory.
+      std::size_t memoryBytes = 0;
+   };
+
+   /// @brief Default memory budget in bytes.
+   static constexpr std::size_t DefaultMemoryBudget = std::size_t(512) * 1024 * 1024;
+
+   /// @brief Default disk budget in bytes.
+   static constexpr qint64 DefaultDiskBudget = qint64(2) * 1024 * 1024 * 1024;
+
+   /// @brief Constructs an empty cache without a disk directory.
+   /// @param memoryBudget Maximum number of pixel bytes kept in memory.
+   explicit TextureRenderCache(std::size_t memoryBudget = DefaultMemoryBudget);
+
+   /// @brief Writes the queued images to the disk directory and stops the disk writer.
+   ~TextureRenderCache();
+
+   /// @brief Disables copying because the cache owns its index and statistics.
+   TextureRenderCache(const TextureRenderCache&) = delete;
+
+   /// @brief Disables copy assignment because the cache owns its index and statistics.
+   TextureRenderCache& operator=(const TextureRenderCache&) = delete;
+
+   /// @brief Returns the cache shared by every project in the process.
+   static TextureRenderCache& instance();
+
+   /// @brief Returns the directory used for rendered images below the user's cache location.
+   /// @return An absolute directory path, or an empty string if no cache location exists.
+   static QString defaultDiskDirectory();
+
+   /// @brief Computes the content key of one node image.
+   /// @param generator Generator that renders the image.
+   /// @param settings Node setting values; missing values use the generator defaults.
+   /// @param size Width and height of the image.
+   /// @param sourceKeys Keys of the images connected to each source slot. Unconnected slots are
+   /// absent.
+   /// @return The key, or an empty array if the generator or any connected source is not cacheable.
+   static QByteArray makeKey(const TextureGenerator& generator, const TextureNodeSettings& settings,
+                             QSize size, const QMap<QString, QByteArray>& sourceKeys);
+
+   /// @brief Looks up an image in memory and then on disk.
+   /// @param key Key returned by makeKey().
+   /// @return The cached image, or a null pointer if neither tier holds it.
+   TextureImagePtr find(const QByteArray& key);
+
+   /// @brief Adds a rendered image to memory and, when enabled, to the disk directory.
+   /// @details The file is written by a background thread, so render workers never wait for the
+   /// disk.
+   /// @param key Key returned by makeKey(); empty keys are ignored.
+   /// @param image Completed image that will no longer be modified.
+   void insert(const QByteArray& key, const TextureImagePtr& image);
+
+   /// @brief Blocks until every image queued for the disk directory has been written.
+   void waitForDiskWrites();
+
+   /// @brief Sets the memory budget and evicts entries that no longer fit.
+   /// @param bytes Maximum number of pixel bytes kept in memory.
+   void setMemoryBudget(std::size_t bytes);
+
+   /// @brief Returns the memory budget in bytes.
+   std::size_t getMemoryBudget() const;
+
+   /// @brief Enables the disk tier in a directory or disables it.
+   /// @param path Directory that stores cached images, or an empty string to disable the tier.
+   /// @param budget Maximum number of bytes kept in the directory.
+   /// @return @c true if the tier is disabled or the directory is usable.
+   bool setDiskDirectory(const QString& path, qint64 budget = DefaultDiskBudget);
+
+   /// @brief Returns the disk directory, or an empty string when the disk tier is disabled.
+   QString getDiskDirectory() const;
+
+   /// @brief Drops every image held in memory and resets the statistics.
+   /// @details Files in the disk directory are kept.
+   void clear();
+
+   /// @brief Returns a snapshot of the cache counters.
+   Statistics getStatistics() const;
+
+private:
+   /// @brief One image held in memory.
+   struct Entry {
+      /// @brief Cached image.
+      TextureImagePtr image;
+      /// @brief Position of the key in the recency list.
+      std::list<QByteArray>::iterator recency;
+   };
+
+   /// @brief Adds an image to memory while mutex is held.
+   /// @param key Key of the image.
+   /// @param image Image to keep.
+   void insertInMemory(const QByteArray& key, const TextureImagePtr& image);
+
+   /// @brief Drops least recently used images until the memory budget is met.
+   void evictToBudget();
+
+   /// @brief Returns the disk file path of a key in a directory.
+   static QString diskPath(const QString& directory, const QByteArray& key);
+
+   /// @brief Reads an image from the disk directory.
+   /// @param directory Disk directory to read.
+   /// @param key Key of the image.
+   /// @return The image, or a null pointer if no valid file exists.
+   static TextureImagePtr readFromDisk(const QString& directory, const QByteArray& key);
+
+   /// @brief Queues an image for the disk writer, starting the writer on first use.
+   /// @param key Key of the image.
+   /// @param image Image to write.
+   void queueDiskWrite(const QByteArray& key, const TextureImagePtr& image);
+
+   /// @brief Writes queued images until the cache is destroyed.
+   void runDiskWriter();
+
+   /// @brief Writes an image to the disk directory and prunes old files when over budget.
+   /// @param key Key of the image.
+   /// @param image Image to write.
+   void writeToDisk(const QByteArray& key, const TextureImagePtr& image);
+
+   /// @brief Deletes the least recently used files until the directory uses at most @p target.
+   /// @param directory Disk directory to prune.
+   /// @param target Byte count to reach.
+   /// @return Remaining number of bytes in the directory.
+   static qint64 pruneDisk(const QString& directory, qint64 target);
+
+   /// @brief Protects the memory index, recency list, budget, and statistics.
+   mutable std::mutex mutex;
+   /// @brief Images held in memory by key.
+   QHash<QByteArray, Entry> entries;
+   /// @brief Keys ordered from most to least recently used.
+   std::list<QByteArray> recency;
+   /// @brief Maximum number of pixel bytes kept in memory.
+   std::size_t memoryBudget;
+   /// @brief Counters reported by getStatistics().
+   Statistics statistics;
+   /// @brief Protects the disk directory, its budget, and its size estimate.
+   mutable std::mutex diskMutex;
+   /// @brief Disk directory, or an empty string when the disk tier is disabled.
+   QString diskDirectory;
+   /// @brief Maximum number of bytes kept in the disk directory.
+   qint64 diskBudget = DefaultDiskBudget;
+   /// @brief Estimated number of bytes in the disk directory.
+   qint64 diskBytes = 0;
+   /// @brief Protects the write queue and the writer's stop flag.
+   std::mutex writeMutex;
+   /// @brief Signals a queued image, a finished write, or a stop request.
+   std::condition_variable writeQueueChanged;
+   /// @brief Keys waiting to be written, oldest first; the key being written stays at the front.
+   std::deque<QByteArray> writeQueue;
+   /// @brief Images of the queued keys, which find() answers before they reach the disk.
+   QHash<QByteArray, TextureImagePtr> pendingWrites;
+   /// @brief Whether the disk writer should exit once the queue is empty.
+   bool stopWriter = false;
+   /// @brief Thread writing queued images, started by the first disk write.
+   std::thread diskWriter;
+};
+
+#endif  // TEXTURERENDERCACHE_H
@@ -0,0 +1,132 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturerendercoalescer.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+/// @brief Number of recent frames averaged by the statistics.
+constexpr int maximumFrameSamples = 30;
+
+/// @brief Adds a sample to a rolling window.
+void appendSample(QList<double>& samples, const double value) {
+   samples.append(value);
+   if (samples.size() > maximumFrameSamples) {
+      samples.removeFirst();
+   }
+}
+
+/// @brief Returns the mean of a rolling window, or zero when it is empty.
+double average(const QList<double>& samples) {
+   if (samples.isEmpty()) {
+      return 0.0;
+   }
+   return std::accumulate(samples.cbegin(), samples.cend(), 0.0) /
+          static_cast<double>(samples.size());
+}
+
+}  // namespace
+
+TextureRenderCoalescer::TextureRenderCoalescer(StartRender startRender,
+                                               RemainingEstimate remainingEstimate,
+                                               QObject* parent)
+    : QObject(parent), start(std::move(startRender)), remaining(std::move(remainingEstimate)) {
+   deadline.setSingleShot(true);
+   deadline.setTimerType(Qt::PreciseTimer);
+   QObject::connect(&deadline, &QTimer::timeout, this, &TextureRenderCoalescer::deadlineReached);
+   clock.start();
+}
+
+void TextureRenderCoalescer::setLatencyBudget(const int milliseconds) {
+   latencyBudget = std::max(0, milliseconds);
+}
+
+void TextureRenderCoalescer::request() {
+   ++statistics.requestCount;
+   if (renderSequence == 0) {
+      pendingSince = now();
+      startRender();
+      return;
+   }
+   if (pending) {
+      ++statistics.coalescedRequestCount;
+      return;
+   }
+   pending = true;
+   pendingSince = now();
+   deadline.start(latencyBudget);
+}
+
+void TextureRenderCoalescer::renderFinished(const std::uint64_t sequence) {
+   if (sequence == 0 || sequence != renderSequence) {
+      return;
+   }
+   const double finished = now();
+   const double frameTime = finished - renderStarted;
+   statistics.lastFrameMilliseconds = frameTime;
+   statistics.maximumFrameMilliseconds = std::max(statistics.maximumFrameMilliseconds, frameTime);
+   ++statistics.frameCount;
+   appendSample(frameTimes, frameTime);
+   appendSample(frameLatencies, finished - renderRequested);
+   if (lastFrameFinished >= 0.0) {
+      appendSample(frameIntervals, finished - lastFrameFinished);
+   }
+   lastFrameFinished = finished;
+   renderSequence = 0;
+   if (pending) {
+      startRender();
+   }
+}
+
+void TextureRenderCoalescer::cancel() {
+   renderSequence = 0;
+   if (pending) {
+      startRender();
+   }
+}
+
+TextureRenderCoalescer::Statistics TextureRenderCoalescer::getStatistics() const {
+   Statistics result = statistics;
+   result.averageFrameMilliseconds = average(frameTimes);
+   result.averageFrameIntervalMilliseconds = average(frameIntervals);
+   result.averageLatencyMilliseconds = average(frameLatencies);
+   return result;
+}
+
+void TextureRenderCoalescer::startRender() {
+   deadline.stop();
+   pending = false;
+   extended = false;
+   renderRequested = pendingSince;
+   renderStarted = now();
+   renderSequence = start ? start() : 0;
+   if (renderSequence != 0) {
+      ++statistics.renderCount;
+   }
+}
+
+void TextureRenderCoalescer::deadlineReached() {
+   if (!pending || renderSequence == 0) {
+      return;
+   }
+   // A render that finishes within another budget gives an earlier frame than a new render would.
+   const double remainingMilliseconds = remaining ? remaining() : 0.0;
+   if (latencyBudget > 0 && !extended && remainingMilliseconds <= latencyBudget) {
+      extended = true;
+      ++statistics.extendedRenderCount;
+      deadline.start(latencyBudget);
+      return;
+   }
+   ++statistics.supersededRenderCount;
+   startRender();
+}
+
+double TextureRenderCoalescer::now() const {
+   return static_cast<double>(clock.nsecsElapsed()) / 1e6;
+}
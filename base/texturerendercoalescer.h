@@ -0,0 +1,137 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTURERENDERCOALESCER_H
+#define TEXTURERENDERCOALESCER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <cstdint>
+#include <functional>
+
+/// @brief Merges bursts of render requests into a steady sequence of renders.
+/// @details A request starts a render at once when none is running. Requests that arrive while a
+/// render runs are merged into one follow-up render, which starts when the running render finishes
+/// so its nodes are not thrown away half done. When the oldest waiting request has waited for the
+/// latency budget, the running render is replaced, unless it is expected to finish within another
+/// budget; it is then given that time once. The coalescer lives on the thread that owns it, and
+/// the callbacks run there.
+class TextureRenderCoalescer final : public QObject {
+   Q_OBJECT
+
+public:
+   /// @brief Counters and frame times of the renders started so far.
+   struct Statistics {
+      /// @brief Number of render requests received.
+      std::uint64_t requestCount = 0;
+      /// @brief Number of renders started.
+      std::uint64_t renderCount = 0;
+      /// @brief Number of renders that finished.
+      std::uint64_t frameCount = 0;
+      /// @brief Number of requests merged into a render that also covers a later request.
+      std::uint64_t coalescedRequestCount = 0;
+      /// @brief Number of unfinished renders replaced because the latency budget ran out.
+      std::uint64_t supersededRenderCount = 0;
+      /// @brief Number of times an unfinished render was kept because it was nearly done.
+      std::uint64_t extendedRenderCount = 0;
+      /// @brief Duration of the last finished render in milliseconds.
+      double lastFrameMilliseconds = 0.0;
+      /// @brief Average duration of the recently finished renders in milliseconds.
+      double averageFrameMilliseconds = 0.0;
+      /// @brief Longest duration of a finished render in milliseconds.
+      double maximumFrameMilliseconds = 0.0;
+      /// @brief Average time between recently finished renders in milliseconds.
+      double averageFrameIntervalMilliseconds = 0.0;
+      /// @brief Average time from the oldest request a recent render covered until it finished.
+      double averageLatencyMilliseconds = 0.0;
+   };
+
+   /// @brief Function that starts a render of the latest state.
+   /// @return Number identifying the render in renderFinished(), or zero if nothing was started.
+   using StartRender = std::function<std::uint64_t()>;
+
+   /// @brief Function that estimates how long the running render still needs, in milliseconds.
+   using RemainingEstimate = std::function<double()>;
+
+   /// @brief Latency budget used until setLatencyBudget() is called.
+   static constexpr int defaultLatencyBudget = 50;
+
+   /// @brief Creates an idle coalescer.
+   /// @param startRender Starts a render of the latest state.
+   /// @param remainingEstimate Estimates the remaining time of the running render.
+   /// @param parent Optional QObject parent.
+   TextureRenderCoalescer(StartRender startRender, RemainingEstimate remainingEstimate,
+                          QObject* parent = nullptr);
+
+   /// @brief Sets how long a request may wait for a running render before replacing it.
+   /// @param milliseconds Budget in milliseconds; zero replaces running renders at once.
+   void setLatencyBudget(int milliseconds);
+
+   /// @brief Returns how long a request may wait for a running render before replacing it.
+   [[nodiscard]] int getLatencyBudget() const { return latencyBudget; }
+
+   /// @brief Requests a render of the latest state.
+   void request();
+
+   /// @brief Reports that a render finished, successfully or not.
+   /// @param sequence Number returned by the start function; older renders are ignored.
+   void renderFinished(std::uint64_t sequence);
+
+   /// @brief Forgets the running render after it was cancelled, so the next request starts at once.
+   void cancel();
+
+   /// @brief Returns whether a started render has not finished yet.
+   [[nodiscard]] bool isRendering() const { return renderSequence != 0; }
+
+   /// @brief Returns a snapshot of the counters and recent frame times.
+   [[nodiscard]] Statistics getStatistics() const;
+
+private:
+   /// @brief Starts a render covering every waiting request.
+   void startRender();
+
+   /// @brief Replaces or extends the running render when the oldest request ran out of budget.
+   void deadlineReached();
+
+   /// @brief Returns the milliseconds since the coalescer was created.
+   [[nodiscard]] double now() const;
+
+   /// @brief Callback starting renders.
+   StartRender start;
+   /// @brief Callback estimating the running render's remaining time.
+   RemainingEstimate remaining;
+   /// @brief Latency budget in milliseconds.
+   int latencyBudget = defaultLatencyBudget;
+   /// @brief Fires when the oldest waiting request runs out of budget.
+   QTimer deadline;
+   /// @brief Clock of all timestamps.
+   QElapsedTimer clock;
+   /// @brief Number of the running render, or zero when idle.
+   std::uint64_t renderSequence = 0;
+   /// @brief Time the running render started.
+   double renderStarted = 0.0;
+   /// @brief Time of the oldest request the running render covers.
+   double renderRequested = 0.0;
+   /// @brief Whether requests wait for the running render to finish.
+   bool pending = false;
+   /// @brief Time of the oldest waiting request.
+   double pendingSince = 0.0;
+   /// @brief Whether the running render already received extra time.
+   bool extended = false;
+   /// @brief Time the last render finished, or a negative value before the first one.
+   double lastFrameFinished = -1.0;
+   /// @brief Counters and extremes reported by getStatistics().
+   Statistics statistics;
+   /// @brief Durations of the recently finished renders.
+   QList<double> frameTimes;
+   /// @brief Times between the recently finished renders.
+   QList<double> frameIntervals;
+   /// @brief Latencies of the recently finished renders.
+   QList<double> frameLatencies;
+};
+
+#endif  // TEXTURERENDERCOALESCER_H
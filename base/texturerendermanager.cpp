@@ -7,27 +7,46 @@
 #include "base/jstexgen.h"
 #include "global.h"
 #include "textureimage.h"
+#include "texturerendercache.h"
+#include "texturerenderplan.h"
+#include <QList>
 #include <QMap>
+#include <QRect>
 #include <QSize>
 #include <QString>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
 #include <memory>
 #include <mutex>
-#include <set>
+#include <stdexcept>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace {
 
-/// @brief Selects a small worker count based on available CPU resources.
-/// @return The number of render workers to create.
-std::size_t defaultWorkerCount() {
-   constexpr unsigned int maxWorkerCount = 4;
-   const unsigned int available = std::max(1U, std::thread::hardware_concurrency());
-   return static_cast<std::size_t>(std::min(maxWorkerCount, available));
+/// @brief Smallest image, in pixels, that is split into regions on several workers.
+constexpr std::size_t minimumTiledPixelCount = 512 * 512;
+
+/// @brief Number of regions offered to each worker, so faster workers can take more of them.
+constexpr std::size_t regionsPerWorker = 4;
+
+/// @brief Cost assumed for a generator that has no timing samples yet.
+constexpr double unmeasuredNodeMilliseconds = 1.0;
+
+/// @brief Estimates how long one node takes to render.
+/// @param snapshot The node to estimate.
+/// @return Zero for cached nodes, otherwise the generator's recent average duration.
+double estimatedNodeMilliseconds(const TextureNodeSnapshot& snapshot) {
+   if (!snapshot.cachedImage.isNull() || snapshot.generator.isNull()) {
+      return 0.0;
+   }
+   const TextureGenerator::GenerationTiming timing = snapshot.generator->getGenerationTiming();
+   return timing.runCount > 0 ? timing.averageMilliseconds : unmeasuredNodeMilliseconds;
 }
 
 }  // namespace
@@ -38,17 +57,19 @@ TextureRenderManager::TextureRenderManager(ResultHandler resultHandler,
    if (workerCount == 0) {
       workerCount = defaultWorkerCount();
    }
+   queues.reserve(workerCount);
+   while (queues.size() < workerCount) {
+      queues.push_back(std::make_unique<WorkerQueue>());
+   }
    workers.reserve(workerCount);
    try {
       while (workers.size() < workerCount) {
-         workers.emplace_back(&TextureRenderManager::runWorker, this);
+         const std::size_t workerIndex = workers.size();
+         workers.emplace_back(&TextureRenderManager::runWorker, this, workerIndex);
       }
    } catch (...) {
-      {
-         std::lock_guard lock(mutex);
-         stopping = true;
-      }
-      taskAvailable.notify_all();
+      stopping = true;
+      notifyWorkers(workers.size());
       for (std::thread& worker : workers) {
          if (worker.joinable()) {
             worker.join();
@@ -59,15 +80,15 @@ TextureRenderManager::TextureRenderManager(ResultHandler resultHandler,
 }
 
 TextureRenderManager::~TextureRenderManager() {
+   stopping = true;
    {
-      std::lock_guard lock(mutex);
-      stopping = true;
+      std::lock_guard lock(renderMutex);
       ++latestRenderSequence;
-      runnableTasks.clear();
+      clearTasks();
       currentRender.reset();
    }
-   JsTexGen::interruptActiveEngines();
-   taskAvailable.notify_all();
+   interruptWorkerScripts();
+   notifyWorkers(workers.size());
    for (std::thread& worker : workers) {
       if (worker.joinable()) {
          worker.join();
@@ -75,100 +96,236 @@ TextureRenderManager::~TextureRenderManager() {
    }
 }
 
-void TextureRenderManager::render(TextureGraphSnapshot snapshot) {
-   const QSize renderSize = snapshot.size;
-   std::shared_ptr<TextureGraphRenderState> renderState;
+std::size_t TextureRenderManager::defaultWorkerCount() {
+   return static_cast<std::size_t>(std::max(1U, std::thread::hardware_concurrency()));
+}
+
+std::uint64_t TextureRenderManager::render(TextureGraphSnapshot snapshot) {
+   std::vector<TextureGraphSnapshot> passes;
+   passes.push_back(std::move(snapshot));
+   return render(std::move(passes));
+}
+
+std::uint64_t TextureRenderManager::render(std::vector<TextureGraphSnapshot> passes) {
+   const auto isEmpty = [](const TextureGraphSnapshot& pass) { return pass.nodes.empty(); };
+   if (!std::all_of(passes.cbegin(), passes.cend(), isEmpty)) {
+      passes.erase(std::remove_if(passes.begin(), passes.end(), isEmpty), passes.end());
+   }
+   if (passes.empty()) {
+      return 0;
+   }
+
+   std::vector<std::shared_ptr<TextureGraphRenderState>> renderStates;
+   renderStates.reserve(passes.size());
+   QSize renderSize;
    try {
-      renderState = createGraphRenderState(std::move(snapshot));
+      for (TextureGraphSnapshot& pass : passes) {
+         renderSize = pass.size;
+         renderStates.push_back(createGraphRenderState(std::move(pass)));
+      }
    } catch (const std::exception& error) {
       if (failureHandler) {
          failureHandler(TextureRenderFailure{0, renderSize, QString::fromUtf8(error.what())});
       }
-      return;
+      return 0;
    } catch (...) {
       if (failureHandler) {
          failureHandler(
              TextureRenderFailure{0, renderSize, QStringLiteral("Unknown render failure")});
       }
-      return;
+      return 0;
+   }
+   for (std::size_t index = renderStates.size() - 1; index > 0; --index) {
+      TextureGraphRenderState& previous = *renderStates[index - 1];
+      previous.nextPass = renderStates[index];
+      previous.laterPassMilliseconds =
+          renderStates[index]->estimatedMilliseconds + renderStates[index]->laterPassMilliseconds;
    }
+   std::vector<TextureNodeRenderTask> rootTasks = createRootTasks(renderStates.front());
 
+   std::uint64_t sequence = 0;
    {
-      std::lock_guard lock(mutex);
+      std::lock_guard lock(renderMutex);
       if (stopping) {
-         return;
+         return 0;
       }
-      ++latestRenderSequence;
-      renderState->sequence = latestRenderSequence;
-      runnableTasks.clear();
-      currentRender = renderState;
-      for (const auto& node : renderState->nodes) {
-         if (node.second.remainingDependencies == 0) {
-            runnableTasks.push_back(TextureNodeRenderTask{renderState, node.first});
-         }
+      sequence = ++latestRenderSequence;
+      for (const std::shared_ptr<TextureGraphRenderState>& renderState : renderStates) {
+         renderState->sequence = sequence;
+         renderState->scheduleObserver = scheduleObserver;
+         renderState->progressObserver = progressObserver;
+         renderState->completionObserver = completionObserver;
+         renderState->passObserver = passObserver;
+         renderState->renderCache = renderCache;
       }
+      clearTasks();
+      startPass(renderStates.front(), rootTasks);
    }
-   taskAvailable.notify_all();
+   notifyWorkers(rootTasks.size());
+   return sequence;
+}
+
+void TextureRenderManager::setScheduleObserver(ScheduleObserver observer) {
+   std::lock_guard lock(renderMutex);
+   scheduleObserver = std::move(observer);
+}
+
+void TextureRenderManager::setProgressObserver(ProgressObserver observer) {
+   std::lock_guard lock(renderMutex);
+   progressObserver = std::move(observer);
+}
+
+void TextureRenderManager::setCompletionObserver(CompletionObserver observer) {
+   std::lock_guard lock(renderMutex);
+   completionObserver = std::move(observer);
+}
+
+void TextureRenderManager::setPassObserver(PassObserver observer) {
+   std::lock_guard lock(renderMutex);
+   passObserver = std::move(observer);
+}
+
+double TextureRenderManager::estimatedRemainingMilliseconds() const {
+   std::lock_guard lock(renderMutex);
+   if (!currentRender) {
+      return 0.0;
+   }
+   const std::chrono::duration<double, std::milli> elapsed =
+       std::chrono::steady_clock::now() - currentRender->started;
+   return std::max(0.0, currentRender->estimatedMilliseconds - elapsed.count()) +
+          currentRender->laterPassMilliseconds;
+}
+
+void TextureRenderManager::setRenderCache(TextureRenderCache* cache) {
+   std::lock_guard lock(renderMutex);
+   renderCache = cache;
 }
 
 void TextureRenderManager::cancel() {
    {
-      std::lock_guard lock(mutex);
+      std::lock_guard lock(renderMutex);
       ++latestRenderSequence;
-      runnableTasks.clear();
+      clearTasks();
       currentRender.reset();
    }
-   JsTexGen::interruptActiveEngines();
-   taskAvailable.notify_all();
+   interruptWorkerScripts();
+}
+
+void TextureRenderManager::interruptWorkerScripts() const {
+   std::vector<std::thread::id> threads;
+   threads.reserve(workers.size());
+   for (const std::thread& worker : workers) {
+      threads.push_back(worker.get_id());
+   }
+   JsTexGen::interruptActiveEngines(threads);
 }
 
 std::shared_ptr<TextureRenderManager::TextureGraphRenderState>
 TextureRenderManager::createGraphRenderState(TextureGraphSnapshot snapshot) {
    auto renderState = std::make_shared<TextureGraphRenderState>();
    renderState->size = snapshot.size;
+   renderState->plan = TextureRenderPlan::compile(snapshot.nodes, snapshot.plan);
+   const TextureRenderPlan& plan = *renderState->plan;
+   renderState->nodes = std::vector<TextureNodeRenderState>(plan.nodeCount());
 
    for (TextureNodeSnapshot& nodeSnapshot : snapshot.nodes) {
-      const int nodeId = nodeSnapshot.nodeId;
-      renderState->nodes.emplace(nodeId, TextureNodeRenderState{std::move(nodeSnapshot), 0, {}});
+      const auto index = static_cast<std::size_t>(plan.indexOf(nodeSnapshot.nodeId));
+      renderState->nodes[index].snapshot = std::move(nodeSnapshot);
+   }
+   for (std::size_t index = 0; index < plan.nodeCount(); ++index) {
+      TextureNodeRenderState& node = renderState->nodes[index];
+      node.remainingDependencies.store(plan.dependencyCount(index), std::memory_order_relaxed);
+      node.remainingReceivers.store(static_cast<int>(plan.receivers(index).size()),
+                                    std::memory_order_relaxed);
    }
 
-   for (auto& nodeEntry : renderState->nodes) {
-      TextureNodeRenderState& node = nodeEntry.second;
-      std::set<int> uniqueSources;
-      for (auto source = node.snapshot.sources.cbegin(); source != node.snapshot.sources.cend();
-           ++source) {
-         if (source.value() != 0 && renderState->nodes.count(source.value()) != 0) {
-            uniqueSources.insert(source.value());
-         }
-      }
-      node.remainingDependencies = static_cast<int>(uniqueSources.size());
-      for (const int sourceId : uniqueSources) {
-         renderState->nodes.at(sourceId).receivers.push_back(nodeEntry.first);
+   // The plan lists sources before receivers, so critical paths accumulate from the sinks upwards.
+   for (std::size_t index = plan.nodeCount(); index > 0; --index) {
+      TextureNodeRenderState& node = renderState->nodes[index - 1];
+      double downstreamMilliseconds = 0.0;
+      for (const int receiver : plan.receivers(index - 1)) {
+         const TextureNodeRenderState& receiverNode =
+             renderState->nodes[static_cast<std::size_t>(receiver)];
+         downstreamMilliseconds =
+             std::max(downstreamMilliseconds, receiverNode.criticalPathMilliseconds);
       }
+      node.criticalPathMilliseconds =
+          estimatedNodeMilliseconds(node.snapshot) + downstreamMilliseconds;
+      renderState->estimatedMilliseconds =
+          std::max(renderState->estimatedMilliseconds, node.criticalPathMilliseconds);
    }
 
-   renderState->unfinishedNodes = renderState->nodes.size();
+   renderState->unfinishedNodes.store(plan.nodeCount(), std::memory_order_relaxed);
    return renderState;
 }
 
-void TextureRenderManager::runWorker() {
-   for (;;) {
+std::vector<TextureRenderManager::TextureNodeRenderTask> TextureRenderManager::createRootTasks(
+    const std::shared_ptr<TextureGraphRenderState>& renderState) {
+   std::vector<TextureNodeRenderTask> rootTasks;
+   const TextureRenderPlan& plan = *renderState->plan;
+   for (std::size_t index = 0; index < plan.nodeCount(); ++index) {
+      if (plan.dependencyCount(index) == 0) {
+         rootTasks.push_back(makeTask(renderState, index));
+      }
+   }
+   // Dealing the most urgent roots first spreads them over different workers.
+   std::sort(rootTasks.begin(), rootTasks.end(),
+             [](const TextureNodeRenderTask& left, const TextureNodeRenderTask& right) {
+                return TaskPriorityLess()(right, left);
+             });
+   return rootTasks;
+}
+
+void TextureRenderManager::startPass(const std::shared_ptr<TextureGraphRenderState>& renderState,
+                                     std::vector<TextureNodeRenderTask>& rootTasks) {
+   renderState->started = std::chrono::steady_clock::now();
+   currentRender = renderState;
+   for (TextureNodeRenderTask& task : rootTasks) {
+      pushTask(nextRootQueue, std::move(task));
+      nextRootQueue = (nextRootQueue + 1) % queues.size();
+   }
+}
+
+TextureRenderManager::TextureNodeRenderTask TextureRenderManager::makeTask(
+    const std::shared_ptr<TextureGraphRenderState>& renderState, const std::size_t nodeIndex) {
+   const TextureNodeRenderState& node = renderState->nodes[nodeIndex];
+   return TextureNodeRenderTask{renderState,
+                                renderState->plan->nodeId(nodeIndex),
+                                nodeIndex,
+                                nullptr,
+                                node.criticalPathMilliseconds,
+                                renderState->plan->receivers(nodeIndex).size()};
+}
+
+bool TextureRenderManager::TaskPriorityLess::operator()(const TextureNodeRenderTask& left,
+                                                        const TextureNodeRenderTask& right) const {
+   if (left.priority != right.priority) {
+      return left.priority < right.priority;
+   }
+   if (left.fanOut != right.fanOut) {
+      return left.fanOut < right.fanOut;
+   }
+   return left.nodeId > right.nodeId;
+}
+
+void TextureRenderManager::runWorker(const std::size_t workerIndex) {
+   while (!stopping) {
       TextureNodeRenderTask task;
-      {
-         std::unique_lock lock(mutex);
-         taskAvailable.wait(lock, [this] { return stopping || !runnableTasks.empty(); });
-         if (stopping) {
-            return;
-         }
-         task = std::move(runnableTasks.front());
-         runnableTasks.pop_front();
-         if (task.renderState->sequence != latestRenderSequence || task.renderState->failed) {
-            continue;
-         }
+      if (!popTask(workerIndex, task)) {
+         std::unique_lock lock(idleMutex);
+         taskAvailable.wait(lock, [this] { return stopping || queuedTaskCount > 0; });
+         continue;
+      }
+      if (task.renderState->failed || isObsolete(task.renderState->sequence)) {
+         continue;
       }
 
       try {
-         renderNode(task);
+         if (task.regions) {
+            renderRegions(workerIndex, task);
+         } else {
+            renderNode(workerIndex, task);
+         }
       } catch (const std::exception& error) {
          failRender(task, QString::fromUtf8(error.what()));
       } catch (...) {
@@ -177,31 +334,99 @@ void TextureRenderManager::runWorker() {
    }
 }
 
-void TextureRenderManager::renderNode(const TextureNodeRenderTask& task) {
-   if (isObsolete(task.renderState->sequence)) {
+void TextureRenderManager::pushTask(const std::size_t queueIndex, TextureNodeRenderTask task) {
+   WorkerQueue& queue = *queues[queueIndex];
+   std::lock_guard lock(queue.mutex);
+   queue.tasks.push_back(std::move(task));
+   std::push_heap(queue.tasks.begin(), queue.tasks.end(), TaskPriorityLess());
+   ++queuedTaskCount;
+}
+
+bool TextureRenderManager::popTask(const std::size_t workerIndex, TextureNodeRenderTask& task) {
+   for (std::size_t offset = 0; offset < queues.size(); ++offset) {
+      WorkerQueue& queue = *queues[(workerIndex + offset) % queues.size()];
+      std::lock_guard lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+         std::pop_heap(queue.tasks.begin(), queue.tasks.end(), TaskPriorityLess());
+         task = std::move(queue.tasks.back());
+         queue.tasks.pop_back();
+         --queuedTaskCount;
+         return true;
+      }
+   }
+   return false;
+}
+
+void TextureRenderManager::clearTasks(
+    const std::shared_ptr<TextureGraphRenderState>& renderState) {
+   for (const std::unique_ptr<WorkerQueue>& queue : queues) {
+      std::lock_guard lock(queue->mutex);
+      const std::size_t previousSize = queue->tasks.size();
+      if (renderState) {
+         queue->tasks.erase(std::remove_if(queue->tasks.begin(), queue->tasks.end(),
+                                           [&renderState](const TextureNodeRenderTask& task) {
+                                              return task.renderState == renderState;
+                                           }),
+                            queue->tasks.end());
+         std::make_heap(queue->tasks.begin(), queue->tasks.end(), TaskPriorityLess());
+      } else {
+         queue->tasks.clear();
+      }
+      queuedTaskCount -= previousSize - queue->tasks.size();
+   }
+}
+
+void TextureRenderManager::notifyWorkers(const std::size_t taskCount) {
+   if (taskCount == 0) {
       return;
    }
+   {
+      // Taking the idle lock orders this wake-up after any worker's predicate check.
+      std::lock_guard lock(idleMutex);
+   }
+   if (taskCount == 1) {
+      taskAvailable.notify_one();
+   } else {
+      taskAvailable.notify_all();
+   }
+}
 
-   const TextureNodeSnapshot& snapshot = task.renderState->nodes.at(task.nodeId).snapshot;
+void TextureRenderManager::renderNode(const std::size_t workerIndex,
+                                      const TextureNodeRenderTask& task) {
+   if (task.renderState->failed || isObsolete(task.renderState->sequence)) {
+      return;
+   }
+
+   const TextureNodeSnapshot& snapshot = task.renderState->nodes[task.nodeIndex].snapshot;
    if (!snapshot.cachedImage.isNull()) {
-      completeNode(task, snapshot.cachedImage, false);
+      completeNode(workerIndex, task, snapshot.cachedImage, false, 0);
       return;
    }
    if (snapshot.generator.isNull()) {
       throw std::runtime_error("A texture node snapshot has no texture generator");
    }
-
-   QMap<QString, TextureImagePtr> sourceImages;
-   {
-      std::lock_guard lock(mutex);
-      if (stopping || task.renderState->sequence != latestRenderSequence ||
-          task.renderState->failed) {
+   TextureRenderCache* const renderCache = task.renderState->renderCache;
+   if (renderCache != nullptr && !snapshot.cacheKey.isEmpty()) {
+      const TextureImagePtr cachedImage = renderCache->find(snapshot.cacheKey);
+      if (!cachedImage.isNull()) {
+         completeNode(workerIndex, task, cachedImage, snapshot.keepImage, 0);
          return;
       }
-      for (const QString& slot : snapshot.generator->getSourceSlots()) {
-         const int sourceId = snapshot.sources.value(slot);
-         if (sourceId != 0 && task.renderState->renderedImages.contains(sourceId)) {
-            sourceImages.insert(slot, task.renderState->renderedImages.value(sourceId));
+   }
+   if (task.renderState->scheduleObserver) {
+      task.renderState->scheduleObserver(task.nodeId);
+   }
+
+   // Source images were stored before the dependency counter that made this task runnable.
+   QMap<QString, TextureImagePtr> sourceImages;
+   for (const QString& slot : snapshot.generator->getSourceSlots()) {
+      const int sourceId = snapshot.sources.value(slot);
+      const int source = sourceId != 0 ? task.renderState->plan->indexOf(sourceId) : -1;
+      if (source >= 0) {
+         const TextureImagePtr& image =
+             task.renderState->nodes[static_cast<std::size_t>(source)].image;
+         if (!image.isNull()) {
+            sourceImages.insert(slot, image);
          }
       }
    }
@@ -214,73 +439,266 @@ void TextureRenderManager::renderNode(const TextureNodeRenderTask& task) {
       }
    }
 
-   TextureImagePtr image = TextureImage::create(task.renderState->size);
-   snapshot.generator->generateWithTiming(task.renderState->size, image->data(), sourceImages,
-                                          settings);
-   completeNode(task, image, true);
+   TextureGraphRenderState& renderState = *task.renderState;
+   TextureNodeRenderState& node = renderState.nodes[task.nodeIndex];
+   const bool kept = snapshot.keepImage;
+   const QString passThroughSlot =
+       snapshot.generator->getPassThroughSlot(renderState.size, settings);
+   if (!passThroughSlot.isEmpty() && sourceImages.contains(passThroughSlot)) {
+      // The output would equal the input, so the node shares the input's image. A buffer handed
+      // on from the input's only receiver is counted once, by the node that holds it last.
+      const int source = exclusiveSource(task, passThroughSlot);
+      std::size_t heldBytes = 0;
+      if (source >= 0) {
+         TextureNodeRenderState& sourceNode = renderState.nodes[static_cast<std::size_t>(source)];
+         heldBytes = std::exchange(sourceNode.imageBytes, 0);
+         node.exclusiveImage = !kept;
+      }
+      completeNode(workerIndex, task, sourceImages.value(passThroughSlot), kept, heldBytes);
+      return;
+   }
+
+   TextureImagePtr image;
+   std::size_t imageBytes = 0;
+   const QString inPlaceSlot = snapshot.generator->getInPlaceSlot();
+   const int inPlaceSource = inPlaceSlot.isEmpty() ? -1 : exclusiveSource(task, inPlaceSlot);
+   if (inPlaceSource >= 0) {
+      // Nothing else reads the input, so the generator renders over its pixels.
+      TextureNodeRenderState& sourceNode =
+          renderState.nodes[static_cast<std::size_t>(inPlaceSource)];
+      image = sourceImages.value(inPlaceSlot);
+      imageBytes = std::exchange(sourceNode.imageBytes, 0);
+   } else {
+      image = TextureImage::create(renderState.size,
+                                   snapshot.generator->writesEveryPixel()
+                                       ? TextureImage::Initialization::Uninitialized
+                                       : TextureImage::Initialization::Zeroed);
+      imageBytes = image->byteSize();
+      holdImageBytes(renderState, imageBytes);
+   }
+   node.exclusiveImage = !kept;
+   if (shouldTile(*snapshot.generator, renderState.size)) {
+      auto regions = std::make_shared<TextureRegionRenderState>();
+      regions->image = std::move(image);
+      regions->imageBytes = imageBytes;
+      regions->sourceImages = std::move(sourceImages);
+      regions->settings = std::move(settings);
+      regions->started = std::chrono::steady_clock::now();
+      startRegionPass(workerIndex, task, std::move(regions));
+      return;
+   }
+   snapshot.generator->generateWithTiming(renderState.size, image->data(), sourceImages, settings);
+   if (renderCache != nullptr && kept) {
+      renderCache->insert(snapshot.cacheKey, image);
+   }
+   completeNode(workerIndex, task, image, kept, imageBytes);
 }
 
-void TextureRenderManager::completeNode(const TextureNodeRenderTask& task,
-                                        const TextureImagePtr& image, const bool publish) {
-   bool runnableTasksAdded = false;
-   {
-      std::lock_guard lock(mutex);
-      if (stopping || task.renderState->sequence != latestRenderSequence ||
-          task.renderState->failed) {
+bool TextureRenderManager::shouldTile(const TextureGenerator& generator, const QSize size) const {
+   const std::size_t pixelCount =
+       static_cast<std::size_t>(size.width()) * static_cast<std::size_t>(size.height());
+   return queues.size() > 1 && pixelCount >= minimumTiledPixelCount && generator.supportsTiling();
+}
+
+void TextureRenderManager::startRegionPass(const std::size_t workerIndex,
+                                           const TextureNodeRenderTask& task,
+                                           std::shared_ptr<TextureRegionRenderState> regions) {
+   const TextureNodeSnapshot& snapshot = task.renderState->nodes[task.nodeIndex].snapshot;
+   const int maximumRegionCount = static_cast<int>(queues.size() * regionsPerWorker);
+   regions->regions = snapshot.generator->getTilingRegions(task.renderState->size, regions->pass,
+                                                           maximumRegionCount);
+   if (regions->regions.isEmpty()) {
+      throw std::runtime_error("A tiled texture generator returned no regions");
+   }
+   regions->remainingRegions = static_cast<std::size_t>(regions->regions.size());
+
+   TextureNodeRenderTask regionTask = task;
+   regionTask.regions = std::move(regions);
+   const std::size_t helperCount =
+       std::min(static_cast<std::size_t>(regionTask.regions->regions.size()), queues.size()) - 1;
+   for (std::size_t helper = 0; helper < helperCount; ++helper) {
+      pushTask(workerIndex, regionTask);
+   }
+   notifyWorkers(helperCount);
+   renderRegions(workerIndex, regionTask);
+}
+
+void TextureRenderManager::renderRegions(const std::size_t workerIndex,
+                                         const TextureNodeRenderTask& task) {
+   TextureRegionRenderState& regions = *task.regions;
+   const TextureNodeSnapshot& snapshot = task.renderState->nodes[task.nodeIndex].snapshot;
+   const auto regionCount = static_cast<std::size_t>(regions.regions.size());
+   for (;;) {
+      if (task.renderState->failed || isObsolete(task.renderState->sequence)) {
+         return;
+      }
+      const std::size_t index = regions.nextRegion.fetch_add(1);
+      if (index >= regionCount) {
          return;
       }
+      snapshot.generator->generateRegion(task.renderState->size, regions.pass,
+                                         regions.regions.at(static_cast<qsizetype>(index)),
+                                         regions.image->data(), regions.sourceImages,
+                                         regions.settings);
+      if (regions.remainingRegions.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+         continue;
+      }
 
-      task.renderState->renderedImages.insert(task.nodeId, image);
-      const TextureNodeRenderState& completedNode = task.renderState->nodes.at(task.nodeId);
-      for (const int receiverId : completedNode.receivers) {
-         TextureNodeRenderState& receiver = task.renderState->nodes.at(receiverId);
-         --receiver.remainingDependencies;
-         if (receiver.remainingDependencies == 0) {
-            runnableTasks.push_back(TextureNodeRenderTask{task.renderState, receiverId});
-            runnableTasksAdded = true;
-         }
+      // This worker finished the last region of the pass.
+      if (regions.pass + 1 < snapshot.generator->getTilingPassCount()) {
+         auto nextPass = std::make_shared<TextureRegionRenderState>();
+         nextPass->image = regions.image;
+         nextPass->imageBytes = regions.imageBytes;
+         nextPass->sourceImages = regions.sourceImages;
+         nextPass->settings = regions.settings;
+         nextPass->pass = regions.pass + 1;
+         nextPass->started = regions.started;
+         startRegionPass(workerIndex, task, std::move(nextPass));
+         return;
+      }
+      const auto elapsed = std::chrono::steady_clock::now() - regions.started;
+      snapshot.generator->recordGenerationTime(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+      if (task.renderState->renderCache != nullptr && snapshot.keepImage) {
+         task.renderState->renderCache->insert(snapshot.cacheKey, regions.image);
       }
+      completeNode(workerIndex, task, regions.image, snapshot.keepImage, regions.imageBytes);
+      return;
+   }
+}
+
+void TextureRenderManager::completeNode(const std::size_t workerIndex,
+                                        const TextureNodeRenderTask& task,
+                                        const TextureImagePtr& image, const bool publish,
+                                        const std::size_t heldBytes) {
+   TextureGraphRenderState& renderState = *task.renderState;
+   if (renderState.failed || isObsolete(renderState.sequence)) {
+      return;
+   }
 
-      if (task.renderState->unfinishedNodes > 0) {
-         --task.renderState->unfinishedNodes;
+   TextureNodeRenderState& completedNode = renderState.nodes[task.nodeIndex];
+   const TextureRenderPlan::IndexRange receivers = renderState.plan->receivers(task.nodeIndex);
+   const std::size_t imageBytes = image.isNull() ? 0 : image->byteSize();
+   holdImageBytes(renderState, imageBytes - std::min(heldBytes, imageBytes));
+   renderState.totalImageBytes.fetch_add(imageBytes, std::memory_order_relaxed);
+   // The result handler keeps a published image, so its bytes are never released by the pass.
+   const std::size_t releasedBytes = publish ? 0 : imageBytes;
+   if (receivers.empty()) {
+      // Nothing in the pass reads a sink.
+      releaseImageBytes(renderState, releasedBytes);
+   } else {
+      completedNode.image = image;
+      completedNode.imageBytes = releasedBytes;
+   }
+   std::size_t runnableTaskCount = 0;
+   for (const int receiverIndex : receivers) {
+      const auto receiver = static_cast<std::size_t>(receiverIndex);
+      if (renderState.nodes[receiver].remainingDependencies.fetch_sub(
+              1, std::memory_order_acq_rel) == 1) {
+         pushTask(workerIndex, makeTask(task.renderState, receiver));
+         ++runnableTaskCount;
+      }
+   }
+   // Every receiver copied its source images before finishing, so the last one drops them.
+   for (const int sourceIndex : renderState.plan->sources(task.nodeIndex)) {
+      TextureNodeRenderState& source = renderState.nodes[static_cast<std::size_t>(sourceIndex)];
+      if (source.remainingReceivers.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+          !source.image.isNull()) {
+         releaseImageBytes(renderState, std::exchange(source.imageBytes, 0));
+         source.image.reset();
+      }
+   }
+
+   const std::size_t unfinishedNodes =
+       renderState.unfinishedNodes.fetch_sub(1, std::memory_order_acq_rel) - 1;
+   if (unfinishedNodes == 0) {
+      std::vector<TextureNodeRenderTask> nextRootTasks;
+      if (renderState.nextPass) {
+         nextRootTasks = createRootTasks(renderState.nextPass);
       }
-      if (task.renderState->unfinishedNodes == 0 && currentRender == task.renderState) {
+      std::lock_guard lock(renderMutex);
+      if (currentRender == task.renderState) {
          currentRender.reset();
+         if (renderState.nextPass) {
+            runnableTaskCount += nextRootTasks.size();
+            startPass(renderState.nextPass, nextRootTasks);
+         }
       }
    }
 
-   if (runnableTasksAdded) {
-      taskAvailable.notify_all();
+   // This worker continues with one of the new tasks, so only the others need other workers.
+   if (runnableTaskCount > 1) {
+      notifyWorkers(runnableTaskCount - 1);
    }
-   if (publish && resultHandler && !isObsolete(task.renderState->sequence)) {
-      const TextureNodeSnapshot& snapshot = task.renderState->nodes.at(task.nodeId).snapshot;
+   if (publish && resultHandler && !isObsolete(renderState.sequence)) {
+      const TextureNodeSnapshot& snapshot = completedNode.snapshot;
       resultHandler(
-          TextureRenderResult{snapshot.nodeId, snapshot.revision, task.renderState->size, image});
+          TextureRenderResult{snapshot.nodeId, snapshot.revision, renderState.size, image});
+   }
+   if (renderState.progressObserver && !isObsolete(renderState.sequence)) {
+      renderState.progressObserver(renderState.nodes.size() - unfinishedNodes,
+                                   renderState.nodes.size());
+   }
+   if (unfinishedNodes == 0 && renderState.passObserver && !isObsolete(renderState.sequence)) {
+      renderState.passObserver(TextureRenderPassStatistics{
+          renderState.sequence, renderState.size, renderState.nodes.size(),
+          renderState.peakImageBytes.load(std::memory_order_relaxed),
+          renderState.totalImageBytes.load(std::memory_order_relaxed)});
+   }
+   if (unfinishedNodes == 0 && !renderState.nextPass && renderState.completionObserver &&
+       !isObsolete(renderState.sequence)) {
+      renderState.completionObserver(renderState.sequence);
    }
 }
 
+int TextureRenderManager::exclusiveSource(const TextureNodeRenderTask& task, const QString& slot) {
+   const TextureGraphRenderState& renderState = *task.renderState;
+   const QMap<QString, int>& sources = renderState.nodes[task.nodeIndex].snapshot.sources;
+   const int sourceId = sources.value(slot);
+   const int source = sourceId != 0 ? renderState.plan->indexOf(sourceId) : -1;
+   if (source < 0 || std::count(sources.cbegin(), sources.cend(), sourceId) != 1 ||
+       renderState.plan->receivers(static_cast<std::size_t>(source)).size() != 1) {
+      return -1;
+   }
+   const TextureNodeRenderState& sourceNode = renderState.nodes[static_cast<std::size_t>(source)];
+   return sourceNode.exclusiveImage && !sourceNode.image.isNull() ? source : -1;
+}
+
+void TextureRenderManager::holdImageBytes(TextureGraphRenderState& renderState,
+                                          const std::size_t bytes) {
+   const std::size_t held =
+       renderState.imageBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+   std::size_t peak = renderState.peakImageBytes.load(std::memory_order_relaxed);
+   while (held > peak && !renderState.peakImageBytes.compare_exchange_weak(
+                             peak, held, std::memory_order_relaxed)) {
+   }
+}
+
+void TextureRenderManager::releaseImageBytes(TextureGraphRenderState& renderState,
+                                             const std::size_t bytes) {
+   renderState.imageBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
 void TextureRenderManager::failRender(const TextureNodeRenderTask& task, QString message) {
-   bool reportFailure = false;
+   if (isObsolete(task.renderState->sequence) || task.renderState->failed.exchange(true)) {
+      return;
+   }
    {
-      std::lock_guard lock(mutex);
-      if (stopping || task.renderState->sequence != latestRenderSequence ||
-          task.renderState->failed) {
-         return;
-      }
-      task.renderState->failed = true;
-      runnableTasks.clear();
+      std::lock_guard lock(renderMutex);
+      clearTasks(task.renderState);
       if (currentRender == task.renderState) {
          currentRender.reset();
       }
-      reportFailure = true;
    }
 
-   if (reportFailure && failureHandler) {
+   if (failureHandler) {
       failureHandler(TextureRenderFailure{task.nodeId, task.renderState->size, std::move(message)});
    }
+   if (task.renderState->completionObserver) {
+      task.renderState->completionObserver(task.renderState->sequence);
+   }
 }
 
 bool TextureRenderManager::isObsolete(const std::uint64_t sequence) const {
-   std::lock_guard lock(mutex);
    return stopping || sequence != latestRenderSequence;
 }
@@ -9,20 +9,26 @@
 #include "base/texturegenerator.h"
 #include "global.h"
 #include "textureimage.h"
+#include <QByteArray>
+#include <QList>
 #include <QMap>
+#include <QRect>
 #include <QSize>
 #include <QString>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
+class TextureRenderCache;
+class TextureRenderPlan;
+
 /// @brief A copy of the state needed to render one texture node.
 struct TextureNodeSnapshot {
    /// @brief ID of the node represented by this snapshot.
@@ -37,6 +43,12 @@ struct TextureNodeSnapshot {
    QMap<QString, int> sources;
    /// @brief Cached image for the current render size, if available.
    TextureImagePtr cachedImage;
+   /// @brief Content key shared through TextureRenderCache, or empty if the image is not cacheable.
+   QByteArray cacheKey;
+   /// @brief Whether the rendered image is handed to the result handler and the render cache.
+   /// @details The render owns an image that is kept by neither, so the node's only receiver may
+   /// render over its pixels in place.
+   bool keepImage = true;
 };
 
 /// @brief A copy of the graph state used for one render.
@@ -45,6 +57,9 @@ struct TextureGraphSnapshot {
    QSize size;
    /// @brief Node states used by this graph render.
    std::vector<TextureNodeSnapshot> nodes;
+   /// @brief Compiled plan of the project graph the nodes were taken from, or null.
+   /// @details The render derives its own plan from the plan instead of sorting the nodes again.
+   std::shared_ptr<const TextureRenderPlan> plan;
 };
 
 /// @brief A rendered texture image with the node state used to produce it.
@@ -69,10 +84,40 @@ struct TextureRenderFailure {
    QString message;
 };
 
+/// @brief Memory held by one finished graph render pass.
+struct TextureRenderPassStatistics {
+   /// @brief Number identifying the render the pass belongs to.
+   std::uint64_t sequence = 0;
+   /// @brief Width and height of the images produced by the pass.
+   QSize size;
+   /// @brief Number of nodes in the pass.
+   std::size_t nodeCount = 0;
+   /// @brief Largest total size in bytes of the images the pass held at once.
+   /// @details Images handed to the result handler count until the pass ends, because the handler
+   /// keeps them.
+   std::size_t peakImageBytes = 0;
+   /// @brief Total size in bytes of the node images the pass held, which it would hold at once if
+   /// images were kept until the pass ends.
+   std::size_t totalImageBytes = 0;
+};
+
 /// @brief Keeps the newest graph render and runs unblocked nodes on an owned worker pool.
-/// @details A new render replaces older queued work. A node becomes runnable after all its source
-/// nodes finish, so independent graph branches can render at the same time. Destruction cancels
-/// queued work, wakes the workers, and joins them.
+/// @details A new render replaces older queued work, and may consist of passes at different sizes
+/// that run one after another. Each pass runs a TextureRenderPlan of its nodes, indexed densely in
+/// topological order. A node becomes runnable after all its source nodes finish, so
+/// independent graph branches can render at the same time. Each worker owns a
+/// task queue ordered by priority: it runs its own most urgent task first and steals the most
+/// urgent task of another worker when its queue is empty. A task's priority is the estimated cost
+/// of the longest chain of nodes from it to a sink, based on each generator's recent timing, with
+/// receiver fan-out breaking ties. The render drops a node's image as soon as the last receiver
+/// in the plan finishes, and only hands a sink's image to the result handler. Images pinned by a
+/// node cache, the render cache, or a view stay alive through their own references; every other
+/// buffer goes back to TextureImagePool for the next node to reuse. Large images from generators
+/// that support tiling are split into regions that idle workers render together. Destruction
+/// cancels queued work, wakes the workers, and joins them.
+/// A node whose generator reports a pass-through input shares that input's image instead of
+/// rendering, and a generator that renders in place takes over its input's buffer when the render
+/// owns the only reference to it.
 class TextureRenderManager final {
 public:
    /// @brief Function called when a node image is ready.
@@ -81,9 +126,22 @@ public:
    /// @brief Function called when a render error occurs.
    using FailureHandler = std::function<void(TextureRenderFailure)>;
 
-   /// @brief Starts the render manager's bounded worker pool.
+   /// @brief Debug function called on a worker thread each time a node starts rendering.
+   using ScheduleObserver = std::function<void(int nodeId)>;
+
+   /// @brief Function called on a worker thread each time a node of a graph render finishes.
+   using ProgressObserver = std::function<void(std::size_t finishedNodes, std::size_t nodeCount)>;
+
+   /// @brief Function called on a worker thread when a graph render finished every node or failed.
+   using CompletionObserver = std::function<void(std::uint64_t sequence)>;
+
+   /// @brief Function called on a worker thread when a pass of a graph render finished every node.
+   using PassObserver = std::function<void(const TextureRenderPassStatistics& statistics)>;
+
+   /// @brief Starts the render manager's worker pool.
    /// @param resultHandler Receives successfully generated images from worker threads.
    /// @param failureHandler Receives render errors.
+   /// @param workerCount Number of worker threads, or zero to use defaultWorkerCount().
    TextureRenderManager(ResultHandler resultHandler, FailureHandler failureHandler,
                         std::size_t workerCount = 0);
 
@@ -104,20 +162,94 @@ public:
 
    /// @brief Starts a graph render and replaces any older queued render.
    /// @param snapshot The fixed graph state to render.
-   void render(TextureGraphSnapshot snapshot);
+   /// @return Number identifying the render in completion notifications, or zero if it did not
+   /// start.
+   std::uint64_t render(TextureGraphSnapshot snapshot);
+
+   /// @brief Starts a graph render made of passes at different sizes and replaces any older render.
+   /// @details The passes render one after another, so a quick pass at a small size can show
+   /// results before a pass at the full size starts. Each pass publishes its results at its own
+   /// size and reports its own progress; the completion hook runs once, after the last pass or
+   /// when a pass fails. Passes without nodes are skipped unless every pass is empty.
+   /// @param passes The fixed graph states to render, in order.
+   /// @return Number identifying the render in completion notifications, or zero if it did not
+   /// start.
+   std::uint64_t render(std::vector<TextureGraphSnapshot> passes);
 
    /// @brief Cancels queued work and asks active work to stop between nodes.
    void cancel();
 
+   /// @brief Sets a debug hook that observes the order in which nodes start rendering.
+   /// @details The hook applies to renders started after the call. It runs on worker threads and
+   /// must not call back into the render manager.
+   /// @param observer Function receiving each node ID, or an empty function to remove the hook.
+   void setScheduleObserver(ScheduleObserver observer);
+
+   /// @brief Sets a hook that observes how many nodes of each graph render have finished.
+   /// @details Nodes completed from a cached image count as finished. The hook applies to renders
+   /// started after the call, runs on worker threads, and must not call back into the render
+   /// manager.
+   /// @param observer Function receiving the finished and total node counts, or an empty
+   /// function to remove the hook.
+   void setProgressObserver(ProgressObserver observer);
+
+   /// @brief Sets a hook that observes when graph renders end.
+   /// @details Renders that are replaced or cancelled before they end are not reported. The hook
+   /// applies to renders started after the call, runs on worker threads, and must not call back
+   /// into the render manager.
+   /// @param observer Function receiving the number returned by render(), or an empty function
+   /// to remove the hook.
+   void setCompletionObserver(CompletionObserver observer);
+
+   /// @brief Sets a hook that receives the image memory held by each finished render pass.
+   /// @details Passes that fail, are replaced, or are cancelled are not reported. The hook applies
+   /// to renders started after the call, runs on worker threads, and must not call back into the
+   /// render manager.
+   /// @param observer Function receiving the statistics of a pass, or an empty function to
+   /// remove the hook.
+   void setPassObserver(PassObserver observer);
+
+   /// @brief Estimates how long the newest graph render still needs to finish.
+   /// @details The estimate is the running pass's longest chain of recent generator timings minus
+   /// the time since it started, plus the longest chains of the passes after it.
+   /// @return Milliseconds, or zero when no render is active.
+   [[nodiscard]] double estimatedRemainingMilliseconds() const;
+
+   /// @brief Sets the cache shared by nodes whose snapshots carry a content key.
+   /// @details Nodes found in the cache complete without rendering, and rendered nodes are added
+   /// to it. The cache applies to renders started after the call and must outlive them.
+   /// @param cache Non-owning cache pointer, or null to render every node.
+   void setRenderCache(TextureRenderCache* cache);
+
+   /// @brief Returns the number of worker threads owned by the render manager.
+   [[nodiscard]] std::size_t getWorkerCount() const noexcept { return workers.size(); }
+
+   /// @brief Returns the worker count used when the constructor receives zero.
+   /// @return The hardware thread count, or one when it cannot be determined.
+   [[nodiscard]] static std::size_t defaultWorkerCount();
+
 private:
    /// @brief Tracks one node and the source nodes that still need to finish.
    struct TextureNodeRenderState {
       /// @brief Render state copied from the node.
       TextureNodeSnapshot snapshot;
-      /// @brief Number of unfinished source nodes.
-      int remainingDependencies = 0;
-      /// @brief IDs of nodes that use this node as a source.
-      std::vector<int> receivers;
+      /// @brief Number of unfinished source nodes, decremented by completing sources without
+      /// locking.
+      std::atomic<int> remainingDependencies{0};
+      /// @brief Number of receivers that have not finished, after which the image is released.
+      std::atomic<int> remainingReceivers{0};
+      /// @brief Image available to receivers, written before they become runnable and released
+      /// after the last of them finishes; sinks never store their image.
+      TextureImagePtr image;
+      /// @brief Size of the image released with it, or zero when another node counts the buffer
+      /// or the result handler keeps it.
+      std::size_t imageBytes = 0;
+      /// @brief Whether the render holds the only reference to the image, written before the
+      /// receivers become runnable.
+      bool exclusiveImage = false;
+      /// @brief Estimated milliseconds from the start of this node to the end of its slowest
+      /// downstream chain.
+      double criticalPathMilliseconds = 0.0;
    };
 
    /// @brief Tracks the shared state of one graph render.
@@ -126,14 +258,62 @@ private:
       std::uint64_t sequence = 0;
       /// @brief Width and height of the images produced by this graph render.
       QSize size;
-      /// @brief Per-node render state stored by node ID.
-      std::map<int, TextureNodeRenderState> nodes;
-      /// @brief Images available to downstream nodes, stored by node ID.
-      QMap<int, TextureImagePtr> renderedImages;
+      /// @brief Order and connections of the nodes.
+      std::shared_ptr<const TextureRenderPlan> plan;
+      /// @brief Per-node render state stored by plan index; the vector is not resized after
+      /// creation.
+      std::vector<TextureNodeRenderState> nodes;
       /// @brief Number of nodes that have not finished rendering.
-      std::size_t unfinishedNodes = 0;
+      std::atomic<std::size_t> unfinishedNodes{0};
       /// @brief Whether rendering stopped because one node failed.
-      bool failed = false;
+      std::atomic<bool> failed{false};
+      /// @brief Debug hook captured when the render started.
+      ScheduleObserver scheduleObserver;
+      /// @brief Progress hook captured when the render started.
+      ProgressObserver progressObserver;
+      /// @brief Completion hook captured when the render started.
+      CompletionObserver completionObserver;
+      /// @brief Pass statistics hook captured when the render started.
+      PassObserver passObserver;
+      /// @brief Bytes of the images held by the pass: images being rendered, images kept for
+      /// receivers that have not finished, and images handed to the result handler.
+      std::atomic<std::size_t> imageBytes{0};
+      /// @brief Largest value imageBytes has reached.
+      std::atomic<std::size_t> peakImageBytes{0};
+      /// @brief Bytes of every node image the pass has held.
+      std::atomic<std::size_t> totalImageBytes{0};
+      /// @brief Time the render started.
+      std::chrono::steady_clock::time_point started;
+      /// @brief Estimated milliseconds of the longest chain of nodes in the render.
+      double estimatedMilliseconds = 0.0;
+      /// @brief Estimated milliseconds of the passes that follow this one.
+      double laterPassMilliseconds = 0.0;
+      /// @brief Pass started when this one finishes, or null for the last pass.
+      std::shared_ptr<TextureGraphRenderState> nextPass;
+      /// @brief Content-addressed cache captured when the render started, or null.
+      TextureRenderCache* renderCache = nullptr;
+   };
+
+   /// @brief Tracks one pass of a node whose image is rendered as regions on several workers.
+   struct TextureRegionRenderState {
+      /// @brief Destination image shared by every region.
+      TextureImagePtr image;
+      /// @brief Size of the destination image counted as held for the node.
+      std::size_t imageBytes = 0;
+      /// @brief Source images keyed by input slot.
+      QMap<QString, TextureImagePtr> sourceImages;
+      /// @brief Generator settings with defaults filled in.
+      TextureNodeSettings settings;
+      /// @brief Zero-based tiling pass.
+      int pass = 0;
+      /// @brief Regions of this pass, fixed before any worker claims one.
+      QList<QRect> regions;
+      /// @brief Index of the next region a worker can claim.
+      std::atomic<std::size_t> nextRegion{0};
+      /// @brief Number of regions that have not finished rendering.
+      std::atomic<std::size_t> remainingRegions{0};
+      /// @brief Time the first pass started, used for generator timing.
+      std::chrono::steady_clock::time_point started;
    };
 
    /// @brief Contains a node task that a worker can run.
@@ -142,26 +322,134 @@ private:
       std::shared_ptr<TextureGraphRenderState> renderState;
       /// @brief ID of the node to render.
       int nodeId = 0;
+      /// @brief Plan index of the node to render.
+      std::size_t nodeIndex = 0;
+      /// @brief Tiling pass to help with, or null for a node that has not started.
+      std::shared_ptr<TextureRegionRenderState> regions;
+      /// @brief Critical-path estimate of the node, copied for queue ordering.
+      double priority = 0.0;
+      /// @brief Number of receivers of the node, used to order tasks with equal priority.
+      std::size_t fanOut = 0;
+   };
+
+   /// @brief Orders tasks so that the most urgent task is at the top of a heap.
+   struct TaskPriorityLess {
+      /// @brief Compares two queued tasks.
+      /// @return @c true if @p left is less urgent than @p right.
+      bool operator()(const TextureNodeRenderTask& left, const TextureNodeRenderTask& right) const;
+   };
+
+   /// @brief Runnable tasks owned by one worker and stolen by idle workers.
+   struct WorkerQueue {
+      /// @brief Protects the task heap.
+      std::mutex mutex;
+      /// @brief Binary heap of tasks ordered by TaskPriorityLess.
+      std::vector<TextureNodeRenderTask> tasks;
    };
 
    /// @brief Builds dependency state for a graph render.
+   /// @details Dependency counts and receivers come from the compiled plan, so only the node
+   /// states are allocated.
    /// @param snapshot The graph snapshot to prepare for rendering.
    /// @return Shared state used by active node render tasks.
    static std::shared_ptr<TextureGraphRenderState> createGraphRenderState(
        TextureGraphSnapshot snapshot);
 
+   /// @brief Creates the tasks of the nodes without unfinished sources, most urgent first.
+   /// @param renderState The graph render whose nodes are checked.
+   /// @return Tasks ready to be queued.
+   static std::vector<TextureNodeRenderTask> createRootTasks(
+       const std::shared_ptr<TextureGraphRenderState>& renderState);
+
+   /// @brief Makes a graph render pass the current one and queues its root tasks.
+   /// @details The caller must hold renderMutex and wake the workers afterwards.
+   /// @param renderState The pass to start.
+   /// @param rootTasks Tasks created by createRootTasks() for the pass.
+   void startPass(const std::shared_ptr<TextureGraphRenderState>& renderState,
+                  std::vector<TextureNodeRenderTask>& rootTasks);
+
    /// @brief Waits for runnable tasks and catches exceptions before they leave the worker thread.
-   void runWorker();
+   /// @param workerIndex Index of the worker's own task queue.
+   void runWorker(std::size_t workerIndex);
+
+   /// @brief Adds a runnable task to a worker queue without waking any worker.
+   /// @param queueIndex Index of the queue that receives the task.
+   /// @param task The task to add.
+   void pushTask(std::size_t queueIndex, TextureNodeRenderTask task);
+
+   /// @brief Takes the most urgent task from a worker's own queue or steals one from another queue.
+   /// @param workerIndex Index of the calling worker.
+   /// @param task Destination for the task.
+   /// @return @c true if a task was taken.
+   bool popTask(std::size_t workerIndex, TextureNodeRenderTask& task);
+
+   /// @brief Removes queued tasks, or only the tasks belonging to one graph render.
+   /// @param renderState Render whose tasks are removed, or null to remove every task.
+   void clearTasks(const std::shared_ptr<TextureGraphRenderState>& renderState = nullptr);
+
+   /// @brief Wakes idle workers after tasks were queued.
+   /// @param taskCount Number of tasks that became runnable.
+   void notifyWorkers(std::size_t taskCount);
 
    /// @brief Renders one node after all its source nodes finish.
+   /// @param workerIndex Index of the worker running the task.
    /// @param task The graph render and node ID to process.
-   void renderNode(const TextureNodeRenderTask& task);
+   void renderNode(std::size_t workerIndex, const TextureNodeRenderTask& task);
+
+   /// @brief Creates a queue task for a node of a graph render.
+   /// @param renderState The graph render that owns the node.
+   /// @param nodeIndex Plan index of the node.
+   /// @return A task carrying the node's priority.
+   static TextureNodeRenderTask makeTask(
+       const std::shared_ptr<TextureGraphRenderState>& renderState, std::size_t nodeIndex);
+
+   /// @brief Checks whether a node image is large enough to split into regions.
+   /// @param generator The generator that renders the node.
+   /// @param size Width and height of the image.
+   /// @return @c true if the image should be rendered as regions on several workers.
+   [[nodiscard]] bool shouldTile(const TextureGenerator& generator, QSize size) const;
+
+   /// @brief Splits one tiling pass into regions, queues helper tasks, and renders regions.
+   /// @param workerIndex Index of the worker starting the pass.
+   /// @param task The node render task.
+   /// @param regions State of the pass to start.
+   void startRegionPass(std::size_t workerIndex, const TextureNodeRenderTask& task,
+                        std::shared_ptr<TextureRegionRenderState> regions);
+
+   /// @brief Claims and renders regions of a pass until none remain.
+   /// @details The worker that finishes the last region starts the next pass or completes the
+   /// node, so no worker waits for another.
+   /// @param workerIndex Index of the worker rendering regions.
+   /// @param task Task whose regions member identifies the pass.
+   void renderRegions(std::size_t workerIndex, const TextureNodeRenderTask& task);
+
+   /// @brief Counts image bytes the pass holds and records a new peak.
+   /// @param renderState The pass holding the image.
+   /// @param bytes Size of the image.
+   static void holdImageBytes(TextureGraphRenderState& renderState, std::size_t bytes);
+
+   /// @brief Stops counting image bytes the pass no longer holds.
+   /// @param renderState The pass that held the image.
+   /// @param bytes Size of the image.
+   static void releaseImageBytes(TextureGraphRenderState& renderState, std::size_t bytes);
 
    /// @brief Stores an available image and queues newly unblocked receiver nodes.
+   /// @details The images of the node's sources are released when this node was their last
+   /// unfinished receiver. A published image stays counted as held until the pass ends.
+   /// @param workerIndex Index of the worker whose queue receives unblocked nodes.
    /// @param task The completed node render task.
    /// @param image The generated or cached image.
    /// @param publish Whether to send the image to the result handler.
-   void completeNode(const TextureNodeRenderTask& task, const TextureImagePtr& image, bool publish);
+   /// @param heldBytes Bytes of the image the pass already counts for this node.
+   void completeNode(std::size_t workerIndex, const TextureNodeRenderTask& task,
+                     const TextureImagePtr& image, bool publish, std::size_t heldBytes);
+
+   /// @brief Finds a source whose image a node may take over instead of copying it.
+   /// @param task The node render task.
+   /// @param slot Input slot of the node.
+   /// @return Plan index of the source connected to @p slot when the render holds the only
+   /// reference to its image, this node is its only receiver, and no other slot reads it; or -1.
+   [[nodiscard]] static int exclusiveSource(const TextureNodeRenderTask& task, const QString& slot);
 
    /// @brief Stops the current graph render and reports its first failure.
    /// @param task The failed node render task.
@@ -173,22 +461,41 @@ private:
    /// @return @c true if work on the render should stop.
    [[nodiscard]] bool isObsolete(std::uint64_t sequence) const;
 
+   /// @brief Interrupts JavaScript running on this render manager's worker threads.
+   void interruptWorkerScripts() const;
+
    /// @brief Callback used to return completed images.
    ResultHandler resultHandler;
    /// @brief Callback used to report render errors.
    FailureHandler failureHandler;
-   /// @brief Protects the task queue and shared render state.
-   mutable std::mutex mutex;
+   /// @brief Serializes render starts, cancellation, and the state copied into new renders.
+   mutable std::mutex renderMutex;
+   /// @brief Protects idle-worker waits so queued tasks cannot be missed.
+   std::mutex idleMutex;
    /// @brief Signals that a task can run or shutdown has started.
    std::condition_variable taskAvailable;
-   /// @brief Node tasks whose source dependencies have finished.
-   std::deque<TextureNodeRenderTask> runnableTasks;
+   /// @brief Per-worker queues of node tasks whose source dependencies have finished.
+   std::vector<std::unique_ptr<WorkerQueue>> queues;
+   /// @brief Total number of tasks in all worker queues.
+   std::atomic<std::size_t> queuedTaskCount{0};
+   /// @brief Queue that receives the next root task of a new render.
+   std::size_t nextRootQueue = 0;
+   /// @brief Debug hook copied into each new graph render.
+   ScheduleObserver scheduleObserver;
+   /// @brief Progress hook copied into each new graph render.
+   ProgressObserver progressObserver;
+   /// @brief Completion hook copied into each new graph render.
+   CompletionObserver completionObserver;
+   /// @brief Pass statistics hook copied into each new graph render.
+   PassObserver passObserver;
+   /// @brief Content-addressed cache copied into each new graph render, or null.
+   TextureRenderCache* renderCache = nullptr;
    /// @brief Newest graph render, or null when no render is active.
    std::shared_ptr<TextureGraphRenderState> currentRender;
    /// @brief Sequence number used to reject older renders.
-   std::uint64_t latestRenderSequence = 0;
+   std::atomic<std::uint64_t> latestRenderSequence{0};
    /// @brief Whether the render manager is shutting down.
-   bool stopping = false;
+   std::atomic<bool> stopping{false};
    /// @brief Worker threads owned by the render manager.
    std::vector<std::thread> workers;
 };
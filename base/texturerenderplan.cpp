@@ -0,0 +1,153 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "texturerenderplan.h"
+#include "texturegraphtopology.h"
+#include "texturerendermanager.h"
+#include <QHash>
+#include <QList>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+TextureRenderPlan::TextureRenderPlan(std::vector<int> orderedIds,
+                                     const std::vector<std::pair<int, int>>& edges,
+                                     const std::uint64_t revision)
+    : nodeIds(std::move(orderedIds)), revision(revision) {
+   const std::size_t count = nodeIds.size();
+   indices.reserve(static_cast<qsizetype>(count));
+   for (std::size_t index = 0; index < count; ++index) {
+      indices.insert(nodeIds[index], static_cast<int>(index));
+   }
+   std::vector<std::pair<int, int>> indexEdges;
+   indexEdges.reserve(edges.size());
+   for (const auto& [sourceId, receiverId] : edges) {
+      indexEdges.emplace_back(indices.value(sourceId), indices.value(receiverId));
+   }
+   // Filling the rows from edges sorted by source keeps both the receiver and the source rows
+   // in ascending order.
+   std::sort(indexEdges.begin(), indexEdges.end());
+   receiverOffsets.assign(count + 1, 0);
+   sourceOffsets.assign(count + 1, 0);
+   for (const auto& [source, receiver] : indexEdges) {
+      ++receiverOffsets[static_cast<std::size_t>(source) + 1];
+      ++sourceOffsets[static_cast<std::size_t>(receiver) + 1];
+   }
+   std::partial_sum(receiverOffsets.begin(), receiverOffsets.end(), receiverOffsets.begin());
+   std::partial_sum(sourceOffsets.begin(), sourceOffsets.end(), sourceOffsets.begin());
+   receiverIndices.resize(indexEdges.size());
+   sourceIndices.resize(indexEdges.size());
+   std::vector<int> nextReceiver(receiverOffsets.cbegin(), receiverOffsets.cend() - 1);
+   std::vector<int> nextSource(sourceOffsets.cbegin(), sourceOffsets.cend() - 1);
+   for (const auto& [source, receiver] : indexEdges) {
+      receiverIndices[static_cast<std::size_t>(nextReceiver[source]++)] = receiver;
+      sourceIndices[static_cast<std::size_t>(nextSource[receiver]++)] = source;
+   }
+}
+
+std::shared_ptr<const TextureRenderPlan> TextureRenderPlan::compile(
+    const TextureGraphTopology& topology) {
+   const QList<int> order = topology.topologicalOrder();
+   std::vector<std::pair<int, int>> edges;
+   edges.reserve(static_cast<std::size_t>(topology.edgeCount()));
+   for (const int id : order) {
+      for (const int receiverId : topology.receivers(id)) {
+         edges.emplace_back(id, receiverId);
+      }
+   }
+   return std::shared_ptr<const TextureRenderPlan>(new TextureRenderPlan(
+       std::vector<int>(order.cbegin(), order.cend()), edges, topology.revision()));
+}
+
+std::shared_ptr<const TextureRenderPlan> TextureRenderPlan::compile(
+    const std::vector<TextureNodeSnapshot>& nodes,
+    const std::shared_ptr<const TextureRenderPlan>& graphPlan) {
+   QHash<int, std::size_t> positions;
+   positions.reserve(static_cast<qsizetype>(nodes.size()));
+   for (std::size_t position = 0; position < nodes.size(); ++position) {
+      positions.insert(nodes[position].nodeId, position);
+   }
+   std::vector<int> ids;
+   ids.reserve(static_cast<std::size_t>(positions.size()));
+   std::vector<std::pair<int, int>> edges;
+   for (std::size_t position = 0; position < nodes.size(); ++position) {
+      const TextureNodeSnapshot& node = nodes[position];
+      if (positions.value(node.nodeId) != position) {
+         continue;
+      }
+      ids.push_back(node.nodeId);
+      if (!node.cachedImage.isNull()) {
+         continue;
+      }
+      const auto firstEdge = static_cast<std::ptrdiff_t>(edges.size());
+      for (const int sourceId : node.sources) {
+         const std::pair<int, int> edge(sourceId, node.nodeId);
+         if (sourceId != 0 && positions.contains(sourceId) &&
+             std::find(edges.cbegin() + firstEdge, edges.cend(), edge) == edges.cend()) {
+            edges.push_back(edge);
+         }
+      }
+   }
+
+   // The project plan's order fits whenever every connection leads forward in it.
+   const auto leadsForward = [&graphPlan](const std::pair<int, int>& edge) {
+      const int source = graphPlan->indexOf(edge.first);
+      return source >= 0 && source < graphPlan->indexOf(edge.second);
+   };
+   const auto planned = [&graphPlan](const int id) { return graphPlan->indexOf(id) >= 0; };
+   if (graphPlan && std::all_of(ids.cbegin(), ids.cend(), planned) &&
+       std::all_of(edges.cbegin(), edges.cend(), leadsForward)) {
+      const auto inGraphPlan = [&graphPlan](const std::pair<int, int>& edge) {
+         const TextureRenderPlan::IndexRange sources =
+             graphPlan->sources(static_cast<std::size_t>(graphPlan->indexOf(edge.second)));
+         return std::binary_search(sources.begin(), sources.end(), graphPlan->indexOf(edge.first));
+      };
+      if (ids.size() == graphPlan->nodeCount() && edges.size() == graphPlan->edgeCount() &&
+          std::all_of(edges.cbegin(), edges.cend(), inGraphPlan)) {
+         return graphPlan;
+      }
+      std::sort(ids.begin(), ids.end(), [&graphPlan](const int left, const int right) {
+         return graphPlan->indexOf(left) < graphPlan->indexOf(right);
+      });
+      return std::shared_ptr<const TextureRenderPlan>(
+          new TextureRenderPlan(std::move(ids), edges, 0));
+   }
+   const TextureRenderPlan unordered(std::move(ids), edges, 0);
+   return std::shared_ptr<const TextureRenderPlan>(
+       new TextureRenderPlan(unordered.topologicalOrder(), edges, 0));
+}
+
+std::vector<int> TextureRenderPlan::topologicalOrder() const {
+   std::vector<int> pendingSources(nodeIds.size());
+   std::vector<int> order;
+   order.reserve(nodeIds.size());
+   for (std::size_t index = 0; index < nodeIds.size(); ++index) {
+      pendingSources[index] = dependencyCount(index);
+      if (pendingSources[index] == 0) {
+         order.push_back(static_cast<int>(index));
+      }
+   }
+   for (std::size_t position = 0; position < order.size(); ++position) {
+      for (const int receiver : receivers(static_cast<std::size_t>(order[position]))) {
+         if (--pendingSources[static_cast<std::size_t>(receiver)] == 0) {
+            order.push_back(receiver);
+         }
+      }
+   }
+   // Nodes on a cycle never become ready; they keep their relative order at the end.
+   for (std::size_t index = 0; index < nodeIds.size(); ++index) {
+      if (pendingSources[index] > 0) {
+         order.push_back(static_cast<int>(index));
+      }
+   }
+   for (int& entry : order) {
+      entry = nodeIds[static_cast<std::size_t>(entry)];
+   }
+   return order;
+}
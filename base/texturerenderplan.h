@@ -0,0 +1,128 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef TEXTURERENDERPLAN_H
+#define TEXTURERENDERPLAN_H
+
+#include <QHash>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class TextureGraphTopology;
+struct TextureNodeSnapshot;
+
+/// @brief Immutable execution order and adjacency of a texture graph, compiled for rendering.
+/// @details Nodes are numbered densely in topological order, so every node's index is larger than
+/// the indices of its sources. Receivers and sources are stored as compressed rows: one flat array
+/// of indices per direction plus an offset per node. The dependency count of a node is the length
+/// of its source row. A plan is shared between renders and never modified after it is compiled.
+class TextureRenderPlan final {
+public:
+   /// @brief Contiguous node indices of one row of the plan.
+   class IndexRange {
+   public:
+      /// @brief Creates a range over the given indices.
+      IndexRange(const int* first, const int* last) : first(first), last(last) {}
+      /// @brief Returns the first index.
+      [[nodiscard]] const int* begin() const { return first; }
+      /// @brief Returns the end of the range.
+      [[nodiscard]] const int* end() const { return last; }
+      /// @brief Returns the number of indices.
+      [[nodiscard]] std::size_t size() const { return static_cast<std::size_t>(last - first); }
+      /// @brief Checks whether the range has no indices.
+      [[nodiscard]] bool empty() const { return first == last; }
+
+   private:
+      /// @brief First index of the range.
+      const int* first;
+      /// @brief End of the range.
+      const int* last;
+   };
+
+   /// @brief Compiles a plan of every node and connection of a project graph.
+   /// @param topology The graph, which must not change during the call.
+   /// @return The plan, tagged with the topology revision.
+   static std::shared_ptr<const TextureRenderPlan> compile(const TextureGraphTopology& topology);
+
+   /// @brief Compiles a plan of the nodes of a graph snapshot.
+   /// @details A node depends on the sources named in its snapshot that are part of the snapshot;
+   /// a node with a cached image depends on nothing. A repeated ID uses its last snapshot. When a
+   /// project plan is given and agrees with the snapshot's connections, its order is reused, and
+   /// if the snapshot holds the whole project graph the project plan itself is returned.
+   /// @param nodes The node snapshots.
+   /// @param graphPlan Plan of the project graph the snapshot was taken from, or null.
+   /// @return The plan of the snapshot nodes.
+   static std::shared_ptr<const TextureRenderPlan> compile(
+       const std::vector<TextureNodeSnapshot>& nodes,
+       const std::shared_ptr<const TextureRenderPlan>& graphPlan);
+
+   /// @brief Gets the number of nodes.
+   [[nodiscard]] std::size_t nodeCount() const { return nodeIds.size(); }
+
+   /// @brief Gets the number of connections.
+   [[nodiscard]] std::size_t edgeCount() const { return receiverIndices.size(); }
+
+   /// @brief Returns the ID of the node at an index.
+   [[nodiscard]] int nodeId(std::size_t index) const { return nodeIds[index]; }
+
+   /// @brief Returns the index of a node.
+   /// @return The index, or -1 when the node is not part of the plan.
+   [[nodiscard]] int indexOf(int nodeId) const { return indices.value(nodeId, -1); }
+
+   /// @brief Returns the indices of the nodes that read a node, in ascending order.
+   [[nodiscard]] IndexRange receivers(std::size_t index) const {
+      return row(receiverOffsets, receiverIndices, index);
+   }
+
+   /// @brief Returns the indices of the nodes a node reads, in ascending order.
+   [[nodiscard]] IndexRange sources(std::size_t index) const {
+      return row(sourceOffsets, sourceIndices, index);
+   }
+
+   /// @brief Returns the number of nodes that must finish before a node can render.
+   [[nodiscard]] int dependencyCount(std::size_t index) const {
+      return sourceOffsets[index + 1] - sourceOffsets[index];
+   }
+
+   /// @brief Gets the topology revision the plan was compiled from, or zero for a snapshot plan.
+   [[nodiscard]] std::uint64_t getRevision() const { return revision; }
+
+private:
+   /// @brief Creates a plan from node IDs and connections between them.
+   /// @param orderedIds Unique node IDs; their order becomes the index order.
+   /// @param edges Unique source and receiver ID pairs.
+   /// @param revision Topology revision stored in the plan.
+   TextureRenderPlan(std::vector<int> orderedIds, const std::vector<std::pair<int, int>>& edges,
+                     std::uint64_t revision);
+
+   /// @brief Returns one row of a compressed adjacency.
+   static IndexRange row(const std::vector<int>& offsets, const std::vector<int>& values,
+                         std::size_t index) {
+      return {values.data() + offsets[index], values.data() + offsets[index + 1]};
+   }
+
+   /// @brief Lists the nodes in topological order; a cycle's nodes come last.
+   [[nodiscard]] std::vector<int> topologicalOrder() const;
+
+   /// @brief Node IDs by index.
+   std::vector<int> nodeIds;
+   /// @brief Node indices by ID.
+   QHash<int, int> indices;
+   /// @brief Start of each node's receiver row, followed by the total receiver count.
+   std::vector<int> receiverOffsets;
+   /// @brief Receiver rows of all nodes.
+   std::vector<int> receiverIndices;
+   /// @brief Start of each node's source row, followed by the total source count.
+   std::vector<int> sourceOffsets;
+   /// @brief Source rows of all nodes.
+   std::vector<int> sourceIndices;
+   /// @brief Topology revision the plan was compiled from.
+   std::uint64_t revision = 0;
+};
+
+#endif  // TEXTURERENDERPLAN_H
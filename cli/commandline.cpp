@@ -6,19 +6,37 @@
 #include "commandline.h"
 #include "base/projectfileservice.h"
 #include "base/textureexporter.h"
+#include "base/textureimageencoder.h"
 #include "base/texturenode.h"
 #include "base/textureproject.h"
+#include "base/texturerendercache.h"
 #include "generators/builtinregistry.h"
 #include "base/jstexgenmanager.h"
 #include "base/jstexgen.h"
 #include <QCommandLineOption>
 #include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QRegularExpression>
+#include <QSet>
 #include <QTextStream>
+#include <algorithm>
+#include <csignal>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iterator>
 #include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -29,11 +47,105 @@ enum class ExitCode : int {
    Project = 4,
    Node = 5,
    Render = 6,
-   Output = 7
+   Output = 7,
+   Cancelled = 8
 };
 
+/// @brief Nodes of one project that a batch manifest exports at several sizes.
+struct BatchEntry {
+   /// @brief Absolute path of the project file.
+   QString projectPath;
+   /// @brief IDs of the nodes to export, or an empty list to export every sink node.
+   QList<int> nodeIds;
+   /// @brief Output image sizes.
+   QList<QSize> sizes;
+   /// @brief Absolute output path, which may contain {project}, {node}, {size}, {width},
+   /// {height}, and {level} placeholders.
+   QString outputPattern;
+   /// @brief Whether each image is followed by a chain of halved copies down to one pixel.
+   bool mipmaps = false;
+};
+
+/// @brief Outcome and timing of one image of a batch export.
+struct BatchOutput {
+   /// @brief ID of the exported node, or zero when the project was not loaded.
+   int nodeId = 0;
+   /// @brief Image size.
+   QSize size;
+   /// @brief Mip level, where zero is the rendered image and each level halves the previous one.
+   int level = 0;
+   /// @brief Destination image path.
+   QString path;
+   /// @brief Duration of the render that produced the image, shared by the outputs of the same
+   /// project and size.
+   double renderMilliseconds = 0.0;
+   /// @brief Duration of encoding and writing the image.
+   double writeMilliseconds = 0.0;
+   /// @brief Exit code of the failure, or ExitCode::Success.
+   ExitCode error = ExitCode::Success;
+   /// @brief Failure description.
+   QString message;
+};
+
+/// @brief Result of writing one batch image on a background thread.
+struct BatchWrite {
+   /// @brief Index of the output in the batch.
+   std::size_t output = 0;
+   /// @brief Write result and duration in milliseconds.
+   std::future<std::pair<TextureExportResult, double>> result;
+};
+
+/// @brief Outputs, pending writes, and totals of a batch export.
+struct BatchRun {
+   /// @brief Whether existing destinations may be replaced.
+   bool overwrite = false;
+   /// @brief Deflate level of PNG outputs.
+   int compressionLevel = TextureEncodeOptions::defaultCompressionLevel;
+   /// @brief Progress and cancellation callbacks of every render.
+   TextureExportHooks hooks;
+   /// @brief Number of render threads of every project, or zero for every hardware thread.
+   std::size_t renderThreads = 0;
+   /// @brief Largest number of images that wait for their background write.
+   std::size_t maximumWrites = 1;
+   /// @brief Every output in the order of the report.
+   std::deque<BatchOutput> outputs;
+   /// @brief Background writes that have not been waited for.
+   std::deque<BatchWrite> writes;
+   /// @brief Destination paths of the outputs, to detect outputs that overwrite each other.
+   QSet<QString> usedPaths;
+   /// @brief Total duration of the renders in milliseconds.
+   double renderMilliseconds = 0.0;
+   /// @brief Whether an interrupt stopped the batch.
+   bool cancelled = false;
+};
+
+/// @brief Set by the interrupt signal handler to stop a running export.
+volatile std::sig_atomic_t interruptRequested = 0;
+
+/// @brief Requests cancellation of the running export instead of terminating the process.
+/// @param signal Number of the received signal.
+extern "C" void requestInterrupt(const int signal) {
+   Q_UNUSED(signal);
+   interruptRequested = 1;
+}
+
 int exitCode(const ExitCode code) { return static_cast<int>(code); }
 
+ExitCode exportExitCode(const TextureExportError error) {
+   switch (error) {
+      case TextureExportError::None:
+         return ExitCode::Success;
+      case TextureExportError::InvalidNode:
+         return ExitCode::Node;
+      case TextureExportError::Render:
+         return ExitCode::Render;
+      case TextureExportError::Cancelled:
+         return ExitCode::Cancelled;
+      default:
+         return ExitCode::Output;
+   }
+}
+
 int reportError(const ExitCode code, const QString& message) {
    QTextStream(stderr) << "Error: " << message << Qt::endl;
    return exitCode(code);
@@ -56,6 +168,41 @@ std::optional<QSize> parseSize(const QString& value) {
    return QSize(width, height);
 }
 
+std::optional<int> parseCompressionLevel(const QString& value) {
+   bool ok = false;
+   const int level = value.toInt(&ok);
+   if (!ok || level < 0 || level > 9) {
+      return std::nullopt;
+   }
+   return level;
+}
+
+std::optional<std::size_t> parseRenderThreads(const QString& value) {
+   bool ok = false;
+   const int threads = value.toInt(&ok);
+   if (!ok || threads < 0 || threads > 256) {
+      return std::nullopt;
+   }
+   return static_cast<std::size_t>(threads);
+}
+
+/// @brief Returns the error message of an output path whose suffix names no supported format.
+QString unsupportedOutputMessage() {
+   return QStringLiteral("Unsupported output format; use .%1")
+       .arg(TextureImageEncoder::fileSuffixes().join(QStringLiteral(", .")));
+}
+
+/// @brief Chooses the encoding of an output from its suffix and the compression option.
+/// @param path Destination path, whose suffix selects the format; unknown suffixes select PNG.
+/// @param compressionLevel Deflate level of PNG outputs.
+/// @return Options for TextureExporter::writeImage().
+TextureEncodeOptions outputEncodeOptions(const QString& path, const int compressionLevel) {
+   TextureEncodeOptions options;
+   options.format = TextureImageEncoder::formatForPath(path).value_or(TextureFileFormat::Png);
+   options.compressionLevel = compressionLevel;
+   return options;
+}
+
 ExitCode projectLoadExitCode(const ProjectFileError error) {
    if (error == ProjectFileError::InputOpen || error == ProjectFileError::XmlParse) {
       return ExitCode::Input;
@@ -64,9 +211,10 @@ ExitCode projectLoadExitCode(const ProjectFileError error) {
 }
 
 bool isCommandLineSwitch(const QByteArray& argument) {
-   return argument == "--no-gui" || argument == "-h" || argument == "--help" ||
-          argument == "--help-all" || argument == "-v" || argument == "--version" ||
-          argument == "--print-js-generator" || argument == "--print-js-template";
+   return argument == "--no-gui" || argument == "--batch" || argument.startsWith("--batch=") ||
+          argument == "-h" || argument == "--help" || argument == "--help-all" ||
+          argument == "-v" || argument == "--version" || argument == "--print-js-generator" ||
+          argument == "--print-js-template";
 }
 
 /// @brief Adds the supported export options and positional arguments to a parser.
@@ -93,14 +241,46 @@ void configureParser(QCommandLineParser& parser) {
                      QStringLiteral("name")});
    parser.addOption({QStringLiteral("print-js-template"),
                      QStringLiteral("Print the JavaScript generator template and exit.")});
+   parser.addOption(
+       {QStringLiteral("force-js-generators"),
+        QStringLiteral("Render bundled JavaScript generators with their scripts, not C++ code.")});
    parser.addOption({{QStringLiteral("f"), QStringLiteral("force")},
                      QStringLiteral("Replace an existing output file.")});
    parser.addOption(
        {QStringLiteral("list-nodes"), QStringLiteral("List project nodes without rendering.")});
+   parser.addOption({QStringLiteral("progress"),
+                     QStringLiteral("Report rendered node counts on standard error.")});
+   parser.addOption({QStringLiteral("render-cache"),
+                     QStringLiteral("Store rendered images in this directory and reuse them in "
+                                    "later exports, for example %1.")
+                         .arg(TextureRenderCache::defaultDiskDirectory()),
+                     QStringLiteral("path")});
+   parser.addOption({QStringLiteral("all-sinks"),
+                     QStringLiteral("Export every sink node; the output name gains {node} unless "
+                                    "it contains that placeholder.")});
+   parser.addOption({QStringLiteral("mipmaps"),
+                     QStringLiteral("Also write halved copies of each image down to 1x1; the "
+                                    "output name gains {size} unless it has a size placeholder.")});
+   parser.addOption({QStringLiteral("compression"),
+                     QStringLiteral("PNG compression level from 0 (fastest) to 9 (smallest), "
+                                    "default %1.")
+                         .arg(TextureEncodeOptions::defaultCompressionLevel),
+                     QStringLiteral("level"),
+                     QString::number(TextureEncodeOptions::defaultCompressionLevel)});
+   parser.addOption({{QStringLiteral("j"), QStringLiteral("threads")},
+                     QStringLiteral("Number of render threads from 1 to 256, or 0 (default) for "
+                                    "every hardware thread."),
+                     QStringLiteral("count"), QStringLiteral("0")});
+   parser.addOption({QStringLiteral("batch"),
+                     QStringLiteral("Export every image listed in this JSON manifest and print a "
+                                    "timing report."),
+                     QStringLiteral("manifest.json")});
    parser.addPositionalArgument(QStringLiteral("input.txl"), QStringLiteral("Input project file."));
-   parser.addPositionalArgument(QStringLiteral("output.png"),
-                                QStringLiteral("Output PNG (not needed with --list-nodes)."),
-                                QStringLiteral("[output.png]"));
+   parser.addPositionalArgument(
+       QStringLiteral("output.png"),
+       QStringLiteral("Output image; the suffix selects PNG, TGA, DDS, QOI, or raw RGBA (.raw or "
+                      ".rgba). Not needed with --list-nodes."),
+       QStringLiteral("[output.png]"));
 }
 
 int printJavaScriptSource(const QCommandLineParser& parser) {
@@ -134,20 +314,36 @@ int printJavaScriptSource(const QCommandLineParser& parser) {
    return exitCode(ExitCode::Success);
 }
 
-/// @brief Registers generators and loads the requested project file.
-/// @param parser Parser containing JavaScript generator directory options.
-/// @param inputPath Path of the project to load.
-/// @param project Project that receives generators and loaded nodes.
+/// @brief Registers the built-in generators and the requested JavaScript generators.
+/// @param parser Parser containing JavaScript generator options.
+/// @param project Project that receives the generators.
 /// @return Process exit code for the operation.
-int loadProject(const QCommandLineParser& parser, const QString& inputPath,
-                TextureProject& project) {
-   registerBuiltInGenerators(project);
+int registerGenerators(const QCommandLineParser& parser, TextureProject& project) {
+   registerBuiltInGenerators(project, parser.isSet(QStringLiteral("force-js-generators"))
+                                          ? BundledGeneratorImplementation::JavaScript
+                                          : BundledGeneratorImplementation::Native);
    for (const QString& directory : parser.values(QStringLiteral("js-dir"))) {
       const QString error = loadJavaScriptGenerators(project, directory);
       if (!error.isEmpty()) {
          return reportError(ExitCode::Project, error);
       }
    }
+   return exitCode(ExitCode::Success);
+}
+
+/// @brief Registers generators and loads the requested project file.
+/// @param parser Parser containing JavaScript generator directory and render thread options.
+/// @param inputPath Path of the project to load.
+/// @param project Project that receives generators and loaded nodes.
+/// @return Process exit code for the operation.
+int loadProject(const QCommandLineParser& parser, const QString& inputPath,
+                TextureProject& project) {
+   project.setRenderWorkerCount(
+       parseRenderThreads(parser.value(QStringLiteral("threads"))).value_or(std::size_t{0}));
+   const int generatorResult = registerGenerators(parser, project);
+   if (generatorResult != exitCode(ExitCode::Success)) {
+      return generatorResult;
+   }
 
    const ProjectFileResult result = ProjectFileService::load(inputPath, project);
    if (!result) {
@@ -207,26 +403,46 @@ int selectNode(const QCommandLineParser& parser, const TextureProject& project,
                           .arg(candidates.join(QStringLiteral(", "))));
 }
 
+/// @brief Creates the progress and interrupt callbacks of an export.
+/// @param parser Parser containing the progress option.
+/// @return Hooks that report progress when requested and stop on an interrupt signal.
+TextureExportHooks exportHooks(const QCommandLineParser& parser) {
+   TextureExportHooks hooks;
+   if (parser.isSet(QStringLiteral("progress"))) {
+      hooks.progress = [](const int finishedNodes, const int nodeCount) {
+         QTextStream(stderr) << QStringLiteral("Rendered %1 of %2 nodes")
+                                    .arg(finishedNodes)
+                                    .arg(nodeCount)
+                             << Qt::endl;
+      };
+   }
+   hooks.cancelRequested = []() { return interruptRequested != 0; };
+   return hooks;
+}
+
 /// @brief Exports the selected node according to parsed output options.
 /// @param parser Parser containing overwrite behavior.
 /// @param project Project containing the selected node.
 /// @param nodeId Identifier of the node to export.
 /// @param size Requested output dimensions.
-/// @param outputPath Destination PNG path.
+/// @param outputPath Destination image path.
+/// @param compressionLevel Deflate level of PNG output.
 /// @return Process exit code for the export operation.
 int exportNode(const QCommandLineParser& parser, TextureProject& project, const int nodeId,
-               const QSize size, const QString& outputPath) {
-   if (QFileInfo(outputPath).suffix().compare(QStringLiteral("png"), Qt::CaseInsensitive) != 0) {
-      return reportError(ExitCode::Output, QStringLiteral("Only PNG output is supported"));
+               const QSize size, const QString& outputPath, const int compressionLevel) {
+   if (!TextureImageEncoder::formatForPath(outputPath)) {
+      return reportError(ExitCode::Output, unsupportedOutputMessage());
    }
 
-   const TextureExportResult result = TextureExporter::exportPng(
-       project, nodeId, size, outputPath, parser.isSet(QStringLiteral("force")));
+   // Interrupting the export stops the render workers and leaves no partial output file.
+   interruptRequested = 0;
+   const auto previousHandler = std::signal(SIGINT, requestInterrupt);
+   const TextureExportResult result = TextureExporter::exportImage(
+       project, nodeId, size, outputPath, parser.isSet(QStringLiteral("force")),
+       outputEncodeOptions(outputPath, compressionLevel), exportHooks(parser));
+   std::signal(SIGINT, previousHandler == SIG_ERR ? SIG_DFL : previousHandler);
    if (!result) {
-      const ExitCode code = result.error == TextureExportError::InvalidNode ? ExitCode::Node
-                            : result.error == TextureExportError::Render    ? ExitCode::Render
-                                                                            : ExitCode::Output;
-      return reportError(code, result.message);
+      return reportError(exportExitCode(result.error), result.message);
    }
 
    QTextStream(stdout) << QStringLiteral("Exported node %1 at %2x%3 to %4")
@@ -238,6 +454,474 @@ int exportNode(const QCommandLineParser& parser, TextureProject& project, const
    return exitCode(ExitCode::Success);
 }
 
+/// @brief Reads the outputs listed in a batch manifest.
+/// @details Relative project and output paths are resolved against the manifest's directory.
+/// @param manifestPath Path of the JSON manifest.
+/// @param defaultSize Size of entries that list no sizes.
+/// @param entries Receives the manifest entries.
+/// @return Process exit code for the operation.
+int readBatchManifest(const QString& manifestPath, const QSize defaultSize,
+                      QList<BatchEntry>& entries) {
+   QFile file(manifestPath);
+   if (!file.open(QIODevice::ReadOnly)) {
+      return reportError(
+          ExitCode::Input,
+          QStringLiteral("Could not open manifest '%1': %2").arg(manifestPath, file.errorString()));
+   }
+   QJsonParseError parseError;
+   const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+   if (document.isNull()) {
+      return reportError(ExitCode::Input, QStringLiteral("Could not parse manifest '%1': %2")
+                                              .arg(manifestPath, parseError.errorString()));
+   }
+   const QJsonValue outputs = document.object().value(QStringLiteral("outputs"));
+   if (!outputs.isArray()) {
+      return reportError(ExitCode::Usage,
+                         QStringLiteral("The manifest has no \"outputs\" array"));
+   }
+
+   const QDir manifestDirectory = QFileInfo(manifestPath).absoluteDir();
+   int index = 0;
+   for (const QJsonValue& value : outputs.toArray()) {
+      ++index;
+      const auto invalid = [index](const QString& message) {
+         return reportError(ExitCode::Usage,
+                            QStringLiteral("Manifest output %1: %2").arg(index).arg(message));
+      };
+      const QJsonObject object = value.toObject();
+      const QString project = object.value(QStringLiteral("project")).toString();
+      const QString output = object.value(QStringLiteral("output")).toString();
+      if (project.isEmpty() || output.isEmpty()) {
+         return invalid(QStringLiteral("\"project\" and \"output\" paths are required"));
+      }
+      if (!TextureImageEncoder::formatForPath(output)) {
+         return invalid(unsupportedOutputMessage());
+      }
+      BatchEntry entry;
+      entry.projectPath = QDir::cleanPath(manifestDirectory.absoluteFilePath(project));
+      entry.outputPattern = QDir::cleanPath(manifestDirectory.absoluteFilePath(output));
+      for (const QJsonValue& node : object.value(QStringLiteral("nodes")).toArray()) {
+         const int nodeId = node.toInt(0);
+         if (nodeId <= 0) {
+            return invalid(QStringLiteral("Node IDs must be positive integers"));
+         }
+         entry.nodeIds.append(nodeId);
+      }
+      for (const QJsonValue& size : object.value(QStringLiteral("sizes")).toArray()) {
+         const std::optional<QSize> parsedSize = parseSize(size.toString());
+         if (!parsedSize) {
+            return invalid(QStringLiteral("Invalid size '%1'").arg(size.toString()));
+         }
+         entry.sizes.append(*parsedSize);
+      }
+      if (entry.sizes.isEmpty()) {
+         entry.sizes.append(defaultSize);
+      }
+      entry.mipmaps = object.value(QStringLiteral("mipmaps")).toBool(false);
+      entries.append(entry);
+   }
+   return exitCode(ExitCode::Success);
+}
+
+/// @brief Fills in the placeholders of a batch output path.
+/// @param entry Manifest entry containing the output path.
+/// @param nodeId ID of the exported node.
+/// @param size Size of the exported image.
+/// @param level Mip level of the exported image.
+/// @return The destination path.
+QString batchOutputPath(const BatchEntry& entry, const int nodeId, const QSize size,
+                        const int level) {
+   QString path = entry.outputPattern;
+   path.replace(QStringLiteral("{project}"), QFileInfo(entry.projectPath).completeBaseName());
+   path.replace(QStringLiteral("{node}"), QString::number(nodeId));
+   path.replace(QStringLiteral("{size}"),
+                QStringLiteral("%1x%2").arg(size.width()).arg(size.height()));
+   path.replace(QStringLiteral("{width}"), QString::number(size.width()));
+   path.replace(QStringLiteral("{height}"), QString::number(size.height()));
+   path.replace(QStringLiteral("{level}"), QString::number(level));
+   return path;
+}
+
+/// @brief Waits for a background image write and records its outcome.
+/// @param write Write to wait for.
+/// @param outputs Outputs of the batch.
+void finishBatchWrite(BatchWrite& write, std::deque<BatchOutput>& outputs) {
+   const std::pair<TextureExportResult, double> result = write.result.get();
+   BatchOutput& output = outputs[write.output];
+   output.writeMilliseconds = result.second;
+   if (!result.first) {
+      output.error = exportExitCode(result.first.error);
+      output.message = result.first.message;
+   }
+}
+
+/// @brief Records that an interrupt stopped the batch before an output was written.
+/// @param output Output that was not rendered.
+void cancelBatchOutput(BatchOutput& output) {
+   output.error = ExitCode::Cancelled;
+   output.message = QStringLiteral("The export was cancelled");
+}
+
+/// @brief Prints the outcome and timing of every batch output.
+/// @param outputs Outputs of the batch.
+/// @param renderMilliseconds Total duration of the renders.
+/// @param totalMilliseconds Duration of the whole batch.
+void printBatchReport(const std::deque<BatchOutput>& outputs, const double renderMilliseconds,
+                      const double totalMilliseconds) {
+   QTextStream output(stdout);
+   output << "Status\tRender ms\tWrite ms\tNode\tSize\tOutput" << Qt::endl;
+   int exported = 0;
+   double writeMilliseconds = 0.0;
+   for (const BatchOutput& batchOutput : outputs) {
+      const bool succeeded = batchOutput.error == ExitCode::Success;
+      const bool cancelled = batchOutput.error == ExitCode::Cancelled;
+      exported += succeeded ? 1 : 0;
+      writeMilliseconds += batchOutput.writeMilliseconds;
+      output << (succeeded ? "ok" : (cancelled ? "cancelled" : "failed")) << '\t'
+             << QString::number(batchOutput.renderMilliseconds, 'f', 1) << '\t'
+             << QString::number(batchOutput.writeMilliseconds, 'f', 1) << '\t'
+             << batchOutput.nodeId << '\t'
+             << QStringLiteral("%1x%2")
+                    .arg(batchOutput.size.width())
+                    .arg(batchOutput.size.height())
+             << '\t' << batchOutput.path << Qt::endl;
+      if (!succeeded && !cancelled) {
+         QTextStream(stderr) << "Error: " << batchOutput.path << ": " << batchOutput.message
+                             << Qt::endl;
+      }
+   }
+   output << QStringLiteral("Exported %1 of %2 images in %3 ms (rendering %4 ms, writing %5 ms)")
+                 .arg(exported)
+                 .arg(outputs.size())
+                 .arg(totalMilliseconds, 0, 'f', 1)
+                 .arg(renderMilliseconds, 0, 'f', 1)
+                 .arg(writeMilliseconds, 0, 'f', 1)
+          << Qt::endl;
+}
+
+/// @brief Creates the state of a batch export from the parsed options.
+/// @param parser Parser containing the overwrite, compression, progress, and thread options.
+/// @return A batch without outputs.
+BatchRun createBatchRun(const QCommandLineParser& parser) {
+   BatchRun run;
+   run.overwrite = parser.isSet(QStringLiteral("force"));
+   run.compressionLevel = parseCompressionLevel(parser.value(QStringLiteral("compression")))
+                              .value_or(TextureEncodeOptions::defaultCompressionLevel);
+   run.hooks = exportHooks(parser);
+   run.renderThreads =
+       parseRenderThreads(parser.value(QStringLiteral("threads"))).value_or(std::size_t{0});
+   run.maximumWrites = static_cast<std::size_t>(std::max(1U, std::thread::hardware_concurrency()));
+   return run;
+}
+
+/// @brief Writes an image on a background thread.
+/// @details Encoding overlaps the next render, while the number of waiting images stays bounded.
+/// @param run Batch containing the output.
+/// @param output Index of the output.
+/// @param image Image to write.
+void startBatchWrite(BatchRun& run, const std::size_t output, const TextureImagePtr& image) {
+   while (run.writes.size() >= run.maximumWrites) {
+      finishBatchWrite(run.writes.front(), run.outputs);
+      run.writes.pop_front();
+   }
+   run.writes.push_back(
+       {output, std::async(std::launch::async,
+                           [image, path = run.outputs[output].path, overwrite = run.overwrite,
+                            options = outputEncodeOptions(run.outputs[output].path,
+                                                          run.compressionLevel)]() {
+                              QElapsedTimer writeTimer;
+                              writeTimer.start();
+                              TextureExportResult result =
+                                  TextureExporter::writeImage(*image, path, overwrite, options);
+                              return std::make_pair(
+                                  std::move(result),
+                                  static_cast<double>(writeTimer.nsecsElapsed()) / 1e6);
+                           })});
+}
+
+/// @brief Exports the outputs of the manifest entries that belong to one project.
+/// @details The nodes exported at the same size render together on all processor cores, so
+/// upstream nodes they share render once. Mip levels are downsampled from the rendered images
+/// instead of rendering the graph again. After an interrupt, the outputs that were not rendered
+/// are recorded as cancelled.
+/// @param run Batch receiving the outputs.
+/// @param project The loaded project.
+/// @param loaded Result of loading the project; on failure every entry records the error.
+/// @param entries Manifest entries of the project.
+void exportBatchProject(BatchRun& run, TextureProject& project, const ProjectFileResult& loaded,
+                        const QList<BatchEntry>& entries) {
+   // Outputs are grouped by size, so each size of the project is rendered once.
+   QList<QSize> sizes;
+   QList<QList<std::size_t>> sizeOutputs;
+   for (const BatchEntry& entry : entries) {
+      if (!loaded) {
+         BatchOutput failed;
+         failed.path = entry.outputPattern;
+         failed.error = projectLoadExitCode(loaded.error);
+         failed.message = loaded.message;
+         run.outputs.push_back(failed);
+         continue;
+      }
+      const QList<int> nodeIds = entry.nodeIds.isEmpty() ? project.getSinkNodeIds() : entry.nodeIds;
+      for (const QSize size : entry.sizes) {
+         if (!sizes.contains(size)) {
+            sizes.append(size);
+            sizeOutputs.emplaceBack();
+         }
+         for (const int nodeId : nodeIds) {
+            QSize levelSize = size;
+            for (int level = 0;; ++level) {
+               BatchOutput output;
+               output.nodeId = nodeId;
+               output.size = levelSize;
+               output.level = level;
+               output.path = batchOutputPath(entry, nodeId, levelSize, level);
+               if (project.getNode(nodeId).isNull()) {
+                  output.error = ExitCode::Node;
+                  output.message = QStringLiteral("The project has no node with id %1").arg(nodeId);
+               } else if (run.usedPaths.contains(output.path)) {
+                  output.error = ExitCode::Usage;
+                  output.message = QStringLiteral("The export writes this file more than once");
+               } else if (!run.overwrite && QFileInfo::exists(output.path)) {
+                  output.error = ExitCode::Output;
+                  output.message = QStringLiteral("The destination already exists");
+               } else {
+                  sizeOutputs[sizes.indexOf(size)].append(run.outputs.size());
+               }
+               run.usedPaths.insert(output.path);
+               run.outputs.push_back(output);
+               if (!entry.mipmaps || (levelSize.width() == 1 && levelSize.height() == 1)) {
+                  break;
+               }
+               levelSize = QSize((levelSize.width() + 1) / 2, (levelSize.height() + 1) / 2);
+            }
+         }
+      }
+   }
+
+   int sizeIndex = 0;
+   for (; sizeIndex < sizes.size() && !run.cancelled; ++sizeIndex) {
+      const QList<std::size_t>& indices = sizeOutputs.at(sizeIndex);
+      QList<int> nodeIds;
+      for (const std::size_t index : indices) {
+         if (!nodeIds.contains(run.outputs[index].nodeId)) {
+            nodeIds.append(run.outputs[index].nodeId);
+         }
+      }
+      if (nodeIds.isEmpty()) {
+         continue;
+      }
+      QElapsedTimer renderTimer;
+      renderTimer.start();
+      QMap<int, TextureImagePtr> images;
+      const TextureExportResult rendered =
+          TextureExporter::renderNodes(project, nodeIds, sizes.at(sizeIndex), images, run.hooks);
+      const double milliseconds = static_cast<double>(renderTimer.nsecsElapsed()) / 1e6;
+      run.renderMilliseconds += milliseconds;
+      run.cancelled = rendered.error == TextureExportError::Cancelled;
+      // Each node's mip chain grows as its outputs ask for deeper levels.
+      QMap<int, QList<TextureImagePtr>> chains;
+      for (const std::size_t index : indices) {
+         BatchOutput& output = run.outputs[index];
+         output.renderMilliseconds = milliseconds;
+         const TextureImagePtr image = images.value(output.nodeId);
+         if (!rendered || image.isNull()) {
+            output.error = rendered ? ExitCode::Render : exportExitCode(rendered.error);
+            output.message = rendered ? QStringLiteral("The texture generator returned no image")
+                                      : rendered.message;
+            continue;
+         }
+         QList<TextureImagePtr>& chain = chains[output.nodeId];
+         if (chain.isEmpty()) {
+            chain.append(image);
+         }
+         try {
+            while (chain.size() <= output.level) {
+               chain.append(chain.last()->halved());
+            }
+         } catch (const std::exception& error) {
+            output.error = ExitCode::Render;
+            output.message = QString::fromUtf8(error.what());
+            continue;
+         }
+         startBatchWrite(run, index, chain.at(output.level));
+      }
+   }
+   // The sizes after an interrupted render are never rendered or written.
+   for (; sizeIndex < sizes.size(); ++sizeIndex) {
+      for (const std::size_t index : sizeOutputs.at(sizeIndex)) {
+         cancelBatchOutput(run.outputs[index]);
+      }
+   }
+}
+
+/// @brief Waits for the background writes of a batch and prints its report.
+/// @param run Finished batch.
+/// @param timer Timer started when the batch started.
+/// @return Process exit code of the first failed output, or success.
+int finishBatchRun(BatchRun& run, const QElapsedTimer& timer) {
+   for (BatchWrite& write : run.writes) {
+      finishBatchWrite(write, run.outputs);
+   }
+   run.writes.clear();
+   printBatchReport(run.outputs, run.renderMilliseconds,
+                    static_cast<double>(timer.nsecsElapsed()) / 1e6);
+   if (run.cancelled) {
+      return exitCode(ExitCode::Cancelled);
+   }
+   const auto failed =
+       std::find_if(run.outputs.cbegin(), run.outputs.cend(),
+                    [](const BatchOutput& output) { return output.error != ExitCode::Success; });
+   return exitCode(failed == run.outputs.cend() ? ExitCode::Success : failed->error);
+}
+
+/// @brief Exports every image listed in a batch manifest.
+/// @details Generators are created once and shared by all projects, and each project is loaded
+/// once. The finished images are encoded on background threads, and the render cache is shared
+/// by every render of the batch.
+/// @param parser Parser containing the manifest path and export options.
+/// @param defaultSize Size of manifest entries that list no sizes.
+/// @return Process exit code of the first failed output, or success.
+int runBatch(const QCommandLineParser& parser, const QSize defaultSize) {
+   QElapsedTimer timer;
+   timer.start();
+   QList<BatchEntry> entries;
+   const int manifestResult =
+       readBatchManifest(parser.value(QStringLiteral("batch")), defaultSize, entries);
+   if (manifestResult != exitCode(ExitCode::Success)) {
+      return manifestResult;
+   }
+   TextureProject generators(false);
+   const int generatorResult = registerGenerators(parser, generators);
+   if (generatorResult != exitCode(ExitCode::Success)) {
+      return generatorResult;
+   }
+   QStringList projectPaths;
+   for (const BatchEntry& entry : entries) {
+      if (!projectPaths.contains(entry.projectPath)) {
+         projectPaths.append(entry.projectPath);
+      }
+   }
+
+   BatchRun run = createBatchRun(parser);
+   interruptRequested = 0;
+   const auto previousHandler = std::signal(SIGINT, requestInterrupt);
+   for (const QString& projectPath : projectPaths) {
+      QList<BatchEntry> projectEntries;
+      std::copy_if(entries.cbegin(), entries.cend(), std::back_inserter(projectEntries),
+                   [&projectPath](const BatchEntry& entry) {
+                      return entry.projectPath == projectPath;
+                   });
+      if (run.cancelled) {
+         // The projects after an interrupt are not loaded, so their outputs keep their patterns.
+         for (const BatchEntry& entry : projectEntries) {
+            BatchOutput skipped;
+            skipped.path = entry.outputPattern;
+            cancelBatchOutput(skipped);
+            run.outputs.push_back(skipped);
+         }
+         continue;
+      }
+      TextureProject project(false);
+      project.setRenderWorkerCount(run.renderThreads);
+      for (const TextureGeneratorPtr& generator : generators.getGenerators()) {
+         project.addGenerator(generator);
+      }
+      const ProjectFileResult loaded = ProjectFileService::load(projectPath, project);
+      exportBatchProject(run, project, loaded, projectEntries);
+   }
+   const int result = finishBatchRun(run, timer);
+   std::signal(SIGINT, previousHandler == SIG_ERR ? SIG_DFL : previousHandler);
+   return result;
+}
+
+/// @brief Exports every sink node, or the selected node with its mip chain, of a loaded project.
+/// @details The outputs are written like a batch with one entry. Without placeholders, the node
+/// ID is added to the output name of every sink, and the image size to the name of every mip
+/// level.
+/// @param parser Parser containing the node selection and export options.
+/// @param project The loaded project.
+/// @param size Size of the rendered images.
+/// @param outputPath Destination path given on the command line.
+/// @return Process exit code of the first failed output, or success.
+int exportProjectOutputs(const QCommandLineParser& parser, TextureProject& project,
+                         const QSize size, const QString& outputPath) {
+   if (!TextureImageEncoder::formatForPath(outputPath)) {
+      return reportError(ExitCode::Output, unsupportedOutputMessage());
+   }
+   BatchEntry entry;
+   entry.sizes.append(size);
+   entry.mipmaps = parser.isSet(QStringLiteral("mipmaps"));
+   if (!parser.isSet(QStringLiteral("all-sinks"))) {
+      int nodeId = 0;
+      const int selectionResult = selectNode(parser, project, nodeId);
+      if (selectionResult != exitCode(ExitCode::Success)) {
+         return selectionResult;
+      }
+      entry.nodeIds.append(nodeId);
+   }
+
+   const QFileInfo output(outputPath);
+   QString suffixes;
+   if (entry.nodeIds.isEmpty() && !outputPath.contains(QStringLiteral("{node}"))) {
+      suffixes += QStringLiteral("-{node}");
+   }
+   static const QRegularExpression sizePlaceholder(
+       QStringLiteral("\\{(size|width|height|level)\\}"));
+   if (entry.mipmaps && !outputPath.contains(sizePlaceholder)) {
+      suffixes += QStringLiteral("-{size}");
+   }
+   entry.outputPattern =
+       suffixes.isEmpty() ? output.absoluteFilePath()
+                          : output.absoluteDir().filePath(output.completeBaseName() + suffixes +
+                                                          QLatin1Char('.') + output.suffix());
+
+   QElapsedTimer timer;
+   timer.start();
+   BatchRun run = createBatchRun(parser);
+   interruptRequested = 0;
+   const auto previousHandler = std::signal(SIGINT, requestInterrupt);
+   exportBatchProject(run, project, ProjectFileResult{}, {entry});
+   const int result = finishBatchRun(run, timer);
+   std::signal(SIGINT, previousHandler == SIG_ERR ? SIG_DFL : previousHandler);
+   return result;
+}
+
+/// @brief Runs a batch, or lists or exports the nodes of the project named on the command line.
+/// @param parser Parser containing validated arguments.
+/// @param exportSize Size of the rendered images.
+/// @param compressionLevel PNG compression level of single-node exports.
+/// @return Process exit code.
+int runProjectCommand(const QCommandLineParser& parser, const QSize exportSize,
+                      const int compressionLevel) {
+   if (parser.isSet(QStringLiteral("batch"))) {
+      return runBatch(parser, exportSize);
+   }
+
+   const QStringList positional = parser.positionalArguments();
+   TextureProject project(false);
+   const int loadResult = loadProject(parser, positional.at(0), project);
+   if (loadResult != exitCode(ExitCode::Success)) {
+      return loadResult;
+   }
+
+   if (parser.isSet(QStringLiteral("list-nodes"))) {
+      return listProjectNodes(project);
+   }
+
+   if (parser.isSet(QStringLiteral("all-sinks")) || parser.isSet(QStringLiteral("mipmaps"))) {
+      return exportProjectOutputs(parser, project, exportSize, positional.at(1));
+   }
+
+   int nodeId = 0;
+   const int selectionResult = selectNode(parser, project, nodeId);
+   if (selectionResult != exitCode(ExitCode::Success)) {
+      return selectionResult;
+   }
+
+   return exportNode(parser, project, nodeId, exportSize, positional.at(1), compressionLevel);
+}
+
 }  // namespace
 
 bool useCommandLineMode(const int argc, char* argv[]) {
@@ -260,8 +944,20 @@ int runCommandLine(QCoreApplication& application) {
    }
 
    const QStringList positional = parser.positionalArguments();
+   const bool batch = parser.isSet(QStringLiteral("batch"));
    const bool listNodes = parser.isSet(QStringLiteral("list-nodes"));
-   if (positional.isEmpty() || positional.size() > 2 || (!listNodes && positional.size() != 2)) {
+   if (parser.isSet(QStringLiteral("all-sinks")) && parser.isSet(QStringLiteral("node"))) {
+      return reportError(ExitCode::Usage,
+                         QStringLiteral("--all-sinks exports every sink node; omit --node"));
+   }
+   if (batch && (!positional.isEmpty() || listNodes || parser.isSet(QStringLiteral("node")))) {
+      QTextStream(stderr) << parser.helpText();
+      return reportError(
+          ExitCode::Usage,
+          QStringLiteral("--batch takes its projects and outputs from the manifest"));
+   }
+   if (!batch &&
+       (positional.isEmpty() || positional.size() > 2 || (!listNodes && positional.size() != 2))) {
       QTextStream(stderr) << parser.helpText();
       return reportError(ExitCode::Usage, QStringLiteral("Expected an input and output path"));
    }
@@ -273,22 +969,27 @@ int runCommandLine(QCoreApplication& application) {
           QStringLiteral("Invalid --size; use positive WIDTHxHEIGHT within %1 pixels")
               .arg(TextureExporter::MaximumPixelCount));
    }
-
-   TextureProject project(false);
-   const int loadResult = loadProject(parser, positional.at(0), project);
-   if (loadResult != exitCode(ExitCode::Success)) {
-      return loadResult;
+   const std::optional<int> compressionLevel =
+       parseCompressionLevel(parser.value(QStringLiteral("compression")));
+   if (!compressionLevel) {
+      return reportError(ExitCode::Usage,
+                         QStringLiteral("Invalid --compression; use a level from 0 to 9"));
    }
-
-   if (listNodes) {
-      return listProjectNodes(project);
+   if (!parseRenderThreads(parser.value(QStringLiteral("threads")))) {
+      return reportError(ExitCode::Usage,
+                         QStringLiteral("Invalid --threads; use a count from 0 to 256"));
    }
 
-   int nodeId = 0;
-   const int selectionResult = selectNode(parser, project, nodeId);
-   if (selectionResult != exitCode(ExitCode::Success)) {
-      return selectionResult;
+   if (!listNodes && parser.isSet(QStringLiteral("render-cache"))) {
+      const QString cacheDirectory = parser.value(QStringLiteral("render-cache"));
+      if (!TextureRenderCache::instance().setDiskDirectory(cacheDirectory)) {
+         QTextStream(stderr) << "Warning: Render cache directory " << cacheDirectory
+                             << " is unavailable" << Qt::endl;
+      }
    }
 
-   return exportNode(parser, project, nodeId, *exportSize, positional.at(1));
+   const int result = runProjectCommand(parser, *exportSize, *compressionLevel);
+   // The render cache writes its files in the background, so they are finished before exiting.
+   TextureRenderCache::instance().waitForDiskWrites();
+   return result;
 }
@@ -0,0 +1,189 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "blending.h"
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// @brief Blend modes in the order of the script's mode setting.
+enum class BlendMode {
+   Normal,
+   Darken,
+   Multiply,
+   Lighten,
+   Screen,
+   ColourDodge,
+   ColourBurn,
+   Overlay,
+   SoftLight,
+   HardLight,
+   Difference,
+   Exclusion
+};
+
+/// @brief Maps a mode name to its formula; unknown names use Normal, as the script does.
+BlendMode blendMode(const QString& name) {
+   static const QStringList names{QStringLiteral("Normal"),       QStringLiteral("Darken"),
+                                  QStringLiteral("Multiply"),     QStringLiteral("Lighten"),
+                                  QStringLiteral("Screen"),       QStringLiteral("Colour Dodge"),
+                                  QStringLiteral("Colour Burn"),  QStringLiteral("Overlay"),
+                                  QStringLiteral("Soft Light"),   QStringLiteral("Hard Light"),
+                                  QStringLiteral("Difference"),   QStringLiteral("Exclusion")};
+   const int index = names.indexOf(name);
+   return index < 0 ? BlendMode::Normal : static_cast<BlendMode>(index);
+}
+
+/// @brief Applies a blend formula to one colour channel in the range 0 to 1.
+double blendChannel(const BlendMode mode, const double lowerColour, const double upperColour) {
+   switch (mode) {
+      case BlendMode::Darken:
+         return std::min(lowerColour, upperColour);
+      case BlendMode::Multiply:
+         return lowerColour * upperColour;
+      case BlendMode::Lighten:
+         return std::max(lowerColour, upperColour);
+      case BlendMode::Screen:
+         return lowerColour + upperColour - lowerColour * upperColour;
+      case BlendMode::ColourDodge:
+         if (lowerColour == 0) {
+            return 0;
+         }
+         if (upperColour == 1) {
+            return 1;
+         }
+         return std::min(1.0, lowerColour / (1 - upperColour));
+      case BlendMode::ColourBurn:
+         if (lowerColour == 1) {
+            return 1;
+         }
+         if (upperColour == 0) {
+            return 0;
+         }
+         return 1 - std::min(1.0, (1 - lowerColour) / upperColour);
+      case BlendMode::Overlay:
+         if (lowerColour <= 0.5) {
+            return upperColour * (2 * lowerColour);
+         } else {
+            const double adjustedLowerColour = 2 * lowerColour - 1;
+            return upperColour + adjustedLowerColour - upperColour * adjustedLowerColour;
+         }
+      case BlendMode::SoftLight:
+         if (upperColour <= 0.5) {
+            return lowerColour - (1 - 2 * upperColour) * lowerColour * (1 - lowerColour);
+         } else {
+            const double highlightCurve = lowerColour <= 0.25
+                                              ? ((16 * lowerColour - 12) * lowerColour + 4) *
+                                                    lowerColour
+                                              : std::sqrt(lowerColour);
+            return lowerColour - (2 * upperColour - 1) * (lowerColour - highlightCurve);
+         }
+      case BlendMode::HardLight:
+         if (upperColour <= 0.5) {
+            return lowerColour * (2 * upperColour);
+         } else {
+            const double adjustedUpperColour = 2 * upperColour - 1;
+            return lowerColour + adjustedUpperColour - lowerColour * adjustedUpperColour;
+         }
+      case BlendMode::Difference:
+         return std::abs(lowerColour - upperColour);
+      case BlendMode::Exclusion:
+         return lowerColour + upperColour - 2 * lowerColour * upperColour;
+      case BlendMode::Normal:
+         break;
+   }
+   return upperColour;
+}
+
+}  // namespace
+
+void BlendingTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                        const QMap<QString, TextureImagePtr>& sourceimages,
+                                        const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void BlendingTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                              TexturePixel* destimage,
+                                              const QMap<QString, TextureImagePtr>& sourceimages,
+                                              const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   const TextureImagePtr baseImage = sourceimages.value(QStringLiteral("Base"));
+   const TextureImagePtr blendImage = sourceimages.value(QStringLiteral("Blend"));
+   if (baseImage.isNull() || blendImage.isNull()) {
+      // With one input there is nothing to combine, so it is copied unchanged.
+      copyBackground(size, region, baseImage.isNull() ? blendImage : baseImage, destimage);
+      return;
+   }
+
+   const bool baseOnTop = settings.value("order").toString() == "Base on top of Blend";
+   const TexturePixel* lowerPixels = baseOnTop ? blendImage->data() : baseImage->data();
+   const TexturePixel* upperPixels = baseOnTop ? baseImage->data() : blendImage->data();
+   const BlendMode mode = blendMode(settings.value("mode").toString());
+   const double upperOpacity =
+       std::max(0.0, std::min(1.0, settings.value("alpha").toDouble() / 100));
+   const int width = size.width();
+
+   for (int y = region.top(); y <= region.bottom(); ++y) {
+      const qsizetype rowStart = static_cast<qsizetype>(y) * width;
+      for (qsizetype i = rowStart + region.left(); i <= rowStart + region.right(); ++i) {
+         const TexturePixel& lower = lowerPixels[i];
+         const TexturePixel& upper = upperPixels[i];
+         TexturePixel& output = destimage[i];
+
+         if (mode == BlendMode::Normal && upperOpacity == 1) {
+            // Opaque upper pixels are copied and transparent ones reveal the lower pixel.
+            if (upper.a == 255) {
+               output = upper;
+            } else if (upper.a == 0) {
+               output = lower.a == 0 ? TexturePixel() : lower;
+            } else if (lower.a == 0) {
+               output = upper;
+            } else {
+               const double lowerAlpha = lower.a / 255.0;
+               const double upperAlpha = upper.a / 255.0;
+               const double resultAlpha = upperAlpha + lowerAlpha - upperAlpha * lowerAlpha;
+               const double upperShare = upperAlpha / resultAlpha;
+               output.r = toUint8((1 - upperShare) * lower.r + upperShare * upper.r);
+               output.g = toUint8((1 - upperShare) * lower.g + upperShare * upper.g);
+               output.b = toUint8((1 - upperShare) * lower.b + upperShare * upper.b);
+               output.a = toUint8(resultAlpha * 255);
+            }
+            continue;
+         }
+
+         const double lowerAlpha = lower.a / 255.0;
+         const double upperAlpha = upperOpacity * upper.a / 255;
+         const double resultAlpha = upperAlpha + lowerAlpha - upperAlpha * lowerAlpha;
+         if (!(resultAlpha > 0)) {
+            output = TexturePixel();
+            continue;
+         }
+         const quint8 lowerBytes[3] = {lower.r, lower.g, lower.b};
+         const quint8 upperBytes[3] = {upper.r, upper.g, upper.b};
+         quint8 resultBytes[3];
+         for (int channel = 0; channel < 3; ++channel) {
+            const double lowerByte = lowerBytes[channel];
+            const double upperByte = upperBytes[channel];
+            const double blendedByte =
+                std::trunc(blendChannel(mode, lowerByte / 255, upperByte / 255) * 255);
+            // The blend applies only where the lower pixel is visible, then alpha mixes both.
+            const double visibleUpperByte =
+                std::floor((1 - lowerAlpha) * upperByte + lowerAlpha * blendedByte + 0.5);
+            const double upperShare = upperAlpha / resultAlpha;
+            const double resultByte =
+                std::trunc((1 - upperShare) * lowerByte + upperShare * visibleUpperByte);
+            resultBytes[channel] = toUint8(std::max(0.0, std::min(255.0, resultByte)));
+         }
+         output = TexturePixel(resultBytes[0], resultBytes[1], resultBytes[2],
+                               toUint8(resultAlpha * 255));
+      }
+   }
+}
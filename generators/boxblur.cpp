@@ -5,6 +5,8 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "boxblur.h"
+#include <cstddef>
+#include <vector>
 
 BoxBlurTextureGenerator::BoxBlurTextureGenerator() {
    TextureGeneratorSetting neighbourssetting;
@@ -16,60 +18,152 @@ BoxBlurTextureGenerator::BoxBlurTextureGenerator() {
    neighbourssetting.id = "numneighbours";
    configurables.append(neighbourssetting);
 }
+namespace {
+
+/// @brief Returns the horizontal and vertical blur radii of an image size.
+QSize blurRadii(const QSize size, const TextureNodeSettings& settings) {
+   // The radius is defined for a 250 pixel image and grows with every full 250 pixels.
+   const QSize reference = textureReferenceSize(size, settings);
+   const double numNeighbours = settings.value("numneighbours").toDouble();
+   const int radiusX = numNeighbours * qMax(reference.width() / 250, 1);
+   const int radiusY = numNeighbours * qMax(reference.height() / 250, 1);
+   if (reference == size) {
+      return QSize(radiusX, radiusY);
+   }
+   // A reduced-size render uses the radii of its reference image, scaled down.
+   return QSize(scaleTextureLength(radiusX, size.width(), reference.width()),
+                scaleTextureLength(radiusY, size.height(), reference.height()));
+}
+
+/// @brief Checks whether the blur window is empty, so every pixel keeps its input value.
+bool hasEmptyWindow(const QSize size, const TextureNodeSettings& settings) {
+   const QSize radii = blurRadii(size, settings);
+   return settings.value("numneighbours").toInt() == 0 || radii.width() <= 0 ||
+          radii.height() <= 0;
+}
+
+/// @brief Wraps a coordinate into [0, length), as the blur window does at image edges.
+int wrapCoordinate(const int position, const int length) {
+   const int wrapped = position % length;
+   return wrapped < 0 ? wrapped + length : wrapped;
+}
+
+/// @brief Sums the horizontal window of every pixel in one span of a source row.
+/// @details The window of column x covers [x - radius, x + radius), wrapping at the row ends.
+/// The first sum is built directly and every later one slides by adding the column entering the
+/// window and removing the one leaving it.
+/// @param row First pixel of the source row.
+/// @param width Number of pixels in the row.
+/// @param left First column to sum.
+/// @param count Number of columns to sum.
+/// @param radius Horizontal window radius, at least one.
+/// @param sums Receives four channel sums per column.
+void sumRowWindows(const TexturePixel* row, const int width, const int left, const int count,
+                   const int radius, quint32* sums) {
+   quint32 red = 0;
+   quint32 green = 0;
+   quint32 blue = 0;
+   quint32 alpha = 0;
+   for (int x = left - radius; x < left + radius; x++) {
+      const TexturePixel& pixel = row[wrapCoordinate(x, width)];
+      red += pixel.r;
+      green += pixel.g;
+      blue += pixel.b;
+      alpha += pixel.a;
+   }
+   int entering = wrapCoordinate(left + radius, width);
+   int leaving = wrapCoordinate(left - radius, width);
+   for (int i = 0; i < count; i++) {
+      sums[i * 4] = red;
+      sums[i * 4 + 1] = green;
+      sums[i * 4 + 2] = blue;
+      sums[i * 4 + 3] = alpha;
+      const TexturePixel& added = row[entering];
+      const TexturePixel& removed = row[leaving];
+      red += added.r - removed.r;
+      green += added.g - removed.g;
+      blue += added.b - removed.b;
+      alpha += added.a - removed.a;
+      if (++entering == width) {
+         entering = 0;
+      }
+      if (++leaving == width) {
+         leaving = 0;
+      }
+   }
+}
+
+}  // namespace
+
+QString BoxBlurTextureGenerator::getPassThroughSlot(QSize size,
+                                                    const TextureNodeSettings& settings) const {
+   return hasEmptyWindow(size, settings) ? QStringLiteral("Image") : QString();
+}
+
 void BoxBlurTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                        const QMap<QString, TextureImagePtr>& sourceimages,
                                        const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void BoxBlurTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                             TexturePixel* destimage,
+                                             const QMap<QString, TextureImagePtr>& sourceimages,
+                                             const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    if (!destimage || !size.isValid()) {
       return;
    }
    if (!sourceimages.contains(QStringLiteral("Image"))) {
-      memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel(0, 0, 0, 0));
       return;
    }
-   TexturePixel* sourceImage = sourceimages.value(QStringLiteral("Image")).data()->getData();
-   if (settings.value("numneighbours").toInt() == 0) {
-      memcpy(destimage, sourceImage, size.width() * size.height() * sizeof(TexturePixel));
+   const TexturePixel* sourceImage = sourceimages.value(QStringLiteral("Image")).data()->getData();
+   if (hasEmptyWindow(size, settings)) {
+      copyTextureRegion(size, region, sourceImage, destimage);
       return;
    }
-   int numNeightboursX = settings.value("numneighbours").toDouble() * qMax(size.width() / 250, 1);
-   int numNeightboursY = settings.value("numneighbours").toDouble() * qMax(size.height() / 250, 1);
-   for (int j = 0; j < size.height(); j++) {
-      for (int i = 0; i < size.width(); i++) {
-         int startX = i - numNeightboursX;
-         int endX = i + numNeightboursX;
-         int startY = j - numNeightboursY;
-         int endY = j + numNeightboursY;
-         int totalPixels = 0;
-         quint64 red = 0;
-         quint64 green = 0;
-         quint64 blue = 0;
-         quint64 alpha = 0;
-         for (int ypos = startY; ypos < endY; ypos++) {
-            int currY = ypos;
-            if (currY < 0) {
-               currY += size.height() * 5;
-            }
-            currY %= size.height();
-            currY *= size.width();
-            for (int xpos = startX; xpos < endX; xpos++) {
-               int currX = xpos;
-               if (currX < 0) {
-                  currX += size.width() * 5;
-               }
-               currX %= size.width();
-               totalPixels++;
-               TexturePixel sourcePixel = sourceImage[currY + currX];
-               red += sourcePixel.r;
-               green += sourcePixel.g;
-               blue += sourcePixel.b;
-               alpha += sourcePixel.a;
-            }
-         }
-         int pixelpos = j * size.width() + i;
-         destimage[pixelpos].r = static_cast<unsigned char>(red / totalPixels);
-         destimage[pixelpos].g = static_cast<unsigned char>(green / totalPixels);
-         destimage[pixelpos].b = static_cast<unsigned char>(blue / totalPixels);
-         destimage[pixelpos].a = static_cast<unsigned char>(alpha / totalPixels);
+   const QSize radii = blurRadii(size, settings);
+   const int numNeighboursX = radii.width();
+   const int numNeighboursY = radii.height();
+   // Every output pixel is the truncated mean of a 2 * numNeighboursX by 2 * numNeighboursY
+   // window that wraps around the image edges. The window is summed separably: each source row
+   // is reduced to horizontal window sums, and a running sum of those rows per column slides
+   // down the region. The cost per pixel does not depend on the radius.
+   const int width = size.width();
+   const int height = size.height();
+   const int columns = region.width();
+   std::vector<quint32> enteringRow(static_cast<std::size_t>(columns) * 4);
+   std::vector<quint32> leavingRow(static_cast<std::size_t>(columns) * 4);
+   std::vector<quint64> columnSums(static_cast<std::size_t>(columns) * 4, 0);
+   for (int y = region.top() - numNeighboursY; y < region.top() + numNeighboursY; y++) {
+      const TexturePixel* row = sourceImage + wrapCoordinate(y, height) * width;
+      sumRowWindows(row, width, region.left(), columns, numNeighboursX, enteringRow.data());
+      for (std::size_t i = 0; i < columnSums.size(); i++) {
+         columnSums[i] += enteringRow[i];
+      }
+   }
+   const quint64 totalPixels = static_cast<quint64>(numNeighboursX) * 2 * numNeighboursY * 2;
+   for (int y = region.top(); y <= region.bottom(); y++) {
+      TexturePixel* destRow = destimage + y * width + region.left();
+      for (int i = 0; i < columns; i++) {
+         destRow[i].r = static_cast<unsigned char>(columnSums[i * 4] / totalPixels);
+         destRow[i].g = static_cast<unsigned char>(columnSums[i * 4 + 1] / totalPixels);
+         destRow[i].b = static_cast<unsigned char>(columnSums[i * 4 + 2] / totalPixels);
+         destRow[i].a = static_cast<unsigned char>(columnSums[i * 4 + 3] / totalPixels);
+      }
+      if (y == region.bottom()) {
+         break;
+      }
+      const TexturePixel* entering =
+          sourceImage + wrapCoordinate(y + numNeighboursY, height) * width;
+      const TexturePixel* leaving =
+          sourceImage + wrapCoordinate(y - numNeighboursY, height) * width;
+      sumRowWindows(entering, width, region.left(), columns, numNeighboursX, enteringRow.data());
+      sumRowWindows(leaving, width, region.left(), columns, numNeighboursX, leavingRow.data());
+      for (std::size_t i = 0; i < columnSums.size(); i++) {
+         columnSums[i] += enteringRow[i];
+         columnSums[i] -= leavingRow[i];
       }
    }
 }
@@ -4,11 +4,14 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "builtinregistry.h"
+#include "base/jstexgen.h"
 #include "base/jstexgenmanager.h"
 #include "base/textureproject.h"
+#include "blending.h"
 #include "boxblur.h"
 #include "cutout.h"
 #include "displacementmap.h"
+#include "fire.h"
 #include "gaussianblur.h"
 #include "gradient.h"
 #include "greyscale.h"
@@ -17,16 +20,40 @@
 #include "merge.h"
 #include "mirror.h"
 #include "modifylevels.h"
+#include "noise.h"
 #include "normalmap.h"
+#include "perlinnoise.h"
 #include "pointillism.h"
 #include "setchannels.h"
+#include "sineplasma.h"
 #include "sinetransform.h"
 #include "stackblur.h"
 #include "star.h"
 #include "text.h"
+#include "transform.h"
+#include "whirl.h"
 #include <stdexcept>
 
-void registerBuiltInGenerators(TextureProject& project) {
+namespace {
+
+/// @brief Renders a bundled JavaScript generator with its C++ implementation.
+/// @param project Project holding the bundled generator.
+/// @param name Name of the bundled generator.
+template <class Implementation>
+void attachNativeImplementation(TextureProject& project, const QString& name) {
+   const TextureGeneratorPtr generator = project.getGenerator(name);
+   auto* script = dynamic_cast<JsTexGen*>(generator.data());
+   if (script == nullptr || script->getOrigin() != TextureGenerator::Origin::BuiltIn) {
+      throw std::runtime_error(
+          QStringLiteral("No bundled JavaScript generator named '%1'").arg(name).toStdString());
+   }
+   script->setNativeImplementation(TextureGeneratorPtr(new Implementation(*script)));
+}
+
+}  // namespace
+
+void registerBuiltInGenerators(TextureProject& project,
+                               const BundledGeneratorImplementation implementation) {
    project.addGenerator(TextureGeneratorPtr(new BoxBlurTextureGenerator()));
    project.addGenerator(TextureGeneratorPtr(new CutoutTextureGenerator()));
    project.addGenerator(TextureGeneratorPtr(new DisplacementMapTextureGenerator()));
@@ -51,4 +78,15 @@ void registerBuiltInGenerators(TextureProject& project) {
                                    .arg(javaScriptErrors.join(QLatin1Char('\n')))
                                    .toStdString());
    }
+   if (implementation == BundledGeneratorImplementation::Native) {
+      attachNativeImplementation<BlendingTextureGenerator>(project, QStringLiteral("Blending"));
+      attachNativeImplementation<FireTextureGenerator>(project, QStringLiteral("Fire"));
+      attachNativeImplementation<NoiseTextureGenerator>(project, QStringLiteral("Noise"));
+      attachNativeImplementation<PerlinNoiseTextureGenerator>(project,
+                                                              QStringLiteral("Perlin noise"));
+      attachNativeImplementation<SinePlasmaTextureGenerator>(project,
+                                                             QStringLiteral("Sine plasma"));
+      attachNativeImplementation<TransformTextureGenerator>(project, QStringLiteral("Transform"));
+      attachNativeImplementation<WhirlTextureGenerator>(project, QStringLiteral("Whirl"));
+   }
 }
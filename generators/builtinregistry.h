@@ -8,7 +8,19 @@
 
 class TextureProject;
 
+/// Selects how bundled JavaScript generators that have a C++ implementation are rendered.
+enum class BundledGeneratorImplementation {
+   /// Render with the C++ implementation, which is several times faster.
+   Native,
+   /// Run the JavaScript source, for example to debug a script against its C++ implementation.
+   JavaScript
+};
+
 /// Registers every built-in C++ texture generator with a project.
-void registerBuiltInGenerators(TextureProject& project);
+/// @param project Project that receives the generators.
+/// @param implementation How bundled JavaScript generators with a C++ implementation render.
+void registerBuiltInGenerators(
+    TextureProject& project,
+    BundledGeneratorImplementation implementation = BundledGeneratorImplementation::Native);
 
 #endif  // BUILTINREGISTRY_H
@@ -5,6 +5,7 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "cutout.h"
+#include "base/texturepixelkernels.h"
 
 CutoutTextureGenerator::CutoutTextureGenerator() {
    QStringList ordering;
@@ -31,6 +32,14 @@ CutoutTextureGenerator::CutoutTextureGenerator() {
 void CutoutTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                       const QMap<QString, TextureImagePtr>& sourceimages,
                                       const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void CutoutTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                            TexturePixel* destimage,
+                                            const QMap<QString, TextureImagePtr>& sourceimages,
+                                            const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    if (!destimage || !size.isValid()) {
       return;
    }
@@ -52,21 +61,18 @@ void CutoutTextureGenerator::generate(QSize size, TexturePixel* destimage,
    if (sourceimages.contains(second)) {
       subtractSource = sourceimages.value(second).data()->getData();
    }
-   int numPixels = size.width() * size.height();
    if (originSource && subtractSource) {
-      memcpy(destimage, originSource, numPixels * sizeof(TexturePixel));
-      for (int i = 0; i < numPixels; i++) {
-         if (destimage[i].a > (factor * subtractSource[i].a)) {
-            destimage[i].a -= subtractSource[i].a;
-         } else {
-            destimage[i].a = 0;
-         }
+      copyTextureRegion(size, region, originSource, destimage);
+      for (int y = region.top(); y <= region.bottom(); y++) {
+         const int rowStart = y * size.width() + region.left();
+         TexturePixelKernels::cutAlpha(destimage + rowStart, subtractSource + rowStart,
+                                       region.width(), factor);
       }
    } else if (originSource) {
-      memcpy(destimage, originSource, numPixels * sizeof(TexturePixel));
+      copyTextureRegion(size, region, originSource, destimage);
    } else if (subtractSource) {
-      memcpy(destimage, subtractSource, numPixels * sizeof(TexturePixel));
+      copyTextureRegion(size, region, subtractSource, destimage);
    } else {
-      memset(destimage, 0, numPixels * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel());
    }
 }
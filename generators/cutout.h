@@ -17,10 +17,16 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   bool writesEveryPixel() const override { return true; }
    QStringList getSourceSlots() const override {
       return {QStringLiteral("Image"), QStringLiteral("Mask")};
    }
    QString getName() const override { return QString("Cutout"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("cutout/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Subtracts one input image's alpha channel from the other.");
@@ -21,6 +21,7 @@ public:
       return {QStringLiteral("Source image"), QStringLiteral("Map")};
    }
    QString getName() const override { return QString("Displacement"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("displacementmap/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Distorts the source image using the luminance of a displacement map.");
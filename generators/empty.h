@@ -17,8 +17,10 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   bool writesEveryPixel() const override { return true; }
    QStringList getSourceSlots() const override { return {}; }
    QString getName() const override { return QString("Empty"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("empty/1"); }
    const TextureGeneratorSettings& getSettings() const override { return _settings; }
    QString getDescription() const override { return QString("Produces a transparent texture."); }
    TextureGenerator::Type getType() const override { return TextureGenerator::Type::Generator; }
@@ -0,0 +1,156 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "fire.h"
+#include <QColor>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+void FireTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                    const QMap<QString, TextureImagePtr>& sourceimages,
+                                    const TextureNodeSettings& settings) const {
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   copyBackground(size, QRect(QPoint(0, 0), size),
+                  sourceimages.value(QStringLiteral("Background")), destimage);
+
+   const int width = size.width();
+   const int height = size.height();
+   const int simulationWidth = std::min(width, 160);
+   const int simulationHeight = std::min(height, 160);
+   const std::size_t simulationSize = static_cast<std::size_t>(simulationWidth) * simulationHeight;
+   // Single precision, as the script's Float32Array buffers round every stored value.
+   std::vector<float> heat(simulationSize, 0.0F);
+   std::vector<float> nextHeat(simulationSize, 0.0F);
+
+   quint32 randomState = toUint32(settings.value("randomize").toDouble());
+   if (randomState == 0) {
+      randomState = 1;
+   }
+   const double cooling = settings.value("falloff").toDouble() * 100 / simulationHeight;
+   const double iterations = settings.value("iterations").toDouble();
+   const int bottomRow = simulationHeight - 1;
+   const int rowAboveBottom = std::max(0, simulationHeight - 2);
+
+   for (int iteration = 0; iteration < iterations; ++iteration) {
+      for (int y = 0; y < simulationHeight - 1; ++y) {
+         const float* firstRowBelow = heat.data() + (y + 1) * simulationWidth;
+         const float* secondRowBelow =
+             heat.data() + std::min(simulationHeight - 1, y + 2) * simulationWidth;
+         float* row = nextHeat.data() + y * simulationWidth;
+         for (int x = 0; x < simulationWidth; ++x) {
+            const int leftX = x == 0 ? simulationWidth - 1 : x - 1;
+            const int rightX = x + 1 == simulationWidth ? 0 : x + 1;
+            const double heatFromBelow =
+                (static_cast<double>(firstRowBelow[leftX]) + firstRowBelow[x] +
+                 firstRowBelow[rightX] + secondRowBelow[x]) /
+                4;
+            row[x] = static_cast<float>(std::max(0.0, heatFromBelow - cooling));
+         }
+      }
+
+      for (int x = 0; x < simulationWidth; ++x) {
+         randomState = randomState * 1664525U + 1013904223U;
+         const double brightness = randomState / 4294967296.0;
+         randomState = randomState * 1664525U + 1013904223U;
+         const bool coolerPocket = randomState / 4294967296.0 < 0.12;
+         const double sourceHeat = coolerPocket ? 45 + brightness * 80 : 190 + brightness * 65;
+         nextHeat[bottomRow * simulationWidth + x] = static_cast<float>(sourceHeat);
+         float& aboveBottom = nextHeat[rowAboveBottom * simulationWidth + x];
+         aboveBottom =
+             static_cast<float>(std::max(static_cast<double>(aboveBottom), sourceHeat * 0.72));
+      }
+      std::swap(heat, nextHeat);
+   }
+
+   const double wavePhase = settings.value("wavephase").toDouble() * M_PI / 180;
+   const double waveTurns = settings.value("wavefrequency").toDouble() * 2 * M_PI;
+   const double waveAmplitude = settings.value("waveamplitude").toDouble() * simulationWidth / 100;
+   const bool sineWave = settings.value("sinewave").toBool();
+   const QColor ember = settings.value("embercolor").value<QColor>();
+   const QColor flame = settings.value("flamecolor").value<QColor>();
+   const QColor hot = settings.value("hotcolor").value<QColor>();
+
+   for (int y = 0; y < height; ++y) {
+      const double verticalPosition = height > 1 ? static_cast<double>(y) / (height - 1) : 0;
+      const double simulationY = verticalPosition * (simulationHeight - 1);
+      const int firstSimulationY = static_cast<int>(std::floor(simulationY));
+      const int secondSimulationY = std::min(simulationHeight - 1, firstSimulationY + 1);
+      const double verticalFraction = simulationY - firstSimulationY;
+      double waveShift = 0;
+      if (sineWave) {
+         const double distanceFromBase = 1 - verticalPosition;
+         waveShift = std::sin(verticalPosition * waveTurns + wavePhase) * waveAmplitude *
+                     distanceFromBase;
+      }
+
+      TexturePixel* pixel = destimage + static_cast<qsizetype>(y) * width;
+      for (int x = 0; x < width; ++x, ++pixel) {
+         const double horizontalPosition = width > 1 ? static_cast<double>(x) / (width - 1) : 0;
+         double simulationX = horizontalPosition * (simulationWidth - 1) - waveShift;
+         simulationX = std::fmod(simulationX, simulationWidth);
+         if (simulationX < 0) {
+            simulationX += simulationWidth;
+         }
+         const int firstSimulationX = static_cast<int>(std::floor(simulationX));
+         if (firstSimulationX >= simulationWidth) {
+            // The script reads past its buffer here and skips the pixel as NaN heat.
+            continue;
+         }
+         const int secondSimulationX = (firstSimulationX + 1) % simulationWidth;
+         const double horizontalFraction = simulationX - firstSimulationX;
+
+         const double topLeftHeat = heat[firstSimulationY * simulationWidth + firstSimulationX];
+         const double topRightHeat = heat[firstSimulationY * simulationWidth + secondSimulationX];
+         const double bottomLeftHeat = heat[secondSimulationY * simulationWidth + firstSimulationX];
+         const double bottomRightHeat =
+             heat[secondSimulationY * simulationWidth + secondSimulationX];
+         const double topHeat = topLeftHeat + (topRightHeat - topLeftHeat) * horizontalFraction;
+         const double bottomHeat =
+             bottomLeftHeat + (bottomRightHeat - bottomLeftHeat) * horizontalFraction;
+         const double sampledHeat = topHeat + (bottomHeat - topHeat) * verticalFraction;
+         const double heatLevel = std::max(0.0, std::min(1.0, sampledHeat / 255));
+         if (!(heatLevel > 0)) {
+            continue;
+         }
+
+         const double palettePosition = std::pow(heatLevel, 0.75);
+         double red;
+         double green;
+         double blue;
+         double paletteAlpha;
+         if (palettePosition < 0.35) {
+            const double amount = palettePosition / 0.35;
+            red = ember.red() * amount;
+            green = ember.green() * amount;
+            blue = ember.blue() * amount;
+            paletteAlpha = ember.alpha();
+         } else if (palettePosition < 0.7) {
+            const double amount = (palettePosition - 0.35) / 0.35;
+            red = ember.red() + (flame.red() - ember.red()) * amount;
+            green = ember.green() + (flame.green() - ember.green()) * amount;
+            blue = ember.blue() + (flame.blue() - ember.blue()) * amount;
+            paletteAlpha = ember.alpha() + (flame.alpha() - ember.alpha()) * amount;
+         } else {
+            const double amount = (palettePosition - 0.7) / 0.3;
+            red = flame.red() + (hot.red() - flame.red()) * amount;
+            green = flame.green() + (hot.green() - flame.green()) * amount;
+            blue = flame.blue() + (hot.blue() - flame.blue()) * amount;
+            paletteAlpha = flame.alpha() + (hot.alpha() - flame.alpha()) * amount;
+         }
+
+         const double fireAlpha = std::min(1.0, heatLevel * 1.35) * paletteAlpha / 255;
+         if (fireAlpha >= 1 || pixel->a == 0) {
+            *pixel = TexturePixel(toUint8(round(red)), toUint8(round(green)),
+                                  toUint8(round(blue)), toUint8(round(fireAlpha * 255)));
+         } else {
+            blendOver(*pixel, red, green, blue, fireAlpha);
+         }
+      }
+   }
+}
@@ -0,0 +1,22 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef FIRETEXTUREGENERATOR_H
+#define FIRETEXTUREGENERATOR_H
+
+#include "nativescriptgenerator.h"
+
+/// @brief Native implementation of the bundled Fire generator, fire.js.
+class FireTextureGenerator : public NativeScriptTextureGenerator {
+public:
+   using NativeScriptTextureGenerator::NativeScriptTextureGenerator;
+   ~FireTextureGenerator() override = default;
+   void generate(QSize size, TexturePixel* destimage,
+                 const QMap<QString, TextureImagePtr>& sourceimages,
+                 const TextureNodeSettings& settings) const override;
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("fire/1"); }
+};
+
+#endif  // FIRETEXTUREGENERATOR_H
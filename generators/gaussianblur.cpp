@@ -5,8 +5,35 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "gaussianblur.h"
+#include "base/texturepixelkernels.h"
+#include <QMutexLocker>
 #include <QtMath>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+
+namespace {
+
+/// @brief Number of columns the vertical pass transposes at once; 16 pixels fill a cache line.
+constexpr int columnBlockWidth = 16;
+
+/// @brief Number of kernels kept before the cache is cleared.
+constexpr int maximumCachedKernels = 64;
+
+/// @brief Copies a row into a buffer with its first and last pixel repeated on each side.
+/// @param source Pixels to copy.
+/// @param count Number of pixels to copy.
+/// @param padding Number of repeated edge pixels on each side.
+/// @param destination Buffer receiving `count + 2 * padding` pixels.
+void copyPadded(const TexturePixel* source, const int count, const int padding,
+                TexturePixel* destination) {
+   std::fill(destination, destination + padding, source[0]);
+   std::copy(source, source + count, destination + padding);
+   std::fill(destination + padding + count, destination + count + 2 * padding,
+             source[count - 1]);
+}
+
+}  // namespace
 
 GaussianBlurTextureGenerator::GaussianBlurTextureGenerator() {
    TextureGeneratorSetting neighbourssetting;
@@ -30,98 +57,143 @@ GaussianBlurTextureGenerator::GaussianBlurTextureGenerator() {
    configurables.append(weightsetting);
 }
 
-float* GaussianBlurTextureGenerator::ComputeGaussianKernel(const int inRadius,
-                                                           const float radiusModifier) const {
-   int mem_amount = (inRadius * 2) + 1;
-   auto* gaussian_kernel = new float[mem_amount];
-
-   float twoRadiusSquaredRecip = 0.5 / (inRadius * inRadius);
-   float sqrtTwoPiTimesRadiusRecip = 1.0 / (sqrt(M_PI * 2) * inRadius);
-
-   // Create Gaussian Kernel
-   int r = -inRadius;
-   float sum = 0;
-   for (int i = 0; i < mem_amount; i++) {
-      float x = r * radiusModifier;
-      x = x * x;
-      float v = sqrtTwoPiTimesRadiusRecip * std::exp(-x * twoRadiusSquaredRecip);
-      gaussian_kernel[i] = v;
-      sum += v;
-      r++;
+GaussianBlurTextureGenerator::Kernel GaussianBlurTextureGenerator::gaussianKernel(
+    const int radius, const float weight) const {
+   const QPair<int, float> key(radius, weight);
+   QMutexLocker locker(&kernelsMutex);
+   const auto cached = kernels.constFind(key);
+   if (cached != kernels.constEnd()) {
+      return cached.value();
+   }
+
+   const int tapCount = radius * 2 + 1;
+   std::vector<double> exact(static_cast<std::size_t>(tapCount));
+   const double twoRadiusSquaredRecip = 0.5 / (static_cast<double>(radius) * radius);
+   double sum = 0;
+   for (int tap = 0; tap < tapCount; ++tap) {
+      const double x = (tap - radius) * static_cast<double>(weight);
+      exact[tap] = std::exp(-x * x * twoRadiusSquaredRecip);
+      sum += exact[tap];
    }
-   // Normalize distribution
-   float div = sum;
-   for (int i = 0; i < mem_amount; i++) {
-      gaussian_kernel[i] /= div;
+   // The weights are normalized to fixed point, and the rounding error is given to the centre
+   // tap, which is the largest, so the weights sum exactly to one.
+   constexpr int one = 1 << TexturePixelKernels::ConvolutionShift;
+   auto weights = std::make_shared<std::vector<qint16>>(static_cast<std::size_t>(tapCount));
+   int total = 0;
+   for (int tap = 0; tap < tapCount; ++tap) {
+      (*weights)[tap] = static_cast<qint16>(std::lround(exact[tap] / sum * one));
+      total += (*weights)[tap];
+   }
+   (*weights)[radius] = static_cast<qint16>((*weights)[radius] + one - total);
+
+   if (kernels.size() >= maximumCachedKernels) {
+      kernels.clear();
+   }
+   Kernel kernel = std::move(weights);
+   kernels.insert(key, kernel);
+   return kernel;
+}
+
+QList<QRect> GaussianBlurTextureGenerator::getTilingRegions(QSize size, int pass,
+                                                            int maximumRegionCount) const {
+   if (pass == 0) {
+      return TextureGenerator::getTilingRegions(size, pass, maximumRegionCount);
+   }
+   // The vertical pass blurs whole columns in place, so it splits by blocks of columns.
+   QList<QRect> regions;
+   const int width = qMax(size.width(), 0);
+   const int blockCount = (width + columnBlockWidth - 1) / columnBlockWidth;
+   const int regionCount = qBound(1, maximumRegionCount, qMax(blockCount, 1));
+   for (int index = 0; index < regionCount; ++index) {
+      const auto blockBoundary = [&](const int boundary) {
+         const auto block = static_cast<qint64>(blockCount) * boundary / regionCount;
+         return static_cast<int>(qMin<qint64>(block * columnBlockWidth, width));
+      };
+      const int left = blockBoundary(index);
+      const int right = blockBoundary(index + 1);
+      if (right > left) {
+         regions.append(QRect(left, 0, right - left, size.height()));
+      }
    }
-   return gaussian_kernel;
+   return regions;
 }
 
-/// @brief Calculates the Gaussian Blur and stores the result on the height map given
 void GaussianBlurTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                             const QMap<QString, TextureImagePtr>& sourceimages,
                                             const TextureNodeSettings& settings) const {
-   if (!destimage || !size.isValid()) {
+   const QRect image(QPoint(0, 0), size);
+   generateRegion(size, 0, image, destimage, sourceimages, settings);
+   generateRegion(size, 1, image, destimage, sourceimages, settings);
+}
+
+void GaussianBlurTextureGenerator::generateRegion(
+    QSize size, int pass, QRect region, TexturePixel* destimage,
+    const QMap<QString, TextureImagePtr>& sourceimages, const TextureNodeSettings& settings) const {
+   if (!destimage || !size.isValid() || size.isEmpty()) {
       return;
    }
-   int numNeightbours = settings.value("numneighbours").toInt();
-   float inWeight = settings.value("weight").toFloat();
-
-   memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
+   const int radius = settings.value("numneighbours").toInt();
+   const float weight = settings.value("weight").toFloat();
+   const TextureImagePtr source = sourceimages.value(QStringLiteral("Image"));
+   if (source.isNull()) {
+      if (pass == 0) {
+         fillTextureRegion(size, region, destimage, TexturePixel());
+      }
+      return;
+   }
+   if (radius <= 0) {
+      if (pass == 0) {
+         copyTextureRegion(size, region, source->getData(), destimage);
+      }
+      return;
+   }
+   const Kernel kernel = gaussianKernel(radius, weight);
+   const int tapCount = static_cast<int>(kernel->size());
+   const int width = size.width();
+   const int height = size.height();
 
-   if (!sourceimages.contains(QStringLiteral("Image"))) {
+   if (pass == 0) {
+      // Each source row is copied with its edge pixels repeated, so the convolution reads a
+      // contiguous span without bounds checks.
+      std::vector<TexturePixel> padded(static_cast<std::size_t>(width + 2 * radius));
+      for (int y = region.top(); y <= region.bottom(); y++) {
+         copyPadded(source->getData() + static_cast<std::ptrdiff_t>(y) * width, width, radius,
+                    padded.data());
+         TexturePixelKernels::convolve(
+             destimage + static_cast<std::ptrdiff_t>(y) * width + region.left(),
+             padded.data() + region.left(), static_cast<std::size_t>(region.width()),
+             kernel->data(), tapCount);
+      }
       return;
    }
-   TexturePixel* sourceImage = sourceimages.value(QStringLiteral("Image")).data()->getData();
-
-   int pixels_on_row = 1 + (numNeightbours * 2);
-
-   float* gaussian_kernel = ComputeGaussianKernel(numNeightbours, inWeight);
-
-   for (int y = 0; y < size.height(); y++) {
-      int row = y * size.width();
-      for (int x = 0; x < size.width(); x++) {
-         TexturePixel blurred_value(0, 0, 0, 0);
-         for (int xoffset = 0; xoffset < pixels_on_row; xoffset++) {
-            int sx = x - numNeightbours + xoffset;
-            if (sx < 0) {
-               sx = 0;
-            } else if (sx > size.width() - 1) {
-               sx = size.width() - 1;
-            }
-            // Calculate newly blurred value
-            int pixelPos = row + sx;
-            blurred_value.r += gaussian_kernel[xoffset] * sourceImage[pixelPos].r;
-            blurred_value.g += gaussian_kernel[xoffset] * sourceImage[pixelPos].g;
-            blurred_value.b += gaussian_kernel[xoffset] * sourceImage[pixelPos].b;
-            blurred_value.a += gaussian_kernel[xoffset] * sourceImage[pixelPos].a;
+
+   // The vertical pass transposes blocks of columns into contiguous buffers, convolves them like
+   // rows and transposes the result back, so every image access reads or writes a whole block of
+   // neighbouring pixels in one row instead of striding down a single column.
+   const int paddedHeight = height + 2 * radius;
+   std::vector<TexturePixel> columns(static_cast<std::size_t>(columnBlockWidth) * paddedHeight);
+   std::vector<TexturePixel> blurred(static_cast<std::size_t>(columnBlockWidth) * height);
+   for (int left = region.left(); left <= region.right(); left += columnBlockWidth) {
+      const int blockWidth = qMin(columnBlockWidth, region.right() + 1 - left);
+      for (int y = 0; y < height; y++) {
+         const TexturePixel* row = destimage + static_cast<std::ptrdiff_t>(y) * width + left;
+         for (int column = 0; column < blockWidth; column++) {
+            columns[static_cast<std::size_t>(column) * paddedHeight + radius + y] = row[column];
          }
-         // Set our calculated value to our temp map
-         destimage[y * size.width() + x] = blurred_value;
       }
-   }
-   for (int y = 0; y < size.height(); y++) {
-      for (int x = 0; x < size.width(); x++) {
-         TexturePixel blurred_value(0, 0, 0, 0);
-         for (int yoffset = 0; yoffset < pixels_on_row; yoffset++) {
-            int sy = y - numNeightbours + yoffset;
-            if (sy < 0) {
-               sy = 0;
-            } else if (sy > size.height() - 1) {
-               sy = size.height() - 1;
-            }
-            int pixelPos = sy * size.width() + x;
-            // Calculate blurred value
-            blurred_value.r += gaussian_kernel[yoffset] * destimage[pixelPos].r;
-            blurred_value.g += gaussian_kernel[yoffset] * destimage[pixelPos].g;
-            blurred_value.b += gaussian_kernel[yoffset] * destimage[pixelPos].b;
-            blurred_value.a += gaussian_kernel[yoffset] * destimage[pixelPos].a;
+      for (int column = 0; column < blockWidth; column++) {
+         TexturePixel* padded = columns.data() + static_cast<std::size_t>(column) * paddedHeight;
+         std::fill(padded, padded + radius, padded[radius]);
+         std::fill(padded + radius + height, padded + paddedHeight, padded[radius + height - 1]);
+         TexturePixelKernels::convolve(blurred.data() + static_cast<std::size_t>(column) * height,
+                                       padded, static_cast<std::size_t>(height), kernel->data(),
+                                       tapCount);
+      }
+      for (int y = 0; y < height; y++) {
+         TexturePixel* row = destimage + static_cast<std::ptrdiff_t>(y) * width + left;
+         for (int column = 0; column < blockWidth; column++) {
+            row[column] = blurred[static_cast<std::size_t>(column) * height + y];
          }
-
-         // Set the original height map value to our computed value
-         // This is the actual blurred value (previously scaled)
-         destimage[y * size.width() + x] = blurred_value;
       }
    }
-   delete[] gaussian_kernel;
 }
@@ -8,6 +8,11 @@
 #define GAUSSIANBLURTEXTUREGENERATOR_H
 
 #include "base/texturegenerator.h"
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <memory>
+#include <vector>
 
 /// @brief The GaussianBlurTextureGenerator class
 class GaussianBlurTextureGenerator : public TextureGenerator {
@@ -17,8 +22,16 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   bool writesEveryPixel() const override { return true; }
+   int getTilingPassCount() const override { return 2; }
+   QList<QRect> getTilingRegions(QSize size, int pass, int maximumRegionCount) const override;
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Gaussian blur"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("gaussianblur/2"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Softens the input image using a configurable Gaussian blur.");
@@ -26,8 +39,20 @@ public:
    TextureGenerator::Type getType() const override { return TextureGenerator::Type::Filter; }
 
 private:
+   /// @brief Fixed-point kernel weights shared by every render with the same settings.
+   using Kernel = std::shared_ptr<const std::vector<qint16>>;
+
+   /// @brief Returns the cached kernel for a radius and centre weight, computing it if needed.
+   /// @param radius Number of neighbouring pixels sampled in each direction.
+   /// @param weight Centre weight setting; larger values narrow the bell curve.
+   /// @return `2 * radius + 1` weights summing to `1 << TexturePixelKernels::ConvolutionShift`.
+   Kernel gaussianKernel(int radius, float weight) const;
+
    TextureGeneratorSettings configurables;
-   float* ComputeGaussianKernel(const int inRadius, const float inWeight) const;
+   /// @brief Protects the kernel cache, which is shared by concurrently rendered regions.
+   mutable QMutex kernelsMutex;
+   /// @brief Kernels computed so far, keyed by radius and centre weight.
+   mutable QMap<QPair<int, float>, Kernel> kernels;
 };
 
 #endif  // GAUSSIANBLURTEXTUREGENERATOR_H
@@ -127,8 +127,11 @@ void GradientTextureGenerator::generate(QSize size, TexturePixel* destimage,
 
    QImage tempimage = makeTextureImageView(size, destimage);
    if (sourceimages.contains(QStringLiteral("Background"))) {
-      memcpy(destimage, sourceimages.value(QStringLiteral("Background"))->getData(),
-             size.width() * size.height() * sizeof(TexturePixel));
+      // A destination that is the background's own buffer already holds it.
+      const TexturePixel* background = sourceimages.value(QStringLiteral("Background"))->getData();
+      if (background != destimage) {
+         memcpy(destimage, background, size.width() * size.height() * sizeof(TexturePixel));
+      }
    } else {
       memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
    }
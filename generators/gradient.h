@@ -17,8 +17,10 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   QString getInPlaceSlot() const override { return QStringLiteral("Background"); }
    QStringList getSourceSlots() const override { return {QStringLiteral("Background")}; }
    QString getName() const override { return QString("Gradient"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("gradient/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Generates a linear, radial, or conical three-colour gradient.");
@@ -5,29 +5,33 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "greyscale.h"
+#include "base/texturepixelkernels.h"
+
 void GreyscaleTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                          const QMap<QString, TextureImagePtr>& sourceimages,
                                          const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void GreyscaleTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                               TexturePixel* destimage,
+                                               const QMap<QString, TextureImagePtr>& sourceimages,
+                                               const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    Q_UNUSED(settings);
 
    if (!destimage || !size.isValid()) {
       return;
    }
    if (!sourceimages.contains(QStringLiteral("Image"))) {
-      memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel());
       return;
    }
    TexturePixel* sourceImage = sourceimages.value(QStringLiteral("Image")).data()->getData();
 
-   for (int j = 0; j < size.height(); j++) {
-      for (int i = 0; i < size.width(); i++) {
-         int pixelpos = j * size.width() + i;
-         TexturePixel sourcePixel = sourceImage[pixelpos];
-         auto color = static_cast<unsigned char>(sourcePixel.intensity() * 255);
-         destimage[pixelpos].r = color;
-         destimage[pixelpos].g = color;
-         destimage[pixelpos].b = color;
-         destimage[pixelpos].a = sourcePixel.a;
-      }
+   for (int y = region.top(); y <= region.bottom(); y++) {
+      const int rowStart = y * size.width() + region.left();
+      TexturePixelKernels::luminance(destimage + rowStart, sourceImage + rowStart,
+                                     region.width());
    }
 }
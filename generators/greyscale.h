@@ -17,8 +17,14 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   bool writesEveryPixel() const override { return true; }
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Greyscale"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("greyscale/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Converts the input image to greyscale while preserving alpha.");
@@ -5,6 +5,7 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "invert.h"
+#include "base/texturepixelkernels.h"
 
 InvertTextureGenerator::InvertTextureGenerator() {
    QStringList options;
@@ -46,6 +47,14 @@ InvertTextureGenerator::InvertTextureGenerator() {
 void InvertTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                       const QMap<QString, TextureImagePtr>& sourceimages,
                                       const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void InvertTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                            TexturePixel* destimage,
+                                            const QMap<QString, TextureImagePtr>& sourceimages,
+                                            const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    if (!destimage || !size.isValid()) {
       return;
    }
@@ -53,45 +62,18 @@ void InvertTextureGenerator::generate(QSize size, TexturePixel* destimage,
    auto channelGreenStr = settings.value("channelGreen").toString();
    auto channelBlueStr = settings.value("channelBlue").toString();
    auto channelAlphaStr = settings.value("channelAlpha").toString();
-   int numPixels = size.width() * size.height();
    TexturePixel* source = nullptr;
    if (sourceimages.contains(QStringLiteral("Image"))) {
       source = sourceimages.value(QStringLiteral("Image")).data()->getData();
    }
    if (!source) {
-      memset(destimage, 0, numPixels * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel());
       return;
    }
-   memcpy(destimage, source, numPixels * sizeof(TexturePixel));
-
-   bool channelRedInvert = false;
-   bool channelGreenInvert = false;
-   bool channelBlueInvert = false;
-   bool channelAlphaInvert = false;
-   if (channelRedStr == "Yes") {
-      channelRedInvert = true;
-   }
-   if (channelGreenStr == "Yes") {
-      channelGreenInvert = true;
-   }
-   if (channelBlueStr == "Yes") {
-      channelBlueInvert = true;
-   }
-   if (channelAlphaStr == "Yes") {
-      channelAlphaInvert = true;
-   }
-   for (int thisPos = 0; thisPos < numPixels; thisPos++) {
-      if (channelRedInvert) {
-         destimage[thisPos].r = 255 - destimage[thisPos].r;
-      }
-      if (channelGreenInvert) {
-         destimage[thisPos].g = 255 - destimage[thisPos].g;
-      }
-      if (channelBlueInvert) {
-         destimage[thisPos].b = 255 - destimage[thisPos].b;
-      }
-      if (channelAlphaInvert) {
-         destimage[thisPos].a = 255 - destimage[thisPos].a;
-      }
+   const TexturePixel mask(channelRedStr == "Yes" ? 255 : 0, channelGreenStr == "Yes" ? 255 : 0,
+                           channelBlueStr == "Yes" ? 255 : 0, channelAlphaStr == "Yes" ? 255 : 0);
+   for (int y = region.top(); y <= region.bottom(); y++) {
+      const int rowStart = y * size.width() + region.left();
+      TexturePixelKernels::invert(destimage + rowStart, source + rowStart, region.width(), mask);
    }
 }
@@ -6,7 +6,18 @@
 
 #include "lens.h"
 #include <QPoint>
+#include <algorithm>
 #include <cmath>
+#include <vector>
+
+namespace {
+
+/// @brief Returns the lens diameter in pixels of an image size.
+int lensDiameter(const QSize size, const TextureNodeSettings& settings) {
+   return settings.value("size").toDouble() * size.height() / 100;
+}
+
+}  // namespace
 
 LensTextureGenerator::LensTextureGenerator() {
    TextureGeneratorSetting offsetleft;
@@ -45,6 +56,12 @@ LensTextureGenerator::LensTextureGenerator() {
    strength.id = "strength";
    configurables.append(strength);
 }
+
+QString LensTextureGenerator::getPassThroughSlot(QSize size,
+                                                 const TextureNodeSettings& settings) const {
+   return lensDiameter(size, settings) <= 0 ? QStringLiteral("Image") : QString();
+}
+
 void LensTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                     const QMap<QString, TextureImagePtr>& sourceimages,
                                     const TextureNodeSettings& settings) const {
@@ -53,7 +70,7 @@ void LensTextureGenerator::generate(QSize size, TexturePixel* destimage,
    }
    int offsetleft = settings.value("offsetleft").toDouble() * size.width() / 100;
    int offsettop = settings.value("offsettop").toDouble() * size.height() / 100;
-   int lenssize = settings.value("size").toDouble() * size.height() / 100;
+   int lenssize = lensDiameter(size, settings);
    double strength = (300 - settings.value("strength").toDouble()) * size.width() / 100;
    if (!sourceimages.contains(QStringLiteral("Image"))) {
       memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
@@ -61,7 +78,9 @@ void LensTextureGenerator::generate(QSize size, TexturePixel* destimage,
    }
    TexturePixel* sourceimage = sourceimages.value(QStringLiteral("Image")).data()->getData();
 
-   memcpy(destimage, sourceimage, size.width() * size.height() * sizeof(TexturePixel));
+   if (destimage != sourceimage) {
+      memcpy(destimage, sourceimage, size.width() * size.height() * sizeof(TexturePixel));
+   }
 
    if (lenssize % 2) {
       lenssize += 1;
@@ -84,6 +103,14 @@ void LensTextureGenerator::generate(QSize size, TexturePixel* destimage,
          lens[lenssize * (lenssize / 2 - y) + lenssize / 2 + x] = QPoint(ix, -iy);
       }
    }
+   // Rendering over the source, the lens area is collected first so no pixel is read after it
+   // was written.
+   const bool inPlace = destimage == sourceimage;
+   const QRect lensArea = QRect(size.width() / 2 + offsetleft - lenssize / 2,
+                                size.height() / 2 + offsettop - lenssize / 2, lenssize, lenssize)
+                              .intersected(QRect(QPoint(0, 0), size));
+   std::vector<TexturePixel> refracted(
+       inPlace ? static_cast<std::size_t>(lensArea.width()) * lensArea.height() : 0);
    for (int y = 0; y < lenssize; y++) {
       int ypos = y + size.height() / 2 + offsettop - lenssize / 2;
       for (int x = 0; x < lenssize; x++) {
@@ -102,9 +129,17 @@ void LensTextureGenerator::generate(QSize size, TexturePixel* destimage,
             } else {
                sourcey = sourcey % size.height();
             }
-            destimage[destpos] = sourceimage[sourcey * size.width() + sourcex];
+            TexturePixel& target =
+                inPlace ? refracted[(ypos - lensArea.top()) * lensArea.width() + xpos -
+                                    lensArea.left()]
+                        : destimage[destpos];
+            target = sourceimage[sourcey * size.width() + sourcex];
          }
       }
    }
+   for (int y = 0; inPlace && y < lensArea.height(); y++) {
+      std::copy_n(refracted.cbegin() + y * lensArea.width(), lensArea.width(),
+                  destimage + (lensArea.top() + y) * size.width() + lensArea.left());
+   }
    delete[] lens;
 }
@@ -17,8 +17,11 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   QString getPassThroughSlot(QSize size, const TextureNodeSettings& settings) const override;
+   QString getInPlaceSlot() const override { return QStringLiteral("Image"); }
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Lens"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("lens/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Warps the input image through a configurable circular lens.");
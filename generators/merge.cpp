@@ -5,6 +5,7 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "merge.h"
+#include "base/texturepixelkernels.h"
 
 QStringList MergeTextureGenerator::getSourceSlots() const {
    QStringList sourceSlots;
@@ -18,18 +19,27 @@ QStringList MergeTextureGenerator::getSourceSlots() const {
 void MergeTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                      const QMap<QString, TextureImagePtr>& sourceimages,
                                      const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void MergeTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                           TexturePixel* destimage,
+                                           const QMap<QString, TextureImagePtr>& sourceimages,
+                                           const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    Q_UNUSED(settings);
    if (!destimage || !size.isValid()) {
       return;
    }
-   int numPixels = size.width() * size.height();
-   memset(destimage, 0, numPixels * sizeof(TexturePixel));
+   fillTextureRegion(size, region, destimage, TexturePixel());
    QMapIterator<QString, TextureImagePtr> sourceIterator(sourceimages);
    while (sourceIterator.hasNext()) {
       sourceIterator.next();
       TexturePixel* newSource = sourceIterator.value().data()->getData();
-      for (int i = 0; i < numPixels; i++) {
-         destimage[i] += newSource[i];
+      for (int y = region.top(); y <= region.bottom(); y++) {
+         const int rowStart = y * size.width() + region.left();
+         TexturePixelKernels::addSaturated(destimage + rowStart, newSource + rowStart,
+                                           region.width());
       }
    }
 }
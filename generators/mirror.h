@@ -19,6 +19,7 @@ public:
                  const TextureNodeSettings& settings) const override;
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Mirror"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("mirror/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Reflects the input image horizontally or vertically.");
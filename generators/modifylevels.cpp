@@ -5,6 +5,7 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "modifylevels.h"
+#include "base/texturepixelkernels.h"
 
 ModifyLevelsTextureGenerator::ModifyLevelsTextureGenerator() {
    TextureGeneratorSetting channel;
@@ -42,19 +43,50 @@ ModifyLevelsTextureGenerator::ModifyLevelsTextureGenerator() {
    blendingAlpha.id = "level";
    configurables.append(blendingAlpha);
 }
+
+namespace {
+
+/// @brief Computes the value a channel value is multiplied to.
+quint8 multiplyLevel(const double levelFactor, const int value) {
+   return static_cast<quint8>(qMax(qMin((int)(levelFactor * value), 255), 0));
+}
+
+}  // namespace
+
+QString ModifyLevelsTextureGenerator::getPassThroughSlot(
+    QSize size, const TextureNodeSettings& settings) const {
+   Q_UNUSED(size);
+   const QString mode = settings.value("mode").toString();
+   bool unchanged = true;
+   if (mode == "Add") {
+      unchanged = qMin(settings.value("level").toInt(), 255) == 0;
+   } else if (mode == "Multiply") {
+      const double levelFactor = settings.value("level").toDouble() / 100;
+      for (int value = 0; value < 256 && unchanged; value++) {
+         unchanged = multiplyLevel(levelFactor, value) == value;
+      }
+   }
+   return unchanged ? QStringLiteral("Image") : QString();
+}
+
 void ModifyLevelsTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                             const QMap<QString, TextureImagePtr>& sourceimages,
                                             const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void ModifyLevelsTextureGenerator::generateRegion(
+    QSize size, int pass, QRect region, TexturePixel* destimage,
+    const QMap<QString, TextureImagePtr>& sourceimages, const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    if (!destimage || !size.isValid()) {
       return;
    }
-   int numpixels = size.width() * size.height();
    if (!sourceimages.contains(QStringLiteral("Image"))) {
-      memset(destimage, 0, numpixels * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel());
       return;
    }
-   memcpy(destimage, sourceimages.value(QStringLiteral("Image"))->getData(),
-          numpixels * sizeof(TexturePixel));
+   const TexturePixel* source = sourceimages.value(QStringLiteral("Image"))->getData();
 
    QString mode = settings.value("mode").toString();
    QString channel = settings.value("channel").toString();
@@ -77,34 +109,34 @@ void ModifyLevelsTextureGenerator::generate(QSize size, TexturePixel* destimage,
    }
 
    if (mode == "Add") {
-      for (int i = 0; i < numpixels; i++) {
-         if (r) {
-            destimage[i].r = qMax(qMin(levelAbsolute + destimage[i].r, 255), 0);
-         }
-         if (g) {
-            destimage[i].g = qMax(qMin(levelAbsolute + destimage[i].g, 255), 0);
-         }
-         if (b) {
-            destimage[i].b = qMax(qMin(levelAbsolute + destimage[i].b, 255), 0);
-         }
-         if (a) {
-            destimage[i].a = qMax(qMin(levelAbsolute + destimage[i].a, 255), 0);
-         }
+      const auto increase = static_cast<quint8>(qMax(levelAbsolute, 0));
+      const auto decrease = static_cast<quint8>(qMin(qMax(-levelAbsolute, 0), 255));
+      const TexturePixel increases(r ? increase : 0, g ? increase : 0, b ? increase : 0,
+                                   a ? increase : 0);
+      const TexturePixel decreases(r ? decrease : 0, g ? decrease : 0, b ? decrease : 0,
+                                   a ? decrease : 0);
+      for (int y = region.top(); y <= region.bottom(); y++) {
+         const int rowStart = y * size.width() + region.left();
+         TexturePixelKernels::offsetSaturated(destimage + rowStart, source + rowStart,
+                                              region.width(), increases, decreases);
       }
    } else if (mode == "Multiply") {
-      for (int i = 0; i < numpixels; i++) {
-         if (r) {
-            destimage[i].r = qMax(qMin((int)(levelFactor * destimage[i].r), 255), 0);
-         }
-         if (g) {
-            destimage[i].g = qMax(qMin((int)(levelFactor * destimage[i].g), 255), 0);
-         }
-         if (b) {
-            destimage[i].b = qMax(qMin((int)(levelFactor * destimage[i].b), 255), 0);
-         }
-         if (a) {
-            destimage[i].a = qMax(qMin((int)(levelFactor * destimage[i].a), 255), 0);
-         }
+      // Each channel value has one result, so the products are computed once per render.
+      TexturePixelKernels::ChannelLookupTables tables;
+      for (int value = 0; value < 256; value++) {
+         const quint8 scaled = multiplyLevel(levelFactor, value);
+         const auto unchanged = static_cast<quint8>(value);
+         tables.red[value] = r ? scaled : unchanged;
+         tables.green[value] = g ? scaled : unchanged;
+         tables.blue[value] = b ? scaled : unchanged;
+         tables.alpha[value] = a ? scaled : unchanged;
+      }
+      for (int y = region.top(); y <= region.bottom(); y++) {
+         const int rowStart = y * size.width() + region.left();
+         TexturePixelKernels::applyLookup(destimage + rowStart, source + rowStart, region.width(),
+                                          tables);
       }
+   } else if (source != destimage) {
+      copyTextureRegion(size, region, source, destimage);
    }
 }
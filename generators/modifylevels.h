@@ -17,8 +17,16 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   bool writesEveryPixel() const override { return true; }
+   QString getPassThroughSlot(QSize size, const TextureNodeSettings& settings) const override;
+   QString getInPlaceSlot() const override { return QStringLiteral("Image"); }
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Modify levels"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("modifylevels/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Adjusts selected colour and alpha channels by adding or multiplying.");
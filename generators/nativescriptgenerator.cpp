@@ -0,0 +1,67 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "nativescriptgenerator.h"
+#include <cmath>
+
+NativeScriptTextureGenerator::NativeScriptTextureGenerator(const TextureGenerator& script)
+    : configurables(script.getSettings()),
+      inputSlots(script.getSourceSlots()),
+      name(script.getName()),
+      description(script.getDescription()),
+      type(script.getType()) {}
+
+quint8 NativeScriptTextureGenerator::toUint8(const double value) {
+   if (!std::isfinite(value)) {
+      return 0;
+   }
+   const double truncated = std::trunc(value);
+   if (truncated >= 0 && truncated < 256) {
+      return static_cast<quint8>(truncated);
+   }
+   double wrapped = std::fmod(truncated, 256.0);
+   if (wrapped < 0) {
+      wrapped += 256.0;
+   }
+   return static_cast<quint8>(wrapped);
+}
+
+quint32 NativeScriptTextureGenerator::toUint32(const double value) {
+   if (!std::isfinite(value)) {
+      return 0;
+   }
+   double wrapped = std::fmod(std::trunc(value), 4294967296.0);
+   if (wrapped < 0) {
+      wrapped += 4294967296.0;
+   }
+   return static_cast<quint32>(wrapped);
+}
+
+double NativeScriptTextureGenerator::round(const double value) { return std::floor(value + 0.5); }
+
+void NativeScriptTextureGenerator::blendOver(TexturePixel& pixel, const double red,
+                                             const double green, const double blue,
+                                             const double opacity) {
+   const double backgroundOpacity = pixel.a / 255.0;
+   const double remainingBackground = 1 - opacity;
+   const double resultOpacity = opacity + backgroundOpacity * remainingBackground;
+   pixel.r = toUint8(round(
+       (red * opacity + pixel.r * backgroundOpacity * remainingBackground) / resultOpacity));
+   pixel.g = toUint8(round(
+       (green * opacity + pixel.g * backgroundOpacity * remainingBackground) / resultOpacity));
+   pixel.b = toUint8(round(
+       (blue * opacity + pixel.b * backgroundOpacity * remainingBackground) / resultOpacity));
+   pixel.a = toUint8(round(resultOpacity * 255));
+}
+
+void NativeScriptTextureGenerator::copyBackground(QSize size, QRect region,
+                                                  const TextureImagePtr& background,
+                                                  TexturePixel* destimage) {
+   if (background.isNull()) {
+      fillTextureRegion(size, region, destimage, TexturePixel());
+   } else {
+      copyTextureRegion(size, region, background->data(), destimage);
+   }
+}
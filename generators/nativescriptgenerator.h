@@ -0,0 +1,73 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef NATIVESCRIPTGENERATOR_H
+#define NATIVESCRIPTGENERATOR_H
+
+#include "base/texturegenerator.h"
+
+/// @brief Base of the C++ implementations that render in place of bundled JavaScript generators.
+/// @details An implementation is attached to the JsTexGen it replaces, so it takes the script's
+/// name, settings and input slots and reads the same setting IDs; saved projects therefore load
+/// and render unchanged. The helpers reproduce the JavaScript number conversions the scripts rely
+/// on, which keeps the output equal to the script's apart from the last bit of Math.sin and
+/// Math.cos.
+class NativeScriptTextureGenerator : public TextureGenerator {
+public:
+   /// @brief Copies the public metadata of the script being replaced.
+   /// @param script Bundled JavaScript generator rendered by this implementation.
+   explicit NativeScriptTextureGenerator(const TextureGenerator& script);
+   ~NativeScriptTextureGenerator() override = default;
+   bool writesEveryPixel() const override { return true; }
+   const TextureGeneratorSettings& getSettings() const override { return configurables; }
+   TextureGenerator::Type getType() const override { return type; }
+   QStringList getSourceSlots() const override { return inputSlots; }
+   QString getName() const override { return name; }
+   QString getDescription() const override { return description; }
+
+protected:
+   /// @brief Converts a number as a store into a JavaScript Uint8Array does.
+   /// @param value Number to store.
+   /// @return The value truncated and wrapped to 0-255, or zero for NaN and infinities.
+   static quint8 toUint8(double value);
+
+   /// @brief Converts a number as JavaScript's unsigned shift operator does.
+   /// @param value Number to convert.
+   /// @return The value truncated and wrapped to 32 bits, or zero for NaN and infinities.
+   static quint32 toUint32(double value);
+
+   /// @brief Rounds a number as JavaScript's Math.round() does.
+   /// @param value Number to round.
+   /// @return The nearest integer, with halves rounded towards positive infinity.
+   static double round(double value);
+
+   /// @brief Paints a colour over a pixel with straight-alpha source-over composition.
+   /// @details Matches the composition written out in the bundled scripts, including the rounding
+   /// of every channel.
+   /// @param pixel Background pixel that receives the result.
+   /// @param red Red channel of the colour, from 0 to 255.
+   /// @param green Green channel of the colour, from 0 to 255.
+   /// @param blue Blue channel of the colour, from 0 to 255.
+   /// @param opacity Opacity of the colour, greater than zero.
+   static void blendOver(TexturePixel& pixel, double red, double green, double blue,
+                         double opacity);
+
+   /// @brief Copies one region of an optional background image, or clears it without one.
+   /// @param size Width and height of the image.
+   /// @param region Pixels to write, in image coordinates.
+   /// @param background Background image, or null.
+   /// @param destimage Pixel buffer written for the whole image.
+   static void copyBackground(QSize size, QRect region, const TextureImagePtr& background,
+                              TexturePixel* destimage);
+
+private:
+   TextureGeneratorSettings configurables;
+   QStringList inputSlots;
+   QString name;
+   QString description;
+   TextureGenerator::Type type;
+};
+
+#endif  // NATIVESCRIPTGENERATOR_H
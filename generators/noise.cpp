@@ -0,0 +1,93 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "noise.h"
+#include <QColor>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void NoiseTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                     const QMap<QString, TextureImagePtr>& sourceimages,
+                                     const TextureNodeSettings& settings) const {
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   copyBackground(size, QRect(QPoint(0, 0), size),
+                  sourceimages.value(QStringLiteral("Background")), destimage);
+
+   const int width = size.width();
+   const int height = size.height();
+   const int noiseWidth = static_cast<int>(
+       std::max(1.0, round(width * settings.value("width").toDouble() / 100)));
+   const int noiseHeight = static_cast<int>(
+       std::max(1.0, round(height * settings.value("height").toDouble() / 100)));
+   std::vector<quint8> noiseAlpha(static_cast<std::size_t>(noiseWidth) * noiseHeight, 0);
+
+   const double alphaMin = settings.value("alphamin").toDouble();
+   const double alphaMax = settings.value("alphamax").toDouble();
+   const double minimumAlpha = std::min(alphaMin, alphaMax);
+   const double alphaRange = std::max(alphaMin, alphaMax) - minimumAlpha + 1;
+   const double density = settings.value("density").toDouble() / 100;
+   const bool scatter = settings.value("scatter").toBool();
+
+   // The same linear congruential sequence as the script, so seeds keep their patterns.
+   quint32 randomState = toUint32(settings.value("randomizer").toDouble());
+   for (quint8& sample : noiseAlpha) {
+      randomState = 1664525U * randomState + 1013904223U;
+      const double placement = randomState / 4294967296.0;
+      if (scatter && placement >= density) {
+         continue;
+      }
+      randomState = 1664525U * randomState + 1013904223U;
+      const double opacity = randomState / 4294967296.0;
+      sample = toUint8(minimumAlpha + std::floor(opacity * alphaRange));
+   }
+
+   const QColor colour = settings.value("color").value<QColor>();
+   const double colourAlpha = colour.alpha() / 255.0;
+   const bool nearest = !settings.value("smoothscale").toBool() ||
+                        (noiseWidth == width && noiseHeight == height);
+
+   // Nearest sampling picks the same grid column for every row, so the columns are found once.
+   std::vector<int> sampleColumns(static_cast<std::size_t>(width));
+   for (int x = 0; x < width; ++x) {
+      const double column = std::floor(static_cast<double>(x) * noiseWidth / width);
+      sampleColumns[x] = std::min(noiseWidth - 1, static_cast<int>(column));
+   }
+
+   for (int y = 0; y < height; ++y) {
+      TexturePixel* row = destimage + static_cast<qsizetype>(y) * width;
+      const double nearestRow = std::floor(static_cast<double>(y) * noiseHeight / height);
+      const int sampleRow = std::min(noiseHeight - 1, static_cast<int>(nearestRow));
+      const double exactY = (y + 0.5) * noiseHeight / height - 0.5;
+      const int top = std::max(0, static_cast<int>(std::floor(exactY)));
+      const int bottom = std::min(noiseHeight - 1, top + 1);
+      const double verticalPart = std::max(0.0, exactY - top);
+      for (int x = 0; x < width; ++x) {
+         double sampledAlpha;
+         if (nearest) {
+            sampledAlpha = noiseAlpha[sampleRow * noiseWidth + sampleColumns[x]];
+         } else {
+            // Pixel centres map to the grid; outside the first or last centre the edge is used.
+            const double exactX = (x + 0.5) * noiseWidth / width - 0.5;
+            const int left = std::max(0, static_cast<int>(std::floor(exactX)));
+            const int right = std::min(noiseWidth - 1, left + 1);
+            const double horizontalPart = std::max(0.0, exactX - left);
+            const double topLeft = noiseAlpha[top * noiseWidth + left];
+            const double bottomLeft = noiseAlpha[bottom * noiseWidth + left];
+            const double topRight = noiseAlpha[top * noiseWidth + right];
+            const double topAlpha = topLeft + (topRight - topLeft) * horizontalPart;
+            const double bottomRight = noiseAlpha[bottom * noiseWidth + right];
+            const double bottomAlpha = bottomLeft + (bottomRight - bottomLeft) * horizontalPart;
+            sampledAlpha = topAlpha + (bottomAlpha - topAlpha) * verticalPart;
+         }
+         const double noiseOpacity = sampledAlpha / 255 * colourAlpha;
+         if (noiseOpacity > 0) {
+            blendOver(row[x], colour.red(), colour.green(), colour.blue(), noiseOpacity);
+         }
+      }
+   }
+}
@@ -0,0 +1,22 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef NOISETEXTUREGENERATOR_H
+#define NOISETEXTUREGENERATOR_H
+
+#include "nativescriptgenerator.h"
+
+/// @brief Native implementation of the bundled Noise generator, noise.js.
+class NoiseTextureGenerator : public NativeScriptTextureGenerator {
+public:
+   using NativeScriptTextureGenerator::NativeScriptTextureGenerator;
+   ~NoiseTextureGenerator() override = default;
+   void generate(QSize size, TexturePixel* destimage,
+                 const QMap<QString, TextureImagePtr>& sourceimages,
+                 const TextureNodeSettings& settings) const override;
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("noise/1"); }
+};
+
+#endif  // NOISETEXTUREGENERATOR_H
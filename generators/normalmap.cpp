@@ -9,19 +9,33 @@
 void NormalMapTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                          const QMap<QString, TextureImagePtr>& sourceimages,
                                          const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void NormalMapTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                               TexturePixel* destimage,
+                                               const QMap<QString, TextureImagePtr>& sourceimages,
+                                               const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
+   Q_UNUSED(settings);
    if (!destimage || !size.isValid()) {
       return;
    }
 
-   memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
+   fillTextureRegion(size, region, destimage, TexturePixel());
 
    if (!sourceimages.contains(QStringLiteral("Height map"))) {
       return;
    }
    TexturePixel* sourceImage = sourceimages.value(QStringLiteral("Height map"))->getData();
 
-   for (int y = 1; y < size.height() - 1; y++) {
-      for (int x = 1; x < size.width() - 1; x++) {
+   // The outermost pixels have no complete neighbourhood and stay transparent.
+   const int firstRow = qMax(region.top(), 1);
+   const int lastRow = qMin(region.bottom(), size.height() - 2);
+   const int firstColumn = qMax(region.left(), 1);
+   const int lastColumn = qMin(region.right(), size.width() - 2);
+   for (int y = firstRow; y <= lastRow; y++) {
+      for (int x = firstColumn; x <= lastColumn; x++) {
          int pixelpos = y * size.width() + x;
          double topleft = sourceImage[(y - 1) * size.width() + x - 1].intensity();
          double topmiddle = sourceImage[(y - 1) * size.width() + x].intensity();
@@ -0,0 +1,162 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "perlinnoise.h"
+#include <QColor>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// @brief Frequency and weight of one octave; they are the same for every pixel.
+struct Octave {
+   double frequency;
+   double amplitude;
+};
+
+/// @brief Dots the hashed gradient of one lattice corner with the distance to the sample point.
+/// @details The hash wraps at 32 bits exactly as the script's Math.imul() and unsigned shifts do.
+double cornerDot(const quint32 gradientX, const quint32 gradientY, const quint32 seedHash,
+                 const double distanceX, const double distanceY) {
+   quint32 hash = gradientX * 374761393U + gradientY * 668265263U + seedHash;
+   hash = (hash ^ (hash >> 13)) * 1274126177U;
+   hash ^= hash >> 16;
+   const double angle = hash / 4294967296.0 * 2 * M_PI;
+   return std::cos(angle) * distanceX + std::sin(angle) * distanceY;
+}
+
+}  // namespace
+
+void PerlinNoiseTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                           const QMap<QString, TextureImagePtr>& sourceimages,
+                                           const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void PerlinNoiseTextureGenerator::generateRegion(
+    QSize size, int pass, QRect region, TexturePixel* destimage,
+    const QMap<QString, TextureImagePtr>& sourceimages, const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   copyBackground(size, region, sourceimages.value(QStringLiteral("Background")), destimage);
+
+   const int width = size.width();
+   const int height = size.height();
+   const double referenceSize = std::min(width, height);
+   const double offsetX = settings.value("offsetx").toDouble() * width / 100;
+   const double offsetY = settings.value("offsety").toDouble() * height / 100;
+   const quint32 seedHash =
+       toUint32(std::trunc(settings.value("randomizer").toDouble())) * 1442695041U;
+
+   const double featureSize = std::max(0.01, settings.value("zoom").toDouble());
+   const double requestedFrequency = 100 / featureSize;
+   const double maximumFrequency = std::max(0.5, referenceSize / 2);
+   const double octaveCount =
+       std::max(1.0, std::min(12.0, std::trunc(settings.value("numoctaves").toDouble())));
+   const double persistence =
+       std::max(0.0, std::min(1.0, settings.value("persistence").toDouble()));
+   const double lacunarity = std::max(1.0, std::min(4.0, settings.value("lacunarity").toDouble()));
+
+   // The octaves stop at the same frequency for every pixel, so they are listed once.
+   QVector<Octave> octaves;
+   double amplitudeTotal = 0;
+   double frequency = std::min(requestedFrequency, maximumFrequency);
+   double amplitude = 1;
+   for (int octave = 0; octave < octaveCount; ++octave) {
+      if (octave > 0 && (frequency > maximumFrequency || amplitude == 0)) {
+         break;
+      }
+      octaves.append(Octave{frequency, amplitude});
+      amplitudeTotal += amplitude;
+      frequency *= lacunarity;
+      amplitude *= persistence;
+   }
+
+   const double minimum = settings.value("minimum").toDouble();
+   const double maximum = settings.value("maximum").toDouble();
+   const double minimumStrength = std::min(minimum, maximum) / 100;
+   const double maximumStrength = std::max(minimum, maximum) / 100;
+   const double strengthRange = maximumStrength - minimumStrength;
+   const QColor colour = settings.value("color").value<QColor>();
+   const double colourOpacity = colour.alpha() / 255.0;
+   const double contrast = settings.value("contrast").toDouble();
+   const double brightness = settings.value("brightness").toDouble();
+   const bool invert = settings.value("invert").toBool();
+   const bool seamless = settings.value("seamless").toBool();
+   const int horizontalSamples = seamless && width > 1 ? 2 : 1;
+   const int verticalSamples = seamless && height > 1 ? 2 : 1;
+
+   for (int y = region.top(); y <= region.bottom(); ++y) {
+      const double verticalBlend = height > 1 ? static_cast<double>(y) / (height - 1) : 0;
+      for (int x = region.left(); x <= region.right(); ++x) {
+         const double horizontalBlend = width > 1 ? static_cast<double>(x) / (width - 1) : 0;
+         double noiseTotal = 0;
+         for (const Octave& octave : octaves) {
+            const double sampleX = (x + offsetX) * octave.frequency / referenceSize;
+            const double sampleY = (y + offsetY) * octave.frequency / referenceSize;
+            const double horizontalSpan = (width - 1) * octave.frequency / referenceSize;
+            const double verticalSpan = (height - 1) * octave.frequency / referenceSize;
+            double octaveNoise = 0;
+            // Seamless mode blends four copies of the field, as the script does.
+            for (int verticalSample = 0; verticalSample < verticalSamples; ++verticalSample) {
+               const double positionY = sampleY - verticalSample * verticalSpan;
+               double verticalWeight = 1;
+               if (verticalSamples > 1) {
+                  verticalWeight = verticalSample == 0 ? 1 - verticalBlend : verticalBlend;
+               }
+               const double latticeY = std::floor(positionY);
+               const double fractionY = positionY - latticeY;
+               const double smoothY =
+                   fractionY * fractionY * fractionY * (fractionY * (fractionY * 6 - 15) + 10);
+               const quint32 topY = toUint32(latticeY);
+               const quint32 bottomY = toUint32(latticeY + 1);
+               for (int horizontalSample = 0; horizontalSample < horizontalSamples;
+                    ++horizontalSample) {
+                  const double positionX = sampleX - horizontalSample * horizontalSpan;
+                  double horizontalWeight = 1;
+                  if (horizontalSamples > 1) {
+                     horizontalWeight =
+                         horizontalSample == 0 ? 1 - horizontalBlend : horizontalBlend;
+                  }
+                  const double latticeX = std::floor(positionX);
+                  const double fractionX = positionX - latticeX;
+                  const double smoothX =
+                      fractionX * fractionX * fractionX * (fractionX * (fractionX * 6 - 15) + 10);
+                  const quint32 leftX = toUint32(latticeX);
+                  const quint32 rightX = toUint32(latticeX + 1);
+                  const double topLeft = cornerDot(leftX, topY, seedHash, fractionX, fractionY);
+                  const double topRight =
+                      cornerDot(rightX, topY, seedHash, fractionX - 1, fractionY);
+                  const double bottomLeft =
+                      cornerDot(leftX, bottomY, seedHash, fractionX, fractionY - 1);
+                  const double bottomRight =
+                      cornerDot(rightX, bottomY, seedHash, fractionX - 1, fractionY - 1);
+                  const double topRow = topLeft + (topRight - topLeft) * smoothX;
+                  const double bottomRow = bottomLeft + (bottomRight - bottomLeft) * smoothX;
+                  const double gradientNoise = topRow + (bottomRow - topRow) * smoothY;
+                  octaveNoise += gradientNoise * horizontalWeight * verticalWeight;
+               }
+            }
+            noiseTotal += octaveNoise * octave.amplitude;
+         }
+
+         double value = 0.5 + noiseTotal / amplitudeTotal * M_SQRT1_2;
+         value = (value - 0.5) * contrast / 100 + 0.5;
+         value += brightness / 100;
+         value = std::max(0.0, std::min(1.0, value));
+         if (invert) {
+            value = 1 - value;
+         }
+         const double noiseOpacity = (minimumStrength + value * strengthRange) * colourOpacity;
+         if (noiseOpacity > 0) {
+            blendOver(destimage[y * width + x], colour.red(), colour.green(), colour.blue(),
+                      noiseOpacity);
+         }
+      }
+   }
+}
@@ -0,0 +1,26 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef PERLINNOISETEXTUREGENERATOR_H
+#define PERLINNOISETEXTUREGENERATOR_H
+
+#include "nativescriptgenerator.h"
+
+/// @brief Native implementation of the bundled Perlin noise generator, perlinnoise.js.
+class PerlinNoiseTextureGenerator : public NativeScriptTextureGenerator {
+public:
+   using NativeScriptTextureGenerator::NativeScriptTextureGenerator;
+   ~PerlinNoiseTextureGenerator() override = default;
+   void generate(QSize size, TexturePixel* destimage,
+                 const QMap<QString, TextureImagePtr>& sourceimages,
+                 const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("perlinnoise/1"); }
+};
+
+#endif  // PERLINNOISETEXTUREGENERATOR_H
@@ -19,6 +19,7 @@ public:
                  const TextureNodeSettings& settings) const override;
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Pointillism"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("pointillism/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Recreates the input image with randomly placed coloured ellipses.");
@@ -55,68 +55,48 @@ SetChannelsTextureGenerator::SetChannelsTextureGenerator() {
    configurables.append(channelAlpha);
 }
 
-quint8 SetChannelsTextureGenerator::getColorFromChannel(
-    const TexturePixel& firstColor, const TexturePixel& secondColor,
-    SetChannelsTextureGenerator::Channels channel) const {
-   switch (channel) {
-      case Channels::none:
-         return 0;
-      case Channels::fill:
-         return 255;
-      case Channels::node1red:
-         return firstColor.r;
-      case Channels::node1green:
-         return firstColor.g;
-      case Channels::node1blue:
-         return firstColor.b;
-      case Channels::node1alpha:
-         return firstColor.a;
-      case Channels::node2red:
-         return secondColor.r;
-      case Channels::node2green:
-         return secondColor.g;
-      case Channels::node2blue:
-         return secondColor.b;
-      case Channels::node2alpha:
-         return secondColor.a;
-   }
-   return 0;
-}
-
-SetChannelsTextureGenerator::Channels SetChannelsTextureGenerator::getChannelFromName(
+TexturePixelKernels::ChannelSource SetChannelsTextureGenerator::getChannelFromName(
     const QString& name) const {
    if (name == "Fill") {
-      return Channels::fill;
+      return TexturePixelKernels::ChannelSource::Full;
    }
    if (name == "First's red") {
-      return Channels::node1red;
+      return TexturePixelKernels::ChannelSource::FirstRed;
    }
    if (name == "First's green") {
-      return Channels::node1green;
+      return TexturePixelKernels::ChannelSource::FirstGreen;
    }
    if (name == "First's blue") {
-      return Channels::node1blue;
+      return TexturePixelKernels::ChannelSource::FirstBlue;
    }
    if (name == "First's alpha") {
-      return Channels::node1alpha;
+      return TexturePixelKernels::ChannelSource::FirstAlpha;
    }
    if (name == "Second's red") {
-      return Channels::node2red;
+      return TexturePixelKernels::ChannelSource::SecondRed;
    }
    if (name == "Second's green") {
-      return Channels::node2green;
+      return TexturePixelKernels::ChannelSource::SecondGreen;
    }
    if (name == "Second's blue") {
-      return Channels::node2blue;
+      return TexturePixelKernels::ChannelSource::SecondBlue;
    }
    if (name == "Second's alpha") {
-      return Channels::node2alpha;
+      return TexturePixelKernels::ChannelSource::SecondAlpha;
    }
-   return Channels::none;
+   return TexturePixelKernels::ChannelSource::Zero;
 }
 void SetChannelsTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                            const QMap<QString, TextureImagePtr>& sourceimages,
                                            const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void SetChannelsTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                                 TexturePixel* destimage,
+                                                 const QMap<QString, TextureImagePtr>& sourceimages,
+                                                 const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    if (!destimage || !size.isValid()) {
       return;
    }
@@ -125,12 +105,10 @@ void SetChannelsTextureGenerator::generate(QSize size, TexturePixel* destimage,
    QString channelBlueStr = settings.value("channelBlue").toString();
    QString channelAlphaStr = settings.value("channelAlpha").toString();
 
-   Channels channelRed = getChannelFromName(channelRedStr);
-   Channels channelGreen = getChannelFromName(channelGreenStr);
-   Channels channelBlue = getChannelFromName(channelBlueStr);
-   Channels channelAlpha = getChannelFromName(channelAlphaStr);
+   const TexturePixelKernels::ChannelSelection selection{
+       getChannelFromName(channelRedStr), getChannelFromName(channelGreenStr),
+       getChannelFromName(channelBlueStr), getChannelFromName(channelAlphaStr)};
 
-   int numPixels = size.width() * size.height();
    TexturePixel* firstSource = nullptr;
    TexturePixel* secondSource = nullptr;
 
@@ -141,32 +119,15 @@ void SetChannelsTextureGenerator::generate(QSize size, TexturePixel* destimage,
       secondSource = sourceimages.value(QStringLiteral("Second")).data()->getData();
    }
    if (!firstSource && !secondSource) {
-      memset(destimage, 0, numPixels * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel());
       return;
    }
-   bool firstAllocated = false;
-   bool secondAllocated = false;
-   if (!firstSource) {
-      firstSource = new TexturePixel[numPixels];
-      firstAllocated = true;
-   } else if (!secondSource) {
-      secondSource = new TexturePixel[numPixels];
-      secondAllocated = true;
-   }
-   for (int thisPos = 0; thisPos < numPixels; thisPos++) {
-      destimage[thisPos].r =
-          getColorFromChannel(firstSource[thisPos], secondSource[thisPos], channelRed);
-      destimage[thisPos].g =
-          getColorFromChannel(firstSource[thisPos], secondSource[thisPos], channelGreen);
-      destimage[thisPos].b =
-          getColorFromChannel(firstSource[thisPos], secondSource[thisPos], channelBlue);
-      destimage[thisPos].a =
-          getColorFromChannel(firstSource[thisPos], secondSource[thisPos], channelAlpha);
-   }
-   if (firstAllocated) {
-      delete[] firstSource;
-   }
-   if (secondAllocated) {
-      delete[] secondSource;
+   // A missing source reads as transparent black.
+   for (int y = region.top(); y <= region.bottom(); y++) {
+      const int rowStart = y * size.width() + region.left();
+      TexturePixelKernels::swizzle(destimage + rowStart,
+                                   firstSource ? firstSource + rowStart : nullptr,
+                                   secondSource ? secondSource + rowStart : nullptr,
+                                   region.width(), selection);
    }
 }
@@ -8,32 +8,26 @@
 #define SETCHANNELSTEXTUREGENERATOR_H
 
 #include "base/texturegenerator.h"
+#include "base/texturepixelkernels.h"
 
 /// @brief The SetChannelsTextureGenerator class
 class SetChannelsTextureGenerator : public TextureGenerator {
 public:
-   enum Channels {
-      none = 1,
-      fill = 2,
-      node1red = 3,
-      node1green = 4,
-      node1blue = 5,
-      node1alpha = 6,
-      node2red = 7,
-      node2green = 8,
-      node2blue = 9,
-      node2alpha = 10
-   };
-
    SetChannelsTextureGenerator();
    ~SetChannelsTextureGenerator() override = default;
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   bool writesEveryPixel() const override { return true; }
    QStringList getSourceSlots() const override {
       return {QStringLiteral("First"), QStringLiteral("Second")};
    }
    QString getName() const override { return QString("Set channels"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("setchannels/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString(
@@ -43,9 +37,7 @@ public:
 
 private:
    TextureGeneratorSettings configurables;
-   Channels getChannelFromName(const QString& name) const;
-   quint8 getColorFromChannel(const TexturePixel& firstColor, const TexturePixel& secondColor,
-                              Channels channel) const;
+   TexturePixelKernels::ChannelSource getChannelFromName(const QString& name) const;
 };
 
 #endif  // SETCHANNELSTEXTUREGENERATOR_H
@@ -0,0 +1,60 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "sineplasma.h"
+#include <QColor>
+#include <cmath>
+#include <vector>
+
+void SinePlasmaTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                          const QMap<QString, TextureImagePtr>& sourceimages,
+                                          const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void SinePlasmaTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                                TexturePixel* destimage,
+                                                const QMap<QString, TextureImagePtr>& sourceimages,
+                                                const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   copyBackground(size, region, sourceimages.value(QStringLiteral("Background")), destimage);
+
+   const int width = size.width();
+   const int height = size.height();
+   const double xOffset = settings.value("xoffset").toDouble() * width / 100;
+   const double yOffset = settings.value("yoffset").toDouble() * height / 100;
+   const double xFrequency = settings.value("xfrequency").toDouble() * 5 / width;
+   const double yFrequency = settings.value("yfrequency").toDouble() * 5 / height;
+   const QColor color = settings.value("color").value<QColor>();
+
+   // One sine per column and one per row instead of two per pixel.
+   std::vector<double> horizontal(static_cast<std::size_t>(region.width()));
+   for (int x = region.left(); x <= region.right(); ++x) {
+      horizontal[x - region.left()] = 0.25 * std::sin((x - xOffset) * xFrequency);
+   }
+
+   for (int y = region.top(); y <= region.bottom(); ++y) {
+      const double vertical = 0.5 + 0.25 * std::sin((y - yOffset) * yFrequency);
+      TexturePixel* pixel = destimage + static_cast<qsizetype>(y) * width + region.left();
+      for (int x = 0; x < region.width(); ++x, ++pixel) {
+         const double value = vertical + horizontal[x];
+         const double plasmaAlpha = value * color.alpha() / 255;
+         if (plasmaAlpha <= 0) {
+            continue;
+         }
+         if (plasmaAlpha >= 1 || pixel->a == 0) {
+            *pixel = TexturePixel(static_cast<quint8>(color.red()),
+                                  static_cast<quint8>(color.green()),
+                                  static_cast<quint8>(color.blue()),
+                                  toUint8(round(plasmaAlpha * 255)));
+            continue;
+         }
+         blendOver(*pixel, color.red(), color.green(), color.blue(), plasmaAlpha);
+      }
+   }
+}
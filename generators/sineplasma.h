@@ -0,0 +1,26 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#ifndef SINEPLASMATEXTUREGENERATOR_H
+#define SINEPLASMATEXTUREGENERATOR_H
+
+#include "nativescriptgenerator.h"
+
+/// @brief Native implementation of the bundled Sine plasma generator, sineplasma.js.
+class SinePlasmaTextureGenerator : public NativeScriptTextureGenerator {
+public:
+   using NativeScriptTextureGenerator::NativeScriptTextureGenerator;
+   ~SinePlasmaTextureGenerator() override = default;
+   void generate(QSize size, TexturePixel* destimage,
+                 const QMap<QString, TextureImagePtr>& sourceimages,
+                 const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("sineplasma/1"); }
+};
+
+#endif  // SINEPLASMATEXTUREGENERATOR_H
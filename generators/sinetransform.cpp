@@ -77,11 +77,18 @@ SineTransformTextureGenerator::SineTransformTextureGenerator() {
 void SineTransformTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                              const QMap<QString, TextureImagePtr>& sourceimages,
                                              const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void SineTransformTextureGenerator::generateRegion(
+    QSize size, int pass, QRect region, TexturePixel* destimage,
+    const QMap<QString, TextureImagePtr>& sourceimages, const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
    if (!destimage || !size.isValid()) {
       return;
    }
    if (!sourceimages.contains(QStringLiteral("Image"))) {
-      memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
+      fillTextureRegion(size, region, destimage, TexturePixel());
       return;
    }
 
@@ -105,8 +112,8 @@ void SineTransformTextureGenerator::generate(QSize size, TexturePixel* destimage
    double x2 = -x1;
    double y2 = -y1;
 
-   for (int y = 0; y < size.height(); y++) {
-      for (int x = 0; x < size.width(); x++) {
+   for (int y = region.top(); y <= region.bottom(); y++) {
+      for (int x = region.left(); x <= region.right(); x++) {
          double x4 = -10000;
          double y4 = y;
          double x4rot = ((x4 - x) * cos(angle)) - ((y4 - y) * sin(angle)) + x;
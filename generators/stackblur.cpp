@@ -1,346 +1,275 @@
-
 // Part of the ProceduralTextureMaker project.
 // http://github.com/johanokl/ProceduralTextureMaker
 // Released under GPLv3.
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "stackblur.h"
+#include <cstddef>
 
-StackBlurTextureGenerator::StackBlurTextureGenerator() {
-   TextureGeneratorSetting level;
-   level.defaultvalue = QVariant((double)10);
-   level.name = "Blur radius (px)";
-   level.description = "Controls the radius of the stack-blur kernel.";
-   level.min = QVariant(0);
-   level.max = QVariant(20);
-   level.id = "level";
-   configurables.append(level);
-}
-void StackBlurTextureGenerator::generate(QSize size, TexturePixel* destimage,
-                                         const QMap<QString, TextureImagePtr>& sourceimages,
-                                         const TextureNodeSettings& settings) const {
-   if (!destimage || !size.isValid()) {
-      return;
-   }
-   int level = settings.value("level").toDouble() * qMax(size.width() / 100, 1);
-   memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
-   if (!sourceimages.contains(QStringLiteral("Image"))) {
-      return;
-   }
-   TexturePixel* sourceImage = sourceimages.value(QStringLiteral("Image")).data()->getData();
-   memcpy(destimage, sourceImage, size.width() * size.height() * sizeof(TexturePixel));
-   if (level <= 0) {
-      return;
-   }
-   if (level > 254) {
-      level = 254;
-   }
+// The Stack Blur Algorithm was invented by Mario Klingemann,
+// mario@quasimondo.com and described here:
+// http://incubator.quasimondo.com/processing/fast_blur_deluxe.php
+// This version is based on a version written by
+// Victor Laskin (victor.laskin@gmail.com)
+// http://vitiy.info/stackblur-algorithm-multi-threaded-blur-for-cpp
+// which blurs bands of rows and then bands of columns on separate threads.
 
-   // The Stack Blur Algorithm was invented by Mario Klingemann,
-   // mario@quasimondo.com and described here:
-   // http://incubator.quasimondo.com/processing/fast_blur_deluxe.php
-   // This version is based on a version written by
-   // Victor Laskin (victor.laskin@gmail.com)
-   // http://vitiy.info/stackblur-algorithm-multi-threaded-blur-for-cpp
+namespace {
 
-   quint16 stackblur_mul[255] = {
-       512, 512, 456, 512, 328, 456, 335, 512, 405, 328, 271, 456, 388, 335, 292, 512, 454,
-       405, 364, 328, 298, 271, 496, 456, 420, 388, 360, 335, 312, 292, 273, 512, 482, 454,
-       428, 405, 383, 364, 345, 328, 312, 298, 284, 271, 259, 496, 475, 456, 437, 420, 404,
-       388, 374, 360, 347, 335, 323, 312, 302, 292, 282, 273, 265, 512, 497, 482, 468, 454,
-       441, 428, 417, 405, 394, 383, 373, 364, 354, 345, 337, 328, 320, 312, 305, 298, 291,
-       284, 278, 271, 265, 259, 507, 496, 485, 475, 465, 456, 446, 437, 428, 420, 412, 404,
-       396, 388, 381, 374, 367, 360, 354, 347, 341, 335, 329, 323, 318, 312, 307, 302, 297,
-       292, 287, 282, 278, 273, 269, 265, 261, 512, 505, 497, 489, 482, 475, 468, 461, 454,
-       447, 441, 435, 428, 422, 417, 411, 405, 399, 394, 389, 383, 378, 373, 368, 364, 359,
-       354, 350, 345, 341, 337, 332, 328, 324, 320, 316, 312, 309, 305, 301, 298, 294, 291,
-       287, 284, 281, 278, 274, 271, 268, 265, 262, 259, 257, 507, 501, 496, 491, 485, 480,
-       475, 470, 465, 460, 456, 451, 446, 442, 437, 433, 428, 424, 420, 416, 412, 408, 404,
-       400, 396, 392, 388, 385, 381, 377, 374, 370, 367, 363, 360, 357, 354, 350, 347, 344,
-       341, 338, 335, 332, 329, 326, 323, 320, 318, 315, 312, 310, 307, 304, 302, 299, 297,
-       294, 292, 289, 287, 285, 282, 280, 278, 275, 273, 271, 269, 267, 265, 263, 261, 259};
+/// @brief Largest supported blur radius.
+constexpr unsigned int maximumRadius = 254;
 
-   quint8 stackblur_shr[255] = {
-       9,  11, 12, 13, 13, 14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17,
-       18, 18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
-       19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 21, 21, 21,
-       21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
-       21, 21, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22,
-       22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 23, 23, 23, 23, 23,
-       23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
-       23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
-       23, 23, 23, 23, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
-       24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
-       24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
-       24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24};
+constexpr quint16 stackblur_mul[255] = {
+    512, 512, 456, 512, 328, 456, 335, 512, 405, 328, 271, 456, 388, 335, 292, 512, 454,
+    405, 364, 328, 298, 271, 496, 456, 420, 388, 360, 335, 312, 292, 273, 512, 482, 454,
+    428, 405, 383, 364, 345, 328, 312, 298, 284, 271, 259, 496, 475, 456, 437, 420, 404,
+    388, 374, 360, 347, 335, 323, 312, 302, 292, 282, 273, 265, 512, 497, 482, 468, 454,
+    441, 428, 417, 405, 394, 383, 373, 364, 354, 345, 337, 328, 320, 312, 305, 298, 291,
+    284, 278, 271, 265, 259, 507, 496, 485, 475, 465, 456, 446, 437, 428, 420, 412, 404,
+    396, 388, 381, 374, 367, 360, 354, 347, 341, 335, 329, 323, 318, 312, 307, 302, 297,
+    292, 287, 282, 278, 273, 269, 265, 261, 512, 505, 497, 489, 482, 475, 468, 461, 454,
+    447, 441, 435, 428, 422, 417, 411, 405, 399, 394, 389, 383, 378, 373, 368, 364, 359,
+    354, 350, 345, 341, 337, 332, 328, 324, 320, 316, 312, 309, 305, 301, 298, 294, 291,
+    287, 284, 281, 278, 274, 271, 268, 265, 262, 259, 257, 507, 501, 496, 491, 485, 480,
+    475, 470, 465, 460, 456, 451, 446, 442, 437, 433, 428, 424, 420, 416, 412, 408, 404,
+    400, 396, 392, 388, 385, 381, 377, 374, 370, 367, 363, 360, 357, 354, 350, 347, 344,
+    341, 338, 335, 332, 329, 326, 323, 320, 318, 315, 312, 310, 307, 304, 302, 299, 297,
+    294, 292, 289, 287, 285, 282, 280, 278, 275, 273, 271, 269, 267, 265, 263, 261, 259};
 
-   /// Stackblur algorithm body
-   unsigned int radius = level;
-   unsigned int div = (radius * 2) + 1;
-   auto* stack = new unsigned char[div * 4];
-   memset(stack, 0, div * 4);
-   auto* src = reinterpret_cast<unsigned char*>(destimage);
+constexpr quint8 stackblur_shr[255] = {
+    9,  11, 12, 13, 13, 14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17,
+    18, 18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+    19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22,
+    22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 23, 23, 23, 23, 23,
+    23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
+    23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
+    23, 23, 23, 23, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24};
 
-   unsigned int w = size.width();
-   unsigned int h = size.height();
+/// @brief Blurs one row or column of pixels in place.
+/// @param pixels First byte of the first pixel.
+/// @param length Number of pixels in the row or column.
+/// @param step Distance in bytes between neighbouring pixels.
+/// @param radius Blur radius from 1 to maximumRadius.
+void blurSpan(unsigned char* const pixels, const unsigned int length, const std::ptrdiff_t step,
+              const unsigned int radius) {
+   const unsigned int div = (radius * 2) + 1;
+   unsigned char stack[(maximumRadius * 2 + 1) * 4] = {};
+   const unsigned int last = length - 1;
+   const unsigned int mul_sum = stackblur_mul[radius];
+   const unsigned char shr_sum = stackblur_shr[radius];
 
-   unsigned int x, y, xp, yp, i;
-   unsigned int sp;
-   unsigned int stack_start;
+   quint64 sum_r = 0;
+   quint64 sum_g = 0;
+   quint64 sum_b = 0;
+   quint64 sum_a = 0;
+   quint64 sum_in_r = 0;
+   quint64 sum_in_g = 0;
+   quint64 sum_in_b = 0;
+   quint64 sum_in_a = 0;
+   quint64 sum_out_r = 0;
+   quint64 sum_out_g = 0;
+   quint64 sum_out_b = 0;
+   quint64 sum_out_a = 0;
    unsigned char* stack_ptr;
+   const unsigned char* src_ptr = pixels;
 
-   unsigned char* src_ptr;
-   unsigned char* dst_ptr;
-
-   quint64 sum_r;
-   quint64 sum_g;
-   quint64 sum_b;
-   quint64 sum_a;
-   quint64 sum_in_r;
-   quint64 sum_in_g;
-   quint64 sum_in_b;
-   quint64 sum_in_a;
-   quint64 sum_out_r;
-   quint64 sum_out_g;
-   quint64 sum_out_b;
-   quint64 sum_out_a;
+   for (unsigned int i = 0; i <= radius; i++) {
+      stack_ptr = &stack[4 * i];
+      stack_ptr[0] = src_ptr[0];
+      stack_ptr[1] = src_ptr[1];
+      stack_ptr[2] = src_ptr[2];
+      stack_ptr[3] = src_ptr[3];
+      sum_r += src_ptr[0] * (i + 1);
+      sum_g += src_ptr[1] * (i + 1);
+      sum_b += src_ptr[2] * (i + 1);
+      sum_a += src_ptr[3] * (i + 1);
+      sum_out_r += src_ptr[0];
+      sum_out_g += src_ptr[1];
+      sum_out_b += src_ptr[2];
+      sum_out_a += src_ptr[3];
+   }
+   for (unsigned int i = 1; i <= radius; i++) {
+      if (i <= last) {
+         src_ptr += step;
+      }
+      stack_ptr = &stack[4 * (i + radius)];
+      stack_ptr[0] = src_ptr[0];
+      stack_ptr[1] = src_ptr[1];
+      stack_ptr[2] = src_ptr[2];
+      stack_ptr[3] = src_ptr[3];
+      sum_r += src_ptr[0] * (radius + 1 - i);
+      sum_g += src_ptr[1] * (radius + 1 - i);
+      sum_b += src_ptr[2] * (radius + 1 - i);
+      sum_a += src_ptr[3] * (radius + 1 - i);
+      sum_in_r += src_ptr[0];
+      sum_in_g += src_ptr[1];
+      sum_in_b += src_ptr[2];
+      sum_in_a += src_ptr[3];
+   }
+   unsigned int sp = radius;
+   unsigned int position = radius;
+   if (position > last) {
+      position = last;
+   }
+   // The read position stays ahead of the write position, so the span can be blurred in place.
+   src_ptr = pixels + step * position;
+   unsigned char* dst_ptr = pixels;
+   for (unsigned int i = 0; i < length; i++) {
+      dst_ptr[0] = (sum_r * mul_sum) >> shr_sum;
+      dst_ptr[1] = (sum_g * mul_sum) >> shr_sum;
+      dst_ptr[2] = (sum_b * mul_sum) >> shr_sum;
+      dst_ptr[3] = (sum_a * mul_sum) >> shr_sum;
+      dst_ptr += step;
 
-   unsigned int wm = w - 1;
-   unsigned int hm = h - 1;
-   unsigned int w4 = w * 4;
-   unsigned int mul_sum = stackblur_mul[radius];
-   unsigned char shr_sum = stackblur_shr[radius];
+      sum_r -= sum_out_r;
+      sum_g -= sum_out_g;
+      sum_b -= sum_out_b;
+      sum_a -= sum_out_a;
 
-   unsigned int minY = 0;
-   unsigned int maxY = size.height();
+      unsigned int stack_start = sp + div - radius;
+      if (stack_start >= div) {
+         stack_start -= div;
+      }
+      stack_ptr = &stack[4 * stack_start];
 
-   for (y = minY; y < maxY; y++) {
-      sum_r = 0;
-      sum_g = 0;
-      sum_b = 0;
-      sum_a = 0;
-      sum_in_r = 0;
-      sum_in_g = 0;
-      sum_in_b = 0;
-      sum_in_a = 0;
-      sum_out_r = 0;
-      sum_out_g = 0;
-      sum_out_b = 0;
-      sum_out_a = 0;
-      src_ptr = src + w4 * y;
+      sum_out_r -= stack_ptr[0];
+      sum_out_g -= stack_ptr[1];
+      sum_out_b -= stack_ptr[2];
+      sum_out_a -= stack_ptr[3];
 
-      for (i = 0; i <= radius; i++) {
-         stack_ptr = &stack[4 * i];
-         stack_ptr[0] = src_ptr[0];
-         stack_ptr[1] = src_ptr[1];
-         stack_ptr[2] = src_ptr[2];
-         stack_ptr[3] = src_ptr[3];
-         sum_r += src_ptr[0] * (i + 1);
-         sum_g += src_ptr[1] * (i + 1);
-         sum_b += src_ptr[2] * (i + 1);
-         sum_a += src_ptr[3] * (i + 1);
-         sum_out_r += src_ptr[0];
-         sum_out_g += src_ptr[1];
-         sum_out_b += src_ptr[2];
-         sum_out_a += src_ptr[3];
+      if (position < last) {
+         src_ptr += step;
+         ++position;
       }
-      for (i = 1; i <= radius; i++) {
-         if (i <= wm) {
-            src_ptr += 4;
-         }
-         stack_ptr = &stack[4 * (i + radius)];
-         stack_ptr[0] = src_ptr[0];
-         stack_ptr[1] = src_ptr[1];
-         stack_ptr[2] = src_ptr[2];
-         stack_ptr[3] = src_ptr[3];
-         sum_r += src_ptr[0] * (radius + 1 - i);
-         sum_g += src_ptr[1] * (radius + 1 - i);
-         sum_b += src_ptr[2] * (radius + 1 - i);
-         sum_a += src_ptr[3] * (radius + 1 - i);
-         sum_in_r += src_ptr[0];
-         sum_in_g += src_ptr[1];
-         sum_in_b += src_ptr[2];
-         sum_in_a += src_ptr[3];
-      }
-      sp = radius;
-      xp = radius;
-      if (xp > wm) {
-         xp = wm;
-      }
-      src_ptr = src + 4 * (xp + y * w);
-      dst_ptr = src + y * w4;
-      for (x = 0; x < w; x++) {
-         dst_ptr[0] = (sum_r * mul_sum) >> shr_sum;
-         dst_ptr[1] = (sum_g * mul_sum) >> shr_sum;
-         dst_ptr[2] = (sum_b * mul_sum) >> shr_sum;
-         dst_ptr[3] = (sum_a * mul_sum) >> shr_sum;
-         dst_ptr += 4;
+      stack_ptr[0] = src_ptr[0];
+      stack_ptr[1] = src_ptr[1];
+      stack_ptr[2] = src_ptr[2];
+      stack_ptr[3] = src_ptr[3];
 
-         sum_r -= sum_out_r;
-         sum_g -= sum_out_g;
-         sum_b -= sum_out_b;
-         sum_a -= sum_out_a;
+      sum_in_r += src_ptr[0];
+      sum_in_g += src_ptr[1];
+      sum_in_b += src_ptr[2];
+      sum_in_a += src_ptr[3];
+      sum_r += sum_in_r;
+      sum_g += sum_in_g;
+      sum_b += sum_in_b;
+      sum_a += sum_in_a;
 
-         stack_start = sp + div - radius;
-         if (stack_start >= div) {
-            stack_start -= div;
-         }
-         stack_ptr = &stack[4 * stack_start];
+      ++sp;
+      if (sp >= div) {
+         sp = 0;
+      }
+      stack_ptr = &stack[sp * 4];
+      sum_out_r += stack_ptr[0];
+      sum_out_g += stack_ptr[1];
+      sum_out_b += stack_ptr[2];
+      sum_out_a += stack_ptr[3];
+      sum_in_r -= stack_ptr[0];
+      sum_in_g -= stack_ptr[1];
+      sum_in_b -= stack_ptr[2];
+      sum_in_a -= stack_ptr[3];
+   }
+}
 
-         sum_out_r -= stack_ptr[0];
-         sum_out_g -= stack_ptr[1];
-         sum_out_b -= stack_ptr[2];
-         sum_out_a -= stack_ptr[3];
+/// @brief Returns the blur radius of an image size.
+unsigned int blurRadius(const QSize size, const TextureNodeSettings& settings) {
+   // The level is defined for a 100 pixel wide image and grows with every full 100 pixels.
+   const QSize reference = textureReferenceSize(size, settings);
+   int level = settings.value("level").toDouble() * qMax(reference.width() / 100, 1);
+   level = qBound(0, level, static_cast<int>(maximumRadius));
+   if (reference != size) {
+      // A reduced-size render uses the radius of its reference image, scaled down.
+      level = scaleTextureLength(level, size.width(), reference.width());
+   }
+   return static_cast<unsigned int>(level);
+}
 
-         if (xp < wm) {
-            src_ptr += 4;
-            ++xp;
-         }
-         stack_ptr[0] = src_ptr[0];
-         stack_ptr[1] = src_ptr[1];
-         stack_ptr[2] = src_ptr[2];
-         stack_ptr[3] = src_ptr[3];
+}  // namespace
 
-         sum_in_r += src_ptr[0];
-         sum_in_g += src_ptr[1];
-         sum_in_b += src_ptr[2];
-         sum_in_a += src_ptr[3];
-         sum_r += sum_in_r;
-         sum_g += sum_in_g;
-         sum_b += sum_in_b;
-         sum_a += sum_in_a;
+StackBlurTextureGenerator::StackBlurTextureGenerator() {
+   TextureGeneratorSetting level;
+   level.defaultvalue = QVariant((double)10);
+   level.name = "Blur radius (px)";
+   level.description = "Controls the radius of the stack-blur kernel.";
+   level.min = QVariant(0);
+   level.max = QVariant(20);
+   level.id = "level";
+   configurables.append(level);
+}
 
-         ++sp;
-         if (sp >= div) {
-            sp = 0;
-         }
-         stack_ptr = &stack[sp * 4];
-         sum_out_r += stack_ptr[0];
-         sum_out_g += stack_ptr[1];
-         sum_out_b += stack_ptr[2];
-         sum_out_a += stack_ptr[3];
-         sum_in_r -= stack_ptr[0];
-         sum_in_g -= stack_ptr[1];
-         sum_in_b -= stack_ptr[2];
-         sum_in_a -= stack_ptr[3];
+QString StackBlurTextureGenerator::getPassThroughSlot(QSize size,
+                                                      const TextureNodeSettings& settings) const {
+   return blurRadius(size, settings) == 0 ? QStringLiteral("Image") : QString();
+}
+
+QList<QRect> StackBlurTextureGenerator::getTilingRegions(QSize size, int pass,
+                                                         int maximumRegionCount) const {
+   if (pass == 0) {
+      return TextureGenerator::getTilingRegions(size, pass, maximumRegionCount);
+   }
+   // The vertical pass blurs whole columns in place, so it splits by column.
+   QList<QRect> regions;
+   const int regionCount = qBound(1, maximumRegionCount, qMax(size.width(), 1));
+   for (int index = 0; index < regionCount; ++index) {
+      const int left = static_cast<int>(static_cast<qint64>(size.width()) * index / regionCount);
+      const int right =
+          static_cast<int>(static_cast<qint64>(size.width()) * (index + 1) / regionCount);
+      if (right > left) {
+         regions.append(QRect(left, 0, right - left, size.height()));
       }
    }
+   return regions;
+}
 
-   // step 2
-   int minX = 0;
-   unsigned int maxX = size.width();
+void StackBlurTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                         const QMap<QString, TextureImagePtr>& sourceimages,
+                                         const TextureNodeSettings& settings) const {
+   const QRect image(QPoint(0, 0), size);
+   generateRegion(size, 0, image, destimage, sourceimages, settings);
+   generateRegion(size, 1, image, destimage, sourceimages, settings);
+}
 
-   for (x = minX; x < maxX; x++) {
-      sum_r = 0;
-      sum_g = 0;
-      sum_b = 0;
-      sum_a = 0;
-      sum_in_r = 0;
-      sum_in_g = 0;
-      sum_in_b = 0;
-      sum_in_a = 0;
-      sum_out_r = 0;
-      sum_out_g = 0;
-      sum_out_b = 0;
-      sum_out_a = 0;
-      src_ptr = src + 4 * x;  // x,0
-      for (i = 0; i <= radius; i++) {
-         stack_ptr = &stack[i * 4];
-         stack_ptr[0] = src_ptr[0];
-         stack_ptr[1] = src_ptr[1];
-         stack_ptr[2] = src_ptr[2];
-         stack_ptr[3] = src_ptr[3];
-         sum_r += src_ptr[0] * (i + 1);
-         sum_g += src_ptr[1] * (i + 1);
-         sum_b += src_ptr[2] * (i + 1);
-         sum_a += src_ptr[3] * (i + 1);
-         sum_out_r += src_ptr[0];
-         sum_out_g += src_ptr[1];
-         sum_out_b += src_ptr[2];
-         sum_out_a += src_ptr[3];
+void StackBlurTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                               TexturePixel* destimage,
+                                               const QMap<QString, TextureImagePtr>& sourceimages,
+                                               const TextureNodeSettings& settings) const {
+   if (!destimage || !size.isValid() || size.isEmpty()) {
+      return;
+   }
+   const TextureImagePtr source = sourceimages.value(QStringLiteral("Image"));
+   if (source.isNull()) {
+      if (pass == 0) {
+         fillTextureRegion(size, region, destimage, TexturePixel(0, 0, 0, 0));
       }
-      for (i = 1; i <= radius; i++) {
-         if (i <= hm) {
-            src_ptr += w4;
-         }
-         stack_ptr = &stack[4 * (i + radius)];
-         stack_ptr[0] = src_ptr[0];
-         stack_ptr[1] = src_ptr[1];
-         stack_ptr[2] = src_ptr[2];
-         stack_ptr[3] = src_ptr[3];
-         sum_r += src_ptr[0] * (radius + 1 - i);
-         sum_g += src_ptr[1] * (radius + 1 - i);
-         sum_b += src_ptr[2] * (radius + 1 - i);
-         sum_a += src_ptr[3] * (radius + 1 - i);
-         sum_in_r += src_ptr[0];
-         sum_in_g += src_ptr[1];
-         sum_in_b += src_ptr[2];
-         sum_in_a += src_ptr[3];
+      return;
+   }
+   const unsigned int radius = blurRadius(size, settings);
+   auto* pixels = reinterpret_cast<unsigned char*>(destimage);
+   const std::ptrdiff_t rowStep = static_cast<std::ptrdiff_t>(size.width()) * 4;
+
+   // The first pass copies and blurs bands of rows, and the second blurs bands of columns of
+   // the result in place. A destination that is the source's own buffer needs no copy.
+   if (pass == 0) {
+      if (source->getData() != destimage) {
+         copyTextureRegion(size, region, source->getData(), destimage);
       }
-      sp = radius;
-      yp = radius;
-      if (yp > hm) {
-         yp = hm;
+      if (radius == 0) {
+         return;
       }
-      src_ptr = src + 4 * (x + yp * w);
-      dst_ptr = src + 4 * x;
-      for (y = 0; y < h; y++) {
-         dst_ptr[0] = (sum_r * mul_sum) >> shr_sum;
-         dst_ptr[1] = (sum_g * mul_sum) >> shr_sum;
-         dst_ptr[2] = (sum_b * mul_sum) >> shr_sum;
-         dst_ptr[3] = (sum_a * mul_sum) >> shr_sum;
-         dst_ptr += w4;
-
-         sum_r -= sum_out_r;
-         sum_g -= sum_out_g;
-         sum_b -= sum_out_b;
-         sum_a -= sum_out_a;
-
-         stack_start = sp + div - radius;
-         if (stack_start >= div) {
-            stack_start -= div;
-         }
-         stack_ptr = &stack[4 * stack_start];
-
-         sum_out_r -= stack_ptr[0];
-         sum_out_g -= stack_ptr[1];
-         sum_out_b -= stack_ptr[2];
-         sum_out_a -= stack_ptr[3];
-
-         if (yp < hm) {
-            src_ptr += w4;  // stride
-            ++yp;
-         }
-
-         stack_ptr[0] = src_ptr[0];
-         stack_ptr[1] = src_ptr[1];
-         stack_ptr[2] = src_ptr[2];
-         stack_ptr[3] = src_ptr[3];
-
-         sum_in_r += src_ptr[0];
-         sum_in_g += src_ptr[1];
-         sum_in_b += src_ptr[2];
-         sum_in_a += src_ptr[3];
-         sum_r += sum_in_r;
-         sum_g += sum_in_g;
-         sum_b += sum_in_b;
-         sum_a += sum_in_a;
-
-         ++sp;
-         if (sp >= div) {
-            sp = 0;
-         }
-         stack_ptr = &stack[sp * 4];
-
-         sum_out_r += stack_ptr[0];
-         sum_out_g += stack_ptr[1];
-         sum_out_b += stack_ptr[2];
-         sum_out_a += stack_ptr[3];
-         sum_in_r -= stack_ptr[0];
-         sum_in_g -= stack_ptr[1];
-         sum_in_b -= stack_ptr[2];
-         sum_in_a -= stack_ptr[3];
+      for (int y = region.top(); y <= region.bottom(); y++) {
+         blurSpan(pixels + rowStep * y + region.left() * 4, region.width(), 4, radius);
       }
+      return;
+   }
+   if (radius == 0) {
+      return;
+   }
+   for (int x = region.left(); x <= region.right(); x++) {
+      blurSpan(pixels + x * 4, size.height(), rowStep, radius);
    }
-   delete[] stack;
 }
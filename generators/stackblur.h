@@ -17,8 +17,18 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destimage,
+                       const QMap<QString, TextureImagePtr>& sourceimages,
+                       const TextureNodeSettings& settings) const override;
+   bool supportsTiling() const override { return true; }
+   bool writesEveryPixel() const override { return true; }
+   QString getPassThroughSlot(QSize size, const TextureNodeSettings& settings) const override;
+   QString getInPlaceSlot() const override { return QStringLiteral("Image"); }
+   int getTilingPassCount() const override { return 2; }
+   QList<QRect> getTilingRegions(QSize size, int pass, int maximumRegionCount) const override;
    QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
    QString getName() const override { return QString("Stack Blur"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("stackblur/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Softens the input image using the fast stack-blur algorithm.");
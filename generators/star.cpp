@@ -139,8 +139,11 @@ void StarTextureGenerator::generate(QSize size, TexturePixel* destimage,
    bool antialiasing = settings.value("antialiasing").toBool();
 
    if (sourceimages.contains(QStringLiteral("Canvas"))) {
-      memcpy(destimage, sourceimages.value(QStringLiteral("Canvas"))->getData(),
-             size.width() * size.height() * sizeof(TexturePixel));
+      // A destination that is the canvas's own buffer already holds it.
+      const TexturePixel* canvas = sourceimages.value(QStringLiteral("Canvas"))->getData();
+      if (canvas != destimage) {
+         memcpy(destimage, canvas, size.width() * size.height() * sizeof(TexturePixel));
+      }
    } else {
       memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
    }
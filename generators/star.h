@@ -17,8 +17,10 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   QString getInPlaceSlot() const override { return QStringLiteral("Canvas"); }
    QStringList getSourceSlots() const override { return {QStringLiteral("Canvas")}; }
    QString getName() const override { return QString("Star"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("star/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Draws a configurable multi-pointed star with an optional cut-out.");
@@ -96,6 +96,14 @@ TextTextureGenerator::TextTextureGenerator() {
    antialiasing.id = "antialiasing";
    configurables.append(antialiasing);
 }
+
+QString TextTextureGenerator::getPassThroughSlot(QSize size,
+                                                 const TextureNodeSettings& settings) const {
+   Q_UNUSED(size);
+   // Without text nothing is drawn over the canvas.
+   return settings.value("text").toString().isEmpty() ? QStringLiteral("Canvas") : QString();
+}
+
 void TextTextureGenerator::generate(QSize size, TexturePixel* destimage,
                                     const QMap<QString, TextureImagePtr>& sourceimages,
                                     const TextureNodeSettings& settings) const {
@@ -131,8 +139,11 @@ void TextTextureGenerator::generate(QSize size, TexturePixel* destimage,
    }
 
    if (sourceimages.contains(QStringLiteral("Canvas"))) {
-      memcpy(destimage, sourceimages.value(QStringLiteral("Canvas"))->getData(),
-             size.width() * size.height() * sizeof(TexturePixel));
+      // A destination that is the canvas's own buffer already holds it.
+      const TexturePixel* canvas = sourceimages.value(QStringLiteral("Canvas"))->getData();
+      if (canvas != destimage) {
+         memcpy(destimage, canvas, size.width() * size.height() * sizeof(TexturePixel));
+      }
    } else {
       memset(destimage, 0, size.width() * size.height() * sizeof(TexturePixel));
    }
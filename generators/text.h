@@ -17,8 +17,11 @@ public:
    void generate(QSize size, TexturePixel* destimage,
                  const QMap<QString, TextureImagePtr>& sourceimages,
                  const TextureNodeSettings& settings) const override;
+   QString getPassThroughSlot(QSize size, const TextureNodeSettings& settings) const override;
+   QString getInPlaceSlot() const override { return QStringLiteral("Canvas"); }
    QStringList getSourceSlots() const override { return {QStringLiteral("Canvas")}; }
    QString getName() const override { return QString("Text"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("text/1"); }
    const TextureGeneratorSettings& getSettings() const override { return configurables; }
    QString getDescription() const override {
       return QString("Renders configurable text into the texture.");
@@ -0,0 +1,100 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "transform.h"
+#include <QColor>
+#include <algorithm>
+#include <cmath>
+
+void TransformTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                         const QMap<QString, TextureImagePtr>& sourceimages,
+                                         const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void TransformTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                               TexturePixel* destimage,
+                                               const QMap<QString, TextureImagePtr>& sourceimages,
+                                               const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   const QColor backgroundColour = settings.value("backgroundcolor").value<QColor>();
+   fillTextureRegion(size, region, destimage,
+                     TexturePixel(static_cast<quint8>(backgroundColour.red()),
+                                  static_cast<quint8>(backgroundColour.green()),
+                                  static_cast<quint8>(backgroundColour.blue()),
+                                  static_cast<quint8>(backgroundColour.alpha())));
+
+   const TextureImagePtr sourceImage = sourceimages.value(QStringLiteral("Image"));
+   const double horizontalScale = settings.value("xscale").toDouble() / 100;
+   const double verticalScale = settings.value("yscale").toDouble() / 100;
+   if (sourceImage.isNull() || horizontalScale <= 0 || verticalScale <= 0) {
+      return;
+   }
+
+   const int width = size.width();
+   const int height = size.height();
+   const double tiledSourceWidth = settings.value("firstXtiles").toDouble() * width;
+   const double tiledSourceHeight = settings.value("firstYtiles").toDouble() * height;
+   const double horizontalRepeats = settings.value("secondXtiles").toDouble();
+   const double verticalRepeats = settings.value("secondYtiles").toDouble();
+   const double transformedCenterX =
+       width / 2.0 + settings.value("offsetleft").toDouble() * width / 100;
+   const double transformedCenterY =
+       height / 2.0 + settings.value("offsettop").toDouble() * height / 100;
+   const double radians = settings.value("rotation").toDouble() * M_PI / 180;
+   const double cosine = std::cos(radians);
+   const double sine = std::sin(radians);
+
+   // Only the rectangle reached by the rotated, scaled source can change.
+   const double halfScaledWidth = tiledSourceWidth * horizontalScale / 2;
+   const double halfScaledHeight = tiledSourceHeight * verticalScale / 2;
+   const double extentX = std::abs(cosine) * halfScaledWidth + std::abs(sine) * halfScaledHeight;
+   const double extentY = std::abs(sine) * halfScaledWidth + std::abs(cosine) * halfScaledHeight;
+   const int left = static_cast<int>(std::max(0.0, std::floor(transformedCenterX - extentX)));
+   const int right =
+       static_cast<int>(std::min(width - 1.0, std::ceil(transformedCenterX + extentX)));
+   const int top = static_cast<int>(
+       std::max<double>(region.top(), std::floor(transformedCenterY - extentY)));
+   const int bottom = static_cast<int>(
+       std::min<double>(region.bottom(), std::ceil(transformedCenterY + extentY)));
+   const int lastColumn = std::min(right, region.right());
+
+   const double virtualXChangePerPixel = cosine / horizontalScale;
+   const double virtualYChangePerPixel = -sine / verticalScale;
+   const TexturePixel* sourcePixels = sourceImage->data();
+
+   for (int y = top; y <= bottom; ++y) {
+      const double xFromCenter = left + 0.5 - transformedCenterX;
+      const double yFromCenter = y + 0.5 - transformedCenterY;
+      double virtualSourceX =
+          (cosine * xFromCenter + sine * yFromCenter) / horizontalScale + tiledSourceWidth / 2;
+      double virtualSourceY =
+          (-sine * xFromCenter + cosine * yFromCenter) / verticalScale + tiledSourceHeight / 2;
+      TexturePixel* row = destimage + static_cast<qsizetype>(y) * width;
+      // Source positions are accumulated from the rectangle's left edge, as in the script, so
+      // that a region starting further right reaches exactly the same positions.
+      for (int x = left; x <= lastColumn; ++x) {
+         if (x >= region.left() && virtualSourceX >= 0 && virtualSourceX < tiledSourceWidth &&
+             virtualSourceY >= 0 && virtualSourceY < tiledSourceHeight) {
+            const auto sourceX =
+                static_cast<qint64>(std::floor(virtualSourceX * horizontalRepeats)) % width;
+            const auto sourceY =
+                static_cast<qint64>(std::floor(virtualSourceY * verticalRepeats)) % height;
+            const TexturePixel& source = sourcePixels[sourceY * width + sourceX];
+            TexturePixel& output = row[x];
+            if (source.a == 255 || (source.a > 0 && output.a == 0)) {
+               output = source;
+            } else if (source.a > 0) {
+               blendOver(output, source.r, source.g, source.b, source.a / 255.0);
+            }
+         }
+         virtualSourceX += virtualXChangePerPixel;
+         virtualSourceY += virtualYChangePerPixel;
+      }
+   }
+}
@@ -0,0 +1,82 @@
+// Part of the ProceduralTextureMaker project.
+// http://github.com/johanokl/ProceduralTextureMaker
+// Released under GPLv3.
+// Johan Lindqvist (johan.lindqvist@gmail.com)
+
+#include "whirl.h"
+#include <algorithm>
+#include <cmath>
+
+void WhirlTextureGenerator::generate(QSize size, TexturePixel* destimage,
+                                     const QMap<QString, TextureImagePtr>& sourceimages,
+                                     const TextureNodeSettings& settings) const {
+   generateRegion(size, 0, QRect(QPoint(0, 0), size), destimage, sourceimages, settings);
+}
+
+void WhirlTextureGenerator::generateRegion(QSize size, int pass, QRect region,
+                                           TexturePixel* destimage,
+                                           const QMap<QString, TextureImagePtr>& sourceimages,
+                                           const TextureNodeSettings& settings) const {
+   Q_UNUSED(pass);
+   if (!destimage || !size.isValid()) {
+      return;
+   }
+   const TextureImagePtr sourceImage = sourceimages.value(QStringLiteral("Image"));
+   copyBackground(size, region, sourceImage, destimage);
+   if (sourceImage.isNull()) {
+      return;
+   }
+
+   const int width = size.width();
+   const int height = size.height();
+   const double radius = settings.value("radius").toDouble() * width / 100;
+   const double horizontalCentreOffset = settings.value("offsetleft").toDouble() * width / 100;
+   const double verticalCentreOffset = settings.value("offsettop").toDouble() * height / 100;
+   const double strength = settings.value("strength").toDouble() / 80;
+   if (!(radius > 0) || strength == 0) {
+      return;
+   }
+
+   const double whirlCentreX = (width - 1) / 2.0 + horizontalCentreOffset;
+   const double whirlCentreY = (height - 1) / 2.0 + verticalCentreOffset;
+   const double radiusSquared = radius * radius;
+   const double angleFactor = 2 * M_PI * strength / radiusSquared;
+
+   // Only the square around the circle can change; the rest keeps the copied source pixels.
+   const auto left =
+       static_cast<int>(std::max<double>(region.left(), std::ceil(whirlCentreX - radius)));
+   const auto right =
+       static_cast<int>(std::min<double>(region.right(), std::floor(whirlCentreX + radius)));
+   const auto top =
+       static_cast<int>(std::max<double>(region.top(), std::ceil(whirlCentreY - radius)));
+   const auto bottom =
+       static_cast<int>(std::min<double>(region.bottom(), std::floor(whirlCentreY + radius)));
+   const TexturePixel* sourcePixels = sourceImage->data();
+
+   for (int y = top; y <= bottom; ++y) {
+      const double verticalDistance = y - whirlCentreY;
+      TexturePixel* pixel = destimage + static_cast<qsizetype>(y) * width + left;
+      for (int x = left; x <= right; ++x, ++pixel) {
+         const double horizontalDistance = x - whirlCentreX;
+         const double distanceSquared =
+             horizontalDistance * horizontalDistance + verticalDistance * verticalDistance;
+         if (distanceSquared > radiusSquared) {
+            continue;
+         }
+         const double distanceFromEdge = radius - std::sqrt(distanceSquared);
+         const double rotation = distanceFromEdge * distanceFromEdge * angleFactor;
+         const double cosine = std::cos(rotation);
+         const double sine = std::sin(rotation);
+         const double sourceX =
+             round(horizontalDistance * cosine - verticalDistance * sine + whirlCentreX);
+         const double sourceY =
+             round(verticalDistance * cosine + horizontalDistance * sine + whirlCentreY);
+         // Coordinates outside the texture wrap around, as in the script.
+         const auto wrappedX =
+             static_cast<int>(std::fmod(std::fmod(sourceX, width) + width, width));
+         const auto wrappedY =
+             static_cast<int>(std::fmod(std::fmod(sourceY, height) + height, height));
+         *pixel = sourcePixels[static_cast<qsizetype>(wrappedY) * width + wrappedX];
+      }
+   }
+}
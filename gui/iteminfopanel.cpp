@@ -27,10 +27,15 @@ ItemInfoPanel::ItemInfoPanel(QWidget* parent, TextureProject* project, EditManag
    lineWidget->hide();
    generatorWidget->hide();
    sceneWidget->show();
+   sceneWidget->updateImageMemory();
    QObject::connect(texproject, &TextureProject::nodeRemoved, this, &ItemInfoPanel::removeNode);
    QObject::connect(texproject, &TextureProject::nodesDisconnected, this,
                     &ItemInfoPanel::nodesDisconnected);
    QObject::connect(texproject, &TextureProject::nodeAdded, this, &ItemInfoPanel::addNode);
+   QObject::connect(texproject, &TextureProject::imageAvailable, sceneWidget,
+                    &SceneInfoWidget::updateImageMemory);
+   QObject::connect(texproject, &TextureProject::imagesUpdated, sceneWidget,
+                    &SceneInfoWidget::updateImageMemory);
    QObject::connect(texproject, &TextureProject::generatorRemoved, this,
                     [this](const TextureGeneratorPtr& generator) {
                        if (currGenerator == generator) {
@@ -70,6 +75,7 @@ void ItemInfoPanel::removeNode(int id) {
       nodes.remove(id);
    }
    sceneWidget->updateNumNodes();
+   sceneWidget->updateImageMemory();
 }
 
 void ItemInfoPanel::sourceUpdated(int id) {
@@ -7,6 +7,7 @@
 #include "base/settingsmanager.h"
 #include "base/projectfileservice.h"
 #include "base/textureexporter.h"
+#include "base/textureexportjob.h"
 #include "base/textureimage.h"
 #include "base/texturenode.h"
 #include "base/textureproject.h"
@@ -32,12 +33,14 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QSettings>
 #include <QSplitter>
 #include <QStatusBar>
 #include <QTextEdit>
 #include <QVBoxLayout>
+#include <algorithm>
 
 MainWindow::MainWindow(TexGenApplication* parent) {
    parentapp = parent;
@@ -67,7 +70,10 @@ MainWindow::MainWindow(TexGenApplication* parent) {
    view->show();
    scene = createScene();
 
-   registerBuiltInGenerators(*project);
+   // Hidden debugging switch that renders bundled scripts instead of their C++ implementations.
+   const bool forceJavaScript = QSettings().value("forceJavaScriptGenerators", false).toBool();
+   registerBuiltInGenerators(*project, forceJavaScript ? BundledGeneratorImplementation::JavaScript
+                                                       : BundledGeneratorImplementation::Native);
    project->clear();
    editManager->reset();
 
@@ -233,8 +239,9 @@ void MainWindow::saveImage(int id) {
    if (texNode.isNull()) {
       return;
    }
-   QString fileName =
-       QFileDialog::getSaveFileName(this, "Save File", QDir::homePath(), "PNG (*.png)");
+   QString fileName = QFileDialog::getSaveFileName(
+       this, "Save File", QDir::homePath(),
+       "PNG (*.png);;TGA (*.tga);;DDS (*.dds);;QOI (*.qoi);;Raw RGBA (*.raw *.rgba)");
 
    if (fileName.isNull()) {
       return;
@@ -256,11 +263,43 @@ void MainWindow::saveImage(int id) {
             return;
       }
    }
-   const TextureExportResult exportResult =
-       TextureExporter::exportPng(*project, id, project->getPreviewSize(), fileName, true);
-   if (!exportResult) {
-      QMessageBox::warning(this, "Error", exportResult.message);
-   }
+   // The export renders on its own thread, so several exports and the thumbnails can progress
+   // while the window stays responsive.
+   auto job = std::make_unique<TextureExportJob>(*project, id, project->getPreviewSize(),
+                                                 fileName, true);
+   TextureExportJob* const exportJob = job.get();
+   auto* progress = new QProgressDialog(
+       QStringLiteral("Rendering %1...").arg(QFileInfo(fileName).fileName()),
+       QStringLiteral("Cancel"), 0, 0, this);
+   progress->setWindowModality(Qt::NonModal);
+   progress->setMinimumDuration(500);
+   QObject::connect(progress, &QProgressDialog::canceled, exportJob, &TextureExportJob::cancel);
+   QObject::connect(exportJob, &TextureExportJob::progressChanged, progress,
+                    [progress](const int finishedNodes, const int nodeCount) {
+                       progress->setMaximum(nodeCount);
+                       progress->setValue(finishedNodes);
+                    });
+   QObject::connect(exportJob, &TextureExportJob::finished, this,
+                    [this, exportJob, progress = QPointer<QProgressDialog>(progress)]() {
+                       if (progress) {
+                          progress->deleteLater();
+                       }
+                       const TextureExportResult exportResult = exportJob->getResult();
+                       const auto finishedJob =
+                           std::find_if(exportJobs.begin(), exportJobs.end(),
+                                        [exportJob](const auto& candidate) {
+                                           return candidate.get() == exportJob;
+                                        });
+                       if (finishedJob != exportJobs.end()) {
+                          finishedJob->release()->deleteLater();
+                          exportJobs.erase(finishedJob);
+                       }
+                       if (!exportResult && exportResult.error != TextureExportError::Cancelled) {
+                          QMessageBox::warning(this, "Error", exportResult.message);
+                       }
+                    });
+   exportJobs.push_back(std::move(job));
+   exportJob->start();
 }
 
 std::unique_ptr<ViewNodeScene> MainWindow::createScene(ViewNodeScene* source) {
@@ -11,6 +11,7 @@
 #include <QMainWindow>
 #include <QPointer>
 #include <memory>
+#include <vector>
 class TexGenApplication;
 class TextureProject;
 class ViewNodeScene;
@@ -25,6 +26,7 @@ class SettingsPanel;
 class SettingsManager;
 class JsTexGenManager;
 class EditManager;
+class TextureExportJob;
 
 /// @brief The application's main window, containing all the scenes and panels.
 ///
@@ -160,6 +162,8 @@ private:
    TexGenApplication* parentapp{nullptr};
    /// @brief Texture project displayed by the window.
    std::unique_ptr<TextureProject> project;
+   /// @brief Image exports running in the background, destroyed before the project they read.
+   std::vector<std::unique_ptr<TextureExportJob>> exportJobs;
    /// @brief Manager and undo history for user-initiated project edits.
    std::unique_ptr<EditManager> editManager;
    /// @brief Path last used to save the current project.
@@ -5,6 +5,7 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "base/settingsmanager.h"
+#include "base/textureimagebudget.h"
 #include "base/textureproject.h"
 #include "global.h"
 #include "gui/cubewidget.h"
@@ -362,8 +363,10 @@ PreviewImagePanel::PreviewImagePanel(TextureProject& project) : project(project)
                     &PreviewImagePanel::setThreeDPreviewVisible);
    QObject::connect(&project, &TextureProject::imageAvailable, this,
                     &PreviewImagePanel::imageAvailable);
-   QObject::connect(&project, &TextureProject::imageUpdated, this,
-                    &PreviewImagePanel::imageUpdated);
+   QObject::connect(&project, &TextureProject::imagesUpdated, this,
+                    &PreviewImagePanel::imagesUpdated);
+   QObject::connect(&project, &TextureProject::frameAvailable, this,
+                    &PreviewImagePanel::frameAvailable);
    QObject::connect(&project, &TextureProject::nodeRemoved, this, &PreviewImagePanel::nodeRemoved);
    if (project.getSettingsManager() != nullptr) {
       QObject::connect(project.getSettingsManager(), &SettingsManager::settingsUpdated, this,
@@ -372,6 +375,41 @@ PreviewImagePanel::PreviewImagePanel(TextureProject& project) : project(project)
    settingsUpdated();
 }
 
+PreviewImagePanel::~PreviewImagePanel() {
+   TextureImageBudget& budget = project.getImageBudget();
+   for (const auto& [id, size] : pinnedImages) {
+      budget.unpin(id, size);
+   }
+}
+
+void PreviewImagePanel::updatePinnedImages() {
+   QList<std::pair<int, QSize>> displayedImages;
+   for (const int id : {selectedNodeId, lockedNodeId}) {
+      if (id > 0) {
+         displayedImages.append({id, project.getThumbnailSize()});
+         if (project.getPreviewSize() != project.getThumbnailSize()) {
+            displayedImages.append({id, project.getPreviewSize()});
+         }
+      }
+   }
+   QList<int> previewNodes;
+   for (const auto& displayed : displayedImages) {
+      if (!previewNodes.contains(displayed.first)) {
+         previewNodes.append(displayed.first);
+      }
+   }
+   project.setPreviewNodes(previewNodes);
+   // Pin before unpinning, so releasing an old pin cannot evict an image that stays displayed.
+   TextureImageBudget& budget = project.getImageBudget();
+   for (const auto& [id, size] : displayedImages) {
+      budget.pin(id, size);
+   }
+   for (const auto& [id, size] : pinnedImages) {
+      budget.unpin(id, size);
+   }
+   pinnedImages = displayedImages;
+}
+
 void PreviewImagePanel::imageUpdated(int id) {
    if (this->isHidden()) {
       return;
@@ -394,17 +432,33 @@ void PreviewImagePanel::imageUpdated(int id) {
    updatePreviewLayout();
 }
 
+void PreviewImagePanel::imagesUpdated(const QList<int>& ids) {
+   if (selectedNodeId > 0 && ids.contains(selectedNodeId)) {
+      imageUpdated(selectedNodeId);
+   }
+   if (lockedNodeId > 0 && lockedNodeId != selectedNodeId && ids.contains(lockedNodeId)) {
+      imageUpdated(lockedNodeId);
+   }
+}
+
 QPixmap PreviewImagePanel::nodePixmap(int id) {
    TextureNodePtr texNode = project.getNode(id);
    if (texNode.isNull()) {
       return {};
    }
+   // An image rendered at the preview size is sharper than the thumbnail.
    imageSize = project.getThumbnailSize();
-   const TextureImagePtr image = texNode->cachedImage(imageSize);
+   TextureImagePtr image = texNode->cachedImage(project.getPreviewSize());
+   if (image.isNull()) {
+      image = texNode->cachedImage(imageSize);
+   }
    if (image.isNull()) {
       return {};
    }
-   const TextureImage& texture = *image;
+   return texturePixmap(*image);
+}
+
+QPixmap PreviewImagePanel::texturePixmap(const TextureImage& texture) {
    QPixmap newImage = QPixmap::fromImage(texture.toQImageView());
    if (numTiles > 1) {
       newImage = tilePixmap(newImage, numTiles);
@@ -450,7 +504,7 @@ bool PreviewImagePanel::loadLockedNodeImage() {
 }
 
 void PreviewImagePanel::imageAvailable(int id, QSize size) {
-   if (size != imageSize) {
+   if (size != imageSize && size != project.getPreviewSize()) {
       return;
    }
    if (this->isHidden()) {
@@ -464,6 +518,30 @@ void PreviewImagePanel::imageAvailable(int id, QSize size) {
    }
 }
 
+void PreviewImagePanel::frameAvailable(int id, QSize size, const TextureImagePtr& image) {
+   Q_UNUSED(size);
+   if (image.isNull() || this->isHidden()) {
+      return;
+   }
+   // Frames keep the rendering overlay, because they are not the node's current image. The
+   // labels scale them, so frames of the low-resolution pass are shown as well.
+   if (id == selectedNodeId) {
+      selectedImageLabel->setPixmap(pixmapWithNodeBackground(texturePixmap(*image)));
+      selectedImageLabel->setRendering(true);
+      selectedImageLabel->show();
+      if (showThreeDButton->isChecked()) {
+         cubeWidget->setTexture(selectedImageLabel->pixmapWithRenderingOverlay());
+         cubeWidget->show();
+      }
+   }
+   if (id == lockedNodeId) {
+      lockedImageLabel->setPixmap(pixmapWithNodeBackground(texturePixmap(*image)));
+      lockedImageLabel->setRendering(true);
+      lockedImageLabel->show();
+   }
+   updatePreviewLayout();
+}
+
 void PreviewImagePanel::showEvent(QShowEvent* event) {
    QWidget::showEvent(event);
    lockedNodePreview->setVisible(lockedNodeId >= 0);
@@ -482,6 +560,7 @@ void PreviewImagePanel::setActiveNode(int id) {
       return;
    }
    selectedNodeId = id;
+   updatePinnedImages();
    if (this->isHidden()) {
       return;
    }
@@ -499,6 +578,7 @@ void PreviewImagePanel::nodeRemoved(int id) {
    if (lockedNodeId == id) {
       lockNodeButton->setChecked(false);
    }
+   updatePinnedImages();
 }
 
 QPixmap PreviewImagePanel::tilePixmap(const QPixmap& pixmap, int number) {
@@ -521,6 +601,7 @@ void PreviewImagePanel::settingsUpdated() {
       cubeWidget->setSmoothFiltering(smoothFiltering);
    }
    numTiles = tileCountComboBox->currentData().toInt();
+   updatePinnedImages();
    if (!this->isHidden()) {
       if (!loadSelectedNodeImage()) {
          selectedImageLabel->hide();
@@ -539,6 +620,7 @@ void PreviewImagePanel::setNodeLocked(const bool locked) {
    }
    if (!locked) {
       lockedNodeId = -1;
+      updatePinnedImages();
       lockNodeButton->setText(QStringLiteral("Lock node"));
       lockedImageLabel->hide();
       lockedNodePreview->hide();
@@ -558,6 +640,7 @@ void PreviewImagePanel::setNodeLocked(const bool locked) {
       return;
    }
    lockedNodeId = selectedNodeId;
+   updatePinnedImages();
    lockNodeButton->setText(QStringLiteral("Unlock node"));
    lockedNodePreview->show();
    lockedImageLabel->hide();
@@ -7,8 +7,12 @@
 #ifndef PREVIEWIMAGEPANEL_H
 #define PREVIEWIMAGEPANEL_H
 
+#include "base/textureimage.h"
+#include <QList>
 #include <QPixmap>
+#include <QSize>
 #include <QWidget>
+#include <utility>
 class TextureProject;
 class QPushButton;
 class ImageLabel;
@@ -30,8 +34,8 @@ public:
    /// @param project Project whose rendered images are displayed.
    explicit PreviewImagePanel(TextureProject& project);
 
-   /// @brief Destroys the image preview panel.
-   ~PreviewImagePanel() override = default;
+   /// @brief Destroys the image preview panel and releases its image pins.
+   ~PreviewImagePanel() override;
 
    /// @brief Reloads preview images when the panel becomes visible.
    /// @param event Show event.
@@ -47,10 +51,20 @@ public slots:
    /// @param size Available image size.
    void imageAvailable(int id, QSize size);
 
+   /// @brief Displays an intermediate thumbnail of a previewed node while it is rendering.
+   /// @param id Node identifier.
+   /// @param size Image size.
+   /// @param image Image rendered for an outdated revision of the node.
+   void frameAvailable(int id, QSize size, const TextureImagePtr& image);
+
    /// @brief Clears a preview whose cached image is no longer valid.
    /// @param id Updated node identifier.
    void imageUpdated(int id);
 
+   /// @brief Clears the previews of the nodes in a project invalidation.
+   /// @param ids Updated node identifiers.
+   void imagesUpdated(const QList<int>& ids);
+
    /// @brief Applies changed project settings to the preview widgets.
    void settingsUpdated();
 
@@ -72,6 +86,10 @@ private:
    /// @return The tiled thumbnail, or a null pixmap when no cached image is available.
    QPixmap nodePixmap(int id);
 
+   /// @brief Returns a thumbnail tiled as configured by the panel.
+   /// @param texture Thumbnail-sized texture.
+   QPixmap texturePixmap(const TextureImage& texture);
+
    /// @brief Composites a texture over the configured transparent-node background.
    QPixmap pixmapWithNodeBackground(const QPixmap& pixmap) const;
 
@@ -95,6 +113,9 @@ private:
    /// @brief Updates the panel minimum width from the current preview controls.
    void updateControlsMinimumWidth();
 
+   /// @brief Pins the images of the selected and locked nodes and releases earlier pins.
+   void updatePinnedImages();
+
    /// @brief Project whose rendered images are displayed.
    TextureProject& project;
    /// @brief Selector controlling the preview tile count.
@@ -123,6 +144,8 @@ private:
    int numTiles{1};
    /// @brief Cached thumbnail size requested from the project.
    QSize imageSize;
+   /// @brief Node images pinned in the project's image budget while displayed.
+   QList<std::pair<int, QSize>> pinnedImages;
 };
 
 /// @brief Automatically scales a pixmap to fit inside a widget.
@@ -4,6 +4,7 @@
 // Released under GPLv3.
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
+#include "base/textureimagebudget.h"
 #include "base/textureproject.h"
 #include "gui/iteminfopanel.h"
 #include "gui/sceneinfowidget.h"
@@ -23,6 +24,23 @@ SceneInfoWidget::SceneInfoWidget(ItemInfoPanel& widgetmanager)
    nodeInfoLayout->addWidget(numNodesLabel, 0, 1);
    layout->addWidget(nodeInfoWidget);
 
+   auto* memoryInfoWidget = new QGroupBox("Image memory");
+   auto* memoryInfoLayout = new QGridLayout();
+   memoryInfoWidget->setLayout(memoryInfoLayout);
+   memoryInfoLayout->addWidget(new QLabel("Cached images: "), 0, 0);
+   numImagesLabel = new QLabel("0", this);
+   memoryInfoLayout->addWidget(numImagesLabel, 0, 1);
+   memoryInfoLayout->addWidget(new QLabel("Memory used: "), 1, 0);
+   imageMemoryLabel = new QLabel(this);
+   memoryInfoLayout->addWidget(imageMemoryLabel, 1, 1);
+   memoryInfoLayout->addWidget(new QLabel("Pinned by views: "), 2, 0);
+   pinnedMemoryLabel = new QLabel(this);
+   memoryInfoLayout->addWidget(pinnedMemoryLabel, 2, 1);
+   memoryInfoLayout->addWidget(new QLabel("Evicted images: "), 3, 0);
+   evictionsLabel = new QLabel("0", this);
+   memoryInfoLayout->addWidget(evictionsLabel, 3, 1);
+   layout->addWidget(memoryInfoWidget);
+
    layout->addItem(new QSpacerItem(0, 0, QSizePolicy::Minimum, QSizePolicy::Expanding));
 }
 
@@ -30,3 +48,16 @@ void SceneInfoWidget::updateNumNodes() {
    int num = widgetmanager.getTextureProject()->getNumNodes();
    numNodesLabel->setText(QString("%1").arg(num));
 }
+
+void SceneInfoWidget::updateImageMemory() {
+   const TextureImageBudget::Statistics statistics =
+       widgetmanager.getTextureProject()->getImageBudget().getStatistics();
+   constexpr double bytesPerMegabyte = 1024.0 * 1024.0;
+   numImagesLabel->setText(QString("%1").arg(statistics.imageCount));
+   imageMemoryLabel->setText(QString("%1 / %2 MiB")
+                                 .arg(statistics.usedBytes / bytesPerMegabyte, 0, 'f', 1)
+                                 .arg(statistics.budgetBytes / bytesPerMegabyte, 0, 'f', 0));
+   pinnedMemoryLabel->setText(
+       QString("%1 MiB").arg(statistics.pinnedBytes / bytesPerMegabyte, 0, 'f', 1));
+   evictionsLabel->setText(QString("%1").arg(statistics.evictions));
+}
@@ -16,7 +16,8 @@ class QGroupBox;
 class QVBoxLayout;
 
 /// @brief Displays basic scene information when no graph item is selected.
-/// Currently, the widget displays the number of nodes in the scene.
+/// Currently, the widget displays the number of nodes in the scene and the memory used by cached
+/// node images.
 class SceneInfoWidget : public QWidget {
    Q_OBJECT
 
@@ -31,11 +32,22 @@ public:
    /// @brief Updates the displayed node count from the current project.
    void updateNumNodes();
 
+   /// @brief Updates the displayed image memory usage and eviction count from the current project.
+   void updateImageMemory();
+
 private:
    /// @brief Information panel that owns this widget.
    ItemInfoPanel& widgetmanager;
    /// @brief Label displaying the current node count.
    QLabel* numNodesLabel{nullptr};
+   /// @brief Label displaying the number of cached node images.
+   QLabel* numImagesLabel{nullptr};
+   /// @brief Label displaying the used and available image memory.
+   QLabel* imageMemoryLabel{nullptr};
+   /// @brief Label displaying the memory held by pinned images.
+   QLabel* pinnedMemoryLabel{nullptr};
+   /// @brief Label displaying the number of evicted images.
+   QLabel* evictionsLabel{nullptr};
 };
 
 #endif  // SCENEINFOWIDGET_H
@@ -215,6 +215,49 @@ SettingsPanel::SettingsPanel(MainWindow* parent, SettingsManager* settingsmanage
    exportLayout->addWidget(exportImageHeightLabel, 1, 0);
    exportLayout->addWidget(exportImageHeightSpinbox, 1, 1);
 
+   QGroupBox* memoryWidget = new QGroupBox("Performance");
+   auto* memoryLayout = new QGridLayout;
+   memoryWidget->setLayout(memoryLayout);
+   memoryWidget->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
+   contentsLayout->addWidget(memoryWidget);
+
+   QLabel* imageMemoryBudgetLabel = new QLabel("Image cache (MiB):");
+   imageMemoryBudgetSpinbox = new QSpinBox(this);
+   imageMemoryBudgetSpinbox->setMinimum(64);
+   imageMemoryBudgetSpinbox->setMaximum(65536);
+   imageMemoryBudgetSpinbox->setSingleStep(64);
+   memoryLayout->addWidget(imageMemoryBudgetLabel, 0, 0);
+   memoryLayout->addWidget(imageMemoryBudgetSpinbox, 0, 1);
+
+   QLabel* previewLatencyLabel = new QLabel("Preview latency (ms):");
+   previewLatencySpinbox = new QSpinBox(this);
+   previewLatencySpinbox->setMinimum(0);
+   previewLatencySpinbox->setMaximum(1000);
+   previewLatencySpinbox->setSingleStep(10);
+   memoryLayout->addWidget(previewLatencyLabel, 1, 0);
+   memoryLayout->addWidget(previewLatencySpinbox, 1, 1);
+
+   QLabel* progressivePreviewScaleLabel = new QLabel("Preview first pass (%):");
+   progressivePreviewScaleSpinbox = new QSpinBox(this);
+   progressivePreviewScaleSpinbox->setMinimum(0);
+   progressivePreviewScaleSpinbox->setMaximum(90);
+   progressivePreviewScaleSpinbox->setSingleStep(5);
+   memoryLayout->addWidget(progressivePreviewScaleLabel, 2, 0);
+   memoryLayout->addWidget(progressivePreviewScaleSpinbox, 2, 1);
+
+   QLabel* fullSizePreviewLabel = new QLabel("Render previews at full size:");
+   fullSizePreviewCheckbox = new QCheckBox(this);
+   memoryLayout->addWidget(fullSizePreviewLabel, 3, 0);
+   memoryLayout->addWidget(fullSizePreviewCheckbox, 3, 1);
+
+   QLabel* renderThreadsLabel = new QLabel("Render threads:");
+   renderThreadsSpinbox = new QSpinBox(this);
+   renderThreadsSpinbox->setMinimum(0);
+   renderThreadsSpinbox->setMaximum(256);
+   renderThreadsSpinbox->setSpecialValueText("Automatic");
+   memoryLayout->addWidget(renderThreadsLabel, 4, 0);
+   memoryLayout->addWidget(renderThreadsSpinbox, 4, 1);
+
    QGroupBox* generatorsWidget = new QGroupBox("JavaScript Generators");
    auto* generatorsLayout = new QGridLayout;
    generatorsWidget->setLayout(generatorsLayout);
@@ -271,6 +314,13 @@ SettingsPanel::SettingsPanel(MainWindow* parent, SettingsManager* settingsmanage
    QObject::connect(thumbnailHeightSpinbox, spinboxChanged, this, &SettingsPanel::applySettings);
    QObject::connect(exportImageWidthSpinbox, spinboxChanged, this, &SettingsPanel::applySettings);
    QObject::connect(exportImageHeightSpinbox, spinboxChanged, this, &SettingsPanel::applySettings);
+   QObject::connect(imageMemoryBudgetSpinbox, spinboxChanged, this, &SettingsPanel::applySettings);
+   QObject::connect(previewLatencySpinbox, spinboxChanged, this, &SettingsPanel::applySettings);
+   QObject::connect(progressivePreviewScaleSpinbox, spinboxChanged, this,
+                    &SettingsPanel::applySettings);
+   QObject::connect(fullSizePreviewCheckbox, &QCheckBox::toggled, this,
+                    &SettingsPanel::applySettings);
+   QObject::connect(renderThreadsSpinbox, spinboxChanged, this, &SettingsPanel::applySettings);
    QObject::connect(lineWidthSlider, sliderChanged, this, &SettingsPanel::applySettings);
    QObject::connect(arrowSizeSlider, sliderChanged, this, &SettingsPanel::applySettings);
    QObject::connect(connectionLabelSizeSlider, sliderChanged, this, &SettingsPanel::applySettings);
@@ -355,6 +405,11 @@ void SettingsPanel::applySettings() {
        QSize(exportImageWidthSpinbox->value(), exportImageHeightSpinbox->value()));
    settingsmanager->setThumbnailSize(
        QSize(thumbnailWidthSpinbox->value(), thumbnailHeightSpinbox->value()));
+   settingsmanager->setImageMemoryBudget(imageMemoryBudgetSpinbox->value());
+   settingsmanager->setPreviewLatency(previewLatencySpinbox->value());
+   settingsmanager->setProgressivePreviewScale(progressivePreviewScaleSpinbox->value());
+   settingsmanager->setFullSizePreview(fullSizePreviewCheckbox->isChecked());
+   settingsmanager->setRenderThreads(renderThreadsSpinbox->value());
    settingsmanager->setPreviewBackgroundColor(QColor(previewBackgroundColorButton->text()));
    settingsmanager->setBackgroundColor(QColor(backgroundColorButton->text()));
    settingsmanager->setBackgroundBrushColor(QColor(backgroundBrushColorButton->text()));
@@ -489,6 +544,11 @@ void SettingsPanel::settingsUpdated() {
    exportImageHeightSpinbox->setValue(settingsmanager->getPreviewSize().height());
    thumbnailWidthSpinbox->setValue(settingsmanager->getThumbnailSize().width());
    thumbnailHeightSpinbox->setValue(settingsmanager->getThumbnailSize().height());
+   imageMemoryBudgetSpinbox->setValue(settingsmanager->getImageMemoryBudget());
+   previewLatencySpinbox->setValue(settingsmanager->getPreviewLatency());
+   progressivePreviewScaleSpinbox->setValue(settingsmanager->getProgressivePreviewScale());
+   fullSizePreviewCheckbox->setChecked(settingsmanager->getFullSizePreview());
+   renderThreadsSpinbox->setValue(settingsmanager->getRenderThreads());
    lineWidthSlider->setValue(lineWidth);
    arrowSizeSlider->setValue(arrowSize / 2);
    connectionLabelSizeSlider->setValue(settingsmanager->getConnectionLabelSize());
@@ -525,6 +585,11 @@ void SettingsPanel::resetSettings() {
    exportImageHeightSpinbox->setValue(800);
    thumbnailWidthSpinbox->setValue(300);
    thumbnailHeightSpinbox->setValue(300);
+   imageMemoryBudgetSpinbox->setValue(1024);
+   previewLatencySpinbox->setValue(50);
+   progressivePreviewScaleSpinbox->setValue(25);
+   fullSizePreviewCheckbox->setChecked(false);
+   renderThreadsSpinbox->setValue(0);
    lineWidthSlider->setValue(3);
    arrowSizeSlider->setValue(6);
    connectionLabelSizeSlider->setValue(12);
@@ -578,6 +643,11 @@ void SettingsPanel::saveSettings() {
    thumbnailHeight = (thumbnailHeight % 2) ? (thumbnailHeight + 1) : thumbnailHeight;
    settingsmanager->setPreviewSize(QSize(exportImageWidth, exportImageHeight));
    settingsmanager->setThumbnailSize(QSize(thumbnailWidth, thumbnailHeight));
+   settingsmanager->setImageMemoryBudget(imageMemoryBudgetSpinbox->value());
+   settingsmanager->setPreviewLatency(previewLatencySpinbox->value());
+   settingsmanager->setProgressivePreviewScale(progressivePreviewScaleSpinbox->value());
+   settingsmanager->setFullSizePreview(fullSizePreviewCheckbox->isChecked());
+   settingsmanager->setRenderThreads(renderThreadsSpinbox->value());
    settingsmanager->setJSTextureGeneratorsPath(jsGeneratorPathEdit->text());
    settingsmanager->setJSTextureGeneratorsEnabled(jsGeneratorEnabledCheckbox->isChecked());
    settingsmanager->setConnectionLabelSize(connectionLabelSizeSlider->value());
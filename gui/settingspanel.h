@@ -101,6 +101,16 @@ private:
    QSpinBox* exportImageWidthSpinbox{nullptr};
    /// @brief Editor for the exported image height.
    QSpinBox* exportImageHeightSpinbox{nullptr};
+   /// @brief Editor for the image cache memory budget in mebibytes.
+   QSpinBox* imageMemoryBudgetSpinbox{nullptr};
+   /// @brief Editor for the preview render latency budget in milliseconds.
+   QSpinBox* previewLatencySpinbox{nullptr};
+   /// @brief Editor for the size of the first thumbnail render pass in percent.
+   QSpinBox* progressivePreviewScaleSpinbox{nullptr};
+   /// @brief Toggle for rendering previewed nodes at the preview size.
+   QCheckBox* fullSizePreviewCheckbox{nullptr};
+   /// @brief Editor for the number of render worker threads, zero meaning automatic.
+   QSpinBox* renderThreadsSpinbox{nullptr};
    /// @brief Slider controlling regular connection-line width.
    QSlider* lineWidthSlider{nullptr};
    /// @brief Slider controlling connection-arrow size.
@@ -175,22 +175,39 @@ void ViewNodeItem::imageAvailable(QSize size) {
       if (image.isNull()) {
          return;
       }
-      const TextureImage& texture = *image;
-      const QPixmap texturePixmap = QPixmap::fromImage(texture.toQImageView());
-      const SettingsManager* settingsManager = scene.getTextureProject().getSettingsManager();
-      if (settingsManager == nullptr) {
-         pixmap = texturePixmap;
-      } else {
-         pixmap = TextureBackground::composite(
-             texturePixmap, settingsManager->getNodeBackgroundColor(),
-             settingsManager->getNodeBackgroundBrushColor(),
-             Qt::BrushStyle(settingsManager->getNodeBackgroundBrush()));
-      }
+      setThumbnail(*image);
       imageValid = true;
       update();
    }
 }
 
+void ViewNodeItem::frameAvailable(QSize size, const TextureImagePtr& image) {
+   // The stale-image overlay stays, because the frame is not the node's current image. Frames of
+   // the low-resolution pass are smaller than the thumbnail and are scaled up.
+   Q_UNUSED(size);
+   if (!image.isNull() && !imageValid) {
+      setThumbnail(*image);
+      update();
+   }
+}
+
+void ViewNodeItem::setThumbnail(const TextureImage& texture) {
+   QPixmap texturePixmap = QPixmap::fromImage(texture.toQImageView());
+   if (texturePixmap.size() != thumbnailSize) {
+      texturePixmap = texturePixmap.scaled(thumbnailSize, Qt::IgnoreAspectRatio,
+                                           Qt::SmoothTransformation);
+   }
+   const SettingsManager* settingsManager = scene.getTextureProject().getSettingsManager();
+   if (settingsManager == nullptr) {
+      pixmap = texturePixmap;
+   } else {
+      pixmap = TextureBackground::composite(
+          texturePixmap, settingsManager->getNodeBackgroundColor(),
+          settingsManager->getNodeBackgroundBrushColor(),
+          Qt::BrushStyle(settingsManager->getNodeBackgroundBrush()));
+   }
+}
+
 void ViewNodeItem::contextMenuEvent(QGraphicsSceneContextMenuEvent* event) {
    event->accept();
    QMenu menu;
@@ -102,6 +102,11 @@ public slots:
    /// @param size Available image size.
    void imageAvailable(QSize size);
 
+   /// @brief Displays an intermediate thumbnail while the current one is rendering.
+   /// @param size Image size, which may differ from the thumbnail size.
+   /// @param image Image rendered for an outdated revision or at a lower resolution.
+   void frameAvailable(QSize size, const TextureImagePtr& image);
+
    /// @brief Refreshes the item after its generator changes.
    void generatorUpdated();
 
@@ -146,6 +151,10 @@ private:
    /// @brief Updates every connection line attached to the node.
    void updateConnectionLines();
 
+   /// @brief Replaces the displayed thumbnail with a texture over the node background.
+   /// @param texture Thumbnail-sized texture.
+   void setThumbnail(const TextureImage& texture);
+
    /// @brief Whether this node should reveal labels on attached connections.
    bool connectionLabelsActive() const { return hovered || isSelected(); }
 
@@ -5,6 +5,7 @@
 // Johan Lindqvist (johan.lindqvist@gmail.com)
 
 #include "base/settingsmanager.h"
+#include "base/textureimagebudget.h"
 #include "base/textureproject.h"
 #include "base/editmanager.h"
 #include "gui/clipboardoperations.h"
@@ -52,6 +53,14 @@ ViewNodeScene::ViewNodeScene(MainWindow& mainWindow)
    settingsUpdated();
 }
 
+ViewNodeScene::~ViewNodeScene() {
+   TextureImageBudget& budget = project.getImageBudget();
+   QMapIterator<int, ViewNodeItem*> nodesIter(nodeItems);
+   while (nodesIter.hasNext()) {
+      budget.unpin(nodesIter.next().key(), pinnedThumbnailSize);
+   }
+}
+
 std::unique_ptr<ViewNodeScene> ViewNodeScene::clone() const {
    auto newscene = std::make_unique<ViewNodeScene>(mainWindow);
    QMapIterator<int, ViewNodeItem*> nodesIter(nodeItems);
@@ -174,6 +183,7 @@ void ViewNodeScene::addNode(const TextureNodePtr& newNode) {
    auto* newItem = new ViewNodeItem(*this, newNode);
    newItem->setHeaderSize(headerSize);
    nodeItems.insert(newNode->getId(), newItem);
+   project.getImageBudget().pin(newNode->getId(), pinnedThumbnailSize);
    QObject::connect(newNode.data(), &TextureNode::positionUpdated, this,
                     &ViewNodeScene::positionUpdated);
    QObject::connect(newNode.data(), &TextureNode::settingsUpdated, this,
@@ -183,6 +193,8 @@ void ViewNodeScene::addNode(const TextureNodePtr& newNode) {
    QObject::connect(newNode.data(), &TextureNode::imageUpdated, this, &ViewNodeScene::imageUpdated);
    QObject::connect(newNode.data(), &TextureNode::imageAvailable, this,
                     &ViewNodeScene::imageAvailable);
+   QObject::connect(newNode.data(), &TextureNode::frameAvailable, this,
+                    &ViewNodeScene::frameAvailable);
    QObject::connect(newNode.data(), &TextureNode::generatorUpdated, this,
                     &ViewNodeScene::generatorUpdated);
    addItem(newItem);
@@ -260,6 +272,7 @@ void ViewNodeScene::nodeRemoved(int id) {
       nodesDisconnected(endLine->sourceItemId, endLine->receiverItemId, endLine->slot);
    }
    nodeItems.remove(id);
+   project.getImageBudget().unpin(id, pinnedThumbnailSize);
    delete nodeItem;
 }
 
@@ -270,6 +283,13 @@ void ViewNodeScene::imageAvailable(int id, QSize size) {
    }
 }
 
+void ViewNodeScene::frameAvailable(int id, QSize size, const TextureImagePtr& image) {
+   ViewNodeItem* node = nodeItems.value(id);
+   if (node) {
+      node->frameAvailable(size, image);
+   }
+}
+
 void ViewNodeScene::settingsUpdated() {
    auto settingsManager = project.getSettingsManager();
    if (settingsManager != nullptr) {
@@ -281,10 +301,19 @@ void ViewNodeScene::settingsUpdated() {
       QSize itemSize = project.getThumbnailSize() + QSize(4, 4);
       dropItem->setRect(QRect(QPoint(0, 0), itemSize));
    }
+   const QSize thumbnailSize = project.getThumbnailSize();
+   TextureImageBudget& budget = project.getImageBudget();
    QMapIterator<int, ViewNodeItem*> nodeItemIterator(nodeItems);
    while (nodeItemIterator.hasNext()) {
-      nodeItemIterator.next().value()->setThumbnailSize(project.getThumbnailSize());
+      nodeItemIterator.next();
+      // Pin the new size before releasing the old one, so unpinning cannot evict the new image.
+      if (thumbnailSize != pinnedThumbnailSize) {
+         budget.pin(nodeItemIterator.key(), thumbnailSize);
+         budget.unpin(nodeItemIterator.key(), pinnedThumbnailSize);
+      }
+      nodeItemIterator.value()->setThumbnailSize(thumbnailSize);
    }
+   pinnedThumbnailSize = thumbnailSize;
    QMapIterator<std::tuple<int, int, QString>, ViewNodeLine*> nodeConnectionsIterator(
        nodeConnections);
    while (nodeConnectionsIterator.hasNext()) {
@@ -32,8 +32,8 @@ public:
    /// @param mainWindow Main window that supplies the project and handles scene actions.
    explicit ViewNodeScene(MainWindow& mainWindow);
 
-   /// @brief Destroys the graph scene and its graphics items.
-   ~ViewNodeScene() override = default;
+   /// @brief Destroys the graph scene and its graphics items and releases their thumbnail pins.
+   ~ViewNodeScene() override;
 
    /// @brief Creates a new scene with the same graph presentation.
    /// @return Owned scene containing copies of the current items.
@@ -162,6 +162,12 @@ public slots:
    /// @param size Available image size.
    void imageAvailable(int id, QSize size);
 
+   /// @brief Displays an intermediate node image while the current one is rendering.
+   /// @param id Node identifier.
+   /// @param size Image size.
+   /// @param image Image rendered for an outdated revision of the node.
+   void frameAvailable(int id, QSize size, const TextureImagePtr& image);
+
    /// @brief Adds a line for a newly created project connection.
    /// @param sourceid Source node identifier.
    /// @param receiverid Receiver node identifier.
@@ -235,6 +241,8 @@ private:
    bool lineDrawing{false};
    /// @brief Optional brush painted over the solid scene background.
    QBrush backgroundPatternBrush;
+   /// @brief Thumbnail size at which every node item pins its image in the project budget.
+   QSize pinnedThumbnailSize;
 };
 
 #endif  // VIEWNODESCENE_H
@@ -45,6 +45,11 @@ void SettingsManagerTest::defaultsChangesAndPersistence() {
    QVERIFY(!settings.getDisplaySourceNames());
    QVERIFY(!settings.getDisplayReceiverNames());
    QCOMPARE(settings.getTextureFiltering(), SettingsManager::TextureFiltering::Smooth);
+   QCOMPARE(settings.getImageMemoryBudget(), 1024);
+   QCOMPARE(settings.getPreviewLatency(), 50);
+   QCOMPARE(settings.getProgressivePreviewScale(), 25);
+   QVERIFY(!settings.getFullSizePreview());
+   QCOMPARE(settings.getRenderThreads(), 0);
 
    QSignalSpy updates(&settings, &SettingsManager::settingsUpdated);
    settings.setPreviewSize(settings.getPreviewSize());
@@ -62,7 +67,12 @@ void SettingsManagerTest::defaultsChangesAndPersistence() {
    settings.setNodeBackgroundBrushColor(QColor(QStringLiteral("#654321")));
    settings.setNodeBackgroundBrush(static_cast<int>(Qt::DiagCrossPattern));
    settings.setTextureFiltering(SettingsManager::TextureFiltering::Nearest);
-   QCOMPARE(updates.count(), 14);
+   settings.setImageMemoryBudget(256);
+   settings.setPreviewLatency(120);
+   settings.setProgressivePreviewScale(0);
+   settings.setFullSizePreview(true);
+   settings.setRenderThreads(3);
+   QCOMPARE(updates.count(), 19);
    settings.setPreviewSize(QSize());
    settings.setBackgroundColor(QColor());
    settings.setConnectionLabelSize(40);
@@ -72,7 +82,12 @@ void SettingsManagerTest::defaultsChangesAndPersistence() {
    settings.setNodeBackgroundBrush(100);
    settings.setBackgroundBrush(static_cast<int>(Qt::LinearGradientPattern));
    settings.setNodeBackgroundBrush(static_cast<int>(Qt::TexturePattern));
-   QCOMPARE(updates.count(), 14);
+   settings.setImageMemoryBudget(16);
+   settings.setPreviewLatency(-1);
+   settings.setProgressivePreviewScale(95);
+   settings.setRenderThreads(-1);
+   settings.setRenderThreads(1000);
+   QCOMPARE(updates.count(), 19);
    QVERIFY(settings.saveSettings());
 
    SettingsManager loaded;
@@ -89,6 +104,11 @@ void SettingsManagerTest::defaultsChangesAndPersistence() {
    QCOMPARE(loaded.getNodeBackgroundBrushColor(), QColor(QStringLiteral("#654321")));
    QCOMPARE(loaded.getNodeBackgroundBrush(), static_cast<int>(Qt::DiagCrossPattern));
    QCOMPARE(loaded.getTextureFiltering(), SettingsManager::TextureFiltering::Nearest);
+   QCOMPARE(loaded.getImageMemoryBudget(), 256);
+   QCOMPARE(loaded.getPreviewLatency(), 120);
+   QCOMPARE(loaded.getProgressivePreviewScale(), 0);
+   QVERIFY(loaded.getFullSizePreview());
+   QCOMPARE(loaded.getRenderThreads(), 3);
 
    QSettings persisted;
    persisted.setValue(QStringLiteral("previewsize"), QSize(-1, 0));
@@ -101,6 +121,10 @@ void SettingsManagerTest::defaultsChangesAndPersistence() {
    persisted.setValue(QStringLiteral("nodebackgroundbrush"), static_cast<int>(Qt::TexturePattern));
    persisted.setValue(QStringLiteral("connectionlabelsize"), 40);
    persisted.setValue(QStringLiteral("texturefiltering"), 100);
+   persisted.setValue(QStringLiteral("imagememorybudget"), 0);
+   persisted.setValue(QStringLiteral("previewlatency"), 5000);
+   persisted.setValue(QStringLiteral("progressivepreviewscale"), -10);
+   persisted.setValue(QStringLiteral("renderthreads"), -4);
    persisted.sync();
    SettingsManager recovered;
    QCOMPARE(recovered.getPreviewSize(), QSize(800, 800));
@@ -112,6 +136,10 @@ void SettingsManagerTest::defaultsChangesAndPersistence() {
    QCOMPARE(recovered.getNodeBackgroundBrush(), static_cast<int>(Qt::CrossPattern));
    QCOMPARE(recovered.getConnectionLabelSize(), 12);
    QCOMPARE(recovered.getTextureFiltering(), SettingsManager::TextureFiltering::Smooth);
+   QCOMPARE(recovered.getImageMemoryBudget(), 1024);
+   QCOMPARE(recovered.getPreviewLatency(), 50);
+   QCOMPARE(recovered.getProgressivePreviewScale(), 25);
+   QCOMPARE(recovered.getRenderThreads(), 0);
 }
 
 QTEST_APPLESS_MAIN(SettingsManagerTest)
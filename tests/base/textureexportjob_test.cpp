@@ -0,0 +1,181 @@
+#include "base/textureexporter.h"
+#include "base/textureexportjob.h"
+#include "base/texturenode.h"
+#include "base/textureproject.h"
+#include "support/testgenerators.h"
+#include <QFileInfo>
+#include <QImage>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace {
+
+/// @brief Adds a recording generator to a project and creates one node that uses it.
+/// @param project Project receiving the generator and node.
+/// @param id Identifier of the new node.
+/// @param generator Generator owned by the project afterwards.
+/// @return The new node.
+TextureNodePtr addNode(TextureProject& project, const int id, RecordingGenerator* generator) {
+   project.addGenerator(TextureGeneratorPtr(generator));
+   return project.newNode(id, project.getGenerator(generator->getName()));
+}
+
+}  // namespace
+
+/// @brief Verifies image exports that run in the background of the event loop.
+class TextureExportJobTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies a job renders and writes the PNG while start() returns immediately.
+   void exportsInBackground();
+   /// @brief Verifies a cancelled job reports cancellation and writes no file.
+   void cancelsExport();
+   /// @brief Verifies two jobs render their graphs at the same time.
+   void runsJobsConcurrently();
+   /// @brief Verifies nodes cached at the export size are not rendered again.
+   void reusesCachedUpstreamImages();
+   /// @brief Verifies an existing destination is kept when overwriting is disabled.
+   void keepsExistingDestination();
+};
+
+void TextureExportJobTest::exportsInBackground() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* sourceRaw = new RecordingGenerator(QStringLiteral("Source"), 0, 1);
+   sourceRaw->block();
+   addNode(project, 1, sourceRaw);
+   const TextureNodePtr receiver =
+       addNode(project, 2, new RecordingGenerator(QStringLiteral("Receiver"), 1, 2));
+   QVERIFY(receiver->setSourceSlot(QStringLiteral("Image"), 1));
+
+   const QSize size(8, 4);
+   const QString path = directory.filePath(QStringLiteral("export.png"));
+   TextureExportJob job(project, 2, size, path, false);
+   QSignalSpy progressSpy(&job, &TextureExportJob::progressChanged);
+   QSignalSpy finishedSpy(&job, &TextureExportJob::finished);
+   job.start();
+   const bool started = sourceRaw->waitUntilStarted();
+   const bool runningWhileBlocked = job.isRunning();
+   sourceRaw->release();
+   QVERIFY(started);
+   QVERIFY(runningWhileBlocked);
+   QVERIFY(finishedSpy.wait(5000));
+
+   QVERIFY2(job.getResult().succeeded(), qPrintable(job.getResult().message));
+   QVERIFY(!job.isRunning());
+   QVERIFY(!progressSpy.isEmpty());
+   QCOMPARE(progressSpy.last().at(0).toInt(), 2);
+   QCOMPARE(progressSpy.last().at(1).toInt(), 2);
+   const QImage written(path);
+   QCOMPARE(written.size(), size);
+   QCOMPARE(qRed(written.pixel(0, 0)), 2);
+   QVERIFY(!receiver->cachedImage(size).isNull());
+   // Intermediate images are released during the render instead of filling the node caches.
+   QVERIFY(project.getNode(1)->cachedImage(size).isNull());
+}
+
+void TextureExportJobTest::cancelsExport() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* sourceRaw = new RecordingGenerator(QStringLiteral("Source"), 0, 1);
+   auto* receiverRaw = new RecordingGenerator(QStringLiteral("Receiver"), 1, 2);
+   sourceRaw->block();
+   addNode(project, 1, sourceRaw);
+   QVERIFY(addNode(project, 2, receiverRaw)->setSourceSlot(QStringLiteral("Image"), 1));
+
+   const QString path = directory.filePath(QStringLiteral("cancelled.png"));
+   TextureExportJob job(project, 2, QSize(4, 4), path, false);
+   QSignalSpy finishedSpy(&job, &TextureExportJob::finished);
+   job.start();
+   QVERIFY(sourceRaw->waitUntilStarted());
+   job.cancel();
+   sourceRaw->release();
+   QVERIFY(finishedSpy.wait(5000));
+
+   QVERIFY(job.getResult().error == TextureExportError::Cancelled);
+   QVERIFY(!QFileInfo::exists(path));
+}
+
+void TextureExportJobTest::runsJobsConcurrently() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* firstRaw = new RecordingGenerator(QStringLiteral("First"), 0, 1);
+   auto* secondRaw = new RecordingGenerator(QStringLiteral("Second"), 0, 2);
+   firstRaw->block();
+   secondRaw->block();
+   addNode(project, 1, firstRaw);
+   addNode(project, 2, secondRaw);
+
+   TextureExportJob first(project, 1, QSize(4, 4),
+                          directory.filePath(QStringLiteral("first.png")), false);
+   TextureExportJob second(project, 2, QSize(4, 4),
+                           directory.filePath(QStringLiteral("second.png")), false);
+   QSignalSpy firstSpy(&first, &TextureExportJob::finished);
+   QSignalSpy secondSpy(&second, &TextureExportJob::finished);
+   first.start();
+   second.start();
+   const bool firstStarted = firstRaw->waitUntilStarted();
+   const bool secondStarted = secondRaw->waitUntilStarted();
+   firstRaw->release();
+   secondRaw->release();
+   QVERIFY(firstStarted);
+   QVERIFY(secondStarted);
+   QVERIFY(firstSpy.count() == 1 || firstSpy.wait(5000));
+   QVERIFY(secondSpy.count() == 1 || secondSpy.wait(5000));
+   QVERIFY2(first.getResult().succeeded(), qPrintable(first.getResult().message));
+   QVERIFY2(second.getResult().succeeded(), qPrintable(second.getResult().message));
+}
+
+void TextureExportJobTest::reusesCachedUpstreamImages() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* sourceRaw = new RecordingGenerator(QStringLiteral("Source"), 0, 1);
+   addNode(project, 1, sourceRaw);
+   const TextureNodePtr receiver =
+       addNode(project, 2, new RecordingGenerator(QStringLiteral("Receiver"), 1, 2));
+   QVERIFY(receiver->setSourceSlot(QStringLiteral("Image"), 1));
+
+   const QSize size(4, 4);
+   TextureImagePtr sourceImage;
+   QVERIFY(TextureExporter::renderNode(project, 1, size, sourceImage).succeeded());
+   QCOMPARE(sourceRaw->callCount(), 1);
+   sourceRaw->fail();
+
+   TextureExportJob job(project, 2, size, directory.filePath(QStringLiteral("cached.png")), false);
+   QSignalSpy finishedSpy(&job, &TextureExportJob::finished);
+   job.start();
+   QVERIFY(finishedSpy.wait(5000));
+   QVERIFY2(job.getResult().succeeded(), qPrintable(job.getResult().message));
+   QCOMPARE(sourceRaw->callCount(), 1);
+}
+
+void TextureExportJobTest::keepsExistingDestination() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   TextureProject project(false);
+   auto* sourceRaw = new RecordingGenerator(QStringLiteral("Source"), 0, 1);
+   addNode(project, 1, sourceRaw);
+   const QString path = directory.filePath(QStringLiteral("existing.png"));
+   QVERIFY(QImage(2, 2, QImage::Format_RGB32).save(path));
+
+   TextureExportJob job(project, 1, QSize(4, 4), path, false);
+   QSignalSpy finishedSpy(&job, &TextureExportJob::finished);
+   job.start();
+   QVERIFY(finishedSpy.wait(5000));
+   QVERIFY(job.getResult().error == TextureExportError::OutputExists);
+   QCOMPARE(sourceRaw->callCount(), 0);
+   QCOMPARE(QImage(path).size(), QSize(2, 2));
+}
+
+QTEST_GUILESS_MAIN(TextureExportJobTest)
+#include "textureexportjob_test.moc"
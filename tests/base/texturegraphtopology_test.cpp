@@ -0,0 +1,224 @@
+#include "base/texturegraphtopology.h"
+#include <QHash>
+#include <QList>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTest>
+
+namespace {
+
+/// @brief Checks by a plain search whether a node reaches another one.
+bool reachesByPath(const QHash<int, QSet<int>>& receivers, const int fromId, const int toId) {
+   QSet<int> seen{fromId};
+   QList<int> pending{fromId};
+   while (!pending.isEmpty()) {
+      const int id = pending.takeLast();
+      if (id == toId) {
+         return true;
+      }
+      for (const int receiverId : receivers.value(id)) {
+         if (!seen.contains(receiverId)) {
+            seen.insert(receiverId);
+            pending.append(receiverId);
+         }
+      }
+   }
+   return false;
+}
+
+/// @brief Checks that every edge leads forward in the topological order.
+bool ordersEveryEdge(const TextureGraphTopology& topology, const QHash<int, QSet<int>>& receivers) {
+   const QList<int> order = topology.topologicalOrder();
+   QHash<int, qsizetype> positions;
+   for (qsizetype position = 0; position < order.size(); ++position) {
+      positions.insert(order.at(position), position);
+   }
+   for (auto node = receivers.cbegin(); node != receivers.cend(); ++node) {
+      for (const int receiverId : node.value()) {
+         if (positions.value(node.key()) >= positions.value(receiverId) ||
+             topology.orderOf(node.key()) >= topology.orderOf(receiverId)) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+/// @brief Returns the ID of a node in a lattice of the given width.
+int latticeId(const int width, const int layer, const int index) {
+   return layer * width + index + 1;
+}
+
+}  // namespace
+
+/// @brief Verifies the topology index keeps graphs acyclic and ordered.
+class TextureGraphTopologyTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies edges are ordered, cycles are rejected, and reachability is reported.
+   void ordersAndRejectsCycles();
+   /// @brief Verifies removing edges and nodes updates the adjacency.
+   void removesEdgesAndNodes();
+   /// @brief Verifies downstream closures are listed once in topological order.
+   void listsDownstreamNodes();
+   /// @brief Verifies random edits of large graphs match a plain reachability search.
+   void matchesPlainSearchOnRandomGraphs();
+   /// @brief Verifies deep lattices connected against the order are built and checked quickly.
+   void connectsDeepLattices();
+};
+
+void TextureGraphTopologyTest::ordersAndRejectsCycles() {
+   TextureGraphTopology topology;
+   for (int id = 1; id <= 4; ++id) {
+      topology.addNode(id);
+   }
+   // Edges against the insertion order make the index reorder the nodes.
+   QVERIFY(topology.addEdge(4, 3));
+   QVERIFY(topology.addEdge(3, 2));
+   QVERIFY(topology.addEdge(2, 1));
+   QVERIFY(topology.addEdge(2, 1));
+   QCOMPARE(topology.edgeCount(), 3);
+   QCOMPARE(topology.topologicalOrder(), QList<int>({4, 3, 2, 1}));
+   QVERIFY(topology.reaches(4, 1));
+   QVERIFY(topology.reaches(2, 2));
+   QVERIFY(!topology.reaches(1, 4));
+
+   QVERIFY(!topology.addEdge(1, 4));
+   QVERIFY(!topology.addEdge(2, 3));
+   QVERIFY(!topology.addEdge(1, 1));
+   QVERIFY(!topology.addEdge(1, 9));
+   QCOMPARE(topology.edgeCount(), 3);
+   QVERIFY(!topology.hasCycle());
+   QCOMPARE(topology.topologicalOrder(), QList<int>({4, 3, 2, 1}));
+}
+
+void TextureGraphTopologyTest::removesEdgesAndNodes() {
+   TextureGraphTopology topology;
+   for (int id = 1; id <= 3; ++id) {
+      topology.addNode(id);
+   }
+   QVERIFY(topology.addEdge(1, 2));
+   QVERIFY(topology.addEdge(2, 3));
+   QVERIFY(!topology.addEdge(3, 1));
+   topology.removeEdge(2, 3);
+   topology.removeEdge(2, 3);
+   QCOMPARE(topology.edgeCount(), 1);
+   QVERIFY(topology.addEdge(3, 1));
+   QCOMPARE(topology.sources(1), QList<int>({3}));
+
+   topology.removeNode(1);
+   QVERIFY(!topology.contains(1));
+   QCOMPARE(topology.nodeCount(), 2);
+   QCOMPARE(topology.edgeCount(), 0);
+   QVERIFY(topology.receivers(3).isEmpty());
+   QVERIFY(topology.sources(2).isEmpty());
+   QCOMPARE(topology.orderOf(1), qint64(-1));
+}
+
+void TextureGraphTopologyTest::listsDownstreamNodes() {
+   TextureGraphTopology topology;
+   for (int id = 1; id <= 6; ++id) {
+      topology.addNode(id);
+   }
+   // 5 feeds 3 and 4, which both feed 2; 1 reads 3; 6 is unrelated.
+   QVERIFY(topology.addEdge(5, 3));
+   QVERIFY(topology.addEdge(5, 4));
+   QVERIFY(topology.addEdge(3, 2));
+   QVERIFY(topology.addEdge(4, 2));
+   QVERIFY(topology.addEdge(3, 1));
+
+   QSet<int> downstream;
+   const QList<int> order = topology.downstreamOrder({5, 99}, &downstream);
+   QCOMPARE(order.size(), 5);
+   QCOMPARE(order.first(), 5);
+   QVERIFY(order.indexOf(3) < order.indexOf(2));
+   QVERIFY(order.indexOf(4) < order.indexOf(2));
+   QVERIFY(order.indexOf(3) < order.indexOf(1));
+   QCOMPARE(downstream, QSet<int>({1, 2, 3, 4}));
+
+   downstream.clear();
+   QCOMPARE(topology.downstreamOrder({4, 2}, &downstream), QList<int>({4, 2}));
+   QCOMPARE(downstream, QSet<int>({2}));
+}
+
+void TextureGraphTopologyTest::matchesPlainSearchOnRandomGraphs() {
+   QRandomGenerator random(42);
+   for (int round = 0; round < 4; ++round) {
+      constexpr int nodeCount = 800;
+      TextureGraphTopology topology;
+      QHash<int, QSet<int>> receivers;
+      for (int id = 1; id <= nodeCount; ++id) {
+         topology.addNode(id);
+         receivers.insert(id, {});
+      }
+      for (int operation = 0; operation < 4000; ++operation) {
+         const int sourceId = random.bounded(nodeCount) + 1;
+         const int receiverId = random.bounded(nodeCount) + 1;
+         if (random.bounded(5) == 0) {
+            topology.removeEdge(sourceId, receiverId);
+            receivers[sourceId].remove(receiverId);
+            continue;
+         }
+         const bool acyclic =
+             sourceId != receiverId && !reachesByPath(receivers, receiverId, sourceId);
+         QCOMPARE(topology.addEdge(sourceId, receiverId), acyclic);
+         if (acyclic) {
+            receivers[sourceId].insert(receiverId);
+         }
+         if (operation % 500 == 0) {
+            const int removedId = random.bounded(nodeCount) + 1;
+            topology.removeNode(removedId);
+            receivers.remove(removedId);
+            for (QSet<int>& nodeReceivers : receivers) {
+               nodeReceivers.remove(removedId);
+            }
+            topology.addNode(removedId);
+            receivers.insert(removedId, {});
+         }
+      }
+      int edgeCount = 0;
+      for (const QSet<int>& nodeReceivers : std::as_const(receivers)) {
+         edgeCount += static_cast<int>(nodeReceivers.size());
+      }
+      QCOMPARE(topology.edgeCount(), edgeCount);
+      QVERIFY(ordersEveryEdge(topology, receivers));
+      QVERIFY(!topology.hasCycle());
+      for (int query = 0; query < 200; ++query) {
+         const int fromId = random.bounded(nodeCount) + 1;
+         const int toId = random.bounded(nodeCount) + 1;
+         QCOMPARE(topology.reaches(fromId, toId), reachesByPath(receivers, fromId, toId));
+      }
+   }
+}
+
+void TextureGraphTopologyTest::connectsDeepLattices() {
+   // Every node reads two nodes of the prior layer, so the number of paths doubles per layer.
+   constexpr int width = 4;
+   constexpr int depth = 200;
+   TextureGraphTopology topology;
+   QHash<int, QSet<int>> receivers;
+   for (int id = 1; id <= width * depth; ++id) {
+      topology.addNode(id);
+   }
+   // Connecting the deepest layers first forces the order to be rearranged for each edge.
+   for (int layer = depth - 1; layer > 0; --layer) {
+      for (int index = 0; index < width; ++index) {
+         const int receiverId = latticeId(width, layer, index);
+         for (const int sourceIndex : {index, (index + 1) % width}) {
+            const int sourceId = latticeId(width, layer - 1, sourceIndex);
+            QVERIFY(topology.addEdge(sourceId, receiverId));
+            receivers[sourceId].insert(receiverId);
+         }
+      }
+   }
+   QCOMPARE(topology.edgeCount(), 2 * width * (depth - 1));
+   QVERIFY(ordersEveryEdge(topology, receivers));
+   QVERIFY(topology.reaches(latticeId(width, 0, 0), latticeId(width, depth - 1, 0)));
+   QVERIFY(!topology.addEdge(latticeId(width, depth - 1, 0), latticeId(width, 0, 0)));
+   QCOMPARE(topology.downstreamOrder({latticeId(width, 0, 0)}).size(),
+            1 + 2 + 3 + width * (depth - 3));
+}
+
+QTEST_GUILESS_MAIN(TextureGraphTopologyTest)
+#include "texturegraphtopology_test.moc"
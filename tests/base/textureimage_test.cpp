@@ -2,7 +2,9 @@
 #include "base/textureimage.h"
 #include <QColor>
 #include <QTest>
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <type_traits>
 
 /// @brief Verifies texture-image storage, ownership, and pixel conversion behavior.
@@ -12,6 +14,12 @@ class TextureImageTest : public QObject {
 private slots:
    /// @brief Verifies storage traits, dimensions, pixel layout, and QImage conversion.
    void storageAndPixelLayout();
+   /// @brief Verifies resampled copies have the new size and keep uniform colors.
+   void scalesToOtherSizes();
+   /// @brief Verifies mip levels average two by two blocks weighted by alpha.
+   void halvesForMipChains();
+   /// @brief Verifies odd sizes round up and keep their last row and column.
+   void halvesOddSizesWithoutDroppingEdges();
 };
 
 void TextureImageTest::storageAndPixelLayout() {
@@ -67,5 +75,67 @@ void TextureImageTest::storageAndPixelLayout() {
    QCOMPARE(moved.getSize(), QSize(3, 2));
 }
 
+void TextureImageTest::scalesToOtherSizes() {
+   const TextureImagePtr image = TextureImage::create(QSize(8, 6));
+   std::fill_n(image->data(), image->pixelCount(), TexturePixel(40, 80, 120, 255));
+
+   const TextureImagePtr smaller = image->scaled(QSize(4, 3));
+   QCOMPARE(smaller->getSize(), QSize(4, 3));
+   QCOMPARE(smaller->data()[0].toRGBA(), quint32(0x285078ff));
+   QCOMPARE(smaller->data()[smaller->pixelCount() - 1].toRGBA(), quint32(0x285078ff));
+
+   const TextureImagePtr copy = image->scaled(image->getSize());
+   QVERIFY(copy != image);
+   QVERIFY(std::equal(copy->data(), copy->data() + copy->pixelCount(), image->data(),
+                      [](const TexturePixel& left, const TexturePixel& right) {
+                         return left.toRGBA() == right.toRGBA();
+                      }));
+   QVERIFY_EXCEPTION_THROWN(image->scaled(QSize(0, 3)), std::invalid_argument);
+}
+
+void TextureImageTest::halvesForMipChains() {
+   const TextureImagePtr image = TextureImage::create(QSize(5, 2));
+   const TexturePixel red(255, 0, 0, 255);
+   const TexturePixel clearBlue(0, 0, 255, 0);
+   const TexturePixel opaque(0, 100, 200, 255);
+   const TexturePixel pixels[] = {red,       clearBlue, opaque, opaque, clearBlue,
+                                  clearBlue, red,       opaque, opaque, clearBlue};
+   std::copy(std::begin(pixels), std::end(pixels), image->data());
+
+   const TextureImagePtr level = image->halved();
+   QCOMPARE(level->getSize(), QSize(3, 1));
+   QCOMPARE(level->data()[0].toRGBA(), quint32(0xff000080));
+   QCOMPARE(level->data()[1].toRGBA(), quint32(0x0064c8ff));
+   QCOMPARE(level->data()[2].toRGBA(), quint32(0x0000ff00));
+   QCOMPARE(level->halved()->getSize(), QSize(2, 1));
+   const TextureImagePtr last = level->halved()->halved();
+   QCOMPARE(last->getSize(), QSize(1, 1));
+   QCOMPARE(last->halved()->getSize(), QSize(1, 1));
+
+   const TextureImagePtr transparent = TextureImage::create(QSize(2, 2));
+   std::fill_n(transparent->data(), transparent->pixelCount(), TexturePixel(10, 20, 30, 0));
+   QCOMPARE(transparent->halved()->data()[0].toRGBA(), quint32(0x0a141e00));
+}
+
+void TextureImageTest::halvesOddSizesWithoutDroppingEdges() {
+   // A 3x3 image whose last column is green and whose last row is blue.
+   const TextureImagePtr image = TextureImage::create(QSize(3, 3));
+   const TexturePixel red(200, 0, 0, 255);
+   const TexturePixel green(0, 200, 0, 255);
+   const TexturePixel blue(0, 0, 200, 255);
+   const TexturePixel pixels[] = {red, red, green, red, red, green, blue, blue, blue};
+   std::copy(std::begin(pixels), std::end(pixels), image->data());
+
+   const TextureImagePtr level = image->halved();
+   QCOMPARE(level->getSize(), QSize(2, 2));
+   QCOMPARE(level->data()[0].toRGBA(), quint32(0xc80000ff));
+   // Blocks past the edge repeat the last column or row instead of leaving it out.
+   QCOMPARE(level->data()[1].toRGBA(), quint32(0x00c800ff));
+   QCOMPARE(level->data()[2].toRGBA(), quint32(0x0000c8ff));
+   QCOMPARE(level->data()[3].toRGBA(), quint32(0x0000c8ff));
+
+   QCOMPARE(TextureImage::create(QSize(7, 1))->halved()->getSize(), QSize(4, 1));
+}
+
 QTEST_APPLESS_MAIN(TextureImageTest)
 #include "textureimage_test.moc"
@@ -0,0 +1,184 @@
+#include "base/textureimagebudget.h"
+#include "base/texturenode.h"
+#include "base/textureproject.h"
+#include "support/testgenerators.h"
+#include <QTest>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+/// @brief Image identity passed to an eviction handler.
+using Eviction = std::tuple<int, QSize, const TextureImage*>;
+
+}  // namespace
+
+/// @brief Verifies image memory accounting, eviction order, and pinning.
+class TextureImageBudgetTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies images of equal cost are evicted least recently used first.
+   void evictsLeastRecentlyUsed();
+   /// @brief Verifies cheap images are evicted before older expensive ones.
+   void prefersCheapImages();
+   /// @brief Verifies pinned images stay tracked until their pin is released.
+   void keepsPinnedImages();
+   /// @brief Verifies replaced images are not removed by their earlier owner.
+   void removesOnlyMatchingImages();
+   /// @brief Verifies project nodes drop evicted images and report usage.
+   void projectNodesFollowBudget();
+};
+
+void TextureImageBudgetTest::evictsLeastRecentlyUsed() {
+   const QSize size(8, 8);
+   const TextureImagePtr first = TextureImage::create(size);
+   const TextureImagePtr second = TextureImage::create(size);
+   const TextureImagePtr third = TextureImage::create(size);
+   const TextureImagePtr fourth = TextureImage::create(size);
+   std::vector<Eviction> evictions;
+   TextureImageBudget budget(
+       [&evictions](int id, QSize evictedSize, const TextureImage* image) {
+          evictions.emplace_back(id, evictedSize, image);
+       },
+       3 * first->byteSize());
+   budget.add(1, size, first, 5.0);
+   budget.add(2, size, second, 5.0);
+   budget.add(3, size, third, 5.0);
+   QVERIFY(evictions.empty());
+   budget.touch(1, size);
+   budget.add(4, size, fourth, 5.0);
+   QCOMPARE(evictions.size(), std::size_t(1));
+   QCOMPARE(evictions.front(), Eviction(2, size, second.data()));
+
+   budget.touch(3, size);
+   budget.add(5, size, second, 5.0);
+   QCOMPARE(evictions.size(), std::size_t(2));
+   QCOMPARE(evictions.back(), Eviction(1, size, first.data()));
+
+   const TextureImageBudget::Statistics statistics = budget.getStatistics();
+   QCOMPARE(statistics.imageCount, std::size_t(3));
+   QCOMPARE(statistics.usedBytes, 3 * first->byteSize());
+   QCOMPARE(statistics.evictions, quint64(2));
+   QCOMPARE(statistics.evictedBytes, quint64(2 * first->byteSize()));
+}
+
+void TextureImageBudgetTest::prefersCheapImages() {
+   const QSize size(16, 16);
+   const TextureImagePtr expensive = TextureImage::create(size);
+   const TextureImagePtr cheap = TextureImage::create(size);
+   const TextureImagePtr medium = TextureImage::create(size);
+   std::vector<Eviction> evictions;
+   TextureImageBudget budget(
+       [&evictions](int id, QSize evictedSize, const TextureImage* image) {
+          evictions.emplace_back(id, evictedSize, image);
+       },
+       2 * expensive->byteSize());
+   budget.add(1, size, expensive, 100.0);
+   budget.add(2, size, cheap, 1.0);
+   budget.add(3, size, medium, 50.0);
+   QCOMPARE(evictions.size(), std::size_t(1));
+   QCOMPARE(std::get<0>(evictions.front()), 2);
+
+   // Large images free more memory per eviction, so they go before small ones of equal cost.
+   const TextureImagePtr large = TextureImage::create(QSize(32, 32));
+   budget.setBudget(budget.getStatistics().usedBytes + large->byteSize());
+   budget.add(4, QSize(32, 32), large, 50.0);
+   budget.add(5, QSize(4, 4), TextureImage::create(QSize(4, 4)), 50.0);
+   QCOMPARE(evictions.size(), std::size_t(2));
+   QCOMPARE(evictions.back(), Eviction(4, QSize(32, 32), large.data()));
+}
+
+void TextureImageBudgetTest::keepsPinnedImages() {
+   const QSize size(8, 8);
+   const TextureImagePtr pinned = TextureImage::create(size);
+   const TextureImagePtr unpinned = TextureImage::create(size);
+   std::vector<Eviction> evictions;
+   TextureImageBudget budget(
+       [&evictions](int id, QSize evictedSize, const TextureImage* image) {
+          evictions.emplace_back(id, evictedSize, image);
+       },
+       pinned->byteSize());
+   budget.pin(1, size);
+   budget.pin(1, size);
+   QVERIFY(budget.isPinned(1, size));
+   budget.add(1, size, pinned, 0.0);
+   budget.add(2, size, unpinned, 1000.0);
+   QCOMPARE(evictions.size(), std::size_t(1));
+   QCOMPARE(std::get<0>(evictions.front()), 2);
+
+   budget.setBudget(0);
+   TextureImageBudget::Statistics statistics = budget.getStatistics();
+   QCOMPARE(statistics.imageCount, std::size_t(1));
+   QCOMPARE(statistics.pinnedBytes, pinned->byteSize());
+   QCOMPARE(statistics.usedBytes, pinned->byteSize());
+
+   budget.unpin(1, size);
+   QVERIFY(budget.isPinned(1, size));
+   QCOMPARE(evictions.size(), std::size_t(1));
+   budget.unpin(1, size);
+   QVERIFY(!budget.isPinned(1, size));
+   QCOMPARE(evictions.size(), std::size_t(2));
+   QCOMPARE(evictions.back(), Eviction(1, size, pinned.data()));
+   statistics = budget.getStatistics();
+   QCOMPARE(statistics.imageCount, std::size_t(0));
+   QCOMPARE(statistics.usedBytes, std::size_t(0));
+}
+
+void TextureImageBudgetTest::removesOnlyMatchingImages() {
+   const QSize size(8, 8);
+   const TextureImagePtr original = TextureImage::create(size);
+   const TextureImagePtr replacement = TextureImage::create(size);
+   TextureImageBudget budget(nullptr);
+   budget.add(1, size, original, 1.0);
+   budget.add(1, size, replacement, 1.0);
+   QCOMPARE(budget.getStatistics().usedBytes, replacement->byteSize());
+   budget.remove(1, size, original.data());
+   QCOMPARE(budget.getStatistics().imageCount, std::size_t(1));
+   budget.remove(1, size, replacement.data());
+   QCOMPARE(budget.getStatistics().imageCount, std::size_t(0));
+   QCOMPARE(budget.getStatistics().usedBytes, std::size_t(0));
+}
+
+void TextureImageBudgetTest::projectNodesFollowBudget() {
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   const TextureGeneratorPtr generator(new RecordingGenerator());
+   const TextureNodePtr first = project.newNode(1, generator);
+   const TextureNodePtr second = project.newNode(2, generator);
+   const TextureNodePtr third = project.newNode(3, generator);
+   const QSize size(32, 32);
+   const std::size_t imageBytes = TextureImage::create(size)->byteSize();
+   TextureImageBudget& budget = project.getImageBudget();
+   budget.setBudget(2 * imageBytes);
+   budget.pin(1, size);
+   budget.pin(3, size);
+
+   QVERIFY(!first->renderImage(size).isNull());
+   QVERIFY(!second->renderImage(size).isNull());
+   QVERIFY(!third->renderImage(size).isNull());
+   QVERIFY(!first->cachedImage(size).isNull());
+   QVERIFY(second->cachedImage(size).isNull());
+   QVERIFY(!third->cachedImage(size).isNull());
+   TextureImageBudget::Statistics statistics = budget.getStatistics();
+   QCOMPARE(statistics.imageCount, std::size_t(2));
+   QCOMPARE(statistics.usedBytes, 2 * imageBytes);
+   QCOMPARE(statistics.pinnedBytes, 2 * imageBytes);
+   QCOMPARE(statistics.evictions, quint64(1));
+
+   QVERIFY(!second->renderImage(size).isNull());
+   QVERIFY(second->cachedImage(size).isNull());
+   QCOMPARE(budget.getStatistics().evictions, quint64(2));
+   budget.unpin(3, size);
+   QVERIFY(!third->cachedImage(size).isNull());
+
+   first->setUpdated();
+   QVERIFY(first->cachedImage(size).isNull());
+   QCOMPARE(budget.getStatistics().usedBytes, imageBytes);
+   project.removeNode(3);
+   QCOMPARE(budget.getStatistics().usedBytes, std::size_t(0));
+   budget.unpin(1, size);
+}
+
+QTEST_GUILESS_MAIN(TextureImageBudgetTest)
+#include "textureimagebudget_test.moc"
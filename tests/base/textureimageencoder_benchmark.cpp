@@ -0,0 +1,127 @@
+#include "base/textureimage.h"
+#include "base/textureimageencoder.h"
+#include <QBuffer>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImageWriter>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QtGlobal>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+namespace {
+
+constexpr int imageSize = 2048;
+constexpr int iterations = 3;
+
+/// @brief Fills an image with smooth gradients, noise, and flat areas like a generated texture.
+void fillPattern(TextureImage& image) {
+   const QSize size = image.getSize();
+   quint32 noise = 2463534242U;
+   for (int y = 0; y < size.height(); ++y) {
+      for (int x = 0; x < size.width(); ++x) {
+         noise ^= noise << 13U;
+         noise ^= noise >> 17U;
+         noise ^= noise << 5U;
+         const double wave = std::sin(x * 0.01) * std::cos(y * 0.013);
+         const auto shade = static_cast<quint8>(127.0 + 100.0 * wave + (noise & 15U));
+         const auto alpha = static_cast<quint8>(255 - y / 16);
+         image.data()[y * size.width() + x] =
+             y < size.height() / 4 ? TexturePixel(200, 180, 40, 255)
+                                   : TexturePixel(shade, static_cast<quint8>(shade / 2 + x / 16),
+                                                  static_cast<quint8>(255 - shade), alpha);
+      }
+   }
+}
+
+/// @brief Prints the encode time and output size of one case as a JSON line.
+void printCase(const QString& name, const int compressionLevel, const int threads,
+               const qsizetype bytes, const qint64 wallNanoseconds) {
+   const double megapixels = static_cast<double>(imageSize) * imageSize * iterations / 1e6;
+   const double seconds = static_cast<double>(qMax<qint64>(wallNanoseconds, 1)) / 1e9;
+   QJsonObject result{
+       {QStringLiteral("case"), name},
+       {QStringLiteral("width"), imageSize},
+       {QStringLiteral("height"), imageSize},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("compressionLevel"), compressionLevel},
+       {QStringLiteral("threads"), threads},
+       {QStringLiteral("iterations"), iterations},
+       {QStringLiteral("bytes"), bytes},
+       {QStringLiteral("ratio"),
+        static_cast<double>(bytes) / (static_cast<double>(imageSize) * imageSize * 4.0)},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("megapixelsPerSecond"), megapixels / seconds}};
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+/// @brief Times an encode function that writes into a memory buffer and prints the result.
+void runCase(const QString& name, const int compressionLevel, const int threads,
+             const std::function<bool(QBuffer&)>& encode) {
+   QByteArray bytes;
+   QElapsedTimer timer;
+   timer.start();
+   for (int iteration = 0; iteration < iterations; ++iteration) {
+      bytes.clear();
+      QBuffer buffer(&bytes);
+      buffer.open(QIODevice::WriteOnly);
+      if (!encode(buffer)) {
+         qFatal("Encoding %s failed", qPrintable(name));
+      }
+   }
+   printCase(name, compressionLevel, threads, bytes.size(), timer.nsecsElapsed());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+   QCoreApplication application(argc, argv);
+   TextureImage image(QSize(imageSize, imageSize), TextureImage::Initialization::Uninitialized);
+   fillPattern(image);
+   const int cores = static_cast<int>(qMax(1U, std::thread::hardware_concurrency()));
+
+   // The encode the exporter used before: an owning QImage copy written by Qt at quality 100.
+   runCase(QStringLiteral("qt-png-copy"), 0, 1, [&image](QBuffer& buffer) {
+      QImageWriter writer(&buffer, "png");
+      writer.setQuality(100);
+      return writer.write(image.toQImageCopy());
+   });
+
+   QList<int> threadCounts{1};
+   if (cores > 1) {
+      threadCounts.append(cores);
+   }
+   for (const int level : {0, 1, 6, 9}) {
+      for (const int threads : threadCounts) {
+         TextureEncodeOptions options;
+         options.compressionLevel = level;
+         options.threadCount = threads;
+         runCase(QStringLiteral("png"), level, threads, [&image, options](QBuffer& buffer) {
+            return TextureImageEncoder::encode(image, buffer, options);
+         });
+      }
+   }
+   for (const TextureFileFormat format :
+        {TextureFileFormat::Tga, TextureFileFormat::Dds, TextureFileFormat::Raw,
+         TextureFileFormat::Qoi}) {
+      TextureEncodeOptions options;
+      options.format = format;
+      runCase(TextureImageEncoder::formatName(format), 0, 1, [&image, options](QBuffer& buffer) {
+         return TextureImageEncoder::encode(image, buffer, options);
+      });
+   }
+   return 0;
+}
@@ -0,0 +1,234 @@
+#include "base/textureimage.h"
+#include "base/textureimageencoder.h"
+#include <QBuffer>
+#include <QByteArray>
+#include <QImage>
+#include <QTest>
+#include <array>
+#include <cstring>
+
+namespace {
+
+/// @brief Creates an image with gradients, flat areas, repeated colours, and varying alpha.
+TextureImage patternImage(const QSize size) {
+   TextureImage image(size);
+   for (int y = 0; y < size.height(); ++y) {
+      for (int x = 0; x < size.width(); ++x) {
+         const bool flat = x < size.width() / 4;
+         image.data()[y * size.width() + x] =
+             flat ? TexturePixel(10, 20, 30, 255)
+                  : TexturePixel(static_cast<quint8>(x * 3 + y), static_cast<quint8>(x / 7 * 20),
+                                 static_cast<quint8>(y % 5 == 0 ? 255 : x ^ y),
+                                 static_cast<quint8>(x % 3 == 0 ? 255 : x * y));
+      }
+   }
+   return image;
+}
+
+/// @brief Encodes an image into memory.
+QByteArray encoded(const TextureImage& image, const TextureEncodeOptions& options) {
+   QByteArray bytes;
+   QBuffer buffer(&bytes);
+   buffer.open(QIODevice::WriteOnly);
+   QString error;
+   if (!TextureImageEncoder::encode(image, buffer, options, &error)) {
+      qWarning("%s", qPrintable(error));
+      return {};
+   }
+   return bytes;
+}
+
+/// @brief Returns the raw RGBA bytes of an image.
+QByteArray pixelBytes(const TextureImage& image) {
+   return QByteArray(reinterpret_cast<const char*>(image.data()),
+                     static_cast<qsizetype>(image.byteSize()));
+}
+
+/// @brief Reads a big-endian 32-bit value.
+quint32 bigEndian32(const QByteArray& bytes, const qsizetype offset) {
+   quint32 value = 0;
+   for (qsizetype i = 0; i < 4; ++i) {
+      value = value << 8U | static_cast<quint8>(bytes.at(offset + i));
+   }
+   return value;
+}
+
+/// @brief Decodes a QOI file into RGBA bytes, or returns an empty array when it is malformed.
+QByteArray decodeQoi(const QByteArray& bytes, QSize& size) {
+   if (!bytes.startsWith("qoif") || bytes.size() < 22) {
+      return {};
+   }
+   size = QSize(static_cast<int>(bigEndian32(bytes, 4)), static_cast<int>(bigEndian32(bytes, 8)));
+   std::array<std::array<quint8, 4>, 64> seen{};
+   std::array<quint8, 4> pixel{0, 0, 0, 255};
+   QByteArray pixels;
+   qsizetype position = 14;
+   int run = 0;
+   const auto next = [&bytes, &position]() { return static_cast<quint8>(bytes.at(position++)); };
+   for (qint64 index = 0; index < static_cast<qint64>(size.width()) * size.height(); ++index) {
+      if (run > 0) {
+         --run;
+      } else {
+         const quint8 tag = next();
+         if (tag == 0xFE) {
+            pixel = {next(), next(), next(), pixel[3]};
+         } else if (tag == 0xFF) {
+            pixel = {next(), next(), next(), next()};
+         } else if (tag >> 6U == 0) {
+            pixel = seen[tag];
+         } else if (tag >> 6U == 1) {
+            pixel[0] = static_cast<quint8>(pixel[0] + ((tag >> 4U) & 3U) - 2);
+            pixel[1] = static_cast<quint8>(pixel[1] + ((tag >> 2U) & 3U) - 2);
+            pixel[2] = static_cast<quint8>(pixel[2] + (tag & 3U) - 2);
+         } else if (tag >> 6U == 2) {
+            const int green = (tag & 63) - 32;
+            const quint8 second = next();
+            pixel[0] = static_cast<quint8>(pixel[0] + green - 8 + (second >> 4U));
+            pixel[1] = static_cast<quint8>(pixel[1] + green);
+            pixel[2] = static_cast<quint8>(pixel[2] + green - 8 + (second & 15U));
+         } else {
+            run = tag & 63;
+         }
+         seen[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64] = pixel;
+      }
+      pixels.append(reinterpret_cast<const char*>(pixel.data()), 4);
+   }
+   if (bytes.mid(position) != QByteArray("\0\0\0\0\0\0\0\1", 8)) {
+      return {};
+   }
+   return pixels;
+}
+
+}  // namespace
+
+/// @brief Verifies images are encoded correctly in every supported file format.
+class TextureImageEncoderTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies file suffixes select the matching format.
+   void selectsFormatFromSuffix();
+   /// @brief Verifies PNG files decode to the exact pixels at every level and thread count.
+   void encodesPng();
+   /// @brief Verifies more compression gives smaller PNG files.
+   void compressesPngByLevel();
+   /// @brief Verifies TGA, DDS, and raw files contain the expected headers and pixels.
+   void writesUncompressedFormats();
+   /// @brief Verifies QOI files decode to the exact pixels.
+   void encodesQoi();
+};
+
+void TextureImageEncoderTest::selectsFormatFromSuffix() {
+   QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("a/b.PNG")) == TextureFileFormat::Png);
+   QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("b.tga")) == TextureFileFormat::Tga);
+   QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("b.dds")) == TextureFileFormat::Dds);
+   QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("b.raw")) == TextureFileFormat::Raw);
+   QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("b.rgba")) == TextureFileFormat::Raw);
+   QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("b.qoi")) == TextureFileFormat::Qoi);
+   QVERIFY(!TextureImageEncoder::formatForPath(QStringLiteral("b.jpg")));
+   QVERIFY(!TextureImageEncoder::formatForPath(QStringLiteral("png")));
+   for (const QString& suffix : TextureImageEncoder::fileSuffixes()) {
+      QVERIFY(TextureImageEncoder::formatForPath(QStringLiteral("image.") + suffix));
+   }
+}
+
+void TextureImageEncoderTest::encodesPng() {
+   // Tall enough to be split into several bands that are deflated separately.
+   const TextureImage image = patternImage(QSize(257, 600));
+   for (const int level : {0, 1, 6, 9}) {
+      for (const int threads : {1, 4}) {
+         TextureEncodeOptions options;
+         options.compressionLevel = level;
+         options.threadCount = threads;
+         const QByteArray bytes = encoded(image, options);
+         QImage decoded;
+         QVERIFY(decoded.loadFromData(bytes, "png"));
+         decoded = decoded.convertToFormat(QImage::Format_RGBA8888);
+         QCOMPARE(decoded.size(), image.getSize());
+         for (int y = 0; y < decoded.height(); ++y) {
+            QVERIFY2(std::memcmp(decoded.constScanLine(y), image.data() + y * 257, 257 * 4) == 0,
+                     qPrintable(QStringLiteral("level %1, %2 threads, row %3")
+                                    .arg(level)
+                                    .arg(threads)
+                                    .arg(y)));
+         }
+      }
+   }
+   QImage single;
+   QVERIFY(single.loadFromData(encoded(patternImage(QSize(1, 1)), {}), "png"));
+   QCOMPARE(single.size(), QSize(1, 1));
+}
+
+void TextureImageEncoderTest::compressesPngByLevel() {
+   const TextureImage image = patternImage(QSize(256, 256));
+   TextureEncodeOptions stored;
+   stored.compressionLevel = 0;
+   TextureEncodeOptions smallest;
+   smallest.compressionLevel = 9;
+   const qsizetype storedSize = encoded(image, stored).size();
+   const qsizetype defaultSize = encoded(image, {}).size();
+   const qsizetype smallestSize = encoded(image, smallest).size();
+   QVERIFY(storedSize > static_cast<qsizetype>(image.byteSize()));
+   QVERIFY(defaultSize < storedSize);
+   QVERIFY(smallestSize <= defaultSize);
+
+   // Splitting the data between threads must not cost much compression.
+   TextureEncodeOptions threaded;
+   threaded.threadCount = 8;
+   TextureEncodeOptions serial;
+   serial.threadCount = 1;
+   QVERIFY(encoded(image, threaded).size() <= encoded(image, serial).size() * 102 / 100);
+}
+
+void TextureImageEncoderTest::writesUncompressedFormats() {
+   const TextureImage image = patternImage(QSize(5, 3));
+   const QByteArray pixels = pixelBytes(image);
+
+   TextureEncodeOptions options;
+   options.format = TextureFileFormat::Raw;
+   QCOMPARE(encoded(image, options), pixels);
+
+   options.format = TextureFileFormat::Dds;
+   const QByteArray dds = encoded(image, options);
+   QVERIFY(dds.startsWith("DDS "));
+   QCOMPARE(dds.size(), 128 + pixels.size());
+   QCOMPARE(dds.mid(128), pixels);
+   QCOMPARE(static_cast<quint8>(dds.at(12)), quint8(3));
+   QCOMPARE(static_cast<quint8>(dds.at(16)), quint8(5));
+
+   options.format = TextureFileFormat::Tga;
+   const QByteArray tga = encoded(image, options);
+   QCOMPARE(tga.size(), 18 + pixels.size() + 26);
+   QCOMPARE(static_cast<quint8>(tga.at(2)), quint8(2));
+   QCOMPARE(static_cast<quint8>(tga.at(12)), quint8(5));
+   QCOMPARE(static_cast<quint8>(tga.at(14)), quint8(3));
+   QCOMPARE(static_cast<quint8>(tga.at(16)), quint8(32));
+   QCOMPARE(static_cast<quint8>(tga.at(17)), quint8(0x28));
+   for (qsizetype i = 0; i < pixels.size(); i += 4) {
+      QCOMPARE(tga.at(18 + i), pixels.at(i + 2));
+      QCOMPARE(tga.at(18 + i + 1), pixels.at(i + 1));
+      QCOMPARE(tga.at(18 + i + 2), pixels.at(i));
+      QCOMPARE(tga.at(18 + i + 3), pixels.at(i + 3));
+   }
+   QVERIFY(tga.endsWith(QByteArray("TRUEVISION-XFILE.\0", 18)));
+}
+
+void TextureImageEncoderTest::encodesQoi() {
+   TextureEncodeOptions options;
+   options.format = TextureFileFormat::Qoi;
+   for (const QSize size : {QSize(1, 1), QSize(100, 70), QSize(300, 2)}) {
+      const TextureImage image = patternImage(size);
+      const QByteArray bytes = encoded(image, options);
+      QSize decodedSize;
+      const QByteArray decoded = decodeQoi(bytes, decodedSize);
+      QCOMPARE(decodedSize, size);
+      QCOMPARE(decoded, pixelBytes(image));
+   }
+   // Long runs of one colour take one byte per 62 pixels.
+   TextureImage flat(QSize(620, 1));
+   std::fill(flat.data(), flat.data() + flat.pixelCount(), TexturePixel(0, 0, 0, 255));
+   QCOMPARE(encoded(flat, options).size(), qsizetype(14 + 10 + 8));
+}
+
+QTEST_GUILESS_MAIN(TextureImageEncoderTest)
+#include "textureimageencoder_test.moc"
@@ -0,0 +1,206 @@
+#include "base/textureimagepool.h"
+#include "base/texturerendermanager.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QtGlobal>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr int layerCount = 4;
+constexpr int nodesPerLayer = 16;
+constexpr int renderCount = 20;
+constexpr int imageCount = 200;
+
+/// @brief Cheap generator that overwrites every pixel, so buffer allocation dominates its cost.
+/// @details Each pixel only depends on the same pixel of the input, so it may render in place.
+class FillGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      const TextureImagePtr source = sources.value(QStringLiteral("Image"));
+      const auto seed = static_cast<unsigned char>(settings.value(QStringLiteral("seed")).toInt());
+      const qsizetype count = static_cast<qsizetype>(size.width()) * size.height();
+      for (qsizetype i = 0; i < count; ++i) {
+         const auto value =
+             static_cast<unsigned char>(source.isNull() ? seed : source->data()[i].r ^ seed);
+         destination[i] = TexturePixel(value, value, value, 255);
+      }
+   }
+   bool writesEveryPixel() const override { return true; }
+   QString getInPlaceSlot() const override { return QStringLiteral("Image"); }
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Filter; }
+   QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
+   QString getName() const override { return QStringLiteral("Fill"); }
+   QString getDescription() const override { return QStringLiteral("Benchmark generator"); }
+
+private:
+   TextureGeneratorSettings schema;
+};
+
+/// @brief Builds layered chains in which every node reads the node above it.
+/// @param keepIntermediates Whether nodes above the last layer hand out their images; when they
+/// do not, every chain renders in one buffer.
+TextureGraphSnapshot chainGraph(const TextureGeneratorPtr& generator, const QSize size,
+                                const bool keepIntermediates) {
+   TextureGraphSnapshot graph{size, {}};
+   for (int layer = 0; layer < layerCount; ++layer) {
+      for (int index = 0; index < nodesPerLayer; ++index) {
+         const int id = layer * nodesPerLayer + index + 1;
+         QMap<QString, int> sources;
+         if (layer > 0) {
+            sources.insert(QStringLiteral("Image"), id - nodesPerLayer);
+         }
+         TextureNodeSettings settings{{QStringLiteral("seed"), id}};
+         graph.nodes.push_back(TextureNodeSnapshot{id, 1, generator, settings, sources, {}});
+         graph.nodes.back().keepImage = keepIntermediates || layer + 1 == layerCount;
+      }
+   }
+   return graph;
+}
+
+/// @brief Waits until every buffer handed out by the pool has been released.
+void waitForReleasedImages() {
+   for (int attempt = 0; attempt < 1000; ++attempt) {
+      if (TextureImagePool::instance().getStatistics().liveBuffers == 0) {
+         return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+}
+
+/// @brief Renders the graph repeatedly, as a slider drag does, and returns the wall time.
+/// @param keepIntermediates Whether every node hands out its image, or only the sinks.
+/// @param statistics Receives the image memory of the render pass with the largest peak.
+qint64 runRenders(const TextureGeneratorPtr& generator, const QSize size,
+                  const bool keepIntermediates, TextureRenderPassStatistics& statistics) {
+   std::mutex mutex;
+   std::condition_variable condition;
+   int finished = 0;
+   bool failed = false;
+   TextureRenderManager manager(
+       [&](TextureRenderResult) {
+          std::lock_guard lock(mutex);
+          ++finished;
+          condition.notify_all();
+       },
+       [&](TextureRenderFailure failure) {
+          QTextStream(stderr) << failure.message << Qt::endl;
+          std::lock_guard lock(mutex);
+          failed = true;
+          condition.notify_all();
+       });
+   manager.setPassObserver([&](const TextureRenderPassStatistics& pass) {
+      std::lock_guard lock(mutex);
+      if (pass.peakImageBytes >= statistics.peakImageBytes) {
+         statistics = pass;
+      }
+   });
+   const TextureGraphSnapshot graph = chainGraph(generator, size, keepIntermediates);
+   const int results = keepIntermediates ? layerCount * nodesPerLayer : nodesPerLayer;
+   QElapsedTimer timer;
+   timer.start();
+   for (int render = 1; render <= renderCount; ++render) {
+      manager.render(graph);
+      std::unique_lock lock(mutex);
+      condition.wait_for(lock, std::chrono::minutes(5), [&] {
+         return failed || finished == render * results;
+      });
+      if (failed) {
+         return -1;
+      }
+      lock.unlock();
+      waitForReleasedImages();
+   }
+   return timer.nsecsElapsed();
+}
+
+/// @brief Creates and releases images one at a time and returns the wall time.
+qint64 runImages(const QSize size, const TextureImage::Initialization initialization) {
+   QElapsedTimer timer;
+   timer.start();
+   for (int index = 0; index < imageCount; ++index) {
+      const TextureImagePtr image = TextureImage::create(size, initialization);
+      image->data()[index % image->pixelCount()] = TexturePixel(1, 2, 3, 4);
+   }
+   return timer.nsecsElapsed();
+}
+
+void printCase(const QString& name, const QSize size, const bool pooled, const int iterations,
+               const qint64 wallNanoseconds, const QJsonObject& details = {}) {
+   const TextureImagePool::Statistics statistics = TextureImagePool::instance().getStatistics();
+   QJsonObject result{
+       {QStringLiteral("case"), name},
+       {QStringLiteral("width"), size.width()},
+       {QStringLiteral("height"), size.height()},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("pooled"), pooled},
+       {QStringLiteral("iterations"), iterations},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("heapAllocations"), static_cast<qint64>(statistics.heapAllocations)},
+       {QStringLiteral("reuses"), static_cast<qint64>(statistics.reuses)},
+       {QStringLiteral("heapFrees"), static_cast<qint64>(statistics.heapFrees)},
+       {QStringLiteral("heapAllocationsPerIteration"),
+        static_cast<double>(statistics.heapAllocations) / iterations}};
+   for (auto detail = details.constBegin(); detail != details.constEnd(); ++detail) {
+      result.insert(detail.key(), detail.value());
+   }
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+   QCoreApplication application(argc, argv);
+   TextureImagePool& pool = TextureImagePool::instance();
+   const TextureGeneratorPtr generator(new FillGenerator);
+   const QList<int> sizes{256, 1024};
+   for (const int size : sizes) {
+      const QSize imageSize(size, size);
+      for (const bool pooled : {false, true}) {
+         pool.trim();
+         pool.setRetainedBudget(pooled ? TextureImagePool::DefaultRetainedBudget : 0);
+         for (const bool keepIntermediates : {true, false}) {
+            pool.trim();
+            pool.resetStatistics();
+            TextureRenderPassStatistics statistics;
+            const qint64 wallNanoseconds =
+                runRenders(generator, imageSize, keepIntermediates, statistics);
+            const QJsonObject memory{
+                {QStringLiteral("peakImageBytes"),
+                 static_cast<qint64>(statistics.peakImageBytes)},
+                {QStringLiteral("totalImageBytes"),
+                 static_cast<qint64>(statistics.totalImageBytes)}};
+            printCase(keepIntermediates ? QStringLiteral("render-chain-64")
+                                        : QStringLiteral("render-chain-64-in-place"),
+                      imageSize, pooled, renderCount, wallNanoseconds, memory);
+         }
+
+         pool.trim();
+         pool.resetStatistics();
+         printCase(QStringLiteral("create-zeroed"), imageSize, pooled, imageCount,
+                   runImages(imageSize, TextureImage::Initialization::Zeroed));
+         pool.trim();
+         pool.resetStatistics();
+         printCase(QStringLiteral("create-uninitialized"), imageSize, pooled, imageCount,
+                   runImages(imageSize, TextureImage::Initialization::Uninitialized));
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,105 @@
+#include "base/textureimage.h"
+#include "base/textureimagepool.h"
+#include <QTest>
+#include <cstdint>
+#include <cstring>
+
+/// @brief Verifies buffer reuse, size buckets, the retained budget, and image initialization.
+class TextureImagePoolTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies released buffers are handed out again for the same pixel count only.
+   void reusesBuffersOfTheSameSize();
+   /// @brief Verifies the least recently used sizes are freed once the budget is exceeded.
+   void respectsRetainedBudget();
+   /// @brief Verifies images return their buffers and zero recycled pixels unless told not to.
+   void imagesRecycleBuffers();
+};
+
+void TextureImagePoolTest::reusesBuffersOfTheSameSize() {
+   TextureImagePool pool;
+   TexturePixel* const first = pool.acquire(64);
+   QCOMPARE(reinterpret_cast<std::uintptr_t>(first) % TextureImagePool::BufferAlignment,
+            std::uintptr_t(0));
+   pool.release(first, 64);
+   TexturePixel* const other = pool.acquire(32);
+   QVERIFY(other != first);
+   QCOMPARE(pool.acquire(64), first);
+
+   TextureImagePool::Statistics statistics = pool.getStatistics();
+   QCOMPARE(statistics.heapAllocations, quint64(2));
+   QCOMPARE(statistics.reuses, quint64(1));
+   QCOMPARE(statistics.liveBuffers, std::size_t(2));
+   QCOMPARE(statistics.retainedBuffers, std::size_t(0));
+
+   pool.release(first, 64);
+   pool.release(other, 32);
+   statistics = pool.getStatistics();
+   QCOMPARE(statistics.releases, quint64(3));
+   QCOMPARE(statistics.liveBuffers, std::size_t(0));
+   QCOMPARE(statistics.retainedBuffers, std::size_t(2));
+   QCOMPARE(statistics.retainedBytes, 96 * sizeof(TexturePixel));
+
+   pool.resetStatistics();
+   pool.trim();
+   statistics = pool.getStatistics();
+   QCOMPARE(statistics.heapFrees, quint64(2));
+   QCOMPARE(statistics.retainedBytes, std::size_t(0));
+}
+
+void TextureImagePoolTest::respectsRetainedBudget() {
+   TextureImagePool pool(100 * sizeof(TexturePixel));
+   TexturePixel* const small = pool.acquire(40);
+   TexturePixel* const large = pool.acquire(50);
+   TexturePixel* const newest = pool.acquire(40);
+   pool.release(small, 40);
+   pool.release(large, 50);
+   QCOMPARE(pool.getStatistics().retainedBytes, 90 * sizeof(TexturePixel));
+   pool.release(newest, 40);
+   TextureImagePool::Statistics statistics = pool.getStatistics();
+   QCOMPARE(statistics.heapFrees, quint64(1));
+   QCOMPARE(statistics.retainedBuffers, std::size_t(2));
+   QCOMPARE(statistics.retainedBytes, 80 * sizeof(TexturePixel));
+
+   pool.setRetainedBudget(0);
+   statistics = pool.getStatistics();
+   QCOMPARE(statistics.heapFrees, quint64(3));
+   QCOMPARE(statistics.retainedBuffers, std::size_t(0));
+   TexturePixel* const unpooled = pool.acquire(40);
+   pool.release(unpooled, 40);
+   QCOMPARE(pool.getStatistics().heapAllocations, quint64(4));
+   QCOMPARE(pool.getStatistics().retainedBuffers, std::size_t(0));
+}
+
+void TextureImagePoolTest::imagesRecycleBuffers() {
+   TextureImagePool& pool = TextureImagePool::instance();
+   pool.trim();
+   const QSize size(7, 5);
+   const TexturePixel* pixels = nullptr;
+   {
+      const TextureImagePtr image = TextureImage::create(size);
+      pixels = image->data();
+      std::memset(static_cast<void*>(image->data()), 0xab, image->byteSize());
+   }
+   QCOMPARE(pool.getStatistics().retainedBuffers, std::size_t(1));
+
+   const TextureImagePtr zeroed = TextureImage::create(size);
+   QCOMPARE(static_cast<const TexturePixel*>(zeroed->data()), pixels);
+   for (std::size_t i = 0; i < zeroed->pixelCount(); ++i) {
+      QCOMPARE(zeroed->data()[i].toRGBA(), quint32(0));
+   }
+
+   std::memset(static_cast<void*>(zeroed->data()), 0xcd, zeroed->byteSize());
+   TextureImage moved(std::move(*zeroed));
+   QCOMPARE(zeroed->pixelCount(), std::size_t(0));
+   QVERIFY(zeroed->data() == nullptr);
+   moved = TextureImage(QSize(1, 1));
+   const TextureImagePtr uninitialized =
+       TextureImage::create(size, TextureImage::Initialization::Uninitialized);
+   QCOMPARE(static_cast<const TexturePixel*>(uninitialized->data()), pixels);
+   QCOMPARE(uninitialized->data()[0].toRGBA(), quint32(0xcdcdcdcd));
+}
+
+QTEST_APPLESS_MAIN(TextureImagePoolTest)
+#include "textureimagepool_test.moc"
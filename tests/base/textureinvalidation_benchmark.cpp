@@ -0,0 +1,155 @@
+#include "base/texturenode.h"
+#include "base/textureproject.h"
+#include "base/texturerendercoalescer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QtGlobal>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int latticeWidth = 4;
+constexpr int iterations = 20;
+
+/// @brief Generator with two inputs that leaves its output untouched, so renders cost nothing.
+class PassGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      Q_UNUSED(size);
+      Q_UNUSED(destination);
+      Q_UNUSED(sources);
+      Q_UNUSED(settings);
+   }
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Combiner; }
+   QStringList getSourceSlots() const override {
+      return {QStringLiteral("First"), QStringLiteral("Second")};
+   }
+   QString getName() const override { return QStringLiteral("Pass"); }
+   QString getDescription() const override { return QStringLiteral("Benchmark generator"); }
+
+private:
+   TextureGeneratorSettings schema;
+};
+
+/// @brief Returns the ID of a lattice node.
+int latticeId(const int layer, const int index) { return layer * latticeWidth + index + 1; }
+
+/// @brief Builds a lattice of diamonds: every node reads two neighbouring nodes of the prior layer.
+void buildLattice(TextureProject& project, const TextureGeneratorPtr& generator, const int depth) {
+   TextureProject::InvalidationBatch batch(project);
+   for (int layer = 0; layer < depth; ++layer) {
+      for (int index = 0; index < latticeWidth; ++index) {
+         const TextureNodePtr node = project.newNode(latticeId(layer, index), generator);
+         if (layer > 0) {
+            node->setSourceSlot(QStringLiteral("First"), latticeId(layer - 1, index));
+            node->setSourceSlot(QStringLiteral("Second"),
+                                latticeId(layer - 1, (index + 1) % latticeWidth));
+         }
+      }
+   }
+}
+
+/// @brief Counts the invalidations a recursive fan-out without a visited set performs.
+/// @details Such a traversal invalidates every node once per path from the edited nodes.
+double recursiveInvalidations(const int depth, const int firstLayer, const int editedNodes) {
+   std::vector<double> paths(latticeWidth, 0.0);
+   for (int index = 0; index < editedNodes; ++index) {
+      paths[index] = 1.0;
+   }
+   double total = editedNodes;
+   for (int layer = firstLayer + 1; layer < depth; ++layer) {
+      std::vector<double> next(latticeWidth, 0.0);
+      for (int index = 0; index < latticeWidth; ++index) {
+         next[index] = paths[index] + paths[(index + 1) % latticeWidth];
+         total += next[index];
+      }
+      paths = std::move(next);
+   }
+   return total;
+}
+
+/// @brief Prints the cost of one invalidation case as a JSON line.
+void printCase(const QString& name, const int depth, const qint64 wallNanoseconds,
+               const qsizetype invalidatedNodes, const double notifications,
+               const double renderRequests, const double recursive) {
+   QJsonObject result{
+       {QStringLiteral("case"), name},
+       {QStringLiteral("depth"), depth},
+       {QStringLiteral("width"), latticeWidth},
+       {QStringLiteral("nodes"), depth * latticeWidth},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("iterations"), iterations},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("wallNsPerEdit"), static_cast<double>(wallNanoseconds) / iterations},
+       {QStringLiteral("invalidatedNodes"), invalidatedNodes},
+       {QStringLiteral("notificationsPerEdit"), notifications},
+       {QStringLiteral("renderRequestsPerEdit"), renderRequests},
+       {QStringLiteral("recursiveInvalidations"), recursive}};
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+/// @brief Times repeated edits of a lattice and prints the result.
+/// @param firstLayer Layer whose nodes are edited.
+/// @param editedNodes Number of nodes of the layer edited together in one batch.
+void runCase(const QString& name, const int depth, const int firstLayer, const int editedNodes) {
+   TextureProject project(true);
+   project.setRenderCache(nullptr);
+   const TextureGeneratorPtr generator(new PassGenerator);
+   project.addGenerator(generator);
+   buildLattice(project, generator, depth);
+
+   qsizetype notifications = 0;
+   qsizetype invalidatedNodes = 0;
+   QObject::connect(&project, &TextureProject::imagesUpdated,
+                    [&notifications, &invalidatedNodes](const QList<int>& ids) {
+                       ++notifications;
+                       invalidatedNodes = ids.size();
+                    });
+   const std::uint64_t requests = project.getRenderCoalescer().getStatistics().requestCount;
+   QElapsedTimer timer;
+   timer.start();
+   for (int iteration = 0; iteration < iterations; ++iteration) {
+      TextureProject::InvalidationBatch batch(project);
+      for (int index = 0; index < editedNodes; ++index) {
+         const TextureNodePtr node = project.getNode(latticeId(firstLayer, index));
+         TextureNodeSettings settings = node->getSettings();
+         settings[QStringLiteral("seed")] = iteration + 1;
+         node->setSettings(settings);
+      }
+   }
+   const qint64 wallNanoseconds = timer.nsecsElapsed();
+   const double renderRequests =
+       static_cast<double>(project.getRenderCoalescer().getStatistics().requestCount - requests) /
+       iterations;
+   printCase(name, depth, wallNanoseconds, invalidatedNodes,
+             static_cast<double>(notifications) / iterations, renderRequests,
+             recursiveInvalidations(depth, firstLayer, editedNodes));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+   QCoreApplication application(argc, argv);
+   for (const int depth : {16, 64, 256}) {
+      runCase(QStringLiteral("root-edit"), depth, 0, 1);
+      runCase(QStringLiteral("layer-batch"), depth, depth / 2, latticeWidth);
+   }
+   return 0;
+}
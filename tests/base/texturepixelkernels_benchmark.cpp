@@ -0,0 +1,141 @@
+#include "base/texturepixelkernels.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QVector>
+#include <QtGlobal>
+#include <cstddef>
+#include <functional>
+
+namespace {
+
+constexpr int imageSize = 1024;
+constexpr int iterations = 50;
+
+using Kernel = std::function<void(TexturePixel*, const TexturePixel*, const TexturePixel*,
+                                  std::size_t)>;
+
+/// @brief Fills an image with a deterministic pattern of colours and alpha values.
+QVector<TexturePixel> patternImage(const int seed) {
+   QVector<TexturePixel> pixels(imageSize * imageSize);
+   for (qsizetype i = 0; i < pixels.size(); ++i) {
+      const auto value = static_cast<quint32>(i * 2654435761U + static_cast<quint32>(seed));
+      pixels[i] =
+          TexturePixel(static_cast<quint8>(value), static_cast<quint8>(value >> 8U),
+                       static_cast<quint8>(value >> 16U), static_cast<quint8>(value >> 24U));
+   }
+   return pixels;
+}
+
+void printCase(const QString& name, const TexturePixelKernels::InstructionSet instructionSet,
+               const qint64 wallNanoseconds) {
+   const double megapixels = static_cast<double>(imageSize) * imageSize * iterations / 1e6;
+   const double seconds = static_cast<double>(qMax<qint64>(wallNanoseconds, 1)) / 1e9;
+   QJsonObject result{
+       {QStringLiteral("case"), name},
+       {QStringLiteral("width"), imageSize},
+       {QStringLiteral("height"), imageSize},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("instructionSet"),
+        QString::fromLatin1(TexturePixelKernels::instructionSetName(instructionSet))},
+       {QStringLiteral("iterations"), iterations},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("megapixelsPerSecond"), megapixels / seconds}};
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+   QCoreApplication application(argc, argv);
+   using TexturePixelKernels::ChannelSource;
+   using TexturePixelKernels::InstructionSet;
+
+   TexturePixelKernels::ChannelLookupTables tables;
+   for (int value = 0; value < 256; ++value) {
+      tables.red[value] = tables.green[value] = tables.blue[value] =
+          static_cast<quint8>(qMin(value * 3 / 2, 255));
+      tables.alpha[value] = static_cast<quint8>(value);
+   }
+   const QList<QPair<QString, Kernel>> kernels{
+       {QStringLiteral("add-saturated"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::addSaturated(destination, first, count); }},
+       {QStringLiteral("offset-saturated"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) {
+           TexturePixelKernels::offsetSaturated(destination, first, count,
+                                                TexturePixel(40, 40, 40, 0), TexturePixel());
+        }},
+       {QStringLiteral("multiply"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::multiply(destination, first, count); }},
+       {QStringLiteral("lerp"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel* second,
+           std::size_t count) {
+           TexturePixelKernels::lerp(destination, first, second, count, 100);
+        }},
+       {QStringLiteral("blend-over"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::blendOver(destination, first, count); }},
+       {QStringLiteral("invert"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) {
+           TexturePixelKernels::invert(destination, first, count, TexturePixel(255, 255, 255, 0));
+        }},
+       {QStringLiteral("swizzle"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel* second,
+           std::size_t count) {
+           TexturePixelKernels::swizzle(destination, first, second, count,
+                                        {ChannelSource::FirstBlue, ChannelSource::SecondGreen,
+                                         ChannelSource::FirstRed, ChannelSource::Full});
+        }},
+       {QStringLiteral("lookup"),
+        [&tables](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+                  std::size_t count) {
+           TexturePixelKernels::applyLookup(destination, first, count, tables);
+        }},
+       {QStringLiteral("luminance"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::luminance(destination, first, count); }},
+       {QStringLiteral("cut-alpha"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::cutAlpha(destination, first, count, 1); }},
+   };
+
+   const QVector<TexturePixel> first = patternImage(1);
+   const QVector<TexturePixel> second = patternImage(2);
+   const QVector<TexturePixel> initial = patternImage(3);
+   const auto count = static_cast<std::size_t>(initial.size());
+   for (const InstructionSet instructionSet :
+        {InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2}) {
+      if (!TexturePixelKernels::isSupported(instructionSet)) {
+         continue;
+      }
+      TexturePixelKernels::setActiveInstructionSet(instructionSet);
+      for (const QPair<QString, Kernel>& kernel : kernels) {
+         QVector<TexturePixel> destination = initial;
+         // One untimed pass detaches the shared copy and warms the caches.
+         kernel.second(destination.data(), first.constData(), second.constData(), count);
+         QElapsedTimer timer;
+         timer.start();
+         for (int iteration = 0; iteration < iterations; ++iteration) {
+            kernel.second(destination.data(), first.constData(), second.constData(), count);
+         }
+         printCase(kernel.first, instructionSet, timer.nsecsElapsed());
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,251 @@
+#include "base/texturepixelkernels.h"
+#include <QTest>
+#include <QVector>
+#include <cstddef>
+#include <functional>
+#include <random>
+
+namespace {
+
+using TexturePixelKernels::ChannelSource;
+using TexturePixelKernels::InstructionSet;
+
+/// @brief Lengths covering empty spans, vector tails, and several whole vectors.
+const std::size_t spanLengths[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100};
+
+/// @brief Creates pixels with random colours and a mix of transparent, opaque, and partial alpha.
+QVector<TexturePixel> randomPixels(std::mt19937& random, const std::size_t count) {
+   QVector<TexturePixel> pixels(static_cast<qsizetype>(count));
+   for (TexturePixel& pixel : pixels) {
+      const quint32 value = random();
+      const quint32 alphaKind = (value >> 24U) % 3;
+      const auto alpha = static_cast<quint8>(alphaKind == 0 ? 0 : alphaKind == 1 ? 255 : value);
+      pixel = TexturePixel(static_cast<quint8>(value), static_cast<quint8>(value >> 8U),
+                           static_cast<quint8>(value >> 16U), alpha);
+   }
+   return pixels;
+}
+
+/// @brief Runs a kernel over spans at an unaligned offset and returns every pixel afterwards.
+/// @param kernel Kernel writing to the first span and reading the other two.
+/// @param seed Seed shared by every instruction set, so all of them receive the same input.
+/// @param count Number of pixels passed to the kernel.
+QVector<TexturePixel> runKernel(
+    const std::function<void(TexturePixel*, const TexturePixel*, const TexturePixel*,
+                             std::size_t)>& kernel,
+    const unsigned seed, const std::size_t count) {
+   std::mt19937 random(seed);
+   QVector<TexturePixel> destination = randomPixels(random, count + 2);
+   const QVector<TexturePixel> first = randomPixels(random, count + 2);
+   const QVector<TexturePixel> second = randomPixels(random, count + 2);
+   kernel(destination.data() + 1, first.constData() + 1, second.constData() + 1, count);
+   return destination;
+}
+
+}  // namespace
+
+/// @brief Verifies the pixel kernels produce the same bytes on every instruction set.
+class TexturePixelKernelsTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Restores the default instruction set after each test.
+   void cleanup();
+   /// @brief Verifies the scalar kernels against per-pixel formulas.
+   void scalarKernelsMatchFormulas();
+   /// @brief Verifies every supported vector instruction set matches the scalar kernels.
+   void vectorKernelsMatchScalar();
+   /// @brief Verifies unsupported instruction sets fall back to supported ones.
+   void selectsSupportedInstructionSets();
+};
+
+void TexturePixelKernelsTest::cleanup() {
+   TexturePixelKernels::setActiveInstructionSet(TexturePixelKernels::bestInstructionSet());
+}
+
+void TexturePixelKernelsTest::scalarKernelsMatchFormulas() {
+   TexturePixelKernels::setActiveInstructionSet(InstructionSet::Scalar);
+   std::mt19937 random(11);
+   const QVector<TexturePixel> source = randomPixels(random, 64);
+   const QVector<TexturePixel> other = randomPixels(random, 64);
+   QVector<TexturePixel> result(source.size());
+   const auto count = static_cast<std::size_t>(source.size());
+
+   result = other;
+   TexturePixelKernels::multiply(result.data(), source.constData(), count);
+   for (qsizetype i = 0; i < source.size(); ++i) {
+      QCOMPARE(int(result[i].g), qRound(other[i].g * source[i].g / 255.0));
+   }
+
+   TexturePixelKernels::lerp(result.data(), source.constData(), other.constData(), count, 51);
+   for (qsizetype i = 0; i < source.size(); ++i) {
+      QCOMPARE(int(result[i].b), qRound((source[i].b * 204 + other[i].b * 51) / 255.0));
+   }
+
+   result = other;
+   TexturePixelKernels::blendOver(result.data(), source.constData(), count);
+   for (qsizetype i = 0; i < source.size(); ++i) {
+      const int alpha = source[i].a;
+      const int colour = other[i].r * (255 - alpha) + source[i].r * alpha;
+      QCOMPARE(int(result[i].r), qRound(colour / 255.0));
+      QCOMPARE(int(result[i].a), alpha + qRound(other[i].a * (255 - alpha) / 255.0));
+   }
+
+   TexturePixelKernels::luminance(result.data(), source.constData(), count);
+   for (qsizetype i = 0; i < source.size(); ++i) {
+      const auto grey = static_cast<quint8>(source[i].intensity() * 255);
+      QCOMPARE(result[i].toRGBA(), TexturePixel(grey, grey, grey, source[i].a).toRGBA());
+   }
+
+   TexturePixelKernels::swizzle(result.data(), source.constData(), nullptr, count,
+                                {ChannelSource::FirstAlpha, ChannelSource::SecondRed,
+                                 ChannelSource::Full, ChannelSource::FirstRed});
+   for (qsizetype i = 0; i < source.size(); ++i) {
+      QCOMPARE(result[i].toRGBA(), TexturePixel(source[i].a, 0, 255, source[i].r).toRGBA());
+   }
+
+   result = other;
+   TexturePixelKernels::cutAlpha(result.data(), source.constData(), count, 2);
+   for (qsizetype i = 0; i < source.size(); ++i) {
+      const int alpha = other[i].a;
+      const int cut = source[i].a;
+      QCOMPARE(int(result[i].a), alpha > 2 * cut ? alpha - cut : 0);
+      QCOMPARE(int(result[i].r), int(other[i].r));
+   }
+
+   const qint16 weights[] = {4096, 8192, 4096};
+   TexturePixelKernels::convolve(result.data(), source.constData(), count - 2, weights, 3);
+   for (qsizetype i = 0; i + 2 < source.size(); ++i) {
+      const int sum = source[i].a + 2 * source[i + 1].a + source[i + 2].a;
+      QCOMPARE(int(result[i].a), (sum * 4096 + 8192) >> 14);
+   }
+}
+
+void TexturePixelKernelsTest::vectorKernelsMatchScalar() {
+   using Kernel = std::function<void(TexturePixel*, const TexturePixel*, const TexturePixel*,
+                                     std::size_t)>;
+   TexturePixelKernels::ChannelLookupTables tables;
+   for (int value = 0; value < 256; ++value) {
+      tables.red[value] = static_cast<quint8>(255 - value);
+      tables.green[value] = static_cast<quint8>(value / 2);
+      tables.blue[value] = static_cast<quint8>(value * 3);
+      tables.alpha[value] = static_cast<quint8>(value);
+   }
+   const QList<QPair<QString, Kernel>> kernels{
+       {QStringLiteral("addSaturated"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::addSaturated(destination, first, count); }},
+       {QStringLiteral("offsetSaturated"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) {
+           TexturePixelKernels::offsetSaturated(destination, first, count,
+                                                TexturePixel(10, 0, 200, 255),
+                                                TexturePixel(0, 30, 100, 7));
+        }},
+       {QStringLiteral("multiply"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::multiply(destination, first, count); }},
+       {QStringLiteral("lerp"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel* second,
+           std::size_t count) {
+           TexturePixelKernels::lerp(destination, first, second, count, 77);
+        }},
+       {QStringLiteral("blendOver"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::blendOver(destination, first, count); }},
+       {QStringLiteral("invert"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) {
+           TexturePixelKernels::invert(destination, first, count, TexturePixel(255, 0, 255, 0));
+        }},
+       {QStringLiteral("swizzle"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel* second,
+           std::size_t count) {
+           TexturePixelKernels::swizzle(destination, first, second, count,
+                                        {ChannelSource::SecondBlue, ChannelSource::Zero,
+                                         ChannelSource::FirstGreen, ChannelSource::SecondAlpha});
+        }},
+       {QStringLiteral("swizzleInPlace"),
+        [](TexturePixel* destination, const TexturePixel*, const TexturePixel* second,
+           std::size_t count) {
+           TexturePixelKernels::swizzle(destination, destination, second, count,
+                                        {ChannelSource::FirstAlpha, ChannelSource::Full,
+                                         ChannelSource::SecondRed, ChannelSource::FirstBlue});
+        }},
+       {QStringLiteral("applyLookup"),
+        [&tables](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+                  std::size_t count) {
+           TexturePixelKernels::applyLookup(destination, first, count, tables);
+        }},
+       {QStringLiteral("luminance"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::luminance(destination, first, count); }},
+       {QStringLiteral("cutAlpha"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::cutAlpha(destination, first, count, 1); }},
+       {QStringLiteral("cutAlphaWrapping"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::cutAlpha(destination, first, count, 0); }},
+       {QStringLiteral("convolve"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) {
+           // Five taps read four pixels beyond the last output, which the spans provide.
+           const qint16 weights[] = {1000, 4000, 6384, 4000, 1000};
+           TexturePixelKernels::convolve(destination, first, count > 4 ? count - 4 : 0, weights,
+                                         5);
+        }},
+       {QStringLiteral("convolveEvenTaps"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) {
+           const qint16 weights[] = {16000, 0, 300, 84};
+           TexturePixelKernels::convolve(destination, first, count > 3 ? count - 3 : 0, weights,
+                                         4);
+        }},
+       {QStringLiteral("cutAlphaLargeFactor"),
+        [](TexturePixel* destination, const TexturePixel* first, const TexturePixel*,
+           std::size_t count) { TexturePixelKernels::cutAlpha(destination, first, count, 999); }},
+   };
+
+   for (const InstructionSet instructionSet : {InstructionSet::SSE2, InstructionSet::AVX2}) {
+      if (!TexturePixelKernels::isSupported(instructionSet)) {
+         continue;
+      }
+      for (const QPair<QString, Kernel>& kernel : kernels) {
+         for (const std::size_t count : spanLengths) {
+            const auto seed = static_cast<unsigned>(count * 31 + 7);
+            TexturePixelKernels::setActiveInstructionSet(InstructionSet::Scalar);
+            const QVector<TexturePixel> expected = runKernel(kernel.second, seed, count);
+            TexturePixelKernels::setActiveInstructionSet(instructionSet);
+            const QVector<TexturePixel> actual = runKernel(kernel.second, seed, count);
+            for (qsizetype i = 0; i < expected.size(); ++i) {
+               QVERIFY2(actual[i].toRGBA() == expected[i].toRGBA(),
+                        qPrintable(QStringLiteral("%1 on %2, %3 pixels, index %4")
+                                       .arg(kernel.first)
+                                       .arg(QString::fromLatin1(
+                                           TexturePixelKernels::instructionSetName(instructionSet)))
+                                       .arg(count)
+                                       .arg(i)));
+            }
+         }
+      }
+   }
+}
+
+void TexturePixelKernelsTest::selectsSupportedInstructionSets() {
+   QVERIFY(TexturePixelKernels::isSupported(InstructionSet::Scalar));
+   QVERIFY(TexturePixelKernels::activeInstructionSet() ==
+           TexturePixelKernels::bestInstructionSet());
+   for (const InstructionSet instructionSet :
+        {InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2}) {
+      TexturePixelKernels::setActiveInstructionSet(instructionSet);
+      const InstructionSet active = TexturePixelKernels::activeInstructionSet();
+      QVERIFY(TexturePixelKernels::isSupported(active));
+      QVERIFY(static_cast<int>(active) <= static_cast<int>(instructionSet));
+      if (TexturePixelKernels::isSupported(instructionSet)) {
+         QVERIFY(active == instructionSet);
+      }
+   }
+}
+
+QTEST_APPLESS_MAIN(TexturePixelKernelsTest)
+#include "texturepixelkernels_test.moc"
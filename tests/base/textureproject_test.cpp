@@ -1,10 +1,15 @@
 #include "base/projectfileservice.h"
 #include "base/texturenode.h"
 #include "base/textureproject.h"
+#include "base/texturerendercoalescer.h"
+#include "base/texturerendermanager.h"
 #include "support/testgenerators.h"
+#include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QTest>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <utility>
 
 namespace {
@@ -50,8 +55,17 @@ class TextureProjectTest : public QObject {
 private slots:
    /// @brief Verifies node identifiers, connections, disconnections, and removal.
    void maintainsGraphAndIds();
+   /// @brief Verifies large graphs with many reconvergent paths connect in order without cycles.
+   void connectsLargeGraphsWithoutCycles();
    /// @brief Verifies synchronous rendering caches and downstream invalidation.
    void cachesAndInvalidatesRenders();
+   /// @brief Verifies edits invalidate each downstream node once with one notification and render.
+   void batchesDownstreamInvalidation();
+   /// @brief Verifies thumbnail renders after an edit only copy the invalidated subgraph, also
+   /// after the number of render threads changes.
+   void rendersOnlyDirtyThumbnails();
+   /// @brief Verifies thumbnail renders offer low-resolution frames and end at the preview size.
+   void rendersProgressiveThumbnails();
    /// @brief Verifies clipboard-style copies and project saved-state tracking.
    void copiesAndTracksSavedState();
    /// @brief Verifies named render inputs are routed independently of alphabetical order.
@@ -89,6 +103,60 @@ void TextureProjectTest::maintainsGraphAndIds() {
    QCOMPARE(project.newNode(0, generator)->getId(), 1);
 }
 
+void TextureProjectTest::connectsLargeGraphsWithoutCycles() {
+   TextureProject project(false);
+   auto generator = TextureGeneratorPtr(new RecordingGenerator(QStringLiteral("Mix"), 2));
+   project.addGenerator(generator);
+   // Every node reads two nodes of the prior layer, so the number of paths doubles per layer.
+   constexpr int width = 4;
+   constexpr int depth = 200;
+   const auto nodeId = [](const int layer, const int index) { return layer * width + index + 1; };
+   {
+      TextureProject::InvalidationBatch batch(project);
+      for (int layer = 0; layer < depth; ++layer) {
+         for (int index = 0; index < width; ++index) {
+            project.newNode(nodeId(layer, index), generator);
+         }
+      }
+      for (int layer = depth - 1; layer > 0; --layer) {
+         for (int index = 0; index < width; ++index) {
+            const TextureNodePtr node = project.getNode(nodeId(layer, index));
+            QVERIFY(node->setSourceSlot(QStringLiteral("Input 1"), nodeId(layer - 1, index)));
+            QVERIFY(node->setSourceSlot(QStringLiteral("Input 2"),
+                                        nodeId(layer - 1, (index + 1) % width)));
+         }
+      }
+   }
+   QVERIFY(!project.findLoops());
+   QVERIFY(!project.getNode(1)->findLoop());
+   QVERIFY(project.reaches(1, nodeId(depth - 1, 0)));
+   QVERIFY(!project.reaches(nodeId(depth - 1, 0), 1));
+
+   const QList<int> order = project.getTopologicalOrder();
+   QCOMPARE(order.size(), width * depth);
+   for (const int id : order) {
+      for (const int sourceId : project.getNode(id)->getSources()) {
+         QVERIFY(sourceId == 0 || order.indexOf(sourceId) < order.indexOf(id));
+      }
+   }
+
+   const TextureNodePtr first = project.getNode(1);
+   QVERIFY(!first->setSourceSlot(QStringLiteral("Input 1"), nodeId(depth - 1, 2)));
+   QCOMPARE(first->getSources().value(QStringLiteral("Input 1")), 0);
+   QCOMPARE(project.getNode(nodeId(depth - 1, 2))->getNumReceivers(), 0);
+
+   // A rejected replacement keeps the previous source connected.
+   const TextureNodePtr second = project.getNode(nodeId(1, 0));
+   QVERIFY(!second->setSourceSlot(QStringLiteral("Input 1"), nodeId(3, 0)));
+   QCOMPARE(second->getSources().value(QStringLiteral("Input 1")), nodeId(0, 0));
+   QVERIFY(project.reaches(nodeId(0, 0), nodeId(1, 0)));
+
+   project.removeNode(nodeId(1, 0));
+   QVERIFY(!project.reaches(nodeId(0, 0), nodeId(2, 0)));
+   QVERIFY(project.getNode(nodeId(2, 0))->setSourceSlot(QStringLiteral("Input 1"), 0));
+   QVERIFY(!project.findLoops());
+}
+
 void TextureProjectTest::cachesAndInvalidatesRenders() {
    TextureProject project(false);
    auto* sourceGenerator = new RecordingGenerator(QStringLiteral("Source"), 0, 25);
@@ -117,6 +185,149 @@ void TextureProjectTest::cachesAndInvalidatesRenders() {
    QVERIFY(output->renderImage(size) != first);
 }
 
+void TextureProjectTest::batchesDownstreamInvalidation() {
+   TextureProject project(true);
+   project.setRenderCache(nullptr);
+   auto generator = TextureGeneratorPtr(new RecordingGenerator(QStringLiteral("Mix"), 2));
+   project.addGenerator(generator);
+   // 1 feeds 2 and 3, which both feed 4; 5 is unrelated.
+   for (int id = 1; id <= 5; ++id) {
+      project.newNode(id, generator);
+   }
+   QVERIFY(project.getNode(2)->setSourceSlot(QStringLiteral("Input 1"), 1));
+   QVERIFY(project.getNode(3)->setSourceSlot(QStringLiteral("Input 1"), 1));
+   QVERIFY(project.getNode(4)->setSourceSlot(QStringLiteral("Input 1"), 2));
+   QVERIFY(project.getNode(4)->setSourceSlot(QStringLiteral("Input 2"), 3));
+
+   QSignalSpy updates(&project, &TextureProject::imagesUpdated);
+   const TextureRenderCoalescer& coalescer = project.getRenderCoalescer();
+   std::uint64_t requests = coalescer.getStatistics().requestCount;
+   const auto setValue = [&project](const int id, const int value) {
+      TextureNodeSettings settings = project.getNode(id)->getSettings();
+      settings[QStringLiteral("value")] = value;
+      project.getNode(id)->setSettings(settings);
+   };
+   setValue(1, 40);
+   QCOMPARE(updates.count(), 1);
+   QList<int> order = updates.takeFirst().at(0).value<QList<int>>();
+   QCOMPARE(order.size(), 4);
+   QCOMPARE(order.first(), 1);
+   QCOMPARE(order.last(), 4);
+   QVERIFY(!order.contains(5));
+   QCOMPARE(coalescer.getStatistics().requestCount, requests + 1);
+
+   const QSize size(3, 2);
+   const TextureImagePtr unrelated = project.getNode(5)->renderImage(size);
+   QCOMPARE(project.getNode(4)->renderImage(size)->data()[0].r, static_cast<unsigned char>(17));
+   requests = coalescer.getStatistics().requestCount;
+   {
+      TextureProject::InvalidationBatch batch(project);
+      setValue(4, 60);
+      setValue(2, 50);
+      QVERIFY(project.getNode(4)->setSourceSlot(QStringLiteral("Input 2"), 0));
+      QCOMPARE(updates.count(), 0);
+   }
+   QCOMPARE(updates.count(), 1);
+   order = updates.takeFirst().at(0).value<QList<int>>();
+   QCOMPARE(order, QList<int>({2, 4}));
+   QCOMPARE(coalescer.getStatistics().requestCount, requests + 1);
+   QVERIFY(project.getNode(4)->cachedImage(size).isNull());
+   QVERIFY(!project.getNode(1)->cachedImage(size).isNull());
+   QCOMPARE(project.getNode(5)->cachedImage(size), unrelated);
+
+   requests = coalescer.getStatistics().requestCount;
+   project.removeNode(1);
+   QCOMPARE(updates.count(), 1);
+   order = updates.takeFirst().at(0).value<QList<int>>();
+   QCOMPARE(order.size(), 3);
+   QCOMPARE(order.last(), 4);
+   QCOMPARE(coalescer.getStatistics().requestCount, requests + 1);
+}
+
+void TextureProjectTest::rendersOnlyDirtyThumbnails() {
+   TextureProject project(true);
+   project.setRenderCache(nullptr);
+   auto* sourceGenerator = new RecordingGenerator(QStringLiteral("Source"), 0, 25);
+   auto* filterGenerator = new RecordingGenerator(QStringLiteral("Filter"), 1, 50);
+   auto* otherGenerator = new RecordingGenerator(QStringLiteral("Other"), 0, 5);
+   project.addGenerator(TextureGeneratorPtr(sourceGenerator));
+   project.addGenerator(TextureGeneratorPtr(filterGenerator));
+   project.addGenerator(TextureGeneratorPtr(otherGenerator));
+   const TextureNodePtr source = project.newNode(1, project.getGenerator(QStringLiteral("Source")));
+   const TextureNodePtr output = project.newNode(2, project.getGenerator(QStringLiteral("Filter")));
+   QVERIFY(output->setSourceSlot(QStringLiteral("Image"), source->getId()));
+   for (int id = 3; id <= 12; ++id) {
+      project.newNode(id, project.getGenerator(QStringLiteral("Other")));
+   }
+
+   const QSize size = project.getThumbnailSize();
+   const auto allThumbnailsCached = [&project, size]() {
+      const QList<int> ids = project.getNodeIds();
+      return std::all_of(ids.cbegin(), ids.cend(), [&project, size](const int id) {
+         return !project.getNode(id)->cachedImage(size).isNull();
+      });
+   };
+   QTRY_VERIFY_WITH_TIMEOUT(allThumbnailsCached(), 5000);
+   QVERIFY(project.createDirtyGraphSnapshot(size).nodes.empty());
+   const int sourceCalls = sourceGenerator->callCount();
+   const int otherCalls = otherGenerator->callCount();
+
+   TextureNodeSettings settings = output->getSettings();
+   settings[QStringLiteral("value")] = 60;
+   output->setSettings(settings);
+   const TextureGraphSnapshot dirty = project.createDirtyGraphSnapshot(size);
+   QCOMPARE(dirty.nodes.size(), std::size_t{2});
+   const auto input = std::find_if(
+       dirty.nodes.cbegin(), dirty.nodes.cend(),
+       [&source](const TextureNodeSnapshot& node) { return node.nodeId == source->getId(); });
+   QVERIFY(input != dirty.nodes.cend());
+   QVERIFY(input->generator.isNull());
+   QCOMPARE(input->cachedImage, source->cachedImage(size));
+
+   QTRY_VERIFY_WITH_TIMEOUT(!output->cachedImage(size).isNull(), 5000);
+   QCOMPARE(output->cachedImage(size)->data()[0].r, static_cast<unsigned char>(60));
+   QCOMPARE(sourceGenerator->callCount(), sourceCalls);
+   QCOMPARE(otherGenerator->callCount(), otherCalls);
+   QVERIFY(project.createDirtyGraphSnapshot(size).nodes.empty());
+
+   // An edit rendered by a replaced, single-threaded render manager.
+   settings[QStringLiteral("value")] = 70;
+   output->setSettings(settings);
+   project.setRenderWorkerCount(1);
+   QCOMPARE(project.getRenderWorkerCount(), std::size_t{1});
+   QTRY_VERIFY_WITH_TIMEOUT(!output->cachedImage(size).isNull(), 5000);
+   QCOMPARE(output->cachedImage(size)->data()[0].r, static_cast<unsigned char>(70));
+   QCOMPARE(otherGenerator->callCount(), otherCalls);
+   QVERIFY(project.createDirtyGraphSnapshot(size).nodes.empty());
+}
+
+void TextureProjectTest::rendersProgressiveThumbnails() {
+   TextureProject project(true);
+   project.setRenderCache(nullptr);
+   project.setProgressiveScale(50);
+   project.setPreviewPassEnabled(true);
+   QSignalSpy frames(&project, &TextureProject::frameAvailable);
+   auto* sourceGenerator = new RecordingGenerator(QStringLiteral("Source"), 0, 25);
+   auto* filterGenerator = new RecordingGenerator(QStringLiteral("Filter"), 1, 50);
+   project.addGenerator(TextureGeneratorPtr(sourceGenerator));
+   project.addGenerator(TextureGeneratorPtr(filterGenerator));
+   const TextureNodePtr source = project.newNode(1, project.getGenerator(QStringLiteral("Source")));
+   const TextureNodePtr output = project.newNode(2, project.getGenerator(QStringLiteral("Filter")));
+   QVERIFY(output->setSourceSlot(QStringLiteral("Image"), source->getId()));
+   project.setPreviewNodes({output->getId()});
+
+   QTRY_VERIFY_WITH_TIMEOUT(!output->cachedImage(project.getPreviewSize()).isNull(), 5000);
+   QVERIFY(!output->cachedImage(project.getThumbnailSize()).isNull());
+   QVERIFY(!source->cachedImage(project.getThumbnailSize()).isNull());
+   const QSize lowResolution(project.getThumbnailSize() / 2);
+   const bool hasLowResolutionFrame =
+       std::any_of(frames.cbegin(), frames.cend(), [&lowResolution](const QList<QVariant>& frame) {
+          return frame.at(0).toInt() == 2 && frame.at(1).toSize() == lowResolution;
+       });
+   QVERIFY(hasLowResolutionFrame);
+   QVERIFY(output->cachedImage(lowResolution).isNull());
+}
+
 void TextureProjectTest::copiesAndTracksSavedState() {
    TextureProject project(false);
    auto generator = TextureGeneratorPtr(new RecordingGenerator(QStringLiteral("Clone")));
@@ -195,5 +406,5 @@ void TextureProjectTest::validatesAndSerializesSettingSchemas() {
    QCOMPARE(definitions.at(1).toElement().attribute(QStringLiteral("id")), QStringLiteral("alpha"));
 }
 
-QTEST_APPLESS_MAIN(TextureProjectTest)
+QTEST_GUILESS_MAIN(TextureProjectTest)
 #include "textureproject_test.moc"
@@ -0,0 +1,251 @@
+#include "base/texturenode.h"
+#include "base/textureproject.h"
+#include "base/texturerendercache.h"
+#include "base/texturerendermanager.h"
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace {
+
+/// @brief Cacheable generator that adds its input to its `value` setting and counts its calls.
+class CountingGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      ++calls;
+      int value = settings.value(QStringLiteral("value")).toInt();
+      const TextureImagePtr image = sources.value(QStringLiteral("Image"));
+      if (!image.isNull()) {
+         value += image->data()[0].r;
+      }
+      std::fill_n(destination, static_cast<qsizetype>(size.width()) * size.height(),
+                  TexturePixel(static_cast<unsigned char>(value), 0, 0, 255));
+   }
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Filter; }
+   QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
+   QString getName() const override { return QStringLiteral("Counting"); }
+   QString getDescription() const override { return QStringLiteral("Counting test generator"); }
+   QByteArray getCacheIdentity() const override { return QByteArrayLiteral("counting/1"); }
+
+   /// @brief Returns the total number of generation calls.
+   int callCount() const { return calls; }
+
+private:
+   TextureGeneratorSettings schema;
+   mutable std::atomic_int calls = 0;
+};
+
+/// @brief Creates an image whose first pixel stores a marker value.
+TextureImagePtr markedImage(const QSize size, const int marker) {
+   TextureImagePtr image = TextureImage::create(size);
+   image->data()[0] = TexturePixel(static_cast<unsigned char>(marker), 0, 0, 255);
+   return image;
+}
+
+/// @brief Creates node settings holding one value.
+TextureNodeSettings valueSettings(const int value) {
+   return TextureNodeSettings{{QStringLiteral("value"), value}};
+}
+
+}  // namespace
+
+/// @brief Verifies content keys, memory and disk tiers, and sharing between nodes.
+class TextureRenderCacheTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies keys change with settings, size, and sources, and reject uncacheable inputs.
+   void keysDescribeContent();
+   /// @brief Verifies the least recently used image is evicted first.
+   void evictsLeastRecentlyUsed();
+   /// @brief Verifies images written in the background by one cache are read back by another.
+   void restoresImagesFromDisk();
+   /// @brief Verifies duplicate nodes and restored settings reuse earlier renders.
+   void sharesRendersBetweenNodesAndRevisions();
+   /// @brief Verifies background renders complete cached nodes without calling the generator.
+   void skipsCachedNodesInBackgroundRenders();
+   /// @brief Verifies the low-resolution frames of progressive renders are not cached.
+   void keepsProgressiveFramesOutOfTheCache();
+};
+
+void TextureRenderCacheTest::keysDescribeContent() {
+   const CountingGenerator generator;
+   const QSize size(4, 4);
+   const QByteArray key = TextureRenderCache::makeKey(generator, valueSettings(1), size, {});
+   QVERIFY(!key.isEmpty());
+   QCOMPARE(TextureRenderCache::makeKey(generator, valueSettings(1), size, {}), key);
+   QVERIFY(TextureRenderCache::makeKey(generator, valueSettings(2), size, {}) != key);
+   QVERIFY(TextureRenderCache::makeKey(generator, valueSettings(1), QSize(4, 5), {}) != key);
+   QVERIFY(TextureRenderCache::makeKey(generator, valueSettings(1), size,
+                                       {{QStringLiteral("Image"), key}}) != key);
+   QVERIFY(TextureRenderCache::makeKey(generator, valueSettings(1), size,
+                                       {{QStringLiteral("Image"), QByteArray()}})
+               .isEmpty());
+   QCOMPARE(TextureRenderCache::makeKey(generator, {{QStringLiteral("value"), 1.5}}, size, {}),
+            TextureRenderCache::makeKey(generator, {{QStringLiteral("value"), 1.5}}, size, {}));
+}
+
+void TextureRenderCacheTest::evictsLeastRecentlyUsed() {
+   const QSize size(4, 4);
+   const std::size_t imageBytes = TextureImage::create(size)->byteSize();
+   TextureRenderCache cache(3 * imageBytes);
+   cache.insert(QByteArrayLiteral("first"), markedImage(size, 1));
+   cache.insert(QByteArrayLiteral("second"), markedImage(size, 2));
+   cache.insert(QByteArrayLiteral("third"), markedImage(size, 3));
+   QVERIFY(!cache.find(QByteArrayLiteral("first")).isNull());
+   cache.insert(QByteArrayLiteral("fourth"), markedImage(size, 4));
+
+   QVERIFY(cache.find(QByteArrayLiteral("second")).isNull());
+   QCOMPARE(cache.find(QByteArrayLiteral("first"))->data()[0].r, static_cast<unsigned char>(1));
+   TextureRenderCache::Statistics statistics = cache.getStatistics();
+   QCOMPARE(statistics.entryCount, std::size_t(3));
+   QCOMPARE(statistics.memoryBytes, 3 * imageBytes);
+   QCOMPARE(statistics.evictions, quint64(1));
+   QCOMPARE(statistics.insertions, quint64(4));
+
+   cache.setMemoryBudget(imageBytes);
+   statistics = cache.getStatistics();
+   QCOMPARE(statistics.entryCount, std::size_t(1));
+   QCOMPARE(statistics.evictions, quint64(3));
+}
+
+void TextureRenderCacheTest::restoresImagesFromDisk() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   const CountingGenerator generator;
+   const QSize size(5, 3);
+   const QByteArray key = TextureRenderCache::makeKey(generator, valueSettings(9), size, {});
+   {
+      TextureRenderCache writer;
+      QVERIFY(writer.setDiskDirectory(directory.path()));
+      writer.insert(key, markedImage(size, 9));
+      writer.waitForDiskWrites();
+      QCOMPARE(QDir(directory.path()).entryList(QDir::Files).size(), 1);
+   }
+
+   TextureRenderCache reader;
+   QVERIFY(reader.find(key).isNull());
+   QVERIFY(reader.setDiskDirectory(directory.path()));
+   const TextureImagePtr image = reader.find(key);
+   QVERIFY(!image.isNull());
+   QCOMPARE(image->getSize(), size);
+   QCOMPARE(image->data()[0].r, static_cast<unsigned char>(9));
+   QCOMPARE(reader.getStatistics().diskHits, quint64(1));
+   QCOMPARE(reader.find(key), image);
+   QCOMPARE(reader.getStatistics().memoryHits, quint64(1));
+
+   TextureRenderCache pruned;
+   QVERIFY(pruned.setDiskDirectory(directory.path(), 1));
+   QVERIFY(pruned.find(key).isNull());
+}
+
+void TextureRenderCacheTest::sharesRendersBetweenNodesAndRevisions() {
+   TextureRenderCache cache;
+   TextureProject project(false);
+   project.setRenderCache(&cache);
+   auto* generatorRaw = new CountingGenerator;
+   const TextureGeneratorPtr generator(generatorRaw);
+   const QSize size(6, 6);
+
+   const TextureNodePtr source = project.newNode(1, generator);
+   const TextureNodePtr first = project.newNode(2, generator);
+   const TextureNodePtr duplicate = project.newNode(3, generator);
+   source->setSettings(valueSettings(10));
+   first->setSettings(valueSettings(1));
+   duplicate->setSettings(valueSettings(1));
+   QVERIFY(first->setSourceSlot(QStringLiteral("Image"), 1));
+   QVERIFY(duplicate->setSourceSlot(QStringLiteral("Image"), 1));
+
+   QCOMPARE(first->renderImage(size)->data()[0].r, static_cast<unsigned char>(11));
+   QCOMPARE(generatorRaw->callCount(), 2);
+   QCOMPARE(duplicate->renderImage(size), first->renderImage(size));
+   QCOMPARE(generatorRaw->callCount(), 2);
+
+   first->setSettings(valueSettings(2));
+   QCOMPARE(first->renderImage(size)->data()[0].r, static_cast<unsigned char>(12));
+   QCOMPARE(generatorRaw->callCount(), 3);
+   first->setSettings(valueSettings(1));
+   QCOMPARE(first->renderImage(size)->data()[0].r, static_cast<unsigned char>(11));
+   QCOMPARE(generatorRaw->callCount(), 3);
+
+   project.setRenderCache(nullptr);
+   first->setSettings(valueSettings(2));
+   first->setSettings(valueSettings(1));
+   QCOMPARE(first->renderImage(size)->data()[0].r, static_cast<unsigned char>(11));
+   QCOMPARE(generatorRaw->callCount(), 4);
+}
+
+void TextureRenderCacheTest::skipsCachedNodesInBackgroundRenders() {
+   std::mutex mutex;
+   std::condition_variable condition;
+   int results = 0;
+   int failures = 0;
+   TextureRenderCache cache;
+   TextureRenderManager manager(
+       [&](TextureRenderResult) {
+          std::lock_guard lock(mutex);
+          ++results;
+          condition.notify_all();
+       },
+       [&](TextureRenderFailure) {
+          std::lock_guard lock(mutex);
+          ++failures;
+          condition.notify_all();
+       },
+       2);
+   manager.setRenderCache(&cache);
+   auto* generatorRaw = new CountingGenerator;
+   const TextureGeneratorPtr generator(generatorRaw);
+   const QSize size(8, 8);
+   const QByteArray rootKey = TextureRenderCache::makeKey(*generator, valueSettings(3), size, {});
+   const QByteArray receiverKey = TextureRenderCache::makeKey(
+       *generator, valueSettings(3), size, {{QStringLiteral("Image"), rootKey}});
+   const TextureGraphSnapshot graph{
+       size,
+       {TextureNodeSnapshot{1, 1, generator, valueSettings(3), {}, {}, rootKey},
+        TextureNodeSnapshot{
+            2, 1, generator, valueSettings(3), {{QStringLiteral("Image"), 1}}, {}, receiverKey}}};
+
+   const auto waitForResults = [&](const int count) {
+      std::unique_lock lock(mutex);
+      return condition.wait_for(lock, std::chrono::seconds(5),
+                                [&] { return results >= count || failures > 0; }) &&
+             failures == 0;
+   };
+   manager.render(graph);
+   QVERIFY(waitForResults(2));
+   QCOMPARE(generatorRaw->callCount(), 2);
+   manager.render(graph);
+   QVERIFY(waitForResults(4));
+   QCOMPARE(generatorRaw->callCount(), 2);
+   QCOMPARE(cache.find(receiverKey)->data()[0].r, static_cast<unsigned char>(6));
+}
+
+void TextureRenderCacheTest::keepsProgressiveFramesOutOfTheCache() {
+   TextureRenderCache cache;
+   TextureProject project(true);
+   project.setRenderCache(&cache);
+   project.setProgressiveScale(50);
+   const TextureGeneratorPtr generator(new CountingGenerator);
+   const TextureNodePtr node = project.newNode(1, generator);
+   node->setSettings(valueSettings(7));
+
+   const QSize thumbnailSize = project.getThumbnailSize();
+   QTRY_VERIFY_WITH_TIMEOUT(!node->cachedImage(thumbnailSize).isNull(), 5000);
+   QVERIFY(!cache.find(TextureRenderCache::makeKey(*generator, valueSettings(7), thumbnailSize, {}))
+                .isNull());
+   QVERIFY(cache.find(TextureRenderCache::makeKey(*generator, valueSettings(7), thumbnailSize / 2,
+                                                  {}))
+               .isNull());
+}
+
+QTEST_GUILESS_MAIN(TextureRenderCacheTest)
+#include "texturerendercache_test.moc"
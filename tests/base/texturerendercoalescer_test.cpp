@@ -0,0 +1,130 @@
+#include "base/texturerendercoalescer.h"
+#include <QTest>
+#include <cstdint>
+
+namespace {
+
+/// @brief Render callbacks whose results a test controls.
+struct RenderStub {
+   /// @brief Number of renders started.
+   std::uint64_t started = 0;
+   /// @brief Remaining time reported for the running render.
+   double remainingMilliseconds = 0.0;
+
+   /// @brief Creates a coalescer that starts renders through this stub.
+   TextureRenderCoalescer::StartRender startFunction() {
+      return [this]() { return ++started; };
+   }
+
+   /// @brief Creates an estimate function that reports the configured remaining time.
+   TextureRenderCoalescer::RemainingEstimate remainingFunction() {
+      return [this]() { return remainingMilliseconds; };
+   }
+};
+
+}  // namespace
+
+/// @brief Verifies render requests are merged, paced, and measured.
+class TextureRenderCoalescerTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies requests during a render start one follow-up render when it finishes.
+   void mergesRequestsWhileRendering();
+   /// @brief Verifies a long render is replaced once the latency budget runs out.
+   void replacesSlowRenderAfterBudget();
+   /// @brief Verifies a render that is nearly done gets extra time instead of being replaced.
+   void extendsNearlyFinishedRender();
+   /// @brief Verifies completions of replaced or cancelled renders are ignored.
+   void ignoresOutdatedCompletions();
+   /// @brief Verifies finished renders are reported as frame-time statistics.
+   void reportsFrameTimes();
+};
+
+void TextureRenderCoalescerTest::mergesRequestsWhileRendering() {
+   RenderStub stub;
+   TextureRenderCoalescer coalescer(stub.startFunction(), stub.remainingFunction());
+   coalescer.setLatencyBudget(1000);
+   coalescer.request();
+   QCOMPARE(stub.started, std::uint64_t{1});
+   QVERIFY(coalescer.isRendering());
+   coalescer.request();
+   coalescer.request();
+   coalescer.request();
+   QCOMPARE(stub.started, std::uint64_t{1});
+
+   coalescer.renderFinished(1);
+   QCOMPARE(stub.started, std::uint64_t{2});
+   coalescer.renderFinished(2);
+   QVERIFY(!coalescer.isRendering());
+   QCOMPARE(stub.started, std::uint64_t{2});
+   const TextureRenderCoalescer::Statistics statistics = coalescer.getStatistics();
+   QCOMPARE(statistics.requestCount, std::uint64_t{4});
+   QCOMPARE(statistics.renderCount, std::uint64_t{2});
+   QCOMPARE(statistics.coalescedRequestCount, std::uint64_t{2});
+   QCOMPARE(statistics.supersededRenderCount, std::uint64_t{0});
+}
+
+void TextureRenderCoalescerTest::replacesSlowRenderAfterBudget() {
+   RenderStub stub;
+   stub.remainingMilliseconds = 10000.0;
+   TextureRenderCoalescer coalescer(stub.startFunction(), stub.remainingFunction());
+   coalescer.setLatencyBudget(10);
+   coalescer.request();
+   coalescer.request();
+   QCOMPARE(stub.started, std::uint64_t{1});
+   QTRY_COMPARE_WITH_TIMEOUT(stub.started, std::uint64_t{2}, 5000);
+   QCOMPARE(coalescer.getStatistics().supersededRenderCount, std::uint64_t{1});
+   QCOMPARE(coalescer.getStatistics().extendedRenderCount, std::uint64_t{0});
+}
+
+void TextureRenderCoalescerTest::extendsNearlyFinishedRender() {
+   RenderStub stub;
+   stub.remainingMilliseconds = 5.0;
+   TextureRenderCoalescer coalescer(stub.startFunction(), stub.remainingFunction());
+   coalescer.setLatencyBudget(200);
+   coalescer.request();
+   coalescer.request();
+   QTRY_COMPARE_WITH_TIMEOUT(coalescer.getStatistics().extendedRenderCount, std::uint64_t{1},
+                             5000);
+   QCOMPARE(stub.started, std::uint64_t{1});
+   coalescer.renderFinished(1);
+   QCOMPARE(stub.started, std::uint64_t{2});
+   QCOMPARE(coalescer.getStatistics().supersededRenderCount, std::uint64_t{0});
+}
+
+void TextureRenderCoalescerTest::ignoresOutdatedCompletions() {
+   RenderStub stub;
+   TextureRenderCoalescer coalescer(stub.startFunction(), stub.remainingFunction());
+   coalescer.request();
+   coalescer.request();
+   coalescer.renderFinished(7);
+   QCOMPARE(stub.started, std::uint64_t{1});
+   QVERIFY(coalescer.isRendering());
+
+   coalescer.cancel();
+   QCOMPARE(stub.started, std::uint64_t{2});
+   coalescer.renderFinished(1);
+   QVERIFY(coalescer.isRendering());
+   QCOMPARE(coalescer.getStatistics().frameCount, std::uint64_t{0});
+}
+
+void TextureRenderCoalescerTest::reportsFrameTimes() {
+   RenderStub stub;
+   TextureRenderCoalescer coalescer(stub.startFunction(), stub.remainingFunction());
+   for (std::uint64_t frame = 1; frame <= 3; ++frame) {
+      coalescer.request();
+      QTest::qWait(5);
+      coalescer.renderFinished(frame);
+   }
+   const TextureRenderCoalescer::Statistics statistics = coalescer.getStatistics();
+   QCOMPARE(statistics.frameCount, std::uint64_t{3});
+   QVERIFY(statistics.lastFrameMilliseconds >= 4.0);
+   QVERIFY(statistics.averageFrameMilliseconds >= 4.0);
+   QVERIFY(statistics.maximumFrameMilliseconds >= statistics.averageFrameMilliseconds);
+   QVERIFY(statistics.averageFrameIntervalMilliseconds >= 4.0);
+   QVERIFY(statistics.averageLatencyMilliseconds >= statistics.averageFrameMilliseconds);
+}
+
+QTEST_GUILESS_MAIN(TextureRenderCoalescerTest)
+#include "texturerendercoalescer_test.moc"
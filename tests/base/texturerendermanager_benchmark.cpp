@@ -0,0 +1,193 @@
+#include "base/texturegraphtopology.h"
+#include "base/texturerendermanager.h"
+#include "base/texturerenderplan.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QtGlobal>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr int layerCount = 10;
+constexpr int nodesPerLayer = 50;
+constexpr int planIterations = 200;
+
+/// @brief CPU-bound generator that mixes up to two inputs with a few transcendental operations.
+class SyntheticGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      const int seed = settings.value(QStringLiteral("seed")).toInt();
+      const TextureImagePtr first = sources.value(QStringLiteral("First"));
+      const TextureImagePtr second = sources.value(QStringLiteral("Second"));
+      const qsizetype count = static_cast<qsizetype>(size.width()) * size.height();
+      for (qsizetype i = 0; i < count; ++i) {
+         double value = std::sin(static_cast<double>(i + seed) * 0.001);
+         if (!first.isNull()) {
+            value += first->data()[i].intensity();
+         }
+         if (!second.isNull()) {
+            value += std::sqrt(second->data()[i].intensity());
+         }
+         const auto channel = static_cast<unsigned char>(std::fmod(std::abs(value) * 97.0, 255.0));
+         destination[i] = TexturePixel(channel, channel, channel, 255);
+      }
+   }
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Combiner; }
+   QStringList getSourceSlots() const override {
+      return {QStringLiteral("First"), QStringLiteral("Second")};
+   }
+   QString getName() const override { return QStringLiteral("Synthetic"); }
+   QString getDescription() const override { return QStringLiteral("Benchmark generator"); }
+
+private:
+   TextureGeneratorSettings schema;
+};
+
+/// @brief Builds a layered graph in which every non-root node reads two nodes of the prior layer.
+TextureGraphSnapshot layeredGraph(const TextureGeneratorPtr& generator, const QSize size) {
+   TextureGraphSnapshot graph{size, {}};
+   for (int layer = 0; layer < layerCount; ++layer) {
+      for (int index = 0; index < nodesPerLayer; ++index) {
+         const int id = layer * nodesPerLayer + index + 1;
+         QMap<QString, int> sources;
+         if (layer > 0) {
+            const int previous = (layer - 1) * nodesPerLayer + 1;
+            sources.insert(QStringLiteral("First"), previous + index);
+            sources.insert(QStringLiteral("Second"), previous + (index * 7 + 3) % nodesPerLayer);
+         }
+         TextureNodeSettings settings{{QStringLiteral("seed"), id}};
+         graph.nodes.push_back(TextureNodeSnapshot{id, 1, generator, settings, sources, {}});
+      }
+   }
+   return graph;
+}
+
+/// @brief Renders the layered graph once and returns the wall time in nanoseconds.
+qint64 runGraph(const TextureGeneratorPtr& generator, const QSize size,
+                const std::size_t workerCount) {
+   std::mutex mutex;
+   std::condition_variable condition;
+   int finished = 0;
+   bool failed = false;
+   TextureRenderManager manager(
+       [&](TextureRenderResult) {
+          std::lock_guard lock(mutex);
+          ++finished;
+          condition.notify_all();
+       },
+       [&](TextureRenderFailure failure) {
+          QTextStream(stderr) << failure.message << Qt::endl;
+          std::lock_guard lock(mutex);
+          failed = true;
+          condition.notify_all();
+       },
+       workerCount);
+   QElapsedTimer timer;
+   timer.start();
+   manager.render(layeredGraph(generator, size));
+   std::unique_lock lock(mutex);
+   condition.wait_for(lock, std::chrono::minutes(5),
+                      [&] { return failed || finished == layerCount * nodesPerLayer; });
+   return failed ? -1 : timer.nsecsElapsed();
+}
+
+void runCase(const QSize size, const std::size_t workerCount, const qint64 baselineNanoseconds,
+             const qint64 wallNanoseconds) {
+   QJsonObject result{
+       {QStringLiteral("case"), QStringLiteral("layered-500")},
+       {QStringLiteral("width"), size.width()},
+       {QStringLiteral("height"), size.height()},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("workerCount"), static_cast<qint64>(workerCount)},
+       {QStringLiteral("nodeCount"), layerCount * nodesPerLayer},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("speedup"), wallNanoseconds > 0 ? static_cast<double>(baselineNanoseconds) /
+                                                            static_cast<double>(wallNanoseconds)
+                                                      : 0.0}};
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+/// @brief Times compiling the render plan of the layered graph and prints the result.
+/// @param withProjectPlan Whether the snapshot carries the plan of the whole graph, as project
+/// snapshots do, or the plan is sorted from the snapshot alone.
+void runPlanCase(const TextureGeneratorPtr& generator, const bool withProjectPlan) {
+   TextureGraphSnapshot graph = layeredGraph(generator, QSize(1, 1));
+   if (withProjectPlan) {
+      TextureGraphTopology topology;
+      for (const TextureNodeSnapshot& node : graph.nodes) {
+         topology.addNode(node.nodeId);
+      }
+      for (const TextureNodeSnapshot& node : graph.nodes) {
+         for (const int sourceId : node.sources) {
+            topology.addEdge(sourceId, node.nodeId);
+         }
+      }
+      graph.plan = TextureRenderPlan::compile(topology);
+   }
+   QElapsedTimer timer;
+   timer.start();
+   std::size_t edgeCount = 0;
+   for (int iteration = 0; iteration < planIterations; ++iteration) {
+      edgeCount = TextureRenderPlan::compile(graph.nodes, graph.plan)->edgeCount();
+   }
+   const qint64 wallNanoseconds = timer.nsecsElapsed();
+   QJsonObject result{
+       {QStringLiteral("case"), withProjectPlan ? QStringLiteral("plan-reuse")
+                                                : QStringLiteral("plan-compile")},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("nodeCount"), layerCount * nodesPerLayer},
+       {QStringLiteral("edgeCount"), static_cast<qint64>(edgeCount)},
+       {QStringLiteral("iterations"), planIterations},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("wallNsPerRender"), static_cast<double>(wallNanoseconds) / planIterations}};
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+   QCoreApplication application(argc, argv);
+   const TextureGeneratorPtr generator(new SyntheticGenerator);
+   const std::size_t maximumWorkers = TextureRenderManager::defaultWorkerCount();
+   runPlanCase(generator, false);
+   runPlanCase(generator, true);
+   const QList<int> sizes{64, 128};
+   for (const int size : sizes) {
+      const QSize imageSize(size, size);
+      const qint64 baseline = runGraph(generator, imageSize, 1);
+      runCase(imageSize, 1, baseline, baseline);
+      for (std::size_t workers = 2; workers <= maximumWorkers; workers *= 2) {
+         runCase(imageSize, workers, baseline, runGraph(generator, imageSize, workers));
+      }
+      if ((maximumWorkers & (maximumWorkers - 1)) != 0) {
+         runCase(imageSize, maximumWorkers, baseline,
+                 runGraph(generator, imageSize, maximumWorkers));
+      }
+   }
+   return 0;
+}
@@ -1,15 +1,21 @@
+#include "base/textureexporter.h"
 #include "base/texturenode.h"
 #include "base/textureproject.h"
 #include "base/texturerendermanager.h"
 #include "support/testgenerators.h"
+#include <QSemaphore>
 #include <QSignalSpy>
 #include <QTest>
 #include <QThread>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -71,6 +77,149 @@ std::unique_ptr<TextureRenderManager> makeManager(CallbackState& state,
        workerCount);
 }
 
+/// @brief Writes a position-dependent pattern and records the threads that render its regions.
+class TiledGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      Q_UNUSED(sources);
+      Q_UNUSED(settings);
+      writePattern(size, QRect(QPoint(0, 0), size), destination);
+   }
+
+   void generateRegion(QSize size, int pass, QRect region, TexturePixel* destination,
+                       const QMap<QString, TextureImagePtr>& sources,
+                       const TextureNodeSettings& settings) const override {
+      Q_UNUSED(pass);
+      Q_UNUSED(sources);
+      Q_UNUSED(settings);
+      bool firstRegion = false;
+      {
+         std::lock_guard lock(mutex);
+         firstRegion = regionCount++ == 0;
+         threads.insert(std::this_thread::get_id());
+      }
+      // Holding the first region open gives idle workers time to claim the others.
+      if (firstRegion) {
+         otherRegionStarted.tryAcquire(1, 5000);
+      } else {
+         otherRegionStarted.release();
+      }
+      writePattern(size, region, destination);
+   }
+
+   bool supportsTiling() const override { return true; }
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Generator; }
+   QStringList getSourceSlots() const override { return {}; }
+   QString getName() const override { return QStringLiteral("Tiled"); }
+   QString getDescription() const override { return QStringLiteral("Tiled test generator"); }
+
+   /// @brief Returns the number of rendered regions.
+   int renderedRegionCount() const {
+      std::lock_guard lock(mutex);
+      return regionCount;
+   }
+
+   /// @brief Returns the number of distinct threads that rendered regions.
+   std::size_t threadCount() const {
+      std::lock_guard lock(mutex);
+      return threads.size();
+   }
+
+private:
+   static void writePattern(const QSize size, const QRect region, TexturePixel* destination) {
+      for (int y = region.top(); y <= region.bottom(); ++y) {
+         for (int x = region.left(); x <= region.right(); ++x) {
+            destination[y * size.width() + x] =
+                TexturePixel(static_cast<quint8>(x), static_cast<quint8>(y),
+                             static_cast<quint8>(x ^ y), 255);
+         }
+      }
+   }
+
+   TextureGeneratorSettings schema;
+   mutable std::mutex mutex;
+   mutable QSemaphore otherRegionStarted;
+   mutable int regionCount = 0;
+   mutable std::set<std::thread::id> threads;
+};
+
+/// @brief Sleeps before filling its output so that timing samples mark it as expensive.
+class SlowGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      Q_UNUSED(sources);
+      Q_UNUSED(settings);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      std::fill(destination, destination + size.width() * size.height(),
+                TexturePixel(0, 0, 0, 255));
+   }
+
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Generator; }
+   QStringList getSourceSlots() const override { return {}; }
+   QString getName() const override { return QStringLiteral("Slow"); }
+   QString getDescription() const override { return QStringLiteral("Slow test generator"); }
+
+private:
+   TextureGeneratorSettings schema;
+};
+
+/// @brief Adds the node's value to the red channel of its input, in place when it may.
+class BrightenGenerator final : public TextureGenerator {
+public:
+   void generate(QSize size, TexturePixel* destination,
+                 const QMap<QString, TextureImagePtr>& sources,
+                 const TextureNodeSettings& settings) const override {
+      const TexturePixel* source = sources.value(QStringLiteral("Image"))->getData();
+      if (source == destination) {
+         ++inPlaceCalls;
+      }
+      const int value = settings.value(QStringLiteral("value")).toInt();
+      const qsizetype count = static_cast<qsizetype>(size.width()) * size.height();
+      for (qsizetype i = 0; i < count; ++i) {
+         destination[i] = source[i];
+         destination[i].r = static_cast<quint8>(qMin(source[i].r + value, 255));
+      }
+   }
+
+   QString getPassThroughSlot(QSize size, const TextureNodeSettings& settings) const override {
+      Q_UNUSED(size);
+      return settings.value(QStringLiteral("value")).toInt() == 0 ? QStringLiteral("Image")
+                                                                   : QString();
+   }
+   QString getInPlaceSlot() const override { return QStringLiteral("Image"); }
+   const TextureGeneratorSettings& getSettings() const override { return schema; }
+   Type getType() const override { return Type::Filter; }
+   QStringList getSourceSlots() const override { return {QStringLiteral("Image")}; }
+   QString getName() const override { return QStringLiteral("Brighten"); }
+   QString getDescription() const override { return QStringLiteral("In-place test generator"); }
+
+   /// @brief Returns the number of calls that rendered over their input.
+   int inPlaceCallCount() const { return inPlaceCalls; }
+
+private:
+   TextureGeneratorSettings schema;
+   mutable std::atomic<int> inPlaceCalls{0};
+};
+
+/// @brief Renders a graph on one worker and returns the order in which its nodes started.
+/// @param graph Graph to render.
+/// @param order Receives the started node IDs.
+/// @return True when every node finished before the timeout.
+bool recordScheduleOrder(TextureGraphSnapshot graph, std::vector<int>& order) {
+   CallbackState state;
+   const std::size_t nodeCount = graph.nodes.size();
+   const auto manager = makeManager(state, 1);
+   manager->setScheduleObserver([&order](const int nodeId) { order.push_back(nodeId); });
+   manager->render(std::move(graph));
+   return state.waitFor(nodeCount);
+}
+
 }  // namespace
 
 /// @brief Verifies background graph scheduling, caching, cancellation, and publication.
@@ -92,6 +241,30 @@ private slots:
    void routesNamedInputs();
    /// @brief Verifies timing samples are thread-safe and capped at ten recent calls.
    void recordsRollingTimingAcrossThreads();
+   /// @brief Verifies the worker count is configurable beyond four and defaults to all threads.
+   void configuresWorkerCount();
+   /// @brief Verifies idle workers steal receivers unblocked on another worker's queue.
+   void stealsUnblockedReceivers();
+   /// @brief Verifies large images from tiling generators are split across workers.
+   void splitsLargeImagesIntoRegions();
+   /// @brief Verifies ready nodes heading the longest chain run before shorter branches.
+   void prioritizesLongestChain();
+   /// @brief Verifies measured generator durations outweigh the number of nodes in a chain.
+   void prioritizesMeasuredCost();
+   /// @brief Verifies exports render only the upstream graph, with branches running in parallel.
+   void exportsUpstreamGraphInParallel();
+   /// @brief Verifies the cancellation hook stops an export before its receivers render.
+   void cancelsExportFromHook();
+   /// @brief Verifies only renders that were not replaced report their completion.
+   void reportsCompletedRenders();
+   /// @brief Verifies render passes at different sizes run in order and complete once.
+   void rendersPassesInOrder();
+   /// @brief Verifies images are released after their last receiver and published ones count.
+   void releasesImagesAfterLastReceiver();
+   /// @brief Verifies unkept inputs are rendered over in place and identity nodes share images.
+   void rendersInPlaceAndPassesThrough();
+   /// @brief Verifies exports render intermediate nodes in place and cache only the target.
+   void rendersExportIntermediatesInPlace();
 };
 
 void TextureRenderManagerTest::rendersIndependentBranchesConcurrently() {
@@ -236,5 +409,417 @@ void TextureRenderManagerTest::recordsRollingTimingAcrossThreads() {
    QVERIFY(timing.averageMilliseconds >= 0.0);
 }
 
+void TextureRenderManagerTest::configuresWorkerCount() {
+   CallbackState state;
+   QCOMPARE(makeManager(state, 0)->getWorkerCount(), TextureRenderManager::defaultWorkerCount());
+   QCOMPARE(TextureRenderManager::defaultWorkerCount(),
+            std::size_t(std::max(1U, std::thread::hardware_concurrency())));
+
+   constexpr int workerCount = 6;
+   std::vector<RecordingGenerator*> blockedGenerators;
+   std::vector<TextureNodeSnapshot> nodes;
+   for (int id = 1; id <= workerCount; ++id) {
+      auto* raw = new RecordingGenerator(QStringLiteral("Parallel %1").arg(id), 0, id);
+      raw->block();
+      blockedGenerators.push_back(raw);
+      nodes.push_back(snapshot(id, TextureGeneratorPtr(raw), id));
+   }
+   const auto manager = makeManager(state, workerCount);
+   QCOMPARE(manager->getWorkerCount(), std::size_t(workerCount));
+   manager->render(TextureGraphSnapshot{QSize(2, 2), std::move(nodes)});
+   int startedCount = 0;
+   for (RecordingGenerator* generator : blockedGenerators) {
+      startedCount += generator->waitUntilStarted() ? 1 : 0;
+   }
+   for (RecordingGenerator* generator : blockedGenerators) {
+      generator->release();
+   }
+   QCOMPARE(startedCount, workerCount);
+   QVERIFY(state.waitFor(workerCount));
+}
+
+void TextureRenderManagerTest::stealsUnblockedReceivers() {
+   CallbackState state;
+   TextureGeneratorPtr root(new RecordingGenerator(QStringLiteral("Root"), 0, 5));
+   constexpr int receiverCount = 4;
+   std::vector<RecordingGenerator*> blockedReceivers;
+   std::vector<TextureNodeSnapshot> nodes{snapshot(1, root, 5)};
+   for (int index = 0; index < receiverCount; ++index) {
+      auto* raw = new RecordingGenerator(QStringLiteral("Receiver %1").arg(index), 1, 9);
+      raw->block();
+      blockedReceivers.push_back(raw);
+      nodes.push_back(
+          snapshot(index + 2, TextureGeneratorPtr(raw), 9, {{QStringLiteral("Image"), 1}}));
+   }
+   const auto manager = makeManager(state, receiverCount);
+   manager->render(TextureGraphSnapshot{QSize(2, 2), std::move(nodes)});
+   int startedCount = 0;
+   for (RecordingGenerator* receiver : blockedReceivers) {
+      startedCount += receiver->waitUntilStarted() ? 1 : 0;
+   }
+   for (RecordingGenerator* receiver : blockedReceivers) {
+      receiver->release();
+   }
+   QCOMPARE(startedCount, receiverCount);
+   QVERIFY(state.waitFor(receiverCount + 1));
+}
+
+void TextureRenderManagerTest::splitsLargeImagesIntoRegions() {
+   CallbackState state;
+   auto* tiledRaw = new TiledGenerator;
+   TextureGeneratorPtr tiled(tiledRaw);
+   const QSize size(640, 520);
+   const auto manager = makeManager(state, 4);
+   manager->render(TextureGraphSnapshot{size, {snapshot(1, tiled, 0)}});
+   QVERIFY(state.waitFor(1));
+
+   TextureImagePtr expected = TextureImage::create(size);
+   tiled->generate(size, expected->data(), {}, {});
+   std::lock_guard lock(state.mutex);
+   const TextureImagePtr& image = state.results.front().image;
+   QVERIFY(std::equal(image->data(), image->data() + image->pixelCount(), expected->data(),
+                      [](const TexturePixel& left, const TexturePixel& right) {
+                         return left.toRGBA() == right.toRGBA();
+                      }));
+   QVERIFY(tiledRaw->renderedRegionCount() > 1);
+   QVERIFY(tiledRaw->threadCount() > 1);
+   QCOMPARE(tiled->getGenerationTiming().runCount, 1);
+}
+
+void TextureRenderManagerTest::prioritizesLongestChain() {
+   TextureGeneratorPtr generator(new RecordingGenerator(QStringLiteral("Chain"), 1, 4));
+   std::vector<int> order;
+   QVERIFY(recordScheduleOrder(
+       TextureGraphSnapshot{QSize(2, 2),
+                            {snapshot(1, generator, 1), snapshot(2, generator, 2),
+                             snapshot(3, generator, 3, {{QStringLiteral("Image"), 2}}),
+                             snapshot(4, generator, 4, {{QStringLiteral("Image"), 3}})}},
+       order));
+   QCOMPARE(order, std::vector<int>({2, 3, 1, 4}));
+}
+
+void TextureRenderManagerTest::prioritizesMeasuredCost() {
+   TextureGeneratorPtr slow(new SlowGenerator);
+   TextureGeneratorPtr fast(new RecordingGenerator(QStringLiteral("Fast"), 1, 4));
+   const TextureImagePtr primer = TextureImage::create(QSize(2, 2));
+   slow->generateWithTiming(QSize(2, 2), primer->data(), {}, {});
+   fast->generateWithTiming(QSize(2, 2), primer->data(), {}, {});
+   QVERIFY(slow->getGenerationTiming().averageMilliseconds >
+           3.0 * fast->getGenerationTiming().averageMilliseconds);
+
+   std::vector<int> order;
+   QVERIFY(recordScheduleOrder(
+       TextureGraphSnapshot{QSize(2, 2),
+                            {snapshot(1, fast, 1),
+                             snapshot(2, fast, 2, {{QStringLiteral("Image"), 1}}),
+                             snapshot(3, fast, 3, {{QStringLiteral("Image"), 2}}),
+                             snapshot(4, slow, 4)}},
+       order));
+   QCOMPARE(order, std::vector<int>({4, 1, 2, 3}));
+}
+
+void TextureRenderManagerTest::exportsUpstreamGraphInParallel() {
+   if (TextureRenderManager::defaultWorkerCount() < 2) {
+      QSKIP("Parallel export needs at least two hardware threads");
+   }
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* firstRaw = new RecordingGenerator(QStringLiteral("First branch"), 0, 1);
+   auto* secondRaw = new RecordingGenerator(QStringLiteral("Second branch"), 0, 2);
+   auto* joinRaw = new RecordingGenerator(QStringLiteral("Join"), 2, 3);
+   auto* unrelatedRaw = new RecordingGenerator(QStringLiteral("Unrelated"), 0, 4);
+   firstRaw->block();
+   secondRaw->block();
+   unrelatedRaw->fail();
+   for (RecordingGenerator* generator : {firstRaw, secondRaw, joinRaw, unrelatedRaw}) {
+      project.addGenerator(TextureGeneratorPtr(generator));
+   }
+   project.newNode(1, project.getGenerator(QStringLiteral("First branch")));
+   project.newNode(2, project.getGenerator(QStringLiteral("Second branch")));
+   const TextureNodePtr join = project.newNode(3, project.getGenerator(QStringLiteral("Join")));
+   project.newNode(4, project.getGenerator(QStringLiteral("Unrelated")));
+   QVERIFY(join->setSourceSlot(QStringLiteral("Input 1"), 1));
+   QVERIFY(join->setSourceSlot(QStringLiteral("Input 2"), 2));
+
+   const QSize size(8, 8);
+   TextureImagePtr image;
+   TextureExportResult result;
+   std::vector<std::pair<int, int>> progress;
+   TextureExportHooks hooks;
+   hooks.progress = [&progress](const int finishedNodes, const int nodeCount) {
+      progress.emplace_back(finishedNodes, nodeCount);
+   };
+   std::thread exporter(
+       [&] { result = TextureExporter::renderNode(project, 3, size, image, hooks); });
+   const bool firstStarted = firstRaw->waitUntilStarted();
+   const bool secondStarted = secondRaw->waitUntilStarted();
+   firstRaw->release();
+   secondRaw->release();
+   exporter.join();
+
+   QVERIFY(firstStarted);
+   QVERIFY(secondStarted);
+   QVERIFY2(result.succeeded(), qPrintable(result.message));
+   QVERIFY(!image.isNull());
+   QCOMPARE(image->data()[0].r, static_cast<unsigned char>(3));
+   QCOMPARE(unrelatedRaw->callCount(), 0);
+   QVERIFY(!progress.empty());
+   QVERIFY(progress.back() == std::make_pair(3, 3));
+   QVERIFY(join->cachedImage(size) == image);
+   QVERIFY(project.getNode(1)->cachedImage(size).isNull());
+}
+
+void TextureRenderManagerTest::cancelsExportFromHook() {
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* sourceRaw = new RecordingGenerator(QStringLiteral("Source"), 0, 1);
+   auto* receiverRaw = new RecordingGenerator(QStringLiteral("Receiver"), 1, 2);
+   sourceRaw->block();
+   project.addGenerator(TextureGeneratorPtr(sourceRaw));
+   project.addGenerator(TextureGeneratorPtr(receiverRaw));
+   project.newNode(1, project.getGenerator(QStringLiteral("Source")));
+   const TextureNodePtr receiver =
+       project.newNode(2, project.getGenerator(QStringLiteral("Receiver")));
+   QVERIFY(receiver->setSourceSlot(QStringLiteral("Image"), 1));
+
+   std::atomic<bool> cancelRequested{false};
+   TextureExportHooks hooks;
+   hooks.cancelRequested = [sourceRaw, &cancelRequested] {
+      if (sourceRaw->callCount() > 0) {
+         cancelRequested = true;
+      }
+      return cancelRequested.load();
+   };
+   // The source keeps rendering until well after the cancellation, so its result is obsolete.
+   std::thread releaser([sourceRaw, &cancelRequested] {
+      sourceRaw->waitUntilStarted();
+      while (!cancelRequested) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      sourceRaw->release();
+   });
+   TextureImagePtr image;
+   const TextureExportResult result =
+       TextureExporter::renderNode(project, 2, QSize(8, 8), image, hooks);
+   releaser.join();
+   QVERIFY(result.error == TextureExportError::Cancelled);
+   QVERIFY(image.isNull());
+   QCOMPARE(receiverRaw->callCount(), 0);
+}
+
+void TextureRenderManagerTest::reportsCompletedRenders() {
+   CallbackState state;
+   auto* replacedRaw = new RecordingGenerator(QStringLiteral("Replaced"), 0, 10);
+   replacedRaw->block();
+   TextureGeneratorPtr replacedGenerator(replacedRaw);
+   TextureGeneratorPtr latestGenerator(new RecordingGenerator(QStringLiteral("Latest"), 0, 20));
+   const auto manager = makeManager(state, 1);
+   std::vector<std::uint64_t> completed;
+   QSemaphore completions;
+   manager->setCompletionObserver([&state, &completed, &completions](const std::uint64_t sequence) {
+      {
+         std::lock_guard lock(state.mutex);
+         completed.push_back(sequence);
+      }
+      completions.release();
+   });
+
+   const std::uint64_t replaced =
+       manager->render(TextureGraphSnapshot{QSize(2, 2), {snapshot(1, replacedGenerator, 10)}});
+   const bool started = replacedRaw->waitUntilStarted();
+   const std::uint64_t latest =
+       manager->render(TextureGraphSnapshot{QSize(2, 2), {snapshot(2, latestGenerator, 20)}});
+   replacedRaw->release();
+   QVERIFY(started);
+   QVERIFY(completions.tryAcquire(1, 5000));
+   QVERIFY(!completions.tryAcquire(1, 100));
+   QVERIFY(replaced != 0);
+   QVERIFY(latest > replaced);
+   QCOMPARE(manager->estimatedRemainingMilliseconds(), 0.0);
+   std::lock_guard lock(state.mutex);
+   QCOMPARE(completed, std::vector<std::uint64_t>{latest});
+}
+
+void TextureRenderManagerTest::rendersPassesInOrder() {
+   CallbackState state;
+   auto* sourceRaw = new RecordingGenerator(QStringLiteral("Source"), 0, 10);
+   TextureGeneratorPtr source(sourceRaw);
+   TextureGeneratorPtr receiver(new RecordingGenerator(QStringLiteral("Receiver"), 1, 20));
+   const auto manager = makeManager(state, 2);
+   std::vector<std::uint64_t> completed;
+   QSemaphore completions;
+   manager->setCompletionObserver([&state, &completed, &completions](const std::uint64_t sequence) {
+      {
+         std::lock_guard lock(state.mutex);
+         completed.push_back(sequence);
+      }
+      completions.release();
+   });
+
+   const auto graph = [&source, &receiver](const QSize size) {
+      return TextureGraphSnapshot{size,
+                                  {snapshot(1, source, 10),
+                                   snapshot(2, receiver, 20, {{QStringLiteral("Image"), 1}})}};
+   };
+   std::vector<TextureGraphSnapshot> passes;
+   passes.push_back(graph(QSize(2, 2)));
+   passes.push_back(TextureGraphSnapshot{QSize(3, 3), {}});
+   passes.push_back(graph(QSize(8, 8)));
+   const std::uint64_t sequence = manager->render(std::move(passes));
+   QVERIFY(sequence != 0);
+   QVERIFY(completions.tryAcquire(1, 5000));
+   QVERIFY(!completions.tryAcquire(1, 100));
+   QCOMPARE(sourceRaw->callCount(), 2);
+   std::lock_guard lock(state.mutex);
+   QCOMPARE(completed, std::vector<std::uint64_t>{sequence});
+   QCOMPARE(state.results.size(), std::size_t(4));
+   for (std::size_t index = 0; index < state.results.size(); ++index) {
+      QCOMPARE(state.results[index].size, index < 2 ? QSize(2, 2) : QSize(8, 8));
+      QCOMPARE(state.results[index].image->getSize(), state.results[index].size);
+   }
+}
+
+void TextureRenderManagerTest::releasesImagesAfterLastReceiver() {
+   CallbackState state;
+   TextureGeneratorPtr source(new RecordingGenerator(QStringLiteral("Source"), 0, 10));
+   TextureGeneratorPtr filter(new RecordingGenerator(QStringLiteral("Filter"), 1, 20));
+   const auto manager = makeManager(state, 1);
+   std::vector<TextureRenderPassStatistics> passes;
+   QSemaphore finishedPasses;
+   manager->setPassObserver(
+       [&state, &passes, &finishedPasses](const TextureRenderPassStatistics& statistics) {
+          {
+             std::lock_guard lock(state.mutex);
+             passes.push_back(statistics);
+          }
+          finishedPasses.release();
+       });
+
+   // A chain 1 -> 2 -> 3 -> 4, with 5 also reading 1.
+   const QSize size(8, 8);
+   const std::size_t imageBytes = TextureImage(size).byteSize();
+   const std::vector<TextureNodeSnapshot> graph{
+       snapshot(1, source, 10), snapshot(2, filter, 20, {{QStringLiteral("Input 1"), 1}}),
+       snapshot(3, filter, 30, {{QStringLiteral("Input 1"), 2}}),
+       snapshot(4, filter, 40, {{QStringLiteral("Input 1"), 3}}),
+       snapshot(5, filter, 50, {{QStringLiteral("Input 1"), 1}})};
+   std::vector<TextureNodeSnapshot> sinksOnly = graph;
+   for (std::size_t index = 0; index < 3; ++index) {
+      sinksOnly[index].keepImage = false;
+   }
+   const std::uint64_t sequence = manager->render(TextureGraphSnapshot{size, sinksOnly});
+   QVERIFY(state.waitFor(2));
+   QVERIFY(finishedPasses.tryAcquire(1, 5000));
+   {
+      std::lock_guard lock(state.mutex);
+      QCOMPARE(passes.size(), std::size_t(1));
+      const TextureRenderPassStatistics& statistics = passes.front();
+      QCOMPARE(statistics.sequence, sequence);
+      QCOMPARE(statistics.size, size);
+      QCOMPARE(statistics.nodeCount, std::size_t(5));
+      QCOMPARE(statistics.totalImageBytes, 5 * imageBytes);
+      // At most one source image, the image of a node waiting for its second receiver or a
+      // finished sink, and the image being rendered are held at once.
+      QVERIFY(statistics.peakImageBytes >= 2 * imageBytes);
+      QVERIFY(statistics.peakImageBytes <= 3 * imageBytes);
+      for (const TextureRenderResult& result : state.results) {
+         QVERIFY(!result.image.isNull());
+      }
+      state.results.clear();
+   }
+
+   // The result handler keeps every published image, so all of them count until the pass ends.
+   manager->render(TextureGraphSnapshot{size, graph});
+   QVERIFY(state.waitFor(5));
+   QVERIFY(finishedPasses.tryAcquire(1, 5000));
+   std::lock_guard lock(state.mutex);
+   QCOMPARE(passes.back().peakImageBytes, 5 * imageBytes);
+}
+
+void TextureRenderManagerTest::rendersInPlaceAndPassesThrough() {
+   CallbackState state;
+   TextureGeneratorPtr source(new RecordingGenerator(QStringLiteral("Source"), 0, 10));
+   auto* brightenRaw = new BrightenGenerator;
+   TextureGeneratorPtr brighten(brightenRaw);
+   const auto manager = makeManager(state, 1);
+   std::vector<TextureRenderPassStatistics> passes;
+   QSemaphore finishedPasses;
+   manager->setPassObserver(
+       [&state, &passes, &finishedPasses](const TextureRenderPassStatistics& statistics) {
+          {
+             std::lock_guard lock(state.mutex);
+             passes.push_back(statistics);
+          }
+          finishedPasses.release();
+       });
+
+   // A chain 1 -> 2 -> 3 -> 4 in which node 3 adds nothing to its input.
+   const QSize size(8, 8);
+   const std::size_t imageBytes = TextureImage(size).byteSize();
+   std::vector<TextureNodeSnapshot> chain{
+       snapshot(1, source, 10), snapshot(2, brighten, 1, {{QStringLiteral("Image"), 1}}),
+       snapshot(3, brighten, 0, {{QStringLiteral("Image"), 2}}),
+       snapshot(4, brighten, 1, {{QStringLiteral("Image"), 3}})};
+   std::vector<TextureNodeSnapshot> unkept = chain;
+   for (std::size_t index = 0; index + 1 < unkept.size(); ++index) {
+      unkept[index].keepImage = false;
+   }
+   manager->render(TextureGraphSnapshot{size, std::move(unkept)});
+   QVERIFY(state.waitFor(1));
+   QVERIFY(finishedPasses.tryAcquire(1, 5000));
+   {
+      // Only the sink is handed out, and the whole chain ran in the buffer of node 1.
+      std::lock_guard lock(state.mutex);
+      QCOMPARE(state.results.size(), std::size_t(1));
+      QCOMPARE(state.results.front().nodeId, 4);
+      QCOMPARE(state.results.front().image->getData()[0].r, quint8(12));
+      QCOMPARE(state.results.front().image->getData()[0].g, quint8(10));
+      QCOMPARE(brightenRaw->inPlaceCallCount(), 2);
+      QCOMPARE(passes.back().peakImageBytes, imageBytes);
+      state.results.clear();
+   }
+
+   // Kept images are shared with the result handler, so they are never rendered over.
+   manager->render(TextureGraphSnapshot{size, std::move(chain)});
+   QVERIFY(state.waitFor(4));
+   QVERIFY(finishedPasses.tryAcquire(1, 5000));
+   std::lock_guard lock(state.mutex);
+   QCOMPARE(brightenRaw->inPlaceCallCount(), 2);
+   QMap<int, TextureImagePtr> images;
+   for (const TextureRenderResult& result : state.results) {
+      images.insert(result.nodeId, result.image);
+   }
+   QCOMPARE(images.value(3), images.value(2));
+   QCOMPARE(images.value(1)->getData()[0].r, quint8(10));
+   QCOMPARE(images.value(4)->getData()[0].r, quint8(12));
+   QVERIFY(passes.back().peakImageBytes >= 2 * imageBytes);
+}
+
+void TextureRenderManagerTest::rendersExportIntermediatesInPlace() {
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   auto* brightenRaw = new BrightenGenerator;
+   const TextureGeneratorPtr brighten(brightenRaw);
+   project.newNode(1, TextureGeneratorPtr(new RecordingGenerator(QStringLiteral("Source"), 0, 10)));
+   const TextureNodePtr first = project.newNode(2, brighten);
+   const TextureNodePtr second = project.newNode(3, brighten);
+   first->setSettings({{QStringLiteral("value"), 1}});
+   second->setSettings({{QStringLiteral("value"), 1}});
+   QVERIFY(first->setSourceSlot(QStringLiteral("Image"), 1));
+   QVERIFY(second->setSourceSlot(QStringLiteral("Image"), 2));
+
+   const QSize size(8, 8);
+   TextureImagePtr image;
+   const TextureExportResult result = TextureExporter::renderNode(project, 3, size, image);
+   QVERIFY2(result.succeeded(), qPrintable(result.message));
+   QCOMPARE(image->getData()[0].r, quint8(12));
+   // Both filters ran in the buffer of the source, which nothing outside the export keeps.
+   QCOMPARE(brightenRaw->inPlaceCallCount(), 2);
+   QVERIFY(second->cachedImage(size) == image);
+   QVERIFY(first->cachedImage(size).isNull());
+   QVERIFY(project.getNode(1)->cachedImage(size).isNull());
+}
+
 QTEST_GUILESS_MAIN(TextureRenderManagerTest)
 #include "texturerendermanager_test.moc"
@@ -0,0 +1,201 @@
+#include "base/texturegraphtopology.h"
+#include "base/texturenode.h"
+#include "base/textureproject.h"
+#include "base/texturerendermanager.h"
+#include "base/texturerenderplan.h"
+#include "support/testgenerators.h"
+#include <QTest>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief Creates a node snapshot with the given sources.
+TextureNodeSnapshot snapshot(const int id, QMap<QString, int> sources = {}) {
+   return TextureNodeSnapshot{id, 1, {}, {}, std::move(sources), {}, {}};
+}
+
+/// @brief Returns the node IDs of a plan in index order.
+std::vector<int> planOrder(const TextureRenderPlan& plan) {
+   std::vector<int> ids;
+   for (std::size_t index = 0; index < plan.nodeCount(); ++index) {
+      ids.push_back(plan.nodeId(index));
+   }
+   return ids;
+}
+
+/// @brief Returns the IDs of the nodes in a plan row.
+std::vector<int> rowIds(const TextureRenderPlan& plan, const TextureRenderPlan::IndexRange row) {
+   std::vector<int> ids;
+   for (const int index : row) {
+      ids.push_back(plan.nodeId(static_cast<std::size_t>(index)));
+   }
+   return ids;
+}
+
+/// @brief Checks that every node of a plan comes after all of its sources.
+bool ordersEverySource(const TextureRenderPlan& plan) {
+   for (std::size_t index = 0; index < plan.nodeCount(); ++index) {
+      for (const int source : plan.sources(index)) {
+         if (static_cast<std::size_t>(source) >= index) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+}  // namespace
+
+/// @brief Verifies render plans are compiled in topological order and shared between renders.
+class TextureRenderPlanTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   /// @brief Verifies a topology is compiled into ordered receiver and source rows.
+   void compilesTopologyIntoRows();
+   /// @brief Verifies snapshot plans keep only their own nodes and reuse the project plan.
+   void compilesSnapshotsFromProjectPlan();
+   /// @brief Verifies snapshots without a project plan are sorted from their own sources.
+   void ordersSnapshotsWithoutProjectPlan();
+   /// @brief Verifies the project compiles its plan again only after connections change.
+   void projectReusesPlanUntilConnectionsChange();
+};
+
+void TextureRenderPlanTest::compilesTopologyIntoRows() {
+   TextureGraphTopology topology;
+   for (int id = 1; id <= 5; ++id) {
+      topology.addNode(id);
+   }
+   // 4 feeds 2 and 3, which both feed 1; 5 is unrelated.
+   QVERIFY(topology.addEdge(4, 2));
+   QVERIFY(topology.addEdge(4, 3));
+   QVERIFY(topology.addEdge(2, 1));
+   QVERIFY(topology.addEdge(3, 1));
+
+   const std::shared_ptr<const TextureRenderPlan> plan = TextureRenderPlan::compile(topology);
+   QCOMPARE(plan->nodeCount(), std::size_t(5));
+   QCOMPARE(plan->edgeCount(), std::size_t(4));
+   QCOMPARE(plan->getRevision(), topology.revision());
+   QVERIFY(ordersEverySource(*plan));
+   QCOMPARE(plan->indexOf(99), -1);
+
+   const auto index = [&plan](const int id) { return static_cast<std::size_t>(plan->indexOf(id)); };
+   QCOMPARE(plan->dependencyCount(index(4)), 0);
+   QCOMPARE(plan->dependencyCount(index(1)), 2);
+   QCOMPARE(plan->dependencyCount(index(5)), 0);
+   QCOMPARE(plan->receivers(index(4)).size(), std::size_t(2));
+   QVERIFY(plan->receivers(index(1)).empty());
+   std::vector<int> sources = rowIds(*plan, plan->sources(index(1)));
+   std::sort(sources.begin(), sources.end());
+   QCOMPARE(sources, std::vector<int>({2, 3}));
+   QCOMPARE(rowIds(*plan, plan->sources(index(2))), std::vector<int>({4}));
+
+   const std::uint64_t revision = topology.revision();
+   topology.removeEdge(3, 1);
+   QVERIFY(topology.revision() != revision);
+}
+
+void TextureRenderPlanTest::compilesSnapshotsFromProjectPlan() {
+   TextureGraphTopology topology;
+   for (int id = 1; id <= 4; ++id) {
+      topology.addNode(id);
+   }
+   // A chain 4 -> 3 -> 2 -> 1, connected against the insertion order.
+   QVERIFY(topology.addEdge(4, 3));
+   QVERIFY(topology.addEdge(3, 2));
+   QVERIFY(topology.addEdge(2, 1));
+   const std::shared_ptr<const TextureRenderPlan> graphPlan = TextureRenderPlan::compile(topology);
+
+   std::vector<TextureNodeSnapshot> chain{snapshot(1, {{QStringLiteral("Input 1"), 2}}),
+                                          snapshot(2, {{QStringLiteral("Input 1"), 3}}),
+                                          snapshot(3, {{QStringLiteral("Input 1"), 4}}),
+                                          snapshot(4)};
+   QCOMPARE(TextureRenderPlan::compile(chain, graphPlan), graphPlan);
+
+   // A cached input lends its image, so its own source is neither listed nor waited for.
+   std::vector<TextureNodeSnapshot> dirty{snapshot(1, {{QStringLiteral("Input 1"), 2}}),
+                                          snapshot(2, {{QStringLiteral("Input 1"), 3}})};
+   dirty.back().cachedImage = TextureImage::create(QSize(1, 1));
+   const std::shared_ptr<const TextureRenderPlan> plan =
+       TextureRenderPlan::compile(dirty, graphPlan);
+   QVERIFY(plan != graphPlan);
+   QCOMPARE(planOrder(*plan), std::vector<int>({2, 1}));
+   QCOMPARE(plan->dependencyCount(0), 0);
+   QCOMPARE(plan->dependencyCount(1), 1);
+   QCOMPARE(plan->edgeCount(), std::size_t(1));
+
+   // Sources that disagree with the project plan are sorted from the snapshot instead.
+   std::vector<TextureNodeSnapshot> rewired{snapshot(3, {{QStringLiteral("Input 1"), 1}}),
+                                            snapshot(1)};
+   const std::shared_ptr<const TextureRenderPlan> rewiredPlan =
+       TextureRenderPlan::compile(rewired, graphPlan);
+   QCOMPARE(planOrder(*rewiredPlan), std::vector<int>({1, 3}));
+   QVERIFY(ordersEverySource(*rewiredPlan));
+}
+
+void TextureRenderPlanTest::ordersSnapshotsWithoutProjectPlan() {
+   std::vector<TextureNodeSnapshot> nodes{
+       snapshot(1, {{QStringLiteral("Input 1"), 2}, {QStringLiteral("Input 2"), 3}}),
+       snapshot(2, {{QStringLiteral("Input 1"), 4}, {QStringLiteral("Input 2"), 4}}),
+       snapshot(3, {{QStringLiteral("Input 1"), 4}, {QStringLiteral("Input 2"), 99}}),
+       snapshot(4, {{QStringLiteral("Input 1"), 2}}),
+       snapshot(4)};
+   const std::shared_ptr<const TextureRenderPlan> plan = TextureRenderPlan::compile(nodes, nullptr);
+   QCOMPARE(plan->nodeCount(), std::size_t(4));
+   QCOMPARE(plan->getRevision(), std::uint64_t(0));
+   QVERIFY(ordersEverySource(*plan));
+   QCOMPARE(plan->nodeId(0), 4);
+   QCOMPARE(plan->nodeId(3), 1);
+   // Two slots reading the same node make one dependency, and missing sources make none.
+   QCOMPARE(plan->dependencyCount(static_cast<std::size_t>(plan->indexOf(2))), 1);
+   QCOMPARE(plan->dependencyCount(static_cast<std::size_t>(plan->indexOf(3))), 1);
+   QCOMPARE(plan->edgeCount(), std::size_t(4));
+
+   // Nodes on a cycle are listed last and never become ready.
+   std::vector<TextureNodeSnapshot> cyclic{snapshot(1, {{QStringLiteral("Input 1"), 2}}),
+                                           snapshot(2, {{QStringLiteral("Input 1"), 1}}),
+                                           snapshot(3)};
+   const std::shared_ptr<const TextureRenderPlan> cyclicPlan =
+       TextureRenderPlan::compile(cyclic, nullptr);
+   QCOMPARE(planOrder(*cyclicPlan), std::vector<int>({3, 1, 2}));
+}
+
+void TextureRenderPlanTest::projectReusesPlanUntilConnectionsChange() {
+   TextureProject project(false);
+   const TextureGeneratorPtr generator(new RecordingGenerator(QStringLiteral("Mix"), 2));
+   project.addGenerator(generator);
+   const TextureNodePtr first = project.newNode(1, generator);
+   project.newNode(2, generator);
+
+   const std::shared_ptr<const TextureRenderPlan> plan = project.getRenderPlan();
+   QCOMPARE(plan->nodeCount(), std::size_t(2));
+   TextureNodeSettings settings = first->getSettings();
+   settings[QStringLiteral("value")] = 40;
+   first->setSettings(settings);
+   QCOMPARE(project.getRenderPlan(), plan);
+
+   QVERIFY(first->setSourceSlot(QStringLiteral("Input 1"), 2));
+   const std::shared_ptr<const TextureRenderPlan> connected = project.getRenderPlan();
+   QVERIFY(connected != plan);
+   QCOMPARE(connected->nodeId(0), 2);
+   QCOMPARE(connected->dependencyCount(1), 1);
+   QCOMPARE(project.getRenderPlan(), connected);
+
+   // A second slot reading the same source adds no connection to the graph.
+   QVERIFY(first->setSourceSlot(QStringLiteral("Input 2"), 2));
+   QCOMPARE(project.getRenderPlan(), connected);
+
+   const TextureGraphSnapshot graph = project.createUpstreamGraphSnapshot(1, QSize(4, 4));
+   QCOMPARE(graph.plan, connected);
+   QCOMPARE(TextureRenderPlan::compile(graph.nodes, graph.plan), connected);
+
+   project.removeNode(2);
+   QCOMPARE(project.getRenderPlan()->nodeCount(), std::size_t(1));
+}
+
+QTEST_GUILESS_MAIN(TextureRenderPlanTest)
+#include "texturerenderplan_test.moc"
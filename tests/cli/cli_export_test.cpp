@@ -1,8 +1,15 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QImage>
 #include <QProcess>
 #include <QProcessEnvironment>
 #include <QTemporaryDir>
 #include <QTest>
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <sys/types.h>
+#endif
 
 namespace {
 
@@ -56,7 +63,7 @@ private slots:
    /// @brief Verifies that help succeeds without starting the graphical interface.
    void showsHelp();
 
-   /// @brief Verifies exporting a project whose output node is unambiguous.
+   /// @brief Verifies exporting a project whose output node is unambiguous, also on one thread.
    void exportsTrackedExampleByUniqueSink();
 
    /// @brief Verifies node listing and explicit selection for multiple output nodes.
@@ -70,6 +77,18 @@ private slots:
 
    /// @brief Verifies stable exit codes for usage and output failures.
    void returnsStableUsageAndOutputErrors();
+
+   /// @brief Verifies a manifest exports several projects, nodes, and sizes in one process.
+   void exportsBatchManifest();
+
+   /// @brief Verifies an interrupted batch reports every unwritten output as cancelled.
+   void reportsCancelledBatchOutputs();
+
+   /// @brief Verifies every sink node and its mip chain are exported in one run.
+   void exportsAllSinksWithMipChains();
+
+   /// @brief Verifies the output suffix selects the file format and PNG compression is adjustable.
+   void exportsOtherFormatsAndCompressionLevels();
 };
 
 void CliExportTest::showsHelp() {
@@ -100,6 +119,20 @@ void CliExportTest::exportsTrackedExampleByUniqueSink() {
    const QImage image(output);
    QVERIFY(!image.isNull());
    QCOMPARE(image.size(), QSize(32, 24));
+
+   // A single render thread produces the same image.
+   const QString serialOutput = directory.filePath(QStringLiteral("serial.png"));
+   QCOMPARE(runExporter({QStringLiteral("-j"), QStringLiteral("1"), QStringLiteral("--size"),
+                         QStringLiteral("32x24"), input, serialOutput},
+                        directory.path())
+                .exitCode,
+            0);
+   QCOMPARE(QImage(serialOutput), image);
+   QCOMPARE(runExporter({QStringLiteral("--threads"), QStringLiteral("-1"), input,
+                         directory.filePath(QStringLiteral("invalid.png"))},
+                        directory.path())
+                .exitCode,
+            2);
 }
 
 void CliExportTest::listsNodesAndRequiresSelectionForMultipleSinks() {
@@ -120,6 +153,11 @@ void CliExportTest::listsNodesAndRequiresSelectionForMultipleSinks() {
                         directory.path());
    QCOMPARE(result.exitCode, 0);
    QCOMPARE(QImage(output).pixelColor(0, 0), QColor(Qt::blue));
+   result = runExporter({QStringLiteral("--node"), QStringLiteral("2"),
+                         QStringLiteral("--progress"), QStringLiteral("--force"), input, output},
+                        directory.path());
+   QCOMPARE(result.exitCode, 0);
+   QVERIFY(result.standardError.contains("Rendered 1 of 1 nodes"));
 }
 
 void CliExportTest::loadsJavaScriptGeneratorsExplicitly() {
@@ -183,5 +221,202 @@ void CliExportTest::returnsStableUsageAndOutputErrors() {
             7);
 }
 
+void CliExportTest::exportsBatchManifest() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   const QString manifest = directory.filePath(QStringLiteral("manifest.json"));
+   QFile manifestFile(manifest);
+   QVERIFY(manifestFile.open(QIODevice::WriteOnly));
+   manifestFile.write(R"({
+      "outputs": [
+         {
+            "project": ")" PTM_SOURCE_DIR R"(/tests/fixtures/projects/multi-sink.txl",
+            "nodes": [1, 2],
+            "sizes": ["4x3", "2x2"],
+            "output": "images/{project}-{node}-{size}.png"
+         },
+         {
+            "project": ")" PTM_SOURCE_DIR R"(/tests/fixtures/projects/minimal-fill.txl",
+            "output": "images/{project}.png"
+         }
+      ]
+   })");
+   manifestFile.close();
+   QVERIFY(QDir(directory.path()).mkpath(QStringLiteral("images")));
+
+   ProcessResult result = runExporter(
+       {QStringLiteral("--size"), QStringLiteral("5x5"), QStringLiteral("--batch"), manifest},
+       directory.path());
+   QCOMPARE(result.exitCode, 0);
+   QVERIFY2(result.standardError.isEmpty(), result.standardError.constData());
+   QVERIFY(result.standardOutput.contains("Status\tRender ms\tWrite ms"));
+   QVERIFY(result.standardOutput.contains("Exported 5 of 5 images"));
+   const QString images = directory.filePath(QStringLiteral("images/"));
+   QCOMPARE(QImage(images + QStringLiteral("multi-sink-1-4x3.png")).pixelColor(0, 0),
+            QColor(Qt::red));
+   QCOMPARE(QImage(images + QStringLiteral("multi-sink-2-4x3.png")).pixelColor(0, 0),
+            QColor(Qt::blue));
+   QCOMPARE(QImage(images + QStringLiteral("multi-sink-2-2x2.png")).size(), QSize(2, 2));
+   QCOMPARE(QImage(images + QStringLiteral("minimal-fill.png")).size(), QSize(5, 5));
+
+   result = runExporter({QStringLiteral("--batch"), manifest}, directory.path());
+   QCOMPARE(result.exitCode, 7);
+   QVERIFY(result.standardOutput.contains("Exported 0 of 5 images"));
+   QVERIFY(result.standardError.contains("already exists"));
+   QCOMPARE(runExporter({QStringLiteral("--force"), QStringLiteral("--batch"), manifest},
+                        directory.path())
+                .exitCode,
+            0);
+   QCOMPARE(runExporter({QStringLiteral("--batch"), directory.filePath(QStringLiteral("none"))},
+                        directory.path())
+                .exitCode,
+            3);
+}
+
+void CliExportTest::reportsCancelledBatchOutputs() {
+#ifndef Q_OS_UNIX
+   QSKIP("Interrupting a child process requires POSIX signals");
+#else
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   const QString manifest = directory.filePath(QStringLiteral("manifest.json"));
+   QFile manifestFile(manifest);
+   QVERIFY(manifestFile.open(QIODevice::WriteOnly));
+   // The large first size keeps the render running until the interrupt arrives.
+   manifestFile.write(R"({
+      "outputs": [
+         {
+            "project": ")" PTM_SOURCE_DIR R"(/examples/wall.txl",
+            "sizes": ["4096x4096", "4x4"],
+            "output": "{project}-{size}.png"
+         },
+         {
+            "project": ")" PTM_SOURCE_DIR R"(/tests/fixtures/projects/minimal-fill.txl",
+            "output": "{project}.png"
+         }
+      ]
+   })");
+   manifestFile.close();
+
+   QProcess process;
+   process.setProgram(QStringLiteral(PTM_APPLICATION_EXECUTABLE));
+   process.setArguments({QStringLiteral("--no-gui"), QStringLiteral("--progress"),
+                         QStringLiteral("--batch"), manifest});
+   process.setWorkingDirectory(directory.path());
+   process.start();
+   QVERIFY(process.waitForStarted(5000));
+   // The first progress report shows the interrupt handler is installed and a render is running.
+   QByteArray standardError;
+   while (!standardError.contains("Rendered") && process.waitForReadyRead(30000)) {
+      standardError += process.readAllStandardError();
+   }
+   QVERIFY(standardError.contains("Rendered"));
+   QCOMPARE(::kill(static_cast<pid_t>(process.processId()), SIGINT), 0);
+   QVERIFY(process.waitForFinished(30000));
+   QCOMPARE(process.exitCode(), 8);
+
+   const QList<QByteArray> lines = process.readAllStandardOutput().split('\n');
+   int cancelled = 0;
+   for (const QByteArray& line : lines) {
+      const QList<QByteArray> fields = line.split('\t');
+      if (fields.size() != 6) {
+         continue;
+      }
+      if (fields.at(0) == "ok") {
+         QVERIFY2(QFileInfo::exists(QString::fromUtf8(fields.at(5))), line.constData());
+      } else if (fields.at(0) == "cancelled") {
+         ++cancelled;
+      }
+   }
+   // The interrupted size, the size after it, and the project that was never loaded.
+   QCOMPARE(cancelled, 3);
+   QVERIFY(!QFileInfo::exists(directory.filePath(QStringLiteral("wall-4x4.png"))));
+   QVERIFY(!QFileInfo::exists(directory.filePath(QStringLiteral("minimal-fill.png"))));
+#endif
+}
+
+void CliExportTest::exportsAllSinksWithMipChains() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   const QString input = QStringLiteral(PTM_SOURCE_DIR "/tests/fixtures/projects/multi-sink.txl");
+   ProcessResult result =
+       runExporter({QStringLiteral("--all-sinks"), QStringLiteral("--size"), QStringLiteral("4x3"),
+                    input, directory.filePath(QStringLiteral("all.png"))},
+                   directory.path());
+   QCOMPARE(result.exitCode, 0);
+   QVERIFY(result.standardOutput.contains("Exported 2 of 2 images"));
+   const QString separate = directory.filePath(QStringLiteral("separate.png"));
+   QCOMPARE(runExporter({QStringLiteral("--node"), QStringLiteral("2"), QStringLiteral("--size"),
+                         QStringLiteral("4x3"), input, separate},
+                        directory.path())
+                .exitCode,
+            0);
+   QCOMPARE(QImage(directory.filePath(QStringLiteral("all-1.png"))).pixelColor(0, 0),
+            QColor(Qt::red));
+   QCOMPARE(QImage(directory.filePath(QStringLiteral("all-2.png"))), QImage(separate));
+
+   result = runExporter({QStringLiteral("--all-sinks"), QStringLiteral("--mipmaps"),
+                         QStringLiteral("--size"), QStringLiteral("4x2"), input,
+                         directory.filePath(QStringLiteral("mip.png"))},
+                        directory.path());
+   QCOMPARE(result.exitCode, 0);
+   QVERIFY(result.standardOutput.contains("Exported 6 of 6 images"));
+   for (const QString& name : {QStringLiteral("mip-1-4x2.png"), QStringLiteral("mip-1-2x1.png"),
+                               QStringLiteral("mip-1-1x1.png"), QStringLiteral("mip-2-4x2.png")}) {
+      QVERIFY2(!QImage(directory.filePath(name)).isNull(), qPrintable(name));
+   }
+   const QImage level = QImage(directory.filePath(QStringLiteral("mip-2-2x1.png")));
+   QCOMPARE(level.size(), QSize(2, 1));
+   QCOMPARE(level.pixelColor(1, 0), QColor(Qt::blue));
+
+   QCOMPARE(runExporter({QStringLiteral("--all-sinks"), QStringLiteral("--node"),
+                         QStringLiteral("1"), input, directory.filePath(QStringLiteral("x.png"))},
+                        directory.path())
+                .exitCode,
+            2);
+}
+
+void CliExportTest::exportsOtherFormatsAndCompressionLevels() {
+   QTemporaryDir directory;
+   QVERIFY(directory.isValid());
+   const QString input = QStringLiteral(PTM_SOURCE_DIR "/tests/fixtures/projects/multi-sink.txl");
+   const auto exportAs = [&](const QString& name, const QStringList& options) {
+      QStringList arguments = options;
+      arguments << QStringLiteral("--node") << QStringLiteral("1") << QStringLiteral("--size")
+                << QStringLiteral("4x3") << input << directory.filePath(name);
+      return runExporter(arguments, directory.path()).exitCode;
+   };
+   const auto contents = [&directory](const QString& name) {
+      QFile file(directory.filePath(name));
+      return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+   };
+
+   QCOMPARE(exportAs(QStringLiteral("red.raw"), {}), 0);
+   const QByteArray raw = contents(QStringLiteral("red.raw"));
+   QCOMPARE(raw.size(), qsizetype(4 * 3 * 4));
+   QCOMPARE(raw.left(4), QByteArray("\xff\x00\x00\xff", 4));
+   QCOMPARE(exportAs(QStringLiteral("red.qoi"), {}), 0);
+   QVERIFY(contents(QStringLiteral("red.qoi")).startsWith("qoif"));
+   QCOMPARE(exportAs(QStringLiteral("red.tga"), {}), 0);
+   QCOMPARE(exportAs(QStringLiteral("red.dds"), {}), 0);
+   QCOMPARE(contents(QStringLiteral("red.dds")).mid(128), raw);
+
+   QCOMPARE(exportAs(QStringLiteral("stored.png"),
+                     {QStringLiteral("--compression"), QStringLiteral("0")}),
+            0);
+   QCOMPARE(exportAs(QStringLiteral("smallest.png"),
+                     {QStringLiteral("--compression"), QStringLiteral("9")}),
+            0);
+   QCOMPARE(QImage(directory.filePath(QStringLiteral("stored.png"))),
+            QImage(directory.filePath(QStringLiteral("smallest.png"))));
+   QVERIFY(contents(QStringLiteral("stored.png")).size() >
+           contents(QStringLiteral("smallest.png")).size());
+
+   QCOMPARE(exportAs(QStringLiteral("bad.png"),
+                     {QStringLiteral("--compression"), QStringLiteral("10")}),
+            2);
+   QCOMPARE(exportAs(QStringLiteral("image.jpg"), {}), 7);
+}
+
 QTEST_APPLESS_MAIN(CliExportTest)
 #include "cli_export_test.moc"
@@ -0,0 +1,129 @@
+#include "base/texturerendermanager.h"
+#include "generators/boxblur.h"
+#include "generators/gaussianblur.h"
+#include "generators/stackblur.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QSharedPointer>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QtGlobal>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int iterations = 3;
+
+struct BenchmarkCase {
+   QString name;
+   QSharedPointer<TextureGenerator> generator;
+   QString radiusSetting;
+   QList<int> radii;
+   QList<int> sizes;
+};
+
+/// @brief Fills an image with a deterministic pattern of colours and alpha values.
+TextureImagePtr patternImage(const QSize size) {
+   TextureImagePtr image = TextureImage::create(size);
+   for (std::size_t i = 0; i < image->pixelCount(); ++i) {
+      const auto value = static_cast<quint32>(i * 2654435761U + 7U);
+      image->data()[i] =
+          TexturePixel(static_cast<quint8>(value), static_cast<quint8>(value >> 8U),
+                       static_cast<quint8>(value >> 16U), static_cast<quint8>(value >> 24U));
+   }
+   return image;
+}
+
+/// @brief Renders an image, splitting every tiling pass over threads when workerCount exceeds 1.
+void render(const TextureGenerator& generator, const QSize size, TexturePixel* output,
+            const QMap<QString, TextureImagePtr>& sources, const TextureNodeSettings& settings,
+            const int workerCount) {
+   if (workerCount <= 1) {
+      generator.generate(size, output, sources, settings);
+      return;
+   }
+   for (int pass = 0; pass < generator.getTilingPassCount(); ++pass) {
+      std::vector<std::thread> workers;
+      for (const QRect& region : generator.getTilingRegions(size, pass, workerCount)) {
+         workers.emplace_back([&generator, size, pass, region, output, &sources, &settings] {
+            generator.generateRegion(size, pass, region, output, sources, settings);
+         });
+      }
+      for (std::thread& worker : workers) {
+         worker.join();
+      }
+   }
+}
+
+void runCase(const BenchmarkCase& benchmark, const QSize size, const int radius,
+             const int workerCount) {
+   const QMap<QString, TextureImagePtr> sources{
+       {benchmark.generator->getSourceSlots().constFirst(), patternImage(size)}};
+   TextureNodeSettings settings;
+   for (const TextureGeneratorSetting& setting : benchmark.generator->getSettings()) {
+      settings.insert(setting.id, setting.defaultvalue);
+   }
+   settings.insert(benchmark.radiusSetting, radius);
+   TextureImagePtr output = TextureImage::create(size);
+   // One untimed render warms the caches and any lazily built tables.
+   render(*benchmark.generator, size, output->data(), sources, settings, workerCount);
+   QElapsedTimer timer;
+   timer.start();
+   for (int iteration = 0; iteration < iterations; ++iteration) {
+      render(*benchmark.generator, size, output->data(), sources, settings, workerCount);
+   }
+   const qint64 wallNanoseconds = timer.nsecsElapsed();
+   const double megapixels = static_cast<double>(size.width()) * size.height() * iterations / 1e6;
+   const double seconds = static_cast<double>(qMax<qint64>(wallNanoseconds, 1)) / 1e9;
+
+   QJsonObject result{
+       {QStringLiteral("case"), benchmark.name},
+       {QStringLiteral("width"), size.width()},
+       {QStringLiteral("height"), size.height()},
+       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+       {QStringLiteral("compiler"), QString::fromLatin1(__VERSION__)},
+#ifdef NDEBUG
+       {QStringLiteral("buildType"), QStringLiteral("release")},
+#else
+       {QStringLiteral("buildType"), QStringLiteral("debug")},
+#endif
+       {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
+       {QStringLiteral("workerCount"), workerCount},
+       {QStringLiteral("radius"), radius},
+       {QStringLiteral("iterations"), iterations},
+       {QStringLiteral("wallNs"), wallNanoseconds},
+       {QStringLiteral("megapixelsPerSecond"), megapixels / seconds}};
+   QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+   QCoreApplication application(argc, argv);
+   const QList<BenchmarkCase> cases{
+       // The box blur radius setting is scaled by every full 250 pixels of the image size.
+       {QStringLiteral("box-blur"), QSharedPointer<BoxBlurTextureGenerator>::create(),
+        QStringLiteral("numneighbours"), {1, 5, 15, 30}, {512, 2048}},
+       {QStringLiteral("gaussian-blur"), QSharedPointer<GaussianBlurTextureGenerator>::create(),
+        QStringLiteral("numneighbours"), {1, 5, 15, 30}, {1024, 2048, 4096, 8192}},
+       // The stack blur level is scaled by every full 100 pixels of the width, up to 254.
+       {QStringLiteral("stack-blur"), QSharedPointer<StackBlurTextureGenerator>::create(),
+        QStringLiteral("level"), {1, 5, 20}, {1024, 4096}},
+   };
+   const auto workerCount = static_cast<int>(TextureRenderManager::defaultWorkerCount());
+   for (const BenchmarkCase& benchmark : cases) {
+      for (const int size : benchmark.sizes) {
+         for (const int radius : benchmark.radii) {
+            runCase(benchmark, QSize(size, size), radius, 1);
+            if (workerCount > 1 && benchmark.generator->supportsTiling()) {
+               runCase(benchmark, QSize(size, size), radius, workerCount);
+            }
+         }
+      }
+   }
+   return 0;
+}
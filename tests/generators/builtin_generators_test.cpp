@@ -1,9 +1,15 @@
 #include "base/texturenode.h"
 #include "base/textureproject.h"
 #include "generators/builtinregistry.h"
+#include <QCryptographicHash>
 #include <QSet>
 #include <QTest>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <exception>
+#include <utility>
+#include <vector>
 
 /// @brief Exercises every registered built-in generator with a small render.
 class BuiltinGeneratorsTest : public QObject {
@@ -12,6 +18,18 @@ class BuiltinGeneratorsTest : public QObject {
 private slots:
    /// @brief Verifies that every built-in generator can render without failing.
    void rendersEveryGenerator();
+   /// @brief Verifies tiled region renders match a full render for every tiling generator.
+   void tiledRegionsMatchFullRender();
+   /// @brief Verifies in-place renders and pass-through inputs match separate-buffer renders.
+   void inPlaceAndPassThroughMatchCopies();
+   /// @brief Verifies pixel lengths scale in proportion to the image size or its reference.
+   void scalesLengthsWithImageSize();
+   /// @brief Verifies box blur matches a direct average of its wrapped window.
+   void boxBlurMatchesWindowAverage();
+   /// @brief Verifies the fixed-point Gaussian blur stays within one level of a float blur.
+   void gaussianBlurMatchesFloatReference();
+   /// @brief Verifies stack blur output matches digests recorded from the single-threaded port.
+   void stackBlurMatchesRecordedOutput();
 };
 
 void BuiltinGeneratorsTest::rendersEveryGenerator() {
@@ -120,5 +138,317 @@ void BuiltinGeneratorsTest::rendersEveryGenerator() {
    QCOMPARE(mask->getSourceIdentity(), QStringLiteral(":/generators/mask.js"));
 }
 
+void BuiltinGeneratorsTest::tiledRegionsMatchFullRender() {
+   TextureProject project(false);
+   registerBuiltInGenerators(project);
+   const QSize size(37, 29);
+   QMap<QString, TextureImagePtr> sources;
+   const auto generators = project.getGenerators();
+   int tiledGenerators = 0;
+
+   for (auto it = generators.cbegin(); it != generators.cend(); ++it) {
+      const TextureGeneratorPtr& generator = it.value();
+      if (!generator->supportsTiling()) {
+         continue;
+      }
+      ++tiledGenerators;
+      sources.clear();
+      int seed = 0;
+      for (const QString& slot : generator->getSourceSlots()) {
+         const TextureImagePtr source = TextureImage::create(size);
+         ++seed;
+         for (std::size_t i = 0; i < source->pixelCount(); ++i) {
+            const auto value = static_cast<quint32>(i * 2654435761U + seed * 40503U);
+            source->data()[i] = TexturePixel(value & 0xffU, (value >> 8U) & 0xffU,
+                                             (value >> 16U) & 0xffU, (value >> 24U) & 0xffU);
+         }
+         sources.insert(slot, source);
+      }
+      const TextureNodeSettings settings = project.newNode(1, generator)->getSettings();
+      project.clear();
+
+      const TextureImagePtr full = TextureImage::create(size);
+      generator->generate(size, full->data(), sources, settings);
+      for (const int regionCount : {1, 3, 8, 64}) {
+         const TextureImagePtr tiled = TextureImage::create(size);
+         for (int pass = 0; pass < generator->getTilingPassCount(); ++pass) {
+            const QList<QRect> regions = generator->getTilingRegions(size, pass, regionCount);
+            QVERIFY2(!regions.isEmpty(), qPrintable(it.key()));
+            for (auto region = regions.crbegin(); region != regions.crend(); ++region) {
+               generator->generateRegion(size, pass, *region, tiled->data(), sources, settings);
+            }
+         }
+         QVERIFY2(std::memcmp(tiled->data(), full->data(), full->byteSize()) == 0,
+                  qPrintable(QStringLiteral("%1 with %2 regions").arg(it.key()).arg(regionCount)));
+      }
+   }
+   QCOMPARE(tiledGenerators, 16);
+}
+
+void BuiltinGeneratorsTest::inPlaceAndPassThroughMatchCopies() {
+   TextureProject project(false);
+   registerBuiltInGenerators(project);
+   const QSize size(37, 29);
+   const auto generators = project.getGenerators();
+   int inPlaceGenerators = 0;
+
+   for (auto it = generators.cbegin(); it != generators.cend(); ++it) {
+      const TextureGeneratorPtr& generator = it.value();
+      QMap<QString, TextureImagePtr> sources;
+      int seed = 0;
+      for (const QString& slot : generator->getSourceSlots()) {
+         const TextureImagePtr source = TextureImage::create(size);
+         ++seed;
+         for (std::size_t i = 0; i < source->pixelCount(); ++i) {
+            const auto value = static_cast<quint32>(i * 2654435761U + seed * 40503U);
+            source->data()[i] = TexturePixel(value & 0xffU, (value >> 8U) & 0xffU,
+                                             (value >> 16U) & 0xffU, (value >> 24U) & 0xffU);
+         }
+         sources.insert(slot, source);
+      }
+      TextureNodeSettings settings = project.newNode(1, generator)->getSettings();
+      project.clear();
+      const TextureImagePtr full = TextureImage::create(size);
+      generator->generate(size, full->data(), sources, settings);
+
+      const QString passThroughSlot = generator->getPassThroughSlot(size, settings);
+      if (!passThroughSlot.isEmpty()) {
+         QVERIFY2(std::memcmp(sources.value(passThroughSlot)->data(), full->data(),
+                              full->byteSize()) == 0,
+                  qPrintable(it.key()));
+      }
+      const QString inPlaceSlot = generator->getInPlaceSlot();
+      if (inPlaceSlot.isEmpty()) {
+         continue;
+      }
+      ++inPlaceGenerators;
+      QVERIFY2(generator->getSourceSlots().contains(inPlaceSlot), qPrintable(it.key()));
+      const TextureImagePtr shared = TextureImage::create(size);
+      std::memcpy(shared->data(), sources.value(inPlaceSlot)->data(), shared->byteSize());
+      sources.insert(inPlaceSlot, shared);
+      generator->generate(size, shared->data(), sources, settings);
+      QVERIFY2(std::memcmp(shared->data(), full->data(), full->byteSize()) == 0,
+               qPrintable(it.key()));
+   }
+   QCOMPARE(inPlaceGenerators, 6);
+
+   // Settings that leave the input unchanged name it as the output.
+   const QList<std::pair<QString, TextureNodeSettings>> identities{
+       {QStringLiteral("Box blur"), {{QStringLiteral("numneighbours"), 0}}},
+       {QStringLiteral("Stack Blur"), {{QStringLiteral("level"), 0}}},
+       {QStringLiteral("Modify levels"),
+        {{QStringLiteral("mode"), QStringLiteral("Multiply")}, {QStringLiteral("level"), 100}}},
+       {QStringLiteral("Modify levels"),
+        {{QStringLiteral("mode"), QStringLiteral("Add")}, {QStringLiteral("level"), 0}}},
+       {QStringLiteral("Lens"), {{QStringLiteral("size"), 0}}},
+       {QStringLiteral("Text"), {{QStringLiteral("text"), QString()}}}};
+   for (const auto& [name, settings] : identities) {
+      const TextureGeneratorPtr generator = project.getGenerator(name);
+      QVERIFY2(!generator.isNull(), qPrintable(name));
+      QCOMPARE(generator->getPassThroughSlot(size, settings), generator->getSourceSlots().first());
+   }
+   const TextureNodeSettings blurred{{QStringLiteral("numneighbours"), 3}};
+   QVERIFY(project.getGenerator(QStringLiteral("Box blur"))
+               ->getPassThroughSlot(size, blurred)
+               .isEmpty());
+   const TextureNodeSettings doubled{{QStringLiteral("mode"), QStringLiteral("Multiply")},
+                                     {QStringLiteral("level"), 200}};
+   QVERIFY(project.getGenerator(QStringLiteral("Modify levels"))
+               ->getPassThroughSlot(size, doubled)
+               .isEmpty());
+}
+
+void BuiltinGeneratorsTest::scalesLengthsWithImageSize() {
+   QCOMPARE(scaleTextureLength(10, 250, 250), 10);
+   QCOMPARE(scaleTextureLength(10, 125, 250), 5);
+   QCOMPARE(scaleTextureLength(10, 62, 250), 2);
+   QCOMPARE(scaleTextureLength(10, 1000, 250), 40);
+   QCOMPARE(scaleTextureLength(3, 375, 250), 5);
+   QCOMPARE(scaleTextureLength(1, 20, 250), 1);
+   QCOMPARE(scaleTextureLength(0, 1000, 250), 0);
+   QCOMPARE(scaleTextureLength(-4, 1000, 250), 0);
+   QCOMPARE(scaleTextureLength(4, 0, 250), 0);
+
+   const TextureNodeSettings reduced{{TextureReferenceSizeSetting, QSize(400, 300)}};
+   QCOMPARE(textureReferenceSize(QSize(100, 75), reduced), QSize(400, 300));
+   QCOMPARE(textureReferenceSize(QSize(100, 75), TextureNodeSettings()), QSize(100, 75));
+}
+
+void BuiltinGeneratorsTest::boxBlurMatchesWindowAverage() {
+   TextureProject project(false);
+   registerBuiltInGenerators(project);
+   const TextureGeneratorPtr generator = project.getGenerator(QStringLiteral("Box blur"));
+   QVERIFY(!generator.isNull());
+
+   for (const QSize size : {QSize(1, 1), QSize(4, 3), QSize(17, 13), QSize(260, 530)}) {
+      const TextureImagePtr source = TextureImage::create(size);
+      for (std::size_t i = 0; i < source->pixelCount(); ++i) {
+         const auto value = static_cast<quint32>(i * 2654435761U + 17U);
+         source->data()[i] = TexturePixel(value & 0xffU, (value >> 8U) & 0xffU,
+                                          (value >> 16U) & 0xffU, (value >> 24U) & 0xffU);
+      }
+      const QMap<QString, TextureImagePtr> sources{{QStringLiteral("Image"), source}};
+      for (const int radius : {0, 1, 3, 30}) {
+         TextureNodeSettings settings;
+         settings.insert(QStringLiteral("numneighbours"), radius);
+         const TextureImagePtr blurred = TextureImage::create(size);
+         generator->generate(size, blurred->data(), sources, settings);
+
+         // The window is 2r by 2r pixels, ending just before r pixels right of and below
+         // the centre, with r scaled by every full 250 pixels of the image size.
+         const int radiusX = radius * qMax(size.width() / 250, 1);
+         const int radiusY = radius * qMax(size.height() / 250, 1);
+         for (int y = 0; y < size.height(); y += 7) {
+            for (int x = 0; x < size.width(); x += 5) {
+               const TexturePixel& actual = blurred->data()[y * size.width() + x];
+               if (radius == 0) {
+                  QCOMPARE(actual.toRGBA(), source->data()[y * size.width() + x].toRGBA());
+                  continue;
+               }
+               quint64 sums[4] = {0, 0, 0, 0};
+               for (int windowY = y - radiusY; windowY < y + radiusY; ++windowY) {
+                  const int wrappedY = (windowY % size.height() + size.height()) % size.height();
+                  for (int windowX = x - radiusX; windowX < x + radiusX; ++windowX) {
+                     const int wrappedX = (windowX % size.width() + size.width()) % size.width();
+                     const TexturePixel& pixel = source->data()[wrappedY * size.width() + wrappedX];
+                     sums[0] += pixel.r;
+                     sums[1] += pixel.g;
+                     sums[2] += pixel.b;
+                     sums[3] += pixel.a;
+                  }
+               }
+               const quint64 count = static_cast<quint64>(radiusX) * radiusY * 4;
+               const TexturePixel expected(
+                   static_cast<quint8>(sums[0] / count), static_cast<quint8>(sums[1] / count),
+                   static_cast<quint8>(sums[2] / count), static_cast<quint8>(sums[3] / count));
+               QVERIFY2(actual.toRGBA() == expected.toRGBA(),
+                        qPrintable(QStringLiteral("%1x%2, radius %3, pixel %4,%5")
+                                       .arg(size.width())
+                                       .arg(size.height())
+                                       .arg(radius)
+                                       .arg(x)
+                                       .arg(y)));
+            }
+         }
+      }
+   }
+}
+
+void BuiltinGeneratorsTest::gaussianBlurMatchesFloatReference() {
+   TextureProject project(false);
+   registerBuiltInGenerators(project);
+   const TextureGeneratorPtr generator = project.getGenerator(QStringLiteral("Gaussian blur"));
+   QVERIFY(!generator.isNull());
+
+   for (const QSize size : {QSize(1, 1), QSize(37, 23), QSize(5, 90)}) {
+      const TextureImagePtr source = TextureImage::create(size);
+      for (std::size_t i = 0; i < source->pixelCount(); ++i) {
+         const auto value = static_cast<quint32>(i * 2654435761U + 17U);
+         source->data()[i] = TexturePixel(value & 0xffU, (value >> 8U) & 0xffU,
+                                          (value >> 16U) & 0xffU, (value >> 24U) & 0xffU);
+      }
+      const QMap<QString, TextureImagePtr> sources{{QStringLiteral("Image"), source}};
+      const int width = size.width();
+      const int height = size.height();
+      for (const int radius : {1, 2, 7, 30}) {
+         for (const double weight : {0.0, 0.5, 1.0, 4.0}) {
+            TextureNodeSettings settings;
+            settings.insert(QStringLiteral("numneighbours"), radius);
+            settings.insert(QStringLiteral("weight"), weight);
+            const TextureImagePtr blurred = TextureImage::create(size);
+            generator->generate(size, blurred->data(), sources, settings);
+
+            // Separable blur in double precision, with edge pixels repeated beyond the image.
+            std::vector<double> kernel(static_cast<std::size_t>(radius) * 2 + 1);
+            double kernelSum = 0;
+            for (int tap = -radius; tap <= radius; ++tap) {
+               const double x = tap * weight;
+               kernel[tap + radius] = std::exp(-x * x / (2.0 * radius * radius));
+               kernelSum += kernel[tap + radius];
+            }
+            const auto channel = [](const TexturePixel& pixel, const int index) {
+               const quint8 channels[4] = {pixel.r, pixel.g, pixel.b, pixel.a};
+               return channels[index];
+            };
+            std::vector<double> horizontal(source->pixelCount() * 4);
+            for (int y = 0; y < height; ++y) {
+               for (int x = 0; x < width; ++x) {
+                  for (int index = 0; index < 4; ++index) {
+                     double sum = 0;
+                     for (int tap = -radius; tap <= radius; ++tap) {
+                        const int sourceX = std::clamp(x + tap, 0, width - 1);
+                        sum += kernel[tap + radius] *
+                               channel(source->data()[y * width + sourceX], index);
+                     }
+                     horizontal[(static_cast<std::size_t>(y) * width + x) * 4 + index] =
+                         sum / kernelSum;
+                  }
+               }
+            }
+            double largestError = 0;
+            for (int y = 0; y < height; ++y) {
+               for (int x = 0; x < width; ++x) {
+                  for (int index = 0; index < 4; ++index) {
+                     double sum = 0;
+                     for (int tap = -radius; tap <= radius; ++tap) {
+                        const int sourceY = std::clamp(y + tap, 0, height - 1);
+                        sum += kernel[tap + radius] *
+                               horizontal[(static_cast<std::size_t>(sourceY) * width + x) * 4 +
+                                          index];
+                     }
+                     const double actual = channel(blurred->data()[y * width + x], index);
+                     largestError = std::max(largestError, std::abs(actual - sum / kernelSum));
+                  }
+               }
+            }
+            QVERIFY2(largestError < 1.0,
+                     qPrintable(QStringLiteral("%1x%2, radius %3, weight %4: %5")
+                                    .arg(width)
+                                    .arg(height)
+                                    .arg(radius)
+                                    .arg(weight)
+                                    .arg(largestError)));
+         }
+      }
+   }
+}
+
+void BuiltinGeneratorsTest::stackBlurMatchesRecordedOutput() {
+   TextureProject project(false);
+   registerBuiltInGenerators(project);
+   const TextureGeneratorPtr generator = project.getGenerator(QStringLiteral("Stack Blur"));
+   QVERIFY(!generator.isNull());
+
+   struct RecordedOutput {
+      QSize size;
+      double level;
+      QByteArray sha1;
+   };
+   const RecordedOutput recorded[] = {
+       {QSize(37, 23), 1, "11297ca316d2db82150f39d171b82db2393efe2a"},
+       {QSize(37, 23), 4, "7f0d60c7d49ad78c4d4ab9c9fd1aaca332312e84"},
+       {QSize(37, 23), 20, "fe671c68f178820a99e9eea156bc0f777e7dcaf7"},
+       {QSize(230, 170), 1, "4abb29a31514eecf25cb5bf505c94180bbd26eef"},
+       {QSize(230, 170), 4, "42c32754e35a39755887c4220c7e94b2fd0222b2"},
+       {QSize(230, 170), 20, "ca1e7fe9a917d5fb748386578c542d333b21b23b"},
+   };
+   for (const RecordedOutput& output : recorded) {
+      const TextureImagePtr source = TextureImage::create(output.size);
+      for (std::size_t i = 0; i < source->pixelCount(); ++i) {
+         const auto value = static_cast<quint32>(i * 2654435761U + 17U);
+         source->data()[i] = TexturePixel(value & 0xffU, (value >> 8U) & 0xffU,
+                                          (value >> 16U) & 0xffU, (value >> 24U) & 0xffU);
+      }
+      TextureNodeSettings settings;
+      settings.insert(QStringLiteral("level"), output.level);
+      const TextureImagePtr blurred = TextureImage::create(output.size);
+      generator->generate(output.size, blurred->data(), {{QStringLiteral("Image"), source}},
+                          settings);
+      const QByteArray bytes(reinterpret_cast<const char*>(blurred->data()),
+                             static_cast<qsizetype>(blurred->pixelCount() * sizeof(TexturePixel)));
+      QCOMPARE(QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex(), output.sha1);
+   }
+}
+
 QTEST_MAIN(BuiltinGeneratorsTest)
 #include "builtin_generators_test.moc"
@@ -23,10 +23,12 @@ TextureImagePtr inputImage(const QSize size, const TexturePixel color) {
    return image;
 }
 
-void runCase(const BenchmarkCase& benchmark, const QSize size) {
+void runCase(const BenchmarkCase& benchmark, const QSize size,
+             const TextureGenerator::Origin origin) {
    QElapsedTimer timer;
    timer.start();
-   JsTexGen generator(benchmark.script, QStringLiteral("<benchmark:%1>").arg(benchmark.name));
+   JsTexGen generator(benchmark.script, QStringLiteral("<benchmark:%1>").arg(benchmark.name),
+                      origin);
    const qint64 validationNanoseconds = timer.nsecsElapsed();
    if (!generator.isValid()) {
       QTextStream(stderr) << generator.validationError() << Qt::endl;
@@ -47,9 +49,11 @@ void runCase(const BenchmarkCase& benchmark, const QSize size) {
    timer.restart();
    generator.generate(size, output->data(), inputs, settings);
    const qint64 coldNanoseconds = timer.nsecsElapsed();
+   const quint64 copiesBefore = JsTexGen::bridgeCopyCount();
    timer.restart();
    generator.generate(size, output->data(), inputs, settings);
    const qint64 warmNanoseconds = timer.nsecsElapsed();
+   const quint64 bridgeCopies = JsTexGen::bridgeCopyCount() - copiesBefore;
 
    QJsonObject result{
        {QStringLiteral("case"), benchmark.name},
@@ -64,8 +68,10 @@ void runCase(const BenchmarkCase& benchmark, const QSize size) {
 #endif
        {QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture()},
        {QStringLiteral("workerCount"), 1},
-       {QStringLiteral("sourceCopies"), benchmark.inputs.size()},
-       {QStringLiteral("outputCopies"), 1},
+       {QStringLiteral("imageBinding"), origin == TextureGenerator::Origin::BuiltIn
+                                            ? QStringLiteral("shared")
+                                            : QStringLiteral("copied")},
+       {QStringLiteral("bridgeCopies"), static_cast<qint64>(bridgeCopies)},
        {QStringLiteral("validationNs"), validationNanoseconds},
        {QStringLiteral("coldInvocationNs"), coldNanoseconds},
        {QStringLiteral("warmInvocationNs"), warmNanoseconds},
@@ -90,6 +96,10 @@ int main(int argc, char** argv) {
        "const generator={apiVersion:1,name:'Benchmark',type:'generator',inputs:%1,settings:[],"
        "generate(size,settings,output,inputs){void settings;");
    const QList<BenchmarkCase> cases{
+       {QStringLiteral("bridge-only"),
+        descriptorStart.arg(QStringLiteral("['First','Second']")) +
+            QStringLiteral("void size;void inputs;void output;}};"),
+        {QStringLiteral("First"), QStringLiteral("Second")}},
        {QStringLiteral("fill"),
         descriptorStart.arg(QStringLiteral("[]")) +
             QStringLiteral("output.data.fill(127);void size;void inputs;}};"),
@@ -116,7 +126,9 @@ int main(int argc, char** argv) {
    const QList<int> sizes{256, 512, 1024, 2048};
    for (const BenchmarkCase& benchmark : cases) {
       for (const int size : sizes) {
-         runCase(benchmark, QSize(size, size));
+         // Bundled scripts share image memory, while user scripts copy every image once.
+         runCase(benchmark, QSize(size, size), TextureGenerator::Origin::Custom);
+         runCase(benchmark, QSize(size, size), TextureGenerator::Origin::BuiltIn);
       }
    }
    return 0;
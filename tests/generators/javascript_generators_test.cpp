@@ -4,11 +4,14 @@
 #include "base/jstexgenmanager.h"
 #include "base/settingsmanager.h"
 #include "generators/builtinregistry.h"
+#include <QColor>
 #include <QFile>
 #include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QTest>
+#include <QVector>
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <atomic>
 #include <thread>
@@ -115,6 +118,15 @@ private slots:
 
    /// @brief Verifies corrected metadata, alpha handling, centring, and edge behaviour.
    void rendersCorrectedBundledGenerators();
+
+   /// @brief Verifies bundled scripts work in place without changing inputs, and others copy.
+   void sharesImageMemoryWithBundledGenerators();
+
+   /// @brief Verifies bundled scripts leave the cached images of their connected inputs intact.
+   void leavesConnectedInputImagesUnchanged();
+
+   /// @brief Verifies C++ implementations of bundled scripts render what the scripts render.
+   void nativeImplementationsMatchScripts();
 };
 
 void JavaScriptGeneratorsTest::rendersAndReportsErrors() {
@@ -665,5 +677,209 @@ void JavaScriptGeneratorsTest::rendersCorrectedBundledGenerators() {
    QCOMPARE(plasma->data()[0].toRGBA(), background->data()[0].toRGBA());
 }
 
+void JavaScriptGeneratorsTest::sharesImageMemoryWithBundledGenerators() {
+   const QString copyScript = QStringLiteral(
+       "const generator={apiVersion:1,name:'Copy',type:'filter',inputs:['Image'],settings:[],"
+       "generate(size,settings,output,inputs){void size;void settings;"
+       "output.data.set(inputs.Image.data);}};");
+   const QSize size(9, 7);
+   const TextureImagePtr source = TextureImage::create(size);
+   for (std::size_t pixel = 0; pixel < source->pixelCount(); ++pixel) {
+      const auto value = static_cast<quint8>(pixel * 3);
+      source->data()[pixel] = TexturePixel(value, 255 - value, 7, 200);
+   }
+   const QMap<QString, TextureImagePtr> sources{{QStringLiteral("Image"), source}};
+
+   const quint64 customCopies = JsTexGen::bridgeCopyCount();
+   const TextureImagePtr copied = renderGenerator(
+       TextureGeneratorPtr(new JsTexGen(copyScript, QStringLiteral("copy.js"))), size, sources);
+   QCOMPARE(JsTexGen::bridgeCopyCount() - customCopies, quint64(2));
+   const quint64 bundledCopies = JsTexGen::bridgeCopyCount();
+   const TextureImagePtr shared = renderGenerator(
+       TextureGeneratorPtr(new JsTexGen(copyScript, QStringLiteral("copy.js"),
+                                        TextureGenerator::Origin::BuiltIn)),
+       size, sources);
+   QCOMPARE(JsTexGen::bridgeCopyCount(), bundledCopies);
+   for (std::size_t pixel = 0; pixel < source->pixelCount(); ++pixel) {
+      QCOMPARE(copied->data()[pixel].toRGBA(), source->data()[pixel].toRGBA());
+      QCOMPARE(shared->data()[pixel].toRGBA(), source->data()[pixel].toRGBA());
+   }
+
+   // Every bundled script sees the same memory as the graph, so none may write to its inputs.
+   TextureProject project(false);
+   registerBuiltInGenerators(project, BundledGeneratorImplementation::JavaScript);
+   const QMap<QString, TextureGeneratorPtr> generators = project.getGenerators();
+   for (const TextureGeneratorPtr& generator : generators) {
+      if (dynamic_cast<const JsTexGen*>(generator.data()) == nullptr) {
+         continue;
+      }
+      QMap<QString, TextureImagePtr> inputs;
+      QMap<QString, QVector<quint32>> originals;
+      for (const QString& slot : generator->getSourceSlots()) {
+         const TextureImagePtr input = TextureImage::create(size);
+         QVector<quint32>& original = originals[slot];
+         for (std::size_t pixel = 0; pixel < input->pixelCount(); ++pixel) {
+            const auto value = static_cast<quint8>(pixel * 5 + inputs.size() * 31);
+            input->data()[pixel] = TexturePixel(value, value / 2, 255 - value, value | 1);
+            original.append(input->data()[pixel].toRGBA());
+         }
+         inputs.insert(slot, input);
+      }
+      QVERIFY(!renderGenerator(generator, size, inputs).isNull());
+      for (auto input = inputs.cbegin(); input != inputs.cend(); ++input) {
+         for (std::size_t pixel = 0; pixel < input.value()->pixelCount(); ++pixel) {
+            QVERIFY2(input.value()->data()[pixel].toRGBA() ==
+                         originals.value(input.key()).at(static_cast<qsizetype>(pixel)),
+                     qPrintable(generator->getName()));
+         }
+      }
+   }
+}
+
+void JavaScriptGeneratorsTest::leavesConnectedInputImagesUnchanged() {
+   TextureProject project(false);
+   project.setRenderCache(nullptr);
+   registerBuiltInGenerators(project, BundledGeneratorImplementation::JavaScript);
+   const QStringList patternNames{QStringLiteral("Perlin noise"), QStringLiteral("Sine plasma"),
+                                  QStringLiteral("Noise")};
+   const QSize size(37, 29);
+   int nextId = 1;
+   QList<TextureNodePtr> patterns;
+   for (const QString& name : patternNames) {
+      const TextureGeneratorPtr generator = project.getGenerator(name);
+      QVERIFY2(!generator.isNull(), qPrintable(name));
+      patterns.append(project.newNode(nextId++, generator));
+   }
+
+   // The inputs are the images cached by the source nodes, which later renders share.
+   const QMap<QString, TextureGeneratorPtr> generators = project.getGenerators();
+   for (const TextureGeneratorPtr& generator : generators) {
+      if (dynamic_cast<const JsTexGen*>(generator.data()) == nullptr ||
+          generator->getSourceSlots().isEmpty()) {
+         continue;
+      }
+      const TextureNodePtr node = project.newNode(nextId++, generator);
+      QMap<int, QByteArray> originals;
+      const QStringList slots = generator->getSourceSlots();
+      for (qsizetype slot = 0; slot < slots.size(); ++slot) {
+         const TextureNodePtr source = patterns.at(slot % patterns.size());
+         QVERIFY(node->setSourceSlot(slots.at(slot), source->getId()));
+         const TextureImagePtr image = source->renderImage(size);
+         originals.insert(source->getId(),
+                          QByteArray(reinterpret_cast<const char*>(image->data()),
+                                     static_cast<qsizetype>(image->pixelCount() *
+                                                            sizeof(TexturePixel))));
+      }
+      QVERIFY2(!node->renderImage(size).isNull(), qPrintable(generator->getName()));
+      for (auto original = originals.cbegin(); original != originals.cend(); ++original) {
+         const TextureImagePtr image = project.getNode(original.key())->cachedImage(size);
+         QVERIFY2(!image.isNull(), qPrintable(generator->getName()));
+         QVERIFY2(std::memcmp(image->data(), original.value().constData(),
+                              static_cast<std::size_t>(original.value().size())) == 0,
+                  qPrintable(generator->getName()));
+      }
+      project.removeNode(node->getId());
+   }
+}
+
+void JavaScriptGeneratorsTest::nativeImplementationsMatchScripts() {
+   TextureProject nativeProject(false);
+   registerBuiltInGenerators(nativeProject);
+   TextureProject scriptProject(false);
+   registerBuiltInGenerators(scriptProject, BundledGeneratorImplementation::JavaScript);
+
+   const QSize size(31, 23);
+   const auto pattern = [size](const int seed) {
+      const TextureImagePtr image = TextureImage::create(size);
+      for (std::size_t pixel = 0; pixel < image->pixelCount(); ++pixel) {
+         const auto value = static_cast<quint8>(pixel * 37 + seed * 101);
+         const quint8 alpha = pixel % 4 == 0 ? 0 : pixel % 4 == 1 ? 255 : value;
+         image->data()[pixel] =
+             TexturePixel(value, static_cast<quint8>(value * 3), 255 - value, alpha);
+      }
+      return image;
+   };
+
+   struct Case {
+      QString generator;
+      TextureNodeSettings settings;
+   };
+   const QVector<Case> cases{
+       {QStringLiteral("Perlin noise"), {}},
+       {QStringLiteral("Perlin noise"),
+        {{QStringLiteral("seamless"), true},
+         {QStringLiteral("numoctaves"), 8},
+         {QStringLiteral("zoom"), 3},
+         {QStringLiteral("invert"), true},
+         {QStringLiteral("color"), QColor(10, 200, 30, 128)}}},
+       {QStringLiteral("Noise"), {}},
+       {QStringLiteral("Noise"),
+        {{QStringLiteral("scatter"), false},
+         {QStringLiteral("smoothscale"), true},
+         {QStringLiteral("width"), 17},
+         {QStringLiteral("alphamin"), 200},
+         {QStringLiteral("alphamax"), 40}}},
+       {QStringLiteral("Sine plasma"), {}},
+       {QStringLiteral("Sine plasma"),
+        {{QStringLiteral("color"), QColor(1, 2, 3, 90)}, {QStringLiteral("xoffset"), -33.3}}},
+       {QStringLiteral("Fire"), {}},
+       {QStringLiteral("Fire"),
+        {{QStringLiteral("sinewave"), true},
+         {QStringLiteral("waveamplitude"), 30.0},
+         {QStringLiteral("wavefrequency"), 7.0},
+         {QStringLiteral("iterations"), 37}}},
+       {QStringLiteral("Whirl"), {}},
+       {QStringLiteral("Whirl"),
+        {{QStringLiteral("radius"), 180.0},
+         {QStringLiteral("strength"), -444.0},
+         {QStringLiteral("offsettop"), -70.0}}},
+       {QStringLiteral("Transform"), {}},
+       {QStringLiteral("Transform"),
+        {{QStringLiteral("rotation"), 33.0},
+         {QStringLiteral("xscale"), 70.0},
+         {QStringLiteral("firstXtiles"), 3},
+         {QStringLiteral("secondYtiles"), 4},
+         {QStringLiteral("backgroundcolor"), QColor(9, 8, 7, 100)}}},
+       {QStringLiteral("Blending"), {}},
+       {QStringLiteral("Blending"),
+        {{QStringLiteral("mode"), QStringLiteral("Soft Light")},
+         {QStringLiteral("alpha"), 45.0},
+         {QStringLiteral("order"), QStringLiteral("Base on top of Blend")}}},
+       {QStringLiteral("Blending"), {{QStringLiteral("mode"), QStringLiteral("Colour Burn")}}},
+   };
+
+   for (const Case& testCase : cases) {
+      const TextureGeneratorPtr native = nativeProject.getGenerator(testCase.generator);
+      const TextureGeneratorPtr script = scriptProject.getGenerator(testCase.generator);
+      QVERIFY2(!native.isNull() && !script.isNull(), qPrintable(testCase.generator));
+      QVERIFY(!static_cast<const JsTexGen&>(*native).getNativeImplementation().isNull());
+      QVERIFY(static_cast<const JsTexGen&>(*script).getNativeImplementation().isNull());
+      QVERIFY(native->getCacheIdentity() != script->getCacheIdentity());
+
+      for (const bool withSources : {false, true}) {
+         QMap<QString, TextureImagePtr> sources;
+         if (withSources) {
+            for (const QString& slot : script->getSourceSlots()) {
+               sources.insert(slot, pattern(static_cast<int>(sources.size())));
+            }
+         }
+         const TextureImagePtr expected = renderGenerator(script, size, sources, testCase.settings);
+         const TextureImagePtr actual = renderGenerator(native, size, sources, testCase.settings);
+         // Math.sin() and Math.cos() may round differently from the C library in the last bit,
+         // which can move a rounded channel or a sampled coordinate at a few pixels.
+         std::size_t differingPixels = 0;
+         for (std::size_t pixel = 0; pixel < expected->pixelCount(); ++pixel) {
+            if (expected->data()[pixel].toRGBA() != actual->data()[pixel].toRGBA()) {
+               ++differingPixels;
+            }
+         }
+         QVERIFY2(differingPixels <= expected->pixelCount() / 100,
+                  qPrintable(QStringLiteral("%1: %2 differing pixels")
+                                 .arg(testCase.generator)
+                                 .arg(differingPixels)));
+      }
+   }
+}
+
 QTEST_GUILESS_MAIN(JavaScriptGeneratorsTest)
 #include "javascript_generators_test.moc"